@@ -42,19 +42,27 @@ SOURCES += \
     dropoutanalysisdialog.cpp \
     ../ld-chroma-decoder/palcolour.cpp \
     ../ld-chroma-decoder/comb.cpp \
+    ../ld-chroma-decoder/combkernels.cpp \
     ../ld-chroma-decoder/componentframe.cpp \
     ../ld-chroma-decoder/outputwriter.cpp \
+    ../ld-chroma-decoder/transformfft.cpp \
     ../ld-chroma-decoder/transformpal.cpp \
     ../ld-chroma-decoder/transformpal2d.cpp \
     ../ld-chroma-decoder/transformpal3d.cpp \
     ../ld-chroma-decoder/framecanvas.cpp \
     ../ld-chroma-decoder/sourcefield.cpp \
+    ../library/tbc/binarymetadata.cpp \
+    ../library/tbc/compressedtbc.cpp \
     ../library/tbc/dropouts.cpp \
+    ../library/tbc/fieldcache.cpp \
+    ../library/tbc/fieldstore.cpp \
     ../library/tbc/filters.cpp \
     ../library/tbc/jsonio.cpp \
     ../library/tbc/lddecodemetadata.cpp \
     ../library/tbc/logging.cpp \
+    ../library/tbc/parallelfor.cpp \
     ../library/tbc/sourcevideo.cpp \
+    ../library/tbc/tbcparts.cpp \
     ../library/tbc/vbidecoder.cpp \
     visibledropoutanalysisdialog.cpp \
     whitesnranalysisdialog.cpp
@@ -75,21 +83,29 @@ HEADERS += \
     dropoutanalysisdialog.h \
     ../ld-chroma-decoder/palcolour.h \
     ../ld-chroma-decoder/comb.h \
+    ../ld-chroma-decoder/combkernels.h \
     ../ld-chroma-decoder/componentframe.h \
     ../ld-chroma-decoder/outputwriter.h \
+    ../ld-chroma-decoder/transformfft.h \
     ../ld-chroma-decoder/transformpal.h \
     ../ld-chroma-decoder/transformpal2d.h \
     ../ld-chroma-decoder/transformpal3d.h \
     ../ld-chroma-decoder/framecanvas.h \
     ../ld-chroma-decoder/sourcefield.h \
     ../library/filter/firfilter.h \
+    ../library/tbc/binarymetadata.h \
+    ../library/tbc/compressedtbc.h \
     ../library/tbc/dropouts.h \
+    ../library/tbc/fieldcache.h \
+    ../library/tbc/fieldstore.h \
     ../library/tbc/filters.h \
     ../library/tbc/jsonio.h \
     ../library/tbc/lddecodemetadata.h \
     ../library/tbc/linenumber.h \
     ../library/tbc/logging.h \
+    ../library/tbc/parallelfor.h \
     ../library/tbc/sourcevideo.h \
+    ../library/tbc/tbcparts.h \
     ../library/tbc/vbidecoder.h \
     visibledropoutanalysisdialog.h \
     whitesnranalysisdialog.h
@@ -144,6 +160,12 @@ INCLUDEPATH += "/usr/local/include"
 LIBS += -L"/usr/local/lib"
 LIBS += -lfftw3
 
+# Single-precision FFTW is optional (used for --transform-single)
+packagesExist(fftw3f) {
+    DEFINES += HAVE_FFTW3F
+    LIBS += -lfftw3f
+}
+
 # Include the QWT library (used for charting)
 unix:!macx {
 #INCLUDEPATH += $(QWT)/include
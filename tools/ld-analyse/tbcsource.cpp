@@ -25,6 +25,7 @@
 
 #include "tbcsource.h"
 
+#include "binarymetadata.h"
 #include "sourcefield.h"
 
 TbcSource::TbcSource(QObject *parent) : QObject(parent)
@@ -66,6 +67,10 @@ void TbcSource::loadSource(QString sourceFilename)
 // Method to unload a TBC source file
 void TbcSource::unloadSource()
 {
+    // Discard loaded fields, as they may refer to the source's memory mapping
+    inputFields.clear();
+    chromaInputFields.clear();
+
     sourceVideo.close();
     if (sourceMode != ONE_SOURCE) chromaSourceVideo.close();
     resetState();
@@ -396,15 +401,16 @@ TbcSource::ScanLineData TbcSource::getScanLineData(qint32 scanLine)
                                 && (scanLine -1) < videoParameters.lastActiveFrameLine;
 
     // Get the field video and dropout data
-    const SourceVideo::Data &fieldData = lineNumber.isFirstField() ? inputFields[inputStartIndex].data
+    const SourceVideo::View &fieldData = lineNumber.isFirstField() ? inputFields[inputStartIndex].data
                                                                    : inputFields[inputStartIndex + 1].data;
     const ComponentFrame &componentFrame = getComponentFrame();
-    DropOuts &dropouts = lineNumber.isFirstField() ? firstField.dropOuts
-                                                   : secondField.dropOuts;
+    const DropOuts &dropouts = lineNumber.isFirstField() ? firstField.dropOuts
+                                                         : secondField.dropOuts;
 
     scanLineData.composite.resize(videoParameters.fieldWidth);
     scanLineData.luma.resize(videoParameters.fieldWidth);
     scanLineData.isDropout.resize(videoParameters.fieldWidth);
+    DropOutIndex(dropouts, videoParameters.fieldHeight).getLineMask(lineNumber.field1(), scanLineData.isDropout);
 
     for (qint32 xPosition = 0; xPosition < videoParameters.fieldWidth; xPosition++) {
         // Get the 16-bit composite value for the current pixel (frame data is numbered 0-624 or 0-524)
@@ -412,13 +418,6 @@ TbcSource::ScanLineData TbcSource::getScanLineData(qint32 scanLine)
 
         // Get the decoded luma value for the current pixel (only computed in the active region)
         scanLineData.luma[xPosition] = static_cast<qint32>(componentFrame.y(scanLine - 1)[xPosition]);
-
-        scanLineData.isDropout[xPosition] = false;
-        for (qint32 doCount = 0; doCount < dropouts.size(); doCount++) {
-            if (dropouts.fieldLine(doCount) == lineNumber.field1()) {
-                if (xPosition >= dropouts.startx(doCount) && xPosition <= dropouts.endx(doCount)) scanLineData.isDropout[xPosition] = true;
-            }
-        }
     }
 
     return scanLineData;
@@ -630,13 +629,15 @@ void TbcSource::loadInputFields()
 
         // Add chroma to luma, removing the offset
         for (qint32 fieldIndex = inputStartIndex; fieldIndex < inputEndIndex; fieldIndex++) {
-            auto &sourceData = inputFields[fieldIndex].data;
+            SourceVideo::Data sourceData = inputFields[fieldIndex].data.toData();
             const auto &chromaData = chromaInputFields[fieldIndex].data;
 
             for (qint32 i = 0; i < sourceData.size(); i++) {
                 qint32 sum = static_cast<qint32>(sourceData[i]) + static_cast<qint32>(chromaData[i]) - CHROMA_OFFSET;
                 sourceData[i] = static_cast<quint16>(qBound(0, sum, 65535));
             }
+
+            inputFields[fieldIndex].data = sourceData;
         }
     }
 
@@ -864,13 +865,8 @@ void TbcSource::generateData()
 
         if (ignoreChapters) continue;
 
-        // Decode the VBI
-        VbiDecoder::Vbi vbi = vbiDecoder.decodeFrame(
-            firstField.vbi.vbiData[0], firstField.vbi.vbiData[1], firstField.vbi.vbiData[2],
-            secondField.vbi.vbiData[0], secondField.vbi.vbiData[1], secondField.vbi.vbiData[2]);
-
-        // Get the chapter number
-        qint32 currentChapter = vbi.chNo;
+        // Get the chapter number from the decoded VBI
+        qint32 currentChapter = ldDecodeMetaData.getFrameVbi(frameNumber + 1).chNo;
         if (currentChapter != -1) {
             if (currentChapter != lastChapter) {
                 lastChapter = currentChapter;
@@ -894,8 +890,10 @@ bool TbcSource::startBackgroundLoad(QString sourceFilename)
     QString jsonFileName = sourceFilename + ".json";
 
     const bool isChromaTbc = sourceFilename.endsWith("_chroma.tbc");
-    if (isChromaTbc && !QFileInfo::exists(jsonFileName)) {
-        // The user specified a _chroma.tbc file, and it doesn't have a .json.
+    if (isChromaTbc && !QFileInfo::exists(jsonFileName)
+        && BinaryMetadata::getSidecarFileName(jsonFileName).isEmpty()) {
+        // The user specified a _chroma.tbc file, and it doesn't have a .json
+        // (or binary metadata).
 
         // The corresponding luma file should have a .json, so use that.
         QString baseFilename = sourceFilename;
@@ -34,10 +34,16 @@
 
 #include <algorithm>
 #include <cmath>
+#include <limits>
 #include <memory>
 #include <utility>
 #include <vector>
 
+// The margin around the active region that the filters read from clpbuffer.
+// getBestCandidates looks up to 2 lines up and down, and 3 samples left and right.
+static constexpr qint32 MARGIN_LINES = 2;
+static constexpr qint32 MARGIN_SAMPLES = 3;
+
 // Indexes for the candidates considered in 3D adaptive mode
 enum CandidateIndex : qint32 {
     CAND_LEFT,
@@ -130,27 +136,36 @@ void Comb::updateConfiguration(const LdDecodeMetaData::VideoParameters &_videoPa
         qCritical() << "Data is not in 4fsc sample rate, color decoding will not work properly!";
     }
 
+    // (Re)allocate the frame buffers for the new parameters
+    nextFrameBuffer = std::make_unique<FrameBuffer>(videoParameters, configuration);
+    currentFrameBuffer = std::make_unique<FrameBuffer>(videoParameters, configuration);
+    previousFrameBuffer = std::make_unique<FrameBuffer>(videoParameters, configuration);
+
     configurationSet = true;
 }
 
 void Comb::decodeFrames(const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
-                        QVector<ComponentFrame> &componentFrames)
+                        QVector<ComponentFrame> &componentFrames, bool continuesPrevious)
 {
     assert(configurationSet);
     assert((componentFrames.size() * 2) == (endIndex - startIndex));
 
-    // Buffers for the next, current and previous frame.
-    // Because we only need three of these, we allocate them upfront then
-    // rotate the pointers below.
-    auto nextFrameBuffer = std::make_unique<FrameBuffer>(videoParameters, configuration);
-    auto currentFrameBuffer = std::make_unique<FrameBuffer>(videoParameters, configuration);
-    auto previousFrameBuffer = std::make_unique<FrameBuffer>(videoParameters, configuration);
+    // Because we only need three frame buffers, they're allocated upfront by
+    // updateConfiguration, and we rotate the pointers below.
 
     // Decode each pair of fields into a frame.
     // To support 3D operation, where we need to see three input frames at a time,
     // each iteration of the loop loads and 1D/2D-filters frame N + 1, then
     // 3D-filters and outputs frame N.
-    const qint32 preStartIndex = (configuration.dimensions == 3) ? startIndex - 4 : startIndex - 2;
+    //
+    // When continuing from the previous call in 3D mode, the buffers already
+    // hold the frame before startIndex and the one at startIndex (which were
+    // the last output frame and the lookahead frame last time), so we can
+    // start directly at startIndex.
+    qint32 preStartIndex = startIndex - 2;
+    if (configuration.dimensions == 3) {
+        preStartIndex = continuesPrevious ? startIndex : startIndex - 4;
+    }
     for (qint32 fieldIndex = preStartIndex; fieldIndex < endIndex; fieldIndex += 2) {
         const qint32 frameIndex = (fieldIndex - startIndex) / 2;
 
@@ -172,6 +187,11 @@ void Comb::decodeFrames(const QVector<SourceField> &inputFields, qint32 startInd
 
             // Extract chroma using 2D filter
             nextFrameBuffer->split2D();
+
+            if (configuration.dimensions == 3) {
+                // Estimate luma for the 3D filter to compare candidates
+                nextFrameBuffer->estimateLuma();
+            }
         }
 
         if (fieldIndex < startIndex) {
@@ -216,13 +236,37 @@ void Comb::decodeFrames(const QVector<SourceField> &inputFields, qint32 startInd
 
 Comb::FrameBuffer::FrameBuffer(const LdDecodeMetaData::VideoParameters &videoParameters_,
                                const Configuration &configuration_)
-    : videoParameters(videoParameters_), configuration(configuration_)
+    : videoParameters(videoParameters_), configuration(configuration_), kernels(getCombKernels())
 {
     // Set the frame height
     frameHeight = ((videoParameters.fieldHeight * 2) - 1);
 
     // Set the IRE scale
     irescale = (videoParameters.white16bIre - videoParameters.black16bIre) / 100;
+
+    // Allocate the chroma buffers (the 3D buffer is only used in 3D mode)
+    const qint32 numBuffers = (configuration.dimensions == 3) ? 3 : 2;
+    for (qint32 buf = 0; buf < numBuffers; buf++) {
+        clpbuffer[buf].resize(videoParameters.firstActiveFrameLine - MARGIN_LINES,
+                              videoParameters.lastActiveFrameLine + MARGIN_LINES,
+                              videoParameters.activeVideoEnd + MARGIN_SAMPLES);
+    }
+
+    // Allocate the luma estimate used to compare 3D candidates
+    if (configuration.dimensions == 3) {
+        ybuffer.resize(videoParameters.firstActiveFrameLine - MARGIN_LINES,
+                       videoParameters.lastActiveFrameLine + MARGIN_LINES,
+                       videoParameters.activeVideoEnd + MARGIN_SAMPLES);
+    }
+}
+
+// Allocate a buffer covering lines from firstLine up to (but not including)
+// lastLine, and samples from 0 up to width, filled with zeros
+void Comb::FrameBuffer::SampleBuffer::resize(qint32 _firstLine, qint32 lastLine, qint32 _width)
+{
+    firstLine = _firstLine;
+    width = _width;
+    samples.assign(static_cast<size_t>(lastLine - firstLine) * width, 0.0);
 }
 
 /*
@@ -261,11 +305,15 @@ inline bool Comb::FrameBuffer::getLinePhase(qint32 lineNumber) const
 void Comb::FrameBuffer::loadFields(const SourceField &firstField, const SourceField &secondField)
 {
     // Interlace the input fields and place in the frame buffer
+    const qint32 fieldWidth = videoParameters.fieldWidth;
     qint32 fieldLine = 0;
-    rawbuffer.clear();
+    rawbuffer.resize(((frameHeight + 1) / 2) * 2 * fieldWidth);
+    quint16 *rawLine = rawbuffer.data();
     for (qint32 frameLine = 0; frameLine < frameHeight; frameLine += 2) {
-        rawbuffer.append(firstField.data.mid(fieldLine * videoParameters.fieldWidth, videoParameters.fieldWidth));
-        rawbuffer.append(secondField.data.mid(fieldLine * videoParameters.fieldWidth, videoParameters.fieldWidth));
+        const quint16 *firstLine = firstField.data.data() + (fieldLine * fieldWidth);
+        const quint16 *secondLine = secondField.data.data() + (fieldLine * fieldWidth);
+        rawLine = std::copy(firstLine, firstLine + fieldWidth, rawLine);
+        rawLine = std::copy(secondLine, secondLine + fieldWidth, rawLine);
         fieldLine++;
     }
 
@@ -273,14 +321,8 @@ void Comb::FrameBuffer::loadFields(const SourceField &firstField, const SourceFi
     firstFieldPhaseID = firstField.field.fieldPhaseID;
     secondFieldPhaseID = secondField.field.fieldPhaseID;
 
-    // Clear clpbuffer
-    for (qint32 buf = 0; buf < 3; buf++) {
-        for (qint32 y = 0; y < MAX_HEIGHT; y++) {
-            for (qint32 x = 0; x < MAX_WIDTH; x++) {
-                clpbuffer[buf].pixel[y][x] = 0.0;
-            }
-        }
-    }
+    // clpbuffer doesn't need clearing: the filters overwrite all of the
+    // active region, and never write to the margin around it
 
     // No component frame yet
     componentFrame = nullptr;
@@ -300,12 +342,8 @@ void Comb::FrameBuffer::split1D()
         // Get a pointer to the line's data
         const quint16 *line = rawbuffer.data() + (lineNumber * videoParameters.fieldWidth);
 
-        for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
-            double tc1 = (line[h] - ((line[h - 2] + line[h + 2]) / 2.0)) / 2.0;
-
-            // Record the 1D C value
-            clpbuffer[0].pixel[lineNumber][h] = tc1;
-        }
+        kernels.split1D(line, clpbuffer[0].line(lineNumber),
+                        videoParameters.activeVideoStart, videoParameters.activeVideoEnd);
     }
 }
 
@@ -329,65 +367,35 @@ void Comb::FrameBuffer::split2D()
         // If a line we need is outside the active area, use blackLine instead.
         const double *previousLine = blackLine;
         if (lineNumber - 2 >= videoParameters.firstActiveFrameLine) {
-            previousLine = clpbuffer[0].pixel[lineNumber - 2];
+            previousLine = clpbuffer[0].line(lineNumber - 2);
         }
-        const double *currentLine = clpbuffer[0].pixel[lineNumber];
+        const double *currentLine = clpbuffer[0].line(lineNumber);
         const double *nextLine = blackLine;
         if (lineNumber + 2 < videoParameters.lastActiveFrameLine) {
-            nextLine = clpbuffer[0].pixel[lineNumber + 2];
+            nextLine = clpbuffer[0].line(lineNumber + 2);
         }
 
-        for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
-            double kp, kn;
-
-            // Summing the differences of the *absolute* values of the 1D chroma samples
-            // will give us a low value if the two lines are nearly in phase (strong Y)
-            // or nearly 180 degrees out of phase (strong C) -- i.e. the two cases where
-            // the 2D filter is probably usable. Also give a small bonus if
-            // there's a large signal (we think).
-            kp  = fabs(fabs(currentLine[h]) - fabs(previousLine[h]));
-            kp += fabs(fabs(currentLine[h - 1]) - fabs(previousLine[h - 1]));
-            kp -= (fabs(currentLine[h]) + fabs(previousLine[h - 1])) * .10;
-            kn  = fabs(fabs(currentLine[h]) - fabs(nextLine[h]));
-            kn += fabs(fabs(currentLine[h - 1]) - fabs(nextLine[h - 1]));
-            kn -= (fabs(currentLine[h]) + fabs(nextLine[h - 1])) * .10;
-
-            // Map the difference into a weighting 0-1.
-            // 1 means in phase or unknown; 0 means out of phase (more than kRange difference).
-            const double kRange = 45 * irescale;
-            kp = qBound(0.0, 1 - (kp / kRange), 1.0);
-            kn = qBound(0.0, 1 - (kn / kRange), 1.0);
-
-            double sc = 1.0;
-
-            if ((kn > 0) || (kp > 0)) {
-                // At least one of the next/previous lines has a good phase relationship.
-
-                // If one of them is much better than the other, only use that one
-                if (kn > (3 * kp)) kp = 0;
-                else if (kp > (3 * kn)) kn = 0;
-
-                sc = (2.0 / (kn + kp));
-                if (sc < 1.0) sc = 1.0;
-            } else {
-                // Neither line has a good phase relationship.
-
-                // But are they similar to each other? If so, we can use both of them!
-                if ((fabs(fabs(previousLine[h]) - fabs(nextLine[h])) - fabs((nextLine[h] + previousLine[h]) * .2)) <= 0) {
-                    kn = kp = 1;
-                }
+        // Map the difference between lines into a weighting 0-1, with
+        // anything more than kRange being out of phase
+        const double kRange = 45 * irescale;
 
-                // Else kn = kp = 0, so we won't extract any chroma for this sample.
-                // (Some NTSC decoders fall back to the 1D chroma in this situation.)
-            }
+        kernels.split2D(previousLine, currentLine, nextLine, kRange, clpbuffer[1].line(lineNumber),
+                        videoParameters.activeVideoStart, videoParameters.activeVideoEnd);
+    }
+}
 
-            // Compute the weighted sum of differences, giving the 2D chroma value
-            double tc1;
-            tc1  = ((currentLine[h] - previousLine[h]) * kp * sc);
-            tc1 += ((currentLine[h] - nextLine[h]) * kn * sc);
-            tc1 /= 4;
+// Estimate the luma of each sample for comparing 3D candidates, by removing
+// the 2D chroma from the composite signal. This is done once per frame, as
+// each frame is used as a candidate source for its neighbours too.
+void Comb::FrameBuffer::estimateLuma()
+{
+    for (qint32 lineNumber = videoParameters.firstActiveFrameLine; lineNumber < videoParameters.lastActiveFrameLine; lineNumber++) {
+        const quint16 *line = rawbuffer.data() + (lineNumber * videoParameters.fieldWidth);
+        const double *chroma = clpbuffer[1].line(lineNumber);
+        double *luma = ybuffer.line(lineNumber);
 
-            clpbuffer[1].pixel[lineNumber][h] = tc1;
+        for (qint32 h = videoParameters.activeVideoStart - MARGIN_SAMPLES; h < videoParameters.activeVideoEnd + MARGIN_SAMPLES; h++) {
+            luma[h] = line[h] - chroma[h];
         }
     }
 }
@@ -400,129 +408,173 @@ void Comb::FrameBuffer::split2D()
 // candidate.
 void Comb::FrameBuffer::split3D(const FrameBuffer &previousFrame, const FrameBuffer &nextFrame)
 {
+    qint32 bestIndex[MAX_WIDTH];
+    double bestSample[MAX_WIDTH];
+
     for (qint32 lineNumber = videoParameters.firstActiveFrameLine; lineNumber < videoParameters.lastActiveFrameLine; lineNumber++) {
-        for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
-            // Select the best candidate
-            qint32 bestIndex;
-            double bestSample;
-            getBestCandidate(lineNumber, h, previousFrame, nextFrame, bestIndex, bestSample);
+        // Select the best candidate for each sample
+        getBestCandidates(lineNumber, previousFrame, nextFrame, bestIndex, bestSample);
 
-            if (bestIndex < CAND_PREV_FIELD) {
+        for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
+            if (bestIndex[h] < CAND_PREV_FIELD) {
                 // A 1D or 2D candidate was best.
                 // Use split2D's output, to save duplicating the line-blending heuristics here.
-                clpbuffer[2].pixel[lineNumber][h] = clpbuffer[1].pixel[lineNumber][h];
+                clpbuffer[2].line(lineNumber)[h] = clpbuffer[1].line(lineNumber)[h];
             } else {
                 // Compute a 3D result.
                 // This sample is Y + C; the candidate is (ideally) Y - C. So compute C as ((Y + C) - (Y - C)) / 2.
-                clpbuffer[2].pixel[lineNumber][h] = (clpbuffer[0].pixel[lineNumber][h] - bestSample) / 2;
+                clpbuffer[2].line(lineNumber)[h] = (clpbuffer[0].line(lineNumber)[h] - bestSample[h]) / 2;
             }
         }
     }
 }
 
-// Evaluate all candidates for 3D decoding for a given position, and return the best one
-void Comb::FrameBuffer::getBestCandidate(qint32 lineNumber, qint32 h,
-                                         const FrameBuffer &previousFrame, const FrameBuffer &nextFrame,
-                                         qint32 &bestIndex, double &bestSample) const
+// Evaluate all candidates for 3D decoding for each sample in the active
+// region of a line, and return the best ones in bestIndex and bestSample
+// (indexed by sample number).
+//
+// The penalties are computed for a run of samples at a time, one candidate at
+// a time. The candidates are considered in order of preference, and if early
+// exit is enabled, the rest are skipped once every sample in the run has a
+// candidate with a penalty below the floor.
+void Comb::FrameBuffer::getBestCandidates(qint32 lineNumber, const FrameBuffer &previousFrame, const FrameBuffer &nextFrame,
+                                          qint32 *bestIndex, double *bestSample) const
 {
-    Candidate candidates[8];
+    const qint32 startH = videoParameters.activeVideoStart;
+    const qint32 endH = videoParameters.activeVideoEnd;
+
+    if (!configuration.adaptive) {
+        // Adaptive mode is disabled - do 3D against the previous frame
+        const double *sample = previousFrame.clpbuffer[0].line(lineNumber);
+        for (qint32 h = startH; h < endH; h++) {
+            bestIndex[h] = CAND_PREV_FRAME;
+            bestSample[h] = sample[h];
+        }
+        return;
+    }
 
     // Bias the comparison so that we prefer 3D results, then 2D, then 1D
     static constexpr double LINE_BONUS = -2.0;
     static constexpr double FIELD_BONUS = LINE_BONUS - 2.0;
     static constexpr double FRAME_BONUS = FIELD_BONUS - 2.0;
 
+    // Where each candidate comes from
+    struct CandidateSource {
+        const FrameBuffer *frameBuffer;
+        qint32 lineNumber;
+        qint32 offset;
+        double adjustPenalty;
+    };
+    CandidateSource sources[NUM_CANDIDATES];
+
     // 1D: Same line, 2 samples left and right
-    candidates[CAND_LEFT]  = getCandidate(lineNumber, h, *this, lineNumber, h - 2, 0);
-    candidates[CAND_RIGHT] = getCandidate(lineNumber, h, *this, lineNumber, h + 2, 0);
+    sources[CAND_LEFT]  = {this, lineNumber, -2, 0};
+    sources[CAND_RIGHT] = {this, lineNumber, 2, 0};
 
     // 2D: Same field, 1 line up and down
-    candidates[CAND_UP]   = getCandidate(lineNumber, h, *this, lineNumber - 2, h, LINE_BONUS);
-    candidates[CAND_DOWN] = getCandidate(lineNumber, h, *this, lineNumber + 2, h, LINE_BONUS);
+    sources[CAND_UP]   = {this, lineNumber - 2, 0, LINE_BONUS};
+    sources[CAND_DOWN] = {this, lineNumber + 2, 0, LINE_BONUS};
 
     // Immediately adjacent lines in previous/next field
     if (getLinePhase(lineNumber) == getLinePhase(lineNumber - 1)) {
-        candidates[CAND_PREV_FIELD] = getCandidate(lineNumber, h, previousFrame, lineNumber - 1, h, FIELD_BONUS);
-        candidates[CAND_NEXT_FIELD] = getCandidate(lineNumber, h, *this, lineNumber + 1, h, FIELD_BONUS);
+        sources[CAND_PREV_FIELD] = {&previousFrame, lineNumber - 1, 0, FIELD_BONUS};
+        sources[CAND_NEXT_FIELD] = {this, lineNumber + 1, 0, FIELD_BONUS};
     } else {
-        candidates[CAND_PREV_FIELD] = getCandidate(lineNumber, h, *this, lineNumber - 1, h, FIELD_BONUS);
-        candidates[CAND_NEXT_FIELD] = getCandidate(lineNumber, h, nextFrame, lineNumber + 1, h, FIELD_BONUS);
+        sources[CAND_PREV_FIELD] = {this, lineNumber - 1, 0, FIELD_BONUS};
+        sources[CAND_NEXT_FIELD] = {&nextFrame, lineNumber + 1, 0, FIELD_BONUS};
     }
 
     // Previous/next frame, same position
-    candidates[CAND_PREV_FRAME] = getCandidate(lineNumber, h, previousFrame, lineNumber, h, FRAME_BONUS);
-    candidates[CAND_NEXT_FRAME] = getCandidate(lineNumber, h, nextFrame, lineNumber, h, FRAME_BONUS);
-
-    if (configuration.adaptive) {
-        // Find the candidate with the lowest penalty
-        bestIndex = 0;
-        for (qint32 i = 1; i < NUM_CANDIDATES; i++) {
-            if (candidates[i].penalty < candidates[bestIndex].penalty) bestIndex = i;
-        }
-    } else {
-        // Adaptive mode is disabled - do 3D against the previous frame
-        bestIndex = CAND_PREV_FRAME;
+    sources[CAND_PREV_FRAME] = {&previousFrame, lineNumber, 0, FRAME_BONUS};
+    sources[CAND_NEXT_FRAME] = {&nextFrame, lineNumber, 0, FRAME_BONUS};
+
+    // A candidate is only viable if it's inside the active region (vertically),
+    // and has 180 degrees phase difference from the reference (which it won't,
+    // for example, if it's a blank frame or the player skipped). Both are the
+    // same for every sample on the line.
+    bool viable[NUM_CANDIDATES];
+    for (qint32 i = 0; i < NUM_CANDIDATES; i++) {
+        const CandidateSource &source = sources[i];
+        const qint32 wantPhase = (2 + (getLinePhase(lineNumber) ? 2 : 0) + startH) % 4;
+        const qint32 havePhase = ((source.frameBuffer->getLinePhase(source.lineNumber) ? 2 : 0) + startH + source.offset) % 4;
+        viable[i] = source.lineNumber >= videoParameters.firstActiveFrameLine
+                    && source.lineNumber < videoParameters.lastActiveFrameLine
+                    && wantPhase == havePhase;
     }
 
-    bestSample = candidates[bestIndex].sample;
-}
+    // The order to consider the candidates in
+    static constexpr CandidateIndex ORDER[NUM_CANDIDATES] = {
+        CAND_PREV_FRAME, CAND_NEXT_FRAME, CAND_PREV_FIELD, CAND_NEXT_FIELD,
+        CAND_UP, CAND_DOWN, CAND_LEFT, CAND_RIGHT,
+    };
 
-// Evaluate a candidate for 3D decoding
-Comb::FrameBuffer::Candidate Comb::FrameBuffer::getCandidate(qint32 refLineNumber, qint32 refH,
-                                                             const FrameBuffer &frameBuffer, qint32 lineNumber, qint32 h,
-                                                             double adjustPenalty) const
-{
-    Candidate result;
-    result.sample = frameBuffer.clpbuffer[0].pixel[lineNumber][h];
+    const double *refY = ybuffer.line(lineNumber);
+    const double *refC = clpbuffer[1].line(lineNumber);
 
-    // If the candidate is outside the active region (vertically), it's not viable
-    if (lineNumber < videoParameters.firstActiveFrameLine || lineNumber >= videoParameters.lastActiveFrameLine) {
-        result.penalty = 1000.0;
-        return result;
-    }
+    static constexpr qint32 RUN_LENGTH = 64;
+    double bestPenalty[RUN_LENGTH];
+    double penalty[RUN_LENGTH];
+    double yDiff[RUN_LENGTH + 2];
+    double cDiff[RUN_LENGTH + 2];
 
-    // The target sample should have 180 degrees phase difference from the reference.
-    // If it doesn't (e.g. because it's a blank frame or the player skipped), it's not viable.
-    const qint32 wantPhase = (2 + (getLinePhase(refLineNumber) ? 2 : 0) + refH) % 4;
-    const qint32 havePhase = ((frameBuffer.getLinePhase(lineNumber) ? 2 : 0) + h) % 4;
-    if (wantPhase != havePhase) {
-        result.penalty = 1000.0;
-        return result;
-    }
+    for (qint32 runStart = startH; runStart < endH; runStart += RUN_LENGTH) {
+        const qint32 runLength = qMin(RUN_LENGTH, endH - runStart);
 
-    // Pointers to the baseband data
-    const quint16 *refLine = rawbuffer.data() + (refLineNumber * videoParameters.fieldWidth);
-    const quint16 *candidateLine = frameBuffer.rawbuffer.data() + (lineNumber * videoParameters.fieldWidth);
+        for (qint32 i = 0; i < runLength; i++) {
+            bestPenalty[i] = std::numeric_limits<double>::infinity();
+            bestIndex[runStart + i] = NUM_CANDIDATES;
+        }
 
-    // Penalty based on mean luma difference in IRE over surrounding three samples
-    double yPenalty = 0.0;
-    for (qint32 offset = -1; offset < 2; offset++) {
-        const double refC = clpbuffer[1].pixel[refLineNumber][refH + offset];
-        const double refY = refLine[refH + offset] - refC;
+        for (const CandidateIndex index : ORDER) {
+            const CandidateSource &source = sources[index];
 
-        const double candidateC = frameBuffer.clpbuffer[1].pixel[lineNumber][h + offset];
-        const double candidateY = candidateLine[h + offset] - candidateC;
+            if (!viable[index]) {
+                for (qint32 i = 0; i < runLength; i++) penalty[i] = 1000.0;
+            } else {
+                // Compare the surrounding three samples. The reference and
+                // candidate are 180 degrees out of phase, so the chroma
+                // difference is the sum.
+                const double *candidateY = source.frameBuffer->ybuffer.line(source.lineNumber) + source.offset;
+                const double *candidateC = source.frameBuffer->clpbuffer[1].line(source.lineNumber) + source.offset;
+                for (qint32 i = 0; i < runLength + 2; i++) {
+                    const qint32 h = runStart + i - 1;
+                    yDiff[i] = fabs(refY[h] - candidateY[h]);
+                    cDiff[i] = fabs(refC[h] + candidateC[h]);
+                }
 
-        yPenalty += fabs(refY - candidateY);
-    }
-    yPenalty = yPenalty / 3 / irescale;
-
-    // Penalty based on mean I/Q difference in IRE over surrounding three samples
-    double iqPenalty = 0.0;
-    for (qint32 offset = -1; offset < 2; offset++) {
-        // The reference and candidate are 180 degrees out of phase here, so negate one
-        const double refC = clpbuffer[1].pixel[refLineNumber][refH + offset];
-        const double candidateC = -frameBuffer.clpbuffer[1].pixel[lineNumber][h + offset];
-
-        // I and Q samples alternate, so weight the two channels equally
-        static constexpr double weights[] = {0.5, 1.0, 0.5};
-        iqPenalty += fabs(refC - candidateC) * weights[offset + 1];
-    }
-    // Weaken this relative to luma, to avoid spurious colour in the 2D result from showing through
-    iqPenalty = (iqPenalty / 2 / irescale) * 0.28;
+                for (qint32 i = 0; i < runLength; i++) {
+                    // Penalty based on mean luma difference in IRE over surrounding three samples
+                    const double yPenalty = (yDiff[i] + yDiff[i + 1] + yDiff[i + 2]) / 3 / irescale;
+
+                    // Penalty based on mean I/Q difference in IRE over surrounding three samples.
+                    // I and Q samples alternate, so weight the two channels equally.
+                    // Weaken this relative to luma, to avoid spurious colour in the 2D result from showing through.
+                    const double iqPenalty = (((cDiff[i] * 0.5) + cDiff[i + 1] + (cDiff[i + 2] * 0.5)) / 2 / irescale) * 0.28;
+
+                    penalty[i] = yPenalty + iqPenalty + source.adjustPenalty;
+                }
+            }
+
+            // Keep the candidate with the lowest penalty, preferring the
+            // lowest index if there's a tie
+            for (qint32 i = 0; i < runLength; i++) {
+                qint32 &best = bestIndex[runStart + i];
+                const bool better = (penalty[i] < bestPenalty[i]) || (penalty[i] == bestPenalty[i] && index < best);
+                bestPenalty[i] = better ? penalty[i] : bestPenalty[i];
+                best = better ? index : best;
+            }
 
-    result.penalty = yPenalty + iqPenalty + adjustPenalty;
-    return result;
+            if (configuration.adaptiveEarlyExit
+                && std::all_of(bestPenalty, bestPenalty + runLength, [&](double p) { return p < configuration.adaptiveFloor; })) {
+                break;
+            }
+        }
+
+        for (qint32 h = runStart; h < runStart + runLength; h++) {
+            const CandidateSource &source = sources[bestIndex[h]];
+            bestSample[h] = source.frameBuffer->clpbuffer[0].line(source.lineNumber)[h + source.offset];
+        }
+    }
 }
 
 namespace {
@@ -579,7 +631,7 @@ void Comb::FrameBuffer::splitIQlocked()
         double *Q = componentFrame->v(lineNumber);
 
         for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
-            const auto val = clpbuffer[configuration.dimensions - 1].pixel[lineNumber][h];
+            const auto val = clpbuffer[configuration.dimensions - 1].line(lineNumber)[h];
 
             // Demodulate the sine and cosine components.
             const auto lsin = val * sin4fsc(h) * 2;
@@ -612,26 +664,8 @@ void Comb::FrameBuffer::splitIQ()
 
         bool linePhase = getLinePhase(lineNumber);
 
-        double si = 0, sq = 0;
-        for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
-            qint32 phase = h % 4;
-
-            double cavg = clpbuffer[configuration.dimensions - 1].pixel[lineNumber][h];
-
-            if (linePhase) cavg = -cavg;
-
-            switch (phase) {
-                case 0: sq = cavg; break;
-                case 1: si = -cavg; break;
-                case 2: sq = -cavg; break;
-                case 3: si = cavg; break;
-                default: break;
-            }
-
-            Y[h] = line[h];
-            I[h] = si;
-            Q[h] = sq;
-        }
+        kernels.splitIQ(line, clpbuffer[configuration.dimensions - 1].line(lineNumber), linePhase, Y, I, Q,
+                        videoParameters.activeVideoStart, videoParameters.activeVideoEnd);
     }
 }
 
@@ -669,21 +703,7 @@ void Comb::FrameBuffer::adjustY()
 
         bool linePhase = getLinePhase(lineNumber);
 
-        for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
-            double comp = 0;
-            qint32 phase = h % 4;
-
-            switch (phase) {
-                case 0: comp = -Q[h]; break;
-                case 1: comp = I[h]; break;
-                case 2: comp = Q[h]; break;
-                case 3: comp = -I[h]; break;
-                default: break;
-            }
-
-            if (!linePhase) comp = -comp;
-            Y[h] -= comp;
-        }
+        kernels.adjustY(I, Q, linePhase, Y, videoParameters.activeVideoStart, videoParameters.activeVideoEnd);
     }
 }
 
@@ -839,20 +859,20 @@ void Comb::FrameBuffer::overlayMap(const FrameBuffer &previousFrame, const Frame
     }
 
     // For each sample in the frame...
+    qint32 bestIndex[MAX_WIDTH];
+    double bestSample[MAX_WIDTH];
     for (qint32 lineNumber = videoParameters.firstActiveFrameLine; lineNumber < videoParameters.lastActiveFrameLine; lineNumber++) {
         double *U = componentFrame->u(lineNumber);
         double *V = componentFrame->v(lineNumber);
 
+        // Select the best candidate for each sample
+        getBestCandidates(lineNumber, previousFrame, nextFrame, bestIndex, bestSample);
+
         // Fill the output frame with the RGB values
         for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
-            // Select the best candidate
-            qint32 bestIndex;
-            double bestSample;
-            getBestCandidate(lineNumber, h, previousFrame, nextFrame, bestIndex, bestSample);
-
             // Leave Y' the same, but replace UV with the appropriate shade
-            U[h] = shades[bestIndex].u;
-            V[h] = shades[bestIndex].v;
+            U[h] = shades[bestIndex[h]].u;
+            V[h] = shades[bestIndex[h]].v;
         }
     }
 }
@@ -32,9 +32,12 @@
 #include <QDebug>
 #include <QFile>
 #include <QtMath>
+#include <memory>
+#include <vector>
 
 #include "lddecodemetadata.h"
 
+#include "combkernels.h"
 #include "componentframe.h"
 #include "decoder.h"
 #include "sourcefield.h"
@@ -51,6 +54,12 @@ public:
         qint32 dimensions = 2;
         bool adaptive = true;
         bool showMap = false;
+
+        // In adaptive 3D mode, stop considering candidates for a run of
+        // samples once they all have a candidate with a penalty below
+        // adaptiveFloor. This is faster, but may not pick the best candidate.
+        bool adaptiveEarlyExit = false;
+        double adaptiveFloor = -5.0;
         bool phaseCompensation = false;
 
         double cNRLevel = 0.0;
@@ -64,9 +73,14 @@ public:
     void updateConfiguration(const LdDecodeMetaData::VideoParameters &videoParameters,
                              const Configuration &configuration);
 
-    // Decode a sequence of fields into a sequence of interlaced frames
+    // Decode a sequence of fields into a sequence of interlaced frames.
+    //
+    // If continuesPrevious is true, the fields must directly follow those from
+    // the previous call. In 3D mode, the frames that overlap with the previous
+    // call are then taken from the frame buffers rather than being processed
+    // again.
     void decodeFrames(const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
-                      QVector<ComponentFrame> &componentFrames);
+                      QVector<ComponentFrame> &componentFrames, bool continuesPrevious = false);
 
     // Maximum frame size
     static constexpr qint32 MAX_WIDTH = 910;
@@ -89,6 +103,7 @@ private:
 
         void split1D();
         void split2D();
+        void estimateLuma();
         void split3D(const FrameBuffer &previousFrame, const FrameBuffer &nextFrame);
 
         void setComponentFrame(ComponentFrame &_componentFrame) {
@@ -110,6 +125,9 @@ private:
         const LdDecodeMetaData::VideoParameters &videoParameters;
         const Configuration &configuration;
 
+        // Per-line filter kernels
+        const CombKernels &kernels;
+
         // Calculated frame height
         qint32 frameHeight;
 
@@ -123,29 +141,46 @@ private:
         qint32 firstFieldPhaseID;
         qint32 secondFieldPhaseID;
 
-        // 1D, 2D and 3D-filtered chroma samples
-        struct Sample {
-            double pixel[MAX_HEIGHT][MAX_WIDTH];
-        } clpbuffer[3];
-
-        // Result of evaluating a 3D candidate
-        struct Candidate {
-            double penalty;
-            double sample;
+        // A buffer of samples, covering the active region of the frame
+        // and a margin around it. The filters read from the margin, but only
+        // write to the active region, so the margin stays zero.
+        class SampleBuffer {
+        public:
+            void resize(qint32 firstLine, qint32 lastLine, qint32 width);
+
+            double *line(qint32 lineNumber) {
+                return samples.data() + ((lineNumber - firstLine) * width);
+            }
+            const double *line(qint32 lineNumber) const {
+                return samples.data() + ((lineNumber - firstLine) * width);
+            }
+
+        private:
+            std::vector<double> samples;
+            qint32 firstLine = 0;
+            qint32 width = 0;
         };
 
+        // 1D, 2D and 3D-filtered chroma samples
+        SampleBuffer clpbuffer[3];
+
+        // Estimated luma samples (composite minus 2D chroma), for 3D mode
+        SampleBuffer ybuffer;
+
         // The component frame for output (if there is one)
         ComponentFrame *componentFrame;
 
         inline qint32 getFieldID(qint32 lineNumber) const;
         inline bool getLinePhase(qint32 lineNumber) const;
-        void getBestCandidate(qint32 lineNumber, qint32 h,
-                              const FrameBuffer &previousFrame, const FrameBuffer &nextFrame,
-                              qint32 &bestIndex, double &bestSample) const;
-        Candidate getCandidate(qint32 refLineNumber, qint32 refH,
-                               const FrameBuffer &frameBuffer, qint32 lineNumber, qint32 h,
-                               double adjustPenalty) const;
+        void getBestCandidates(qint32 lineNumber, const FrameBuffer &previousFrame, const FrameBuffer &nextFrame,
+                               qint32 *bestIndex, double *bestSample) const;
     };
+
+    // Buffers for the next, current and previous frame. These are allocated
+    // when the configuration is set, and reused for every batch of frames.
+    std::unique_ptr<FrameBuffer> nextFrameBuffer;
+    std::unique_ptr<FrameBuffer> currentFrameBuffer;
+    std::unique_ptr<FrameBuffer> previousFrameBuffer;
 };
 
 #endif // COMB_H
@@ -0,0 +1,357 @@
+/************************************************************************
+
+    combkernels.cpp
+
+    ld-chroma-decoder - Colourisation filter for ld-decode
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-chroma-decoder is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include "combkernels.h"
+
+#include <cmath>
+
+// AVX2 kernels are built with GCC or Clang on x86, using function attributes
+// so the rest of the program doesn't need AVX2
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define COMB_KERNELS_AVX2
+#include <immintrin.h>
+#endif
+
+// Portable kernels --------------------------------------------------------------------------------------------------
+
+static void split1DScalar(const quint16 *line, double *chroma, qint32 start, qint32 end)
+{
+    for (qint32 h = start; h < end; h++) {
+        double tc1 = (line[h] - ((line[h - 2] + line[h + 2]) / 2.0)) / 2.0;
+
+        // Record the 1D C value
+        chroma[h] = tc1;
+    }
+}
+
+static void split2DScalar(const double *previousLine, const double *currentLine, const double *nextLine,
+                          double kRange, double *chroma, qint32 start, qint32 end)
+{
+    for (qint32 h = start; h < end; h++) {
+        double kp, kn;
+
+        // Summing the differences of the *absolute* values of the 1D chroma samples
+        // will give us a low value if the two lines are nearly in phase (strong Y)
+        // or nearly 180 degrees out of phase (strong C) -- i.e. the two cases where
+        // the 2D filter is probably usable. Also give a small bonus if
+        // there's a large signal (we think).
+        kp  = fabs(fabs(currentLine[h]) - fabs(previousLine[h]));
+        kp += fabs(fabs(currentLine[h - 1]) - fabs(previousLine[h - 1]));
+        kp -= (fabs(currentLine[h]) + fabs(previousLine[h - 1])) * .10;
+        kn  = fabs(fabs(currentLine[h]) - fabs(nextLine[h]));
+        kn += fabs(fabs(currentLine[h - 1]) - fabs(nextLine[h - 1]));
+        kn -= (fabs(currentLine[h]) + fabs(nextLine[h - 1])) * .10;
+
+        // Map the difference into a weighting 0-1.
+        // 1 means in phase or unknown; 0 means out of phase (more than kRange difference).
+        kp = qBound(0.0, 1 - (kp / kRange), 1.0);
+        kn = qBound(0.0, 1 - (kn / kRange), 1.0);
+
+        double sc = 1.0;
+
+        if ((kn > 0) || (kp > 0)) {
+            // At least one of the next/previous lines has a good phase relationship.
+
+            // If one of them is much better than the other, only use that one
+            if (kn > (3 * kp)) kp = 0;
+            else if (kp > (3 * kn)) kn = 0;
+
+            sc = (2.0 / (kn + kp));
+            if (sc < 1.0) sc = 1.0;
+        } else {
+            // Neither line has a good phase relationship.
+
+            // But are they similar to each other? If so, we can use both of them!
+            if ((fabs(fabs(previousLine[h]) - fabs(nextLine[h])) - fabs((nextLine[h] + previousLine[h]) * .2)) <= 0) {
+                kn = kp = 1;
+            }
+
+            // Else kn = kp = 0, so we won't extract any chroma for this sample.
+            // (Some NTSC decoders fall back to the 1D chroma in this situation.)
+        }
+
+        // Compute the weighted sum of differences, giving the 2D chroma value
+        double tc1;
+        tc1  = ((currentLine[h] - previousLine[h]) * kp * sc);
+        tc1 += ((currentLine[h] - nextLine[h]) * kn * sc);
+        tc1 /= 4;
+
+        chroma[h] = tc1;
+    }
+}
+
+// splitIQ for part of a line. si and sq hold the most recent I and Q values,
+// which are carried forward to the following samples.
+static void splitIQRange(const quint16 *line, const double *chroma, bool linePhase,
+                         double *Y, double *I, double *Q, qint32 start, qint32 end,
+                         double si, double sq)
+{
+    for (qint32 h = start; h < end; h++) {
+        qint32 phase = h % 4;
+
+        double cavg = chroma[h];
+
+        if (linePhase) cavg = -cavg;
+
+        switch (phase) {
+            case 0: sq = cavg; break;
+            case 1: si = -cavg; break;
+            case 2: sq = -cavg; break;
+            case 3: si = cavg; break;
+            default: break;
+        }
+
+        Y[h] = line[h];
+        I[h] = si;
+        Q[h] = sq;
+    }
+}
+
+static void splitIQScalar(const quint16 *line, const double *chroma, bool linePhase,
+                          double *Y, double *I, double *Q, qint32 start, qint32 end)
+{
+    splitIQRange(line, chroma, linePhase, Y, I, Q, start, end, 0, 0);
+}
+
+static void adjustYScalar(const double *I, const double *Q, bool linePhase, double *Y, qint32 start, qint32 end)
+{
+    for (qint32 h = start; h < end; h++) {
+        double comp = 0;
+        qint32 phase = h % 4;
+
+        switch (phase) {
+            case 0: comp = -Q[h]; break;
+            case 1: comp = I[h]; break;
+            case 2: comp = Q[h]; break;
+            case 3: comp = -I[h]; break;
+            default: break;
+        }
+
+        if (!linePhase) comp = -comp;
+        Y[h] -= comp;
+    }
+}
+
+static const CombKernels scalarKernels {
+    "scalar",
+    split1DScalar,
+    split2DScalar,
+    splitIQScalar,
+    adjustYScalar,
+};
+
+// AVX2 kernels ------------------------------------------------------------------------------------------------------
+//
+// These process four samples at a time, using the same arithmetic operations
+// in the same order as the portable kernels, so the results are identical.
+// Branches are replaced by computing both alternatives and selecting between
+// them with masks. splitIQ and adjustY work on groups of four samples
+// starting at a multiple of 4, so the chroma phase of each lane is fixed, and
+// the per-phase choices become constant blends and sign tables.
+
+#ifdef COMB_KERNELS_AVX2
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+// Load four 16-bit samples, converted to doubles
+AVX2_TARGET static inline __m256d loadSamples(const quint16 *samples)
+{
+    const __m128i words = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(samples));
+    return _mm256_cvtepi32_pd(_mm_cvtepu16_epi32(words));
+}
+
+AVX2_TARGET static inline __m256d absPd(__m256d x)
+{
+    return _mm256_andnot_pd(_mm256_set1_pd(-0.0), x);
+}
+
+AVX2_TARGET static void split1DAvx2(const quint16 *line, double *chroma, qint32 start, qint32 end)
+{
+    const __m256d two = _mm256_set1_pd(2.0);
+
+    qint32 h = start;
+    for (; h + 4 <= end; h += 4) {
+        const __m256d left = loadSamples(line + h - 2);
+        const __m256d centre = loadSamples(line + h);
+        const __m256d right = loadSamples(line + h + 2);
+
+        const __m256d tc1 = _mm256_div_pd(_mm256_sub_pd(centre, _mm256_div_pd(_mm256_add_pd(left, right), two)), two);
+        _mm256_storeu_pd(chroma + h, tc1);
+    }
+
+    split1DScalar(line, chroma, h, end);
+}
+
+// Compute kp or kn for split2D, before it's mapped into a weighting
+AVX2_TARGET static inline __m256d split2DDifference(__m256d current, __m256d currentLeft,
+                                                    const double *otherLine, qint32 h)
+{
+    const __m256d other = absPd(_mm256_loadu_pd(otherLine + h));
+    const __m256d otherLeft = absPd(_mm256_loadu_pd(otherLine + h - 1));
+
+    __m256d k = absPd(_mm256_sub_pd(current, other));
+    k = _mm256_add_pd(k, absPd(_mm256_sub_pd(currentLeft, otherLeft)));
+    return _mm256_sub_pd(k, _mm256_mul_pd(_mm256_add_pd(current, otherLeft), _mm256_set1_pd(.10)));
+}
+
+AVX2_TARGET static void split2DAvx2(const double *previousLine, const double *currentLine, const double *nextLine,
+                                    double kRange, double *chroma, qint32 start, qint32 end)
+{
+    const __m256d zero = _mm256_setzero_pd();
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d three = _mm256_set1_pd(3.0);
+    const __m256d kRangeV = _mm256_set1_pd(kRange);
+
+    qint32 h = start;
+    for (; h + 4 <= end; h += 4) {
+        const __m256d current = absPd(_mm256_loadu_pd(currentLine + h));
+        const __m256d currentLeft = absPd(_mm256_loadu_pd(currentLine + h - 1));
+        __m256d kp = split2DDifference(current, currentLeft, previousLine, h);
+        __m256d kn = split2DDifference(current, currentLeft, nextLine, h);
+
+        // qBound(0.0, 1 - (k / kRange), 1.0). The operand order makes these
+        // behave like qMin and qMax.
+        kp = _mm256_max_pd(_mm256_min_pd(one, _mm256_sub_pd(one, _mm256_div_pd(kp, kRangeV))), zero);
+        kn = _mm256_max_pd(_mm256_min_pd(one, _mm256_sub_pd(one, _mm256_div_pd(kn, kRangeV))), zero);
+
+        // Either line has a good phase relationship: if one of them is much
+        // better than the other, only use that one
+        const __m256d good = _mm256_or_pd(_mm256_cmp_pd(kn, zero, _CMP_GT_OQ), _mm256_cmp_pd(kp, zero, _CMP_GT_OQ));
+        const __m256d knBetter = _mm256_cmp_pd(kn, _mm256_mul_pd(three, kp), _CMP_GT_OQ);
+        const __m256d kpBetter = _mm256_andnot_pd(knBetter, _mm256_cmp_pd(kp, _mm256_mul_pd(three, kn), _CMP_GT_OQ));
+        const __m256d goodKp = _mm256_blendv_pd(kp, zero, knBetter);
+        const __m256d goodKn = _mm256_blendv_pd(kn, zero, kpBetter);
+        __m256d goodSc = _mm256_div_pd(_mm256_set1_pd(2.0), _mm256_add_pd(goodKn, goodKp));
+        goodSc = _mm256_blendv_pd(goodSc, one, _mm256_cmp_pd(goodSc, one, _CMP_LT_OQ));
+
+        // Neither line has a good phase relationship (so kn and kp are 0):
+        // use both if they're similar to each other
+        const __m256d previous = _mm256_loadu_pd(previousLine + h);
+        const __m256d next = _mm256_loadu_pd(nextLine + h);
+        const __m256d similarity = _mm256_sub_pd(absPd(_mm256_sub_pd(absPd(previous), absPd(next))),
+                                                 absPd(_mm256_mul_pd(_mm256_add_pd(next, previous), _mm256_set1_pd(.2))));
+        const __m256d similar = _mm256_cmp_pd(similarity, zero, _CMP_LE_OQ);
+        const __m256d badKp = _mm256_blendv_pd(kp, one, similar);
+        const __m256d badKn = _mm256_blendv_pd(kn, one, similar);
+
+        kp = _mm256_blendv_pd(badKp, goodKp, good);
+        kn = _mm256_blendv_pd(badKn, goodKn, good);
+        const __m256d sc = _mm256_blendv_pd(one, goodSc, good);
+
+        // Compute the weighted sum of differences, giving the 2D chroma value
+        const __m256d centre = _mm256_loadu_pd(currentLine + h);
+        __m256d tc1 = _mm256_mul_pd(_mm256_mul_pd(_mm256_sub_pd(centre, previous), kp), sc);
+        tc1 = _mm256_add_pd(tc1, _mm256_mul_pd(_mm256_mul_pd(_mm256_sub_pd(centre, next), kn), sc));
+        tc1 = _mm256_div_pd(tc1, _mm256_set1_pd(4.0));
+
+        _mm256_storeu_pd(chroma + h, tc1);
+    }
+
+    split2DScalar(previousLine, currentLine, nextLine, kRange, chroma, h, end);
+}
+
+AVX2_TARGET static void splitIQAvx2(const quint16 *line, const double *chroma, bool linePhase,
+                                    double *Y, double *I, double *Q, qint32 start, qint32 end)
+{
+    // Work up to a multiple of 4
+    qint32 h = qMin((start + 3) & ~3, end);
+    splitIQRange(line, chroma, linePhase, Y, I, Q, start, h, 0, 0);
+
+    // In each group of four samples, with c being the chroma (negated if
+    // linePhase is set), I is {previous I, -c[1], -c[1], c[3]} and Q is
+    // {c[0], c[0], -c[2], -c[2]}
+    const __m256d lineSign = _mm256_set1_pd(linePhase ? -1.0 : 1.0);
+    const __m256d iSigns = _mm256_setr_pd(1.0, -1.0, -1.0, 1.0);
+    const __m256d qSigns = _mm256_setr_pd(1.0, 1.0, -1.0, -1.0);
+    __m256d previousI = _mm256_set1_pd(h > start ? I[h - 1] : 0.0);
+
+    for (; h + 4 <= end; h += 4) {
+        const __m256d c = _mm256_mul_pd(_mm256_loadu_pd(chroma + h), lineSign);
+
+        const __m256d iValues = _mm256_mul_pd(_mm256_permute4x64_pd(c, _MM_SHUFFLE(3, 1, 1, 3)), iSigns);
+        _mm256_storeu_pd(I + h, _mm256_blend_pd(iValues, previousI, 0x1));
+        _mm256_storeu_pd(Q + h, _mm256_mul_pd(_mm256_movedup_pd(c), qSigns));
+        _mm256_storeu_pd(Y + h, loadSamples(line + h));
+
+        previousI = _mm256_permute4x64_pd(c, _MM_SHUFFLE(3, 3, 3, 3));
+    }
+
+    // Finish the line, carrying on from the last I and Q values
+    if (h > start) {
+        splitIQRange(line, chroma, linePhase, Y, I, Q, h, end, I[h - 1], Q[h - 1]);
+    } else {
+        splitIQRange(line, chroma, linePhase, Y, I, Q, h, end, 0, 0);
+    }
+}
+
+AVX2_TARGET static void adjustYAvx2(const double *I, const double *Q, bool linePhase, double *Y, qint32 start, qint32 end)
+{
+    // Work up to a multiple of 4
+    qint32 h = qMin((start + 3) & ~3, end);
+    adjustYScalar(I, Q, linePhase, Y, start, h);
+
+    // In each group of four samples, the component is {-Q, I, Q, -I},
+    // negated if linePhase isn't set
+    const __m256d signs = linePhase ? _mm256_setr_pd(-1.0, 1.0, 1.0, -1.0) : _mm256_setr_pd(1.0, -1.0, -1.0, 1.0);
+
+    for (; h + 4 <= end; h += 4) {
+        const __m256d values = _mm256_blend_pd(_mm256_loadu_pd(Q + h), _mm256_loadu_pd(I + h), 0xA);
+        const __m256d comp = _mm256_mul_pd(values, signs);
+        _mm256_storeu_pd(Y + h, _mm256_sub_pd(_mm256_loadu_pd(Y + h), comp));
+    }
+
+    adjustYScalar(I, Q, linePhase, Y, h, end);
+}
+
+static const CombKernels avx2Kernels {
+    "AVX2",
+    split1DAvx2,
+    split2DAvx2,
+    splitIQAvx2,
+    adjustYAvx2,
+};
+
+#endif
+
+// Kernel selection --------------------------------------------------------------------------------------------------
+
+const CombKernels &getScalarCombKernels()
+{
+    return scalarKernels;
+}
+
+const CombKernels *getAvx2CombKernels()
+{
+#ifdef COMB_KERNELS_AVX2
+    if (__builtin_cpu_supports("avx2")) return &avx2Kernels;
+#endif
+
+    return nullptr;
+}
+
+const CombKernels &getCombKernels()
+{
+    static const CombKernels *kernels = getAvx2CombKernels();
+    return kernels != nullptr ? *kernels : scalarKernels;
+}
@@ -0,0 +1,64 @@
+/************************************************************************
+
+    combkernels.h
+
+    ld-chroma-decoder - Colourisation filter for ld-decode
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-chroma-decoder is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef COMBKERNELS_H
+#define COMBKERNELS_H
+
+#include <QtGlobal>
+
+// Per-line kernels for the NTSC comb filter (see Comb::FrameBuffer for what
+// each one does). Each kernel processes samples from start up to (but not
+// including) end on one line.
+//
+// There's a portable implementation of each kernel, and, where the compiler
+// supports it, an AVX2 implementation that's used if the CPU supports it.
+// The implementations give bit-identical results.
+struct CombKernels {
+    const char *name;
+
+    // Extract 1D chroma from the composite signal
+    void (*split1D)(const quint16 *line, double *chroma, qint32 start, qint32 end);
+
+    // Extract 2D chroma from the 1D chroma of three adjacent lines in a field
+    void (*split2D)(const double *previousLine, const double *currentLine, const double *nextLine,
+                    double kRange, double *chroma, qint32 start, qint32 end);
+
+    // Demodulate chroma into I and Q, and copy the composite signal to Y
+    void (*splitIQ)(const quint16 *line, const double *chroma, bool linePhase,
+                    double *Y, double *I, double *Q, qint32 start, qint32 end);
+
+    // Remove the remodulated I and Q from Y
+    void (*adjustY)(const double *I, const double *Q, bool linePhase, double *Y, qint32 start, qint32 end);
+};
+
+// Get the fastest kernels supported by this CPU
+const CombKernels &getCombKernels();
+
+// Get the portable kernels
+const CombKernels &getScalarCombKernels();
+
+// Get the AVX2 kernels, or nullptr if they're not supported by this build or CPU
+const CombKernels *getAvx2CombKernels();
+
+#endif // COMBKERNELS_H
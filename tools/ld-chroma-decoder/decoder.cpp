@@ -47,11 +47,12 @@ void DecoderThread::run()
     QVector<SourceField> inputFields;
     QVector<ComponentFrame> componentFrames;
     QVector<OutputFrame> outputFrames;
+    DecoderPool::InputRun inputRun;
 
     while (!abort) {
         // Get the next batch of fields to process
         qint32 startFrameNumber, startIndex, endIndex;
-        if (!decoderPool.getInputFrames(startFrameNumber, inputFields, startIndex, endIndex)) {
+        if (!decoderPool.getInputFrames(inputRun, startFrameNumber, inputFields, startIndex, endIndex)) {
             // No more input frames -- exit
             break;
         }
@@ -62,7 +63,7 @@ void DecoderThread::run()
         outputFrames.resize(numFrames);
 
         // Decode the fields to component frames
-        decodeFrames(inputFields, startIndex, endIndex, componentFrames);
+        decodeFrames(inputFields, startIndex, endIndex, componentFrames, inputRun.isContinuation);
 
         // Convert the component frames to the output format
         for (qint32 i = 0; i < numFrames; i++) {
@@ -94,9 +94,12 @@ public:
 protected:
     void run() override;
 
-    // Decode a sequence of composite fields into a sequence of component frames
+    // Decode a sequence of composite fields into a sequence of component frames.
+    // continuesPrevious is true if these frames directly follow the ones from
+    // the previous call, so the decoder can reuse its work on the fields that
+    // overlap.
     virtual void decodeFrames(const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
-                              QVector<ComponentFrame> &componentFrames) = 0;
+                              QVector<ComponentFrame> &componentFrames, bool continuesPrevious) = 0;
 
     // Decoder pool
     QAtomicInt &abort;
@@ -29,11 +29,12 @@
 DecoderPool::DecoderPool(Decoder &_decoder, QString _inputFileName,
                          LdDecodeMetaData &_ldDecodeMetaData,
                          OutputWriter::Configuration &_outputConfig, QString _outputFileName,
-                         qint32 _startFrame, qint32 _length, qint32 _maxThreads)
+                         qint32 _startFrame, qint32 _length, qint32 _maxThreads,
+                         qint32 _prefetchWindow, QString _followJsonFileName, qint32 _runLength)
     : decoder(_decoder), inputFileName(_inputFileName),
       outputConfig(_outputConfig), outputFileName(_outputFileName),
-      startFrame(_startFrame), length(_length), maxThreads(_maxThreads),
-      abort(false), ldDecodeMetaData(_ldDecodeMetaData)
+      startFrame(_startFrame), length(_length), maxThreads(_maxThreads), prefetchWindow(_prefetchWindow),
+      followJsonFileName(_followJsonFileName), runLength(_runLength), abort(false), ldDecodeMetaData(_ldDecodeMetaData)
 {
 }
 
@@ -54,7 +55,18 @@ bool DecoderPool::process()
     decoderLookBehind = decoder.getLookBehind();
     decoderLookAhead = decoder.getLookAhead();
 
-    // Open the source video file
+    // Runs read the input out of order, and need to know where it ends
+    if (runLength > 0 && (inputFileName == "-" || !followJsonFileName.isEmpty())) {
+        qInfo() << "Runs can't be used with piped or followed input, so decoding in batches";
+        runLength = 0;
+    }
+
+    // Open the source video file. If it's stdin, keep enough fields to cover
+    // the decoder's lookbehind and lookahead, plus a frame of slack for
+    // fields that are out of order in the input.
+    sourceVideo.setPrefetchWindow(prefetchWindow);
+    sourceVideo.setStreamWindow(2 * (decoderLookBehind + decoderLookAhead + 1));
+    sourceVideo.setFollowMode(!followJsonFileName.isEmpty());
     if (!sourceVideo.open(inputFileName, videoParameters.fieldWidth * videoParameters.fieldHeight)) {
         // Could not open source video file
         qInfo() << "Unable to open ld-decode video file";
@@ -64,13 +76,19 @@ bool DecoderPool::process()
     // If no startFrame parameter was specified, set the start frame to 1
     if (startFrame == -1) startFrame = 1;
 
-    if (startFrame > ldDecodeMetaData.getNumberOfFrames()) {
+    if (!followJsonFileName.isEmpty()) {
+        // The input is still being written, so the number of frames isn't known
+        // yet -- getInputFrames will keep track of it as the input grows
+        qInfo() << "Following the input as it is written";
+    } else if (startFrame > ldDecodeMetaData.getNumberOfFrames()) {
         qInfo() << "Specified start frame is out of bounds, only" << ldDecodeMetaData.getNumberOfFrames() << "frames available";
         return false;
     }
 
     // If no length parameter was specified set the length to the number of available frames
-    if (length == -1) {
+    if (!followJsonFileName.isEmpty()) {
+        // Leave the length as specified
+    } else if (length == -1) {
         length = ldDecodeMetaData.getNumberOfFrames() - (startFrame - 1);
     } else {
         if (length + (startFrame - 1) > ldDecodeMetaData.getNumberOfFrames()) {
@@ -108,12 +126,20 @@ bool DecoderPool::process()
     }
 
     qInfo() << "Using" << maxThreads << "threads";
-    qInfo() << "Processing from start frame #" << startFrame << "with a length of" << length << "frames";
+    if (runLength > 0) {
+        qInfo() << "Decoding in runs of up to" << runLength << "frames per thread";
+    }
+    if (followJsonFileName.isEmpty() || length != -1) {
+        qInfo() << "Processing from start frame #" << startFrame << "with a length of" << length << "frames";
+    } else {
+        qInfo() << "Processing from start frame #" << startFrame << "until the end of the input";
+    }
 
     // Initialise processing state
     inputFrameNumber = startFrame;
     outputFrameNumber = startFrame;
     lastFrameNumber = length + (startFrame - 1);
+    inputFinished = followJsonFileName.isEmpty();
     totalTimer.start();
 
     // Start a vector of filtering threads to process the video
@@ -146,9 +172,15 @@ bool DecoderPool::process()
         return false;
     }
 
+    // When following, the length is whatever was available
+    length = lastFrameNumber - (startFrame - 1);
+
     double totalSecs = (static_cast<double>(totalTimer.elapsed()) / 1000.0);
     qInfo() << "Processing complete -" << length << "frames in" << totalSecs << "seconds (" <<
                length / totalSecs << "FPS )";
+    if (prefetchWindow > 0) {
+        qInfo() << "Prefetch:" << sourceVideo.getPrefetchHits() << "hits," << sourceVideo.getPrefetchMisses() << "misses";
+    }
 
     // Close the source video
     sourceVideo.close();
@@ -159,7 +191,8 @@ bool DecoderPool::process()
     return true;
 }
 
-bool DecoderPool::getInputFrames(qint32 &startFrameNumber, QVector<SourceField> &fields, qint32 &startIndex, qint32 &endIndex)
+bool DecoderPool::getInputFrames(InputRun &inputRun, qint32 &startFrameNumber, QVector<SourceField> &fields,
+                                 qint32 &startIndex, qint32 &endIndex)
 {
     QMutexLocker locker(&inputMutex);
 
@@ -167,23 +200,52 @@ bool DecoderPool::getInputFrames(qint32 &startFrameNumber, QVector<SourceField>
     // This assumes that the synchronisation to get a new batch is less
     // expensive than computing a single frame, so a batch size of 1 is
     // reasonable.
-    const qint32 maxBatchSize = qMin(DEFAULT_BATCH_SIZE, qMax(1, length / maxThreads));
+    // (If following the input with no length given, the length isn't known.)
+    const qint32 maxBatchSize = (length == -1) ? DEFAULT_BATCH_SIZE : qMin(DEFAULT_BATCH_SIZE, qMax(1, length / maxThreads));
+
+    // Is there more of the worker's current run to decode?
+    const bool isContinuation = inputRun.nextFrameNumber < inputRun.endFrameNumber;
+
+    if (!isContinuation) {
+        // Start a new run. Without a run length, the run is a single batch;
+        // otherwise it's long, but not so long that some threads have no work.
+        qint32 runFrames = maxBatchSize;
+        if (runLength > 0) runFrames = qMax(maxBatchSize, qMin(runLength, length / maxThreads));
+
+        // If the input is still being written, wait until there's enough for
+        // the run (including the decoder's lookahead)
+        if (!inputFinished) followInput(inputFrameNumber + runFrames - 1 + decoderLookAhead);
+
+        // Work out how many frames will be in this run
+        runFrames = qMin(runFrames, lastFrameNumber + 1 - inputFrameNumber);
+        if (runFrames == 0) {
+            // No more input frames
+            return false;
+        }
 
-    // Work out how many frames will be in this batch
-    qint32 batchFrames = qMin(maxBatchSize, lastFrameNumber + 1 - inputFrameNumber);
-    if (batchFrames == 0) {
-        // No more input frames
-        return false;
+        // Advance the frame number
+        inputRun.nextFrameNumber = inputFrameNumber;
+        inputRun.endFrameNumber = inputFrameNumber + runFrames;
+        inputFrameNumber += runFrames;
     }
 
-    // Advance the frame number
-    startFrameNumber = inputFrameNumber;
-    inputFrameNumber += batchFrames;
-
-    // Load the fields
-    SourceField::loadFields(sourceVideo, ldDecodeMetaData,
-                            startFrameNumber, batchFrames, decoderLookBehind, decoderLookAhead,
-                            fields, startIndex, endIndex);
+    // Take the next batch from the run
+    const qint32 batchFrames = qMin(maxBatchSize, inputRun.endFrameNumber - inputRun.nextFrameNumber);
+    startFrameNumber = inputRun.nextFrameNumber;
+    inputRun.nextFrameNumber += batchFrames;
+    inputRun.isContinuation = isContinuation;
+
+    if (isContinuation) {
+        // Keep the fields that overlap with the previous batch, and only load the rest
+        SourceField::continueFields(sourceVideo, ldDecodeMetaData,
+                                    startFrameNumber, batchFrames, decoderLookBehind, decoderLookAhead,
+                                    fields, startIndex, endIndex);
+    } else {
+        // Load the fields
+        SourceField::loadFields(sourceVideo, ldDecodeMetaData,
+                                startFrameNumber, batchFrames, decoderLookBehind, decoderLookAhead,
+                                fields, startIndex, endIndex);
+    }
 
     return true;
 }
@@ -201,6 +263,47 @@ bool DecoderPool::putOutputFrames(qint32 startFrameNumber, const QVector<OutputF
     return true;
 }
 
+// Wait until the input metadata covers requiredFrameNumber, or the input has
+// stopped growing, and update lastFrameNumber to match. You must hold
+// inputMutex to call this.
+void DecoderPool::followInput(qint32 requiredFrameNumber)
+{
+    // Don't wait for frames beyond the requested length
+    if (length != -1) requiredFrameNumber = qMin(requiredFrameNumber, length + (startFrame - 1));
+
+    // Count the frames in the metadata whose fields have both been written to
+    // the TBC file
+    auto getAvailableFrames = [&]() {
+        qint32 availableFrames = ldDecodeMetaData.getNumberOfFields() == 0 ? 0 : ldDecodeMetaData.getNumberOfFrames();
+        const qint32 availableFields = sourceVideo.getNumberOfAvailableFields();
+        while (availableFrames > 0
+               && qMax(ldDecodeMetaData.getFirstFieldNumber(availableFrames),
+                       ldDecodeMetaData.getSecondFieldNumber(availableFrames)) > availableFields) {
+            availableFrames--;
+        }
+        return availableFrames;
+    };
+
+    qint32 availableFrames = getAvailableFrames();
+    while (!inputFinished && availableFrames < requiredFrameNumber) {
+        // Wait for another field to be written, then read any new metadata.
+        // The JSON is written after the fields it describes, so read it once
+        // more after the TBC file stops growing.
+        if (!sourceVideo.waitForFields(sourceVideo.getNumberOfAvailableFields() + 1)) inputFinished = true;
+        ldDecodeMetaData.refreshFields(followJsonFileName);
+        availableFrames = getAvailableFrames();
+    }
+
+    if (length == -1) {
+        lastFrameNumber = availableFrames;
+    } else {
+        lastFrameNumber = qMin(length + (startFrame - 1), availableFrames);
+    }
+
+    // Frames that have already been read stay read
+    lastFrameNumber = qMax(lastFrameNumber, inputFrameNumber - 1);
+}
+
 // Write one output frame. You must hold outputMutex to call this.
 //
 // The worker threads will complete frames in an arbitrary order, so we can't
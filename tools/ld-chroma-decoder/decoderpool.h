@@ -46,7 +46,9 @@ public:
     explicit DecoderPool(Decoder &decoder, QString inputFileName,
                          LdDecodeMetaData &ldDecodeMetaData,
                          OutputWriter::Configuration &outputConfig, QString outputFileName,
-                         qint32 startFrame, qint32 length, qint32 maxThreads);
+                         qint32 startFrame, qint32 length, qint32 maxThreads,
+                         qint32 prefetchWindow = 0, QString followJsonFileName = QString(),
+                         qint32 runLength = 0);
 
     // Decode fields to frames as specified by the constructor args.
     // Returns true on success; on failure, prints a message and returns false.
@@ -57,8 +59,29 @@ public:
         return outputWriter;
     }
 
+    // For worker threads: the run of frames that a worker is decoding.
+    //
+    // If the pool has a run length, each worker takes that many consecutive
+    // frames at a time, and fetches them in batches. The fields that overlap
+    // between one batch and the next (the decoder's lookbehind and lookahead)
+    // are reused rather than being read again, and the decoder is told that
+    // the batch continues the previous one. Otherwise, each run is one batch.
+    struct InputRun {
+        // The frames left in the run, from nextFrameNumber up to (but not
+        // including) endFrameNumber
+        qint32 nextFrameNumber = 0;
+        qint32 endFrameNumber = 0;
+
+        // True if the batch most recently returned continues the previous one
+        bool isContinuation = false;
+    };
+
     // For worker threads: get the next batch of data from the input file.
     //
+    // inputRun holds the worker's state between calls; it should start out
+    // default-constructed, and fields should be left as they were returned by
+    // the previous call.
+    //
     // fields will be resized and filled with pairs of SourceFields; entries
     // from startIndex to endIndex are those that should be processed into
     // output frames, with startIndex corresponding to the first field of frame
@@ -71,7 +94,8 @@ public:
     //
     // Returns true if a frame was returned, false if the end of the input has
     // been reached.
-    bool getInputFrames(qint32 &startFrameNumber, QVector<SourceField> &fields, qint32 &startIndex, qint32 &endIndex);
+    bool getInputFrames(InputRun &inputRun, qint32 &startFrameNumber, QVector<SourceField> &fields,
+                        qint32 &startIndex, qint32 &endIndex);
 
     // For worker threads: return decoded frames to write to the output file.
     //
@@ -83,6 +107,7 @@ public:
 
 private:
     bool putOutputFrame(qint32 frameNumber, const OutputFrame &outputFrame);
+    void followInput(qint32 requiredFrameNumber);
 
     // Default batch size, in frames
     static constexpr qint32 DEFAULT_BATCH_SIZE = 16;
@@ -95,6 +120,9 @@ private:
     qint32 startFrame;
     qint32 length;
     qint32 maxThreads;
+    qint32 prefetchWindow;
+    QString followJsonFileName;
+    qint32 runLength;
 
     // Atomic abort flag shared by worker threads; workers watch this, and shut
     // down as soon as possible if it becomes true
@@ -106,6 +134,7 @@ private:
     qint32 decoderLookAhead;
     qint32 inputFrameNumber;
     qint32 lastFrameNumber;
+    bool inputFinished;
     LdDecodeMetaData &ldDecodeMetaData;
     SourceVideo sourceVideo;
 
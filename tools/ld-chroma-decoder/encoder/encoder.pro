@@ -22,10 +22,14 @@ SOURCES += \
     main.cpp \
     ntscencoder.cpp \
     palencoder.cpp \
+    ../../library/tbc/binarymetadata.cpp \
     ../../library/tbc/dropouts.cpp \
+    ../../library/tbc/fieldstore.cpp \
     ../../library/tbc/jsonio.cpp \
     ../../library/tbc/lddecodemetadata.cpp \
     ../../library/tbc/logging.cpp \
+    ../../library/tbc/parallelfor.cpp \
+    ../../library/tbc/tbcparts.cpp \
     ../../library/tbc/vbidecoder.cpp
 
 HEADERS += \
@@ -33,10 +37,14 @@ HEADERS += \
     ntscencoder.h \
     palencoder.h \
     ../../library/filter/firfilter.h \
+    ../../library/tbc/binarymetadata.h \
     ../../library/tbc/dropouts.h \
+    ../../library/tbc/fieldstore.h \
     ../../library/tbc/jsonio.h \
     ../../library/tbc/lddecodemetadata.h \
     ../../library/tbc/logging.h \
+    ../../library/tbc/parallelfor.h \
+    ../../library/tbc/tbcparts.h \
     ../../library/tbc/vbidecoder.h
 
 # Add external includes to the include path
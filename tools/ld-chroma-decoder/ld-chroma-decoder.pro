@@ -16,6 +16,7 @@ DEFINES += QT_DEPRECATED_WARNINGS
 
 SOURCES += \
     comb.cpp \
+    combkernels.cpp \
     componentframe.cpp \
     decoder.cpp \
     decoderpool.cpp \
@@ -27,18 +28,26 @@ SOURCES += \
     palcolour.cpp \
     paldecoder.cpp \
     sourcefield.cpp \
+    transformfft.cpp \
     transformpal.cpp \
     transformpal2d.cpp \
     transformpal3d.cpp \
+    ../library/tbc/binarymetadata.cpp \
+    ../library/tbc/compressedtbc.cpp \
     ../library/tbc/dropouts.cpp \
+    ../library/tbc/fieldcache.cpp \
+    ../library/tbc/fieldstore.cpp \
     ../library/tbc/jsonio.cpp \
     ../library/tbc/lddecodemetadata.cpp \
     ../library/tbc/logging.cpp \
+    ../library/tbc/parallelfor.cpp \
     ../library/tbc/sourcevideo.cpp \
+    ../library/tbc/tbcparts.cpp \
     ../library/tbc/vbidecoder.cpp
 
 HEADERS += \
     comb.h \
+    combkernels.h \
     componentframe.h \
     decoder.h \
     decoderpool.h \
@@ -49,17 +58,24 @@ HEADERS += \
     palcolour.h \
     paldecoder.h \
     sourcefield.h \
+    transformfft.h \
     transformpal.h \
     transformpal2d.h \
     transformpal3d.h \
     ../library/filter/deemp.h \
     ../library/filter/firfilter.h \
     ../library/filter/iirfilter.h \
+    ../library/tbc/binarymetadata.h \
+    ../library/tbc/compressedtbc.h \
     ../library/tbc/dropouts.h \
+    ../library/tbc/fieldcache.h \
+    ../library/tbc/fieldstore.h \
     ../library/tbc/jsonio.h \
     ../library/tbc/lddecodemetadata.h \
     ../library/tbc/logging.h \
+    ../library/tbc/parallelfor.h \
     ../library/tbc/sourcevideo.h \
+    ../library/tbc/tbcparts.h \
     ../library/tbc/vbidecoder.h
 
 # Add external includes to the include path
@@ -92,3 +108,9 @@ INCLUDEPATH += "/usr/local/include"
 # Normal open-source OS goodness
 LIBS += -L"/usr/local/lib"
 LIBS += -lfftw3
+
+# Single-precision FFTW is optional (used for --transform-single)
+packagesExist(fftw3f) {
+    DEFINES += HAVE_FFTW3F
+    LIBS += -lfftw3f
+}
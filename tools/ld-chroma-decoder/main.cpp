@@ -34,6 +34,7 @@
 #include <memory>
 
 #include "decoderpool.h"
+#include "fieldcache.h"
 #include "lddecodemetadata.h"
 #include "logging.h"
 
@@ -192,6 +193,29 @@ int main(int argc, char *argv[])
                                      QCoreApplication::translate("main", "number"));
     parser.addOption(threadsOption);
 
+    // Option to read fields ahead of the decoder (--prefetch)
+    QCommandLineOption prefetchOption(QStringList() << "prefetch",
+                                      QCoreApplication::translate("main", "Read this many fields ahead in a background thread (default 0, disabled)"),
+                                      QCoreApplication::translate("main", "fields"));
+    parser.addOption(prefetchOption);
+
+    // Option to give each thread long runs of frames (--run-length)
+    QCommandLineOption runLengthOption(QStringList() << "run-length",
+                                       QCoreApplication::translate("main", "Give each thread runs of this many consecutive frames, so 3D decoders don't repeat work between batches; uses more memory for output (default 0, disabled)"),
+                                       QCoreApplication::translate("main", "frames"));
+    parser.addOption(runLengthOption);
+
+    // Option to follow an input that's still being written (--follow)
+    QCommandLineOption followOption(QStringList() << "follow",
+                                    QCoreApplication::translate("main", "Process the input TBC and JSON while they are still being written, until they stop growing"));
+    parser.addOption(followOption);
+
+    // Option to set the size of the field cache (--cache-mb)
+    QCommandLineOption cacheSizeOption(QStringList() << "cache-mb",
+                                       QCoreApplication::translate("main", "Maximum memory used to cache fields, in MiB (default 256)"),
+                                       QCoreApplication::translate("main", "size"));
+    parser.addOption(cacheSizeOption);
+
     // Option to override calculated firstActiveFieldLine in our video parameters (-ffll)
     QCommandLineOption firstFieldLineOption(QStringList() << "ffll" << "first_active_field_line",
                                             QCoreApplication::translate("main", "The first visible line of a field. Range 1-259 for NTSC (default: 20), 2-308 for PAL (default: 22)"),
@@ -223,6 +247,12 @@ int main(int argc, char *argv[])
                                      QCoreApplication::translate("main", "NTSC: Overlay the adaptive filter map (only used for testing)"));
     parser.addOption(showMapOption);
 
+    // Option to stop the adaptive filter's candidate search early
+    QCommandLineOption adaptFloorOption(QStringList() << "ntsc-adapt-floor",
+                                        QCoreApplication::translate("main", "NTSC: Use the first 3D candidates with a penalty below this (faster, but may not pick the best; default: compare all candidates)"),
+                                        QCoreApplication::translate("main", "number"));
+    parser.addOption(adaptFloorOption);
+
     // Option to set the chroma noise reduction level
     QCommandLineOption chromaNROption(QStringList() << "chroma-nr",
                                       QCoreApplication::translate("main", "NTSC: Chroma noise reduction level in dB (default 0.0)"),
@@ -259,6 +289,13 @@ int main(int argc, char *argv[])
                                                  QCoreApplication::translate("main", "file"));
     parser.addOption(transformThresholdsOption);
 
+#ifdef HAVE_FFTW3F
+    // Option to compute the Transform PAL FFTs in single precision
+    QCommandLineOption transformSingleOption(QStringList() << "transform-single",
+                                             QCoreApplication::translate("main", "Transform: Use single-precision FFTs (faster, slightly less accurate)"));
+    parser.addOption(transformSingleOption);
+#endif
+
     // Option to overlay the FFTs
     QCommandLineOption showFFTsOption(QStringList() << "show-ffts",
                                       QCoreApplication::translate("main", "Transform: Overlay the input and output FFTs"));
@@ -304,6 +341,11 @@ int main(int argc, char *argv[])
         qCritical("Input and output files cannot be the same");
         return -1;
     }
+    if (inputFileName == "-" && parser.isSet(followOption)) {
+        // Quit with error
+        qCritical("You cannot follow piped input");
+        return -1;
+    }
 
     qint32 startFrame = -1;
     qint32 length = -1;
@@ -342,6 +384,43 @@ int main(int argc, char *argv[])
         }
     }
 
+    qint32 prefetchWindow = 0;
+    if (parser.isSet(prefetchOption)) {
+        prefetchWindow = parser.value(prefetchOption).toInt();
+
+        if (prefetchWindow < 0) {
+            // Quit with error
+            qCritical("Specified prefetch window must not be negative");
+            return -1;
+        }
+    }
+
+    qint32 runLength = 0;
+    if (parser.isSet(runLengthOption)) {
+        runLength = parser.value(runLengthOption).toInt();
+
+        if (runLength < 0) {
+            // Quit with error
+            qCritical("Specified run length must not be negative");
+            return -1;
+        }
+    }
+
+    if (parser.isSet(cacheSizeOption)) {
+        const qint32 cacheSize = parser.value(cacheSizeOption).toInt();
+
+        if (cacheSize < 0) {
+            // Quit with error
+            qCritical("Specified cache size must not be negative");
+            return -1;
+        }
+
+        FieldCache::global().setByteLimit(static_cast<qint64>(cacheSize) * 1024 * 1024);
+    }
+
+    // Fields are processed in order, so only the most recent fields are worth caching
+    FieldCache::global().setEvictionPolicy(FieldCache::SEQUENTIAL);
+
     if (parser.isSet(chromaGainOption)) {
         const double value = parser.value(chromaGainOption).toDouble();
         palConfig.chromaGain = value;
@@ -370,6 +449,11 @@ int main(int argc, char *argv[])
         combConfig.showMap = true;
     }
 
+    if (parser.isSet(adaptFloorOption)) {
+        combConfig.adaptiveEarlyExit = true;
+        combConfig.adaptiveFloor = parser.value(adaptFloorOption).toDouble();
+    }
+
     if (parser.isSet(chromaNROption)) {
         combConfig.cNRLevel = parser.value(chromaNROption).toDouble();
 
@@ -409,6 +493,12 @@ int main(int argc, char *argv[])
         }
     }
 
+#ifdef HAVE_FFTW3F
+    if (parser.isSet(transformSingleOption)) {
+        palConfig.transformSinglePrecision = true;
+    }
+#endif
+
     LdDecodeMetaData::LineParameters lineParameters;
     if (parser.isSet(firstFieldLineOption)) {
         lineParameters.firstActiveFieldLine = parser.value(firstFieldLineOption).toInt();
@@ -432,8 +522,11 @@ int main(int argc, char *argv[])
         inputJsonFileName = parser.value(inputJsonOption);
     }
 
-    // Load the source video metadata
+    // Load the source video metadata. Fields are only parsed when they're
+    // needed, so decoding part of a long capture starts quickly -- unless
+    // we're following the input, as the JSON file will be rewritten.
     LdDecodeMetaData metaData;
+    metaData.setLazyLoading(!parser.isSet(followOption));
     if (!metaData.read(inputJsonFileName)) {
         qInfo() << "Unable to open ld-decode metadata file";
         return -1;
@@ -537,11 +630,15 @@ int main(int argc, char *argv[])
     }
     
     // Perform the processing
-    DecoderPool decoderPool(*decoder, inputFileName, metaData, outputConfig, outputFileName, startFrame, length, maxThreads);
+    DecoderPool decoderPool(*decoder, inputFileName, metaData, outputConfig, outputFileName, startFrame, length, maxThreads,
+                            prefetchWindow, parser.isSet(followOption) ? inputJsonFileName : QString(), runLength);
     if (!decoderPool.process()) {
         return -1;
     }
 
+    // Report on the field cache
+    FieldCache::global().printStatistics();
+
     // Quit with success
     return 0;
 }
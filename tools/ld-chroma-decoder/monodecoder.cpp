@@ -47,7 +47,7 @@ MonoThread::MonoThread(QAtomicInt& _abort, DecoderPool& _decoderPool,
 }
 
 void MonoThread::decodeFrames(const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
-                              QVector<ComponentFrame> &componentFrames)
+                              QVector<ComponentFrame> &componentFrames, bool)
 {
     for (qint32 fieldIndex = startIndex, frameIndex = 0; fieldIndex < endIndex; fieldIndex += 2, frameIndex++) {
         decodeFrame(inputFields[fieldIndex], inputFields[fieldIndex + 1], componentFrames[frameIndex]);
@@ -67,7 +67,7 @@ void MonoThread::decodeFrame(const SourceField &firstField, const SourceField &s
 
     // Interlace the active lines of the two input fields to produce a component frame
     for (qint32 y = videoParameters.firstActiveFrameLine; y < videoParameters.lastActiveFrameLine; y++) {
-        const SourceVideo::Data &inputFieldData = (y % 2) == 0 ? firstField.data : secondField.data;
+        const SourceVideo::View &inputFieldData = (y % 2) == 0 ? firstField.data : secondField.data;
         const quint16 *inputLine = inputFieldData.data() + ((y / 2) * videoParameters.fieldWidth);
 
         // Copy the whole composite signal to Y (leaving U and V blank)
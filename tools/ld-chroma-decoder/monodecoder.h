@@ -60,7 +60,7 @@ public:
 
 protected:
     void decodeFrames(const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
-                      QVector<ComponentFrame> &componentFrames) override;
+                      QVector<ComponentFrame> &componentFrames, bool continuesPrevious) override;
 
 private:
     void decodeFrame(const SourceField &firstField, const SourceField &secondField, ComponentFrame &componentFrame);
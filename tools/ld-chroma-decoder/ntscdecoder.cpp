@@ -69,8 +69,8 @@ NtscThread::NtscThread(QAtomicInt& _abort, DecoderPool &_decoderPool,
 }
 
 void NtscThread::decodeFrames(const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
-                              QVector<ComponentFrame> &componentFrames)
+                              QVector<ComponentFrame> &componentFrames, bool continuesPrevious)
 {
     // Decode fields to frames
-    comb.decodeFrames(inputFields, startIndex, endIndex, componentFrames);
+    comb.decodeFrames(inputFields, startIndex, endIndex, componentFrames, continuesPrevious);
 }
@@ -125,7 +125,8 @@ void PalColour::updateConfiguration(const LdDecodeMetaData::VideoParameters &_vi
 
         // Configure the filter
         transformPal->updateConfiguration(videoParameters, configuration.transformThreshold,
-                                          configuration.transformThresholds);
+                                          configuration.transformThresholds,
+                                          configuration.transformSinglePrecision);
     }
 
     configurationSet = true;
@@ -62,6 +62,7 @@ public:
         ChromaFilterMode chromaFilter = palColourFilter;
         double transformThreshold = 0.4;
         QVector<double> transformThresholds;
+        bool transformSinglePrecision = false;
         bool showFFTs = false;
         qint32 showPositionX = 200;
         qint32 showPositionY = 200;
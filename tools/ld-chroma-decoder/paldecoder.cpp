@@ -67,7 +67,7 @@ PalThread::PalThread(QAtomicInt& _abort, DecoderPool& _decoderPool,
 }
 
 void PalThread::decodeFrames(const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
-                             QVector<ComponentFrame> &componentFrames)
+                             QVector<ComponentFrame> &componentFrames, bool)
 {
     palColour.decodeFrames(inputFields, startIndex, endIndex, componentFrames);
 }
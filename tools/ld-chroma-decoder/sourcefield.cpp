@@ -26,6 +26,8 @@
 
 #include "sourcevideo.h"
 
+#include <algorithm>
+
 void SourceField::loadFields(SourceVideo &sourceVideo, LdDecodeMetaData &ldDecodeMetaData,
                              qint32 firstFrameNumber, qint32 numFrames,
                              qint32 lookBehindFrames, qint32 lookAheadFrames,
@@ -39,8 +41,9 @@ void SourceField::loadFields(SourceVideo &sourceVideo, LdDecodeMetaData &ldDecod
     endIndex = startIndex + (2 * numFrames);
     fields.resize(endIndex + (2 * lookAheadFrames));
 
-    // Populate fields
+    // Work out which fields we need, and fetch their metadata
     const qint32 numInputFrames = ldDecodeMetaData.getNumberOfFrames();
+    QVector<qint32> fieldNumbers(fields.size());
     qint32 frameNumber = firstFrameNumber - lookBehindFrames;
     for (qint32 i = 0; i < fields.size(); i += 2) {
 
@@ -56,33 +59,79 @@ void SourceField::loadFields(SourceVideo &sourceVideo, LdDecodeMetaData &ldDecod
         fields[i].field = ldDecodeMetaData.getField(firstFieldNumber);
         fields[i + 1].field = ldDecodeMetaData.getField(secondFieldNumber);
 
-        const quint16 black = videoParameters.black16bIre;
+        // Remember which fields to load (-1 for black fields)
+        fieldNumbers[i] = useBlankFrame ? -1 : firstFieldNumber;
+        fieldNumbers[i + 1] = useBlankFrame ? -1 : secondFieldNumber;
+
+        frameNumber++;
+    }
 
-        if (useBlankFrame) {
-            // Fill both fields with black
-            fields[i].data.fill(black, sourceVideo.getFieldLength());
-            fields[i + 1].data.fill(black, sourceVideo.getFieldLength());
+    // Fetch the input fields
+    const quint16 black = videoParameters.black16bIre;
+    const qint32 fieldLength = sourceVideo.getFieldLength();
+    const SourceVideo::Data blackField(fieldLength, black);
+    for (qint32 i = 0; i < fields.size(); ) {
+        if (fieldNumbers[i] == -1) {
+            // Fill the field with black
+            fields[i].data = blackField;
+            i++;
+        } else if (sourceVideo.isSourceMapped()) {
+            // The data can be used directly from the mapping
+            fields[i].data = sourceVideo.getVideoFieldView(fieldNumbers[i]);
+            i++;
         } else {
-            // Fetch the input fields
-            fields[i].data = sourceVideo.getVideoField(firstFieldNumber);
-            fields[i + 1].data = sourceVideo.getVideoField(secondFieldNumber);
-
-            if ((videoParameters.system == PAL || videoParameters.system == PAL_M) && videoParameters.isSubcarrierLocked) {
-                // With subcarrier-locked 4fSC PAL sampling, we have four
-                // "extra" samples over the course of the frame, so the two
-                // fields will be horizontally misaligned by two samples. Shift
-                // the second field to the left to compensate.
-                //
-                // XXX This should be done elsewhere, as it affects other tools
-                // too.
-
-                fields[i + 1].data.remove(0, 2);
-                for (int j = 0; j < 2; j++) {
-                    fields[i + 1].data.append(black);
-                }
+            // Find a run of fields that are consecutive in the input file, and
+            // read them all into one buffer
+            qint32 runLength = 1;
+            while (i + runLength < fields.size() && fieldNumbers[i + runLength] == fieldNumbers[i] + runLength) {
+                runLength++;
             }
+
+            SourceVideo::Data runData;
+            sourceVideo.getVideoFields(fieldNumbers[i], runLength, runData);
+            for (qint32 j = 0; j < runLength; j++) {
+                fields[i + j].data = SourceVideo::View(runData, j * fieldLength, fieldLength);
+            }
+            i += runLength;
         }
+    }
 
-        frameNumber++;
+    if ((videoParameters.system == PAL || videoParameters.system == PAL_M) && videoParameters.isSubcarrierLocked) {
+        // With subcarrier-locked 4fSC PAL sampling, we have four "extra"
+        // samples over the course of the frame, so the two fields will be
+        // horizontally misaligned by two samples. Shift the second field of
+        // each frame to the left to compensate.
+        //
+        // This means we need a copy of the second field's data.
+        //
+        // XXX This should be done elsewhere, as it affects other tools too.
+        for (qint32 i = 0; i < fields.size(); i += 2) {
+            if (fieldNumbers[i + 1] == -1) continue;
+
+            const SourceVideo::View &secondField = fields[i + 1].data;
+            SourceVideo::Data shiftedField(secondField.size(), black);
+            std::copy(secondField.begin() + 2, secondField.end(), shiftedField.begin());
+            fields[i + 1].data = shiftedField;
+        }
     }
 }
+
+void SourceField::continueFields(SourceVideo &sourceVideo, LdDecodeMetaData &ldDecodeMetaData,
+                                 qint32 firstFrameNumber, qint32 numFrames,
+                                 qint32 lookBehindFrames, qint32 lookAheadFrames,
+                                 QVector<SourceField> &fields, qint32 &startIndex, qint32 &endIndex)
+{
+    // Load the frames after the previous lookahead
+    QVector<SourceField> newFields;
+    qint32 newStartIndex, newEndIndex;
+    loadFields(sourceVideo, ldDecodeMetaData, firstFrameNumber + lookAheadFrames, numFrames, 0, 0,
+               newFields, newStartIndex, newEndIndex);
+
+    // Keep the fields that overlap, and add the new ones after them
+    const qint32 overlapFields = 2 * (lookBehindFrames + lookAheadFrames);
+    fields = fields.mid(fields.size() - overlapFields);
+    fields.append(newFields);
+
+    startIndex = 2 * lookBehindFrames;
+    endIndex = startIndex + (2 * numFrames);
+}
@@ -31,7 +31,10 @@
 // A field read from the input, with metadata and data
 struct SourceField {
     LdDecodeMetaData::Field field;
-    SourceVideo::Data data;
+
+    // The field's samples. If the input is memory-mapped, this points into
+    // the mapping, so fields must not be used after the SourceVideo is closed.
+    SourceVideo::View data;
 
     // Load a sequence of frames from the input files.
     //
@@ -42,6 +45,17 @@ struct SourceField {
                            qint32 lookBehindFrames, qint32 lookAheadFrames,
                            QVector<SourceField> &fields, qint32 &startIndex, qint32 &endIndex);
 
+    // Load the numFrames frames that directly follow a sequence returned by
+    // loadFields (or by a previous call to this), starting at firstFrameNumber.
+    //
+    // The previous sequence's last lookbehind frames and its lookahead frames
+    // become the new lookbehind frames and first frames, so they're kept in
+    // fields rather than being loaded again.
+    static void continueFields(SourceVideo &sourceVideo, LdDecodeMetaData &ldDecodeMetaData,
+                               qint32 firstFrameNumber, qint32 numFrames,
+                               qint32 lookBehindFrames, qint32 lookAheadFrames,
+                               QVector<SourceField> &fields, qint32 &startIndex, qint32 &endIndex);
+
     // Return the vertical offset of this field within the interlaced frame
     // (i.e. 0 for the top field, 1 for the bottom field).
     qint32 getOffset() const {
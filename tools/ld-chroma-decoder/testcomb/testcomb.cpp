@@ -0,0 +1,767 @@
+/************************************************************************
+
+    testcomb.cpp
+
+    ld-chroma-decoder - Colourisation filter for ld-decode
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-chroma-decoder is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include <QFile>
+#include <QTemporaryDir>
+#include <QVector>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+using std::cerr;
+using std::string;
+using std::vector;
+
+#include "comb.h"
+#include "componentframe.h"
+#include "sourcefield.h"
+
+#include "deemp.h"
+#include "firfilter.h"
+
+// The number of frames in the test input
+static constexpr qint32 NUM_FRAMES = 9;
+
+// The frame at which the test input cuts to a different scene
+static constexpr qint32 SCENE_CUT_FRAME = 5;
+
+// The frame at which the player skips, so the field phase sequence restarts
+static constexpr qint32 PHASE_SKIP_FRAME = 7;
+
+// This is the original NTSC comb filter code from comb.cpp, which decoded
+// each batch with freshly-allocated frame buffers and evaluated every 3D
+// candidate for every sample. The noise reduction filters and the
+// phase-compensating and map-overlay modes aren't included, as the tests
+// don't use them.
+class OriginalComb
+{
+public:
+    OriginalComb(const LdDecodeMetaData::VideoParameters &_videoParameters, const Comb::Configuration &_configuration)
+        : videoParameters(_videoParameters), configuration(_configuration)
+    {
+    }
+
+    void decodeFrames(const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
+                      QVector<ComponentFrame> &componentFrames)
+    {
+        auto nextFrameBuffer = std::make_unique<FrameBuffer>(videoParameters, configuration);
+        auto currentFrameBuffer = std::make_unique<FrameBuffer>(videoParameters, configuration);
+        auto previousFrameBuffer = std::make_unique<FrameBuffer>(videoParameters, configuration);
+
+        const qint32 preStartIndex = (configuration.dimensions == 3) ? startIndex - 4 : startIndex - 2;
+        for (qint32 fieldIndex = preStartIndex; fieldIndex < endIndex; fieldIndex += 2) {
+            const qint32 frameIndex = (fieldIndex - startIndex) / 2;
+
+            {
+                auto recycle = std::move(previousFrameBuffer);
+                previousFrameBuffer = std::move(currentFrameBuffer);
+                currentFrameBuffer = std::move(nextFrameBuffer);
+                nextFrameBuffer = std::move(recycle);
+            }
+
+            if (fieldIndex + 3 < inputFields.size()) {
+                nextFrameBuffer->loadFields(inputFields[fieldIndex + 2], inputFields[fieldIndex + 3]);
+                nextFrameBuffer->split1D();
+                nextFrameBuffer->split2D();
+            }
+
+            if (fieldIndex < startIndex) continue;
+
+            if (configuration.dimensions == 3) {
+                currentFrameBuffer->split3D(*previousFrameBuffer, *nextFrameBuffer);
+            }
+
+            componentFrames[frameIndex].init(videoParameters);
+            currentFrameBuffer->setComponentFrame(componentFrames[frameIndex]);
+
+            currentFrameBuffer->splitIQ();
+            currentFrameBuffer->adjustY();
+            currentFrameBuffer->filterIQ();
+            currentFrameBuffer->transformIQ(configuration.chromaGain, configuration.chromaPhase);
+        }
+    }
+
+private:
+    static constexpr qint32 MAX_WIDTH = 910;
+    static constexpr qint32 MAX_HEIGHT = 525;
+
+    enum CandidateIndex : qint32 {
+        CAND_LEFT,
+        CAND_RIGHT,
+        CAND_UP,
+        CAND_DOWN,
+        CAND_PREV_FIELD,
+        CAND_NEXT_FIELD,
+        CAND_PREV_FRAME,
+        CAND_NEXT_FRAME,
+        NUM_CANDIDATES
+    };
+
+    class FrameBuffer {
+    public:
+        FrameBuffer(const LdDecodeMetaData::VideoParameters &videoParameters_, const Comb::Configuration &configuration_)
+            : videoParameters(videoParameters_), configuration(configuration_)
+        {
+            frameHeight = ((videoParameters.fieldHeight * 2) - 1);
+            irescale = (videoParameters.white16bIre - videoParameters.black16bIre) / 100;
+        }
+
+        void setComponentFrame(ComponentFrame &_componentFrame) {
+            componentFrame = &_componentFrame;
+        }
+
+        qint32 getFieldID(qint32 lineNumber) const
+        {
+            bool isFirstField = ((lineNumber % 2) == 0);
+
+            return isFirstField ? firstFieldPhaseID : secondFieldPhaseID;
+        }
+
+        bool getLinePhase(qint32 lineNumber) const
+        {
+            qint32 fieldID = getFieldID(lineNumber);
+            bool isPositivePhaseOnEvenLines = (fieldID == 1) || (fieldID == 4);
+
+            int fieldLine = (lineNumber / 2);
+            bool isEvenLine = (fieldLine % 2) == 0;
+
+            return isEvenLine ? isPositivePhaseOnEvenLines : !isPositivePhaseOnEvenLines;
+        }
+
+        void loadFields(const SourceField &firstField, const SourceField &secondField)
+        {
+            // SourceField now holds a view of the samples, rather than a copy
+            const SourceVideo::Data firstFieldData = firstField.data.toData();
+            const SourceVideo::Data secondFieldData = secondField.data.toData();
+
+            qint32 fieldLine = 0;
+            rawbuffer.clear();
+            for (qint32 frameLine = 0; frameLine < frameHeight; frameLine += 2) {
+                rawbuffer.append(firstFieldData.mid(fieldLine * videoParameters.fieldWidth, videoParameters.fieldWidth));
+                rawbuffer.append(secondFieldData.mid(fieldLine * videoParameters.fieldWidth, videoParameters.fieldWidth));
+                fieldLine++;
+            }
+
+            firstFieldPhaseID = firstField.field.fieldPhaseID;
+            secondFieldPhaseID = secondField.field.fieldPhaseID;
+
+            for (qint32 buf = 0; buf < 3; buf++) {
+                for (qint32 y = 0; y < MAX_HEIGHT; y++) {
+                    for (qint32 x = 0; x < MAX_WIDTH; x++) {
+                        clpbuffer[buf].pixel[y][x] = 0.0;
+                    }
+                }
+            }
+
+            componentFrame = nullptr;
+        }
+
+        void split1D()
+        {
+            for (qint32 lineNumber = videoParameters.firstActiveFrameLine; lineNumber < videoParameters.lastActiveFrameLine; lineNumber++) {
+                const quint16 *line = rawbuffer.data() + (lineNumber * videoParameters.fieldWidth);
+
+                for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
+                    double tc1 = (line[h] - ((line[h - 2] + line[h + 2]) / 2.0)) / 2.0;
+
+                    clpbuffer[0].pixel[lineNumber][h] = tc1;
+                }
+            }
+        }
+
+        void split2D()
+        {
+            static constexpr double blackLine[MAX_WIDTH] = {0};
+
+            for (qint32 lineNumber = videoParameters.firstActiveFrameLine; lineNumber < videoParameters.lastActiveFrameLine; lineNumber++) {
+                const double *previousLine = blackLine;
+                if (lineNumber - 2 >= videoParameters.firstActiveFrameLine) {
+                    previousLine = clpbuffer[0].pixel[lineNumber - 2];
+                }
+                const double *currentLine = clpbuffer[0].pixel[lineNumber];
+                const double *nextLine = blackLine;
+                if (lineNumber + 2 < videoParameters.lastActiveFrameLine) {
+                    nextLine = clpbuffer[0].pixel[lineNumber + 2];
+                }
+
+                for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
+                    double kp, kn;
+
+                    kp  = fabs(fabs(currentLine[h]) - fabs(previousLine[h]));
+                    kp += fabs(fabs(currentLine[h - 1]) - fabs(previousLine[h - 1]));
+                    kp -= (fabs(currentLine[h]) + fabs(previousLine[h - 1])) * .10;
+                    kn  = fabs(fabs(currentLine[h]) - fabs(nextLine[h]));
+                    kn += fabs(fabs(currentLine[h - 1]) - fabs(nextLine[h - 1]));
+                    kn -= (fabs(currentLine[h]) + fabs(nextLine[h - 1])) * .10;
+
+                    const double kRange = 45 * irescale;
+                    kp = qBound(0.0, 1 - (kp / kRange), 1.0);
+                    kn = qBound(0.0, 1 - (kn / kRange), 1.0);
+
+                    double sc = 1.0;
+
+                    if ((kn > 0) || (kp > 0)) {
+                        if (kn > (3 * kp)) kp = 0;
+                        else if (kp > (3 * kn)) kn = 0;
+
+                        sc = (2.0 / (kn + kp));
+                        if (sc < 1.0) sc = 1.0;
+                    } else {
+                        if ((fabs(fabs(previousLine[h]) - fabs(nextLine[h])) - fabs((nextLine[h] + previousLine[h]) * .2)) <= 0) {
+                            kn = kp = 1;
+                        }
+                    }
+
+                    double tc1;
+                    tc1  = ((currentLine[h] - previousLine[h]) * kp * sc);
+                    tc1 += ((currentLine[h] - nextLine[h]) * kn * sc);
+                    tc1 /= 4;
+
+                    clpbuffer[1].pixel[lineNumber][h] = tc1;
+                }
+            }
+        }
+
+        void split3D(const FrameBuffer &previousFrame, const FrameBuffer &nextFrame)
+        {
+            for (qint32 lineNumber = videoParameters.firstActiveFrameLine; lineNumber < videoParameters.lastActiveFrameLine; lineNumber++) {
+                for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
+                    qint32 bestIndex;
+                    double bestSample;
+                    getBestCandidate(lineNumber, h, previousFrame, nextFrame, bestIndex, bestSample);
+
+                    if (bestIndex < CAND_PREV_FIELD) {
+                        clpbuffer[2].pixel[lineNumber][h] = clpbuffer[1].pixel[lineNumber][h];
+                    } else {
+                        clpbuffer[2].pixel[lineNumber][h] = (clpbuffer[0].pixel[lineNumber][h] - bestSample) / 2;
+                    }
+                }
+            }
+        }
+
+        void splitIQ()
+        {
+            for (qint32 lineNumber = videoParameters.firstActiveFrameLine; lineNumber < videoParameters.lastActiveFrameLine; lineNumber++) {
+                const quint16 *line = rawbuffer.data() + (lineNumber * videoParameters.fieldWidth);
+
+                double *Y = componentFrame->y(lineNumber);
+                double *I = componentFrame->u(lineNumber);
+                double *Q = componentFrame->v(lineNumber);
+
+                bool linePhase = getLinePhase(lineNumber);
+
+                double si = 0, sq = 0;
+                for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
+                    qint32 phase = h % 4;
+
+                    double cavg = clpbuffer[configuration.dimensions - 1].pixel[lineNumber][h];
+
+                    if (linePhase) cavg = -cavg;
+
+                    switch (phase) {
+                        case 0: sq = cavg; break;
+                        case 1: si = -cavg; break;
+                        case 2: sq = -cavg; break;
+                        case 3: si = cavg; break;
+                        default: break;
+                    }
+
+                    Y[h] = line[h];
+                    I[h] = si;
+                    Q[h] = sq;
+                }
+            }
+        }
+
+        void filterIQ()
+        {
+            auto iqFilter = makeFIRFilter(c_colorlp_b);
+
+            const int width = videoParameters.activeVideoEnd - videoParameters.activeVideoStart;
+            std::vector<double> tempBuf(width);
+
+            for (qint32 lineNumber = videoParameters.firstActiveFrameLine; lineNumber < videoParameters.lastActiveFrameLine; lineNumber++) {
+                double *I = componentFrame->u(lineNumber) + videoParameters.activeVideoStart;
+                double *Q = componentFrame->v(lineNumber) + videoParameters.activeVideoStart;
+
+                iqFilter.apply(I, tempBuf.data(), width);
+                std::copy(tempBuf.begin(), tempBuf.end(), I);
+
+                iqFilter.apply(Q, tempBuf.data(), width);
+                std::copy(tempBuf.begin(), tempBuf.end(), Q);
+            }
+        }
+
+        void adjustY()
+        {
+            for (qint32 lineNumber = videoParameters.firstActiveFrameLine; lineNumber < videoParameters.lastActiveFrameLine; lineNumber++) {
+                double *Y = componentFrame->y(lineNumber);
+                double *I = componentFrame->u(lineNumber);
+                double *Q = componentFrame->v(lineNumber);
+
+                bool linePhase = getLinePhase(lineNumber);
+
+                for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
+                    double comp = 0;
+                    qint32 phase = h % 4;
+
+                    switch (phase) {
+                        case 0: comp = -Q[h]; break;
+                        case 1: comp = I[h]; break;
+                        case 2: comp = Q[h]; break;
+                        case 3: comp = -I[h]; break;
+                        default: break;
+                    }
+
+                    if (!linePhase) comp = -comp;
+                    Y[h] -= comp;
+                }
+            }
+        }
+
+        void transformIQ(double chromaGain, double chromaPhase)
+        {
+            const double theta = ((33 + chromaPhase) * M_PI) / 180;
+            const double bp = sin(theta) * chromaGain;
+            const double bq = cos(theta) * chromaGain;
+
+            for (qint32 lineNumber = videoParameters.firstActiveFrameLine; lineNumber < videoParameters.lastActiveFrameLine; lineNumber++) {
+                double *I = componentFrame->u(lineNumber);
+                double *Q = componentFrame->v(lineNumber);
+
+                for (qint32 h = videoParameters.activeVideoStart; h < videoParameters.activeVideoEnd; h++) {
+                    double U = (-bp * I[h]) + (bq * Q[h]);
+                    double V = ( bq * I[h]) + (bp * Q[h]);
+
+                    I[h] = U;
+                    Q[h] = V;
+                }
+            }
+        }
+
+    private:
+        const LdDecodeMetaData::VideoParameters &videoParameters;
+        const Comb::Configuration &configuration;
+
+        qint32 frameHeight;
+        double irescale;
+
+        SourceVideo::Data rawbuffer;
+
+        qint32 firstFieldPhaseID;
+        qint32 secondFieldPhaseID;
+
+        struct Sample {
+            double pixel[MAX_HEIGHT][MAX_WIDTH];
+        } clpbuffer[3];
+
+        struct Candidate {
+            double penalty;
+            double sample;
+        };
+
+        ComponentFrame *componentFrame = nullptr;
+
+        void getBestCandidate(qint32 lineNumber, qint32 h,
+                              const FrameBuffer &previousFrame, const FrameBuffer &nextFrame,
+                              qint32 &bestIndex, double &bestSample) const
+        {
+            Candidate candidates[8];
+
+            static constexpr double LINE_BONUS = -2.0;
+            static constexpr double FIELD_BONUS = LINE_BONUS - 2.0;
+            static constexpr double FRAME_BONUS = FIELD_BONUS - 2.0;
+
+            candidates[CAND_LEFT]  = getCandidate(lineNumber, h, *this, lineNumber, h - 2, 0);
+            candidates[CAND_RIGHT] = getCandidate(lineNumber, h, *this, lineNumber, h + 2, 0);
+
+            candidates[CAND_UP]   = getCandidate(lineNumber, h, *this, lineNumber - 2, h, LINE_BONUS);
+            candidates[CAND_DOWN] = getCandidate(lineNumber, h, *this, lineNumber + 2, h, LINE_BONUS);
+
+            if (getLinePhase(lineNumber) == getLinePhase(lineNumber - 1)) {
+                candidates[CAND_PREV_FIELD] = getCandidate(lineNumber, h, previousFrame, lineNumber - 1, h, FIELD_BONUS);
+                candidates[CAND_NEXT_FIELD] = getCandidate(lineNumber, h, *this, lineNumber + 1, h, FIELD_BONUS);
+            } else {
+                candidates[CAND_PREV_FIELD] = getCandidate(lineNumber, h, *this, lineNumber - 1, h, FIELD_BONUS);
+                candidates[CAND_NEXT_FIELD] = getCandidate(lineNumber, h, nextFrame, lineNumber + 1, h, FIELD_BONUS);
+            }
+
+            candidates[CAND_PREV_FRAME] = getCandidate(lineNumber, h, previousFrame, lineNumber, h, FRAME_BONUS);
+            candidates[CAND_NEXT_FRAME] = getCandidate(lineNumber, h, nextFrame, lineNumber, h, FRAME_BONUS);
+
+            if (configuration.adaptive) {
+                bestIndex = 0;
+                for (qint32 i = 1; i < NUM_CANDIDATES; i++) {
+                    if (candidates[i].penalty < candidates[bestIndex].penalty) bestIndex = i;
+                }
+            } else {
+                bestIndex = CAND_PREV_FRAME;
+            }
+
+            bestSample = candidates[bestIndex].sample;
+        }
+
+        Candidate getCandidate(qint32 refLineNumber, qint32 refH,
+                               const FrameBuffer &frameBuffer, qint32 lineNumber, qint32 h,
+                               double adjustPenalty) const
+        {
+            Candidate result;
+            result.sample = frameBuffer.clpbuffer[0].pixel[lineNumber][h];
+
+            if (lineNumber < videoParameters.firstActiveFrameLine || lineNumber >= videoParameters.lastActiveFrameLine) {
+                result.penalty = 1000.0;
+                return result;
+            }
+
+            const qint32 wantPhase = (2 + (getLinePhase(refLineNumber) ? 2 : 0) + refH) % 4;
+            const qint32 havePhase = ((frameBuffer.getLinePhase(lineNumber) ? 2 : 0) + h) % 4;
+            if (wantPhase != havePhase) {
+                result.penalty = 1000.0;
+                return result;
+            }
+
+            const quint16 *refLine = rawbuffer.data() + (refLineNumber * videoParameters.fieldWidth);
+            const quint16 *candidateLine = frameBuffer.rawbuffer.data() + (lineNumber * videoParameters.fieldWidth);
+
+            double yPenalty = 0.0;
+            for (qint32 offset = -1; offset < 2; offset++) {
+                const double refC = clpbuffer[1].pixel[refLineNumber][refH + offset];
+                const double refY = refLine[refH + offset] - refC;
+
+                const double candidateC = frameBuffer.clpbuffer[1].pixel[lineNumber][h + offset];
+                const double candidateY = candidateLine[h + offset] - candidateC;
+
+                yPenalty += fabs(refY - candidateY);
+            }
+            yPenalty = yPenalty / 3 / irescale;
+
+            double iqPenalty = 0.0;
+            for (qint32 offset = -1; offset < 2; offset++) {
+                const double refC = clpbuffer[1].pixel[refLineNumber][refH + offset];
+                const double candidateC = -frameBuffer.clpbuffer[1].pixel[lineNumber][h + offset];
+
+                static constexpr double weights[] = {0.5, 1.0, 0.5};
+                iqPenalty += fabs(refC - candidateC) * weights[offset + 1];
+            }
+            iqPenalty = (iqPenalty / 2 / irescale) * 0.28;
+
+            result.penalty = yPenalty + iqPenalty + adjustPenalty;
+            return result;
+        }
+    };
+
+    const LdDecodeMetaData::VideoParameters &videoParameters;
+    const Comb::Configuration &configuration;
+};
+
+// Make video parameters for an NTSC field, matching what ld-decode produces,
+// but with a smaller active area so the tests run quickly. The active area
+// doesn't start on a multiple of 4 samples, and isn't a whole number of runs
+// of samples wide.
+static LdDecodeMetaData::VideoParameters makeVideoParameters()
+{
+    LdDecodeMetaData::VideoParameters videoParameters;
+    videoParameters.system = NTSC;
+    videoParameters.fieldWidth = 910;
+    videoParameters.fieldHeight = 263;
+    videoParameters.fSC = 315.0e6 / 88.0;
+    videoParameters.sampleRate = 4 * videoParameters.fSC;
+    videoParameters.colourBurstStart = 74;
+    videoParameters.colourBurstEnd = 110;
+    videoParameters.activeVideoStart = 134;
+    videoParameters.activeVideoEnd = 395;
+    videoParameters.firstActiveFieldLine = 20;
+    videoParameters.lastActiveFieldLine = 61;
+    videoParameters.firstActiveFrameLine = 40;
+    videoParameters.lastActiveFrameLine = 121;
+    videoParameters.white16bIre = 50800;
+    videoParameters.black16bIre = 15050;
+    return videoParameters;
+}
+
+// Get the field phase ID of a field, given its frame number (from 1) and
+// whether it's the first field of the frame. The phase sequence restarts at
+// PHASE_SKIP_FRAME, so the frames on either side of it don't have the expected
+// phase relationship.
+static qint32 getFieldPhaseID(qint32 frameNumber, bool isFirstField)
+{
+    const qint32 sequenceFrame = (frameNumber < PHASE_SKIP_FRAME) ? frameNumber : frameNumber - PHASE_SKIP_FRAME;
+    return ((sequenceFrame * 2) + (isFirstField ? 0 : 1)) % 4 + 1;
+}
+
+// Work out the chroma phase of a frame line, in the same way as the comb filter
+static bool getLinePhase(qint32 frameNumber, qint32 frameLine)
+{
+    const qint32 fieldPhaseID = getFieldPhaseID(frameNumber, (frameLine % 2) == 0);
+    const bool isPositivePhaseOnEvenLines = (fieldPhaseID == 1) || (fieldPhaseID == 4);
+    const bool isEvenLine = ((frameLine / 2) % 2) == 0;
+    return isEvenLine ? isPositivePhaseOnEvenLines : !isPositivePhaseOnEvenLines;
+}
+
+// Make a field (numbered from 1) of a scene that gives the 3D filter a mix of
+// choices: a static background with diagonal luma stripes and a static colour
+// block, a colour block that moves between frames, and a cut to a different
+// background at SCENE_CUT_FRAME. The chroma is at fSC, so it lines up with the
+// 4fSC sample grid, and there's a little noise.
+static SourceVideo::Data makeField(const LdDecodeMetaData::VideoParameters &videoParameters, qint32 fieldNumber,
+                                   std::mt19937 &randomGenerator)
+{
+    const qint32 frameNumber = (fieldNumber + 1) / 2;
+    const bool isFirstField = (fieldNumber % 2) == 1;
+    const double irescale = (videoParameters.white16bIre - videoParameters.black16bIre) / 100;
+    std::uniform_int_distribution<int> noiseDist(-150, 150);
+
+    SourceVideo::Data data(videoParameters.fieldWidth * videoParameters.fieldHeight);
+    for (qint32 fieldLine = 0; fieldLine < videoParameters.fieldHeight; fieldLine++) {
+        const qint32 frameLine = (fieldLine * 2) + (isFirstField ? 0 : 1);
+        const bool linePhase = getLinePhase(frameNumber, frameLine);
+
+        for (qint32 x = 0; x < videoParameters.fieldWidth; x++) {
+            // Background
+            const qint32 stripe = (frameNumber < SCENE_CUT_FRAME) ? (x + (2 * frameLine)) / 24 : (x - frameLine) / 10;
+            double luma = 30.0 + (20.0 * (stripe % 3));
+            double i = 0.0, q = 0.0;
+
+            // Static colour block
+            if (x >= 300 && x < 360 && frameLine >= 60 && frameLine < 110) {
+                i = -15.0;
+                q = 25.0;
+            }
+
+            // Moving colour block
+            const qint32 blockStart = 150 + (6 * frameNumber);
+            if (x >= blockStart && x < blockStart + 40 && frameLine >= 50 && frameLine < 90) {
+                luma = 70.0;
+                i = 20.0;
+                q = -10.0;
+            }
+
+            static constexpr double chromaPattern[4][2] = {{0, 1}, {-1, 0}, {0, -1}, {1, 0}};
+            double chroma = (i * chromaPattern[x % 4][0]) + (q * chromaPattern[x % 4][1]);
+            if (linePhase) chroma = -chroma;
+
+            const double sample = videoParameters.black16bIre + ((luma + chroma) * irescale) + noiseDist(randomGenerator);
+            data[(fieldLine * videoParameters.fieldWidth) + x] = static_cast<quint16>(qBound(0.0, sample, 65535.0));
+        }
+    }
+
+    return data;
+}
+
+// Write the test input to a TBC file, and make matching metadata
+static void makeInput(const QString &filename, LdDecodeMetaData &ldDecodeMetaData)
+{
+    const LdDecodeMetaData::VideoParameters videoParameters = makeVideoParameters();
+    ldDecodeMetaData.setVideoParameters(videoParameters);
+
+    std::mt19937 randomGenerator(42);
+    QFile file(filename);
+    if (!file.open(QIODevice::WriteOnly)) {
+        cerr << "Could not create " << filename.toStdString() << "\n";
+        exit(1);
+    }
+
+    for (qint32 fieldNumber = 1; fieldNumber <= NUM_FRAMES * 2; fieldNumber++) {
+        const SourceVideo::Data data = makeField(videoParameters, fieldNumber, randomGenerator);
+        const qint64 dataBytes = data.size() * sizeof(quint16);
+        if (file.write(reinterpret_cast<const char *>(data.constData()), dataBytes) != dataBytes) {
+            cerr << "Could not write " << filename.toStdString() << "\n";
+            exit(1);
+        }
+
+        LdDecodeMetaData::Field field;
+        field.seqNo = fieldNumber;
+        field.isFirstField = (fieldNumber % 2) == 1;
+        field.fieldPhaseID = getFieldPhaseID((fieldNumber + 1) / 2, field.isFirstField);
+        ldDecodeMetaData.appendField(field);
+    }
+
+    file.close();
+}
+
+// Decode every frame with the original code, one frame at a time
+static QVector<ComponentFrame> decodeOriginal(SourceVideo &sourceVideo, LdDecodeMetaData &ldDecodeMetaData,
+                                              const Comb::Configuration &configuration)
+{
+    const LdDecodeMetaData::VideoParameters &videoParameters = ldDecodeMetaData.getVideoParameters();
+    OriginalComb comb(videoParameters, configuration);
+
+    QVector<ComponentFrame> outputFrames;
+    for (qint32 frameNumber = 1; frameNumber <= NUM_FRAMES; frameNumber++) {
+        QVector<SourceField> fields;
+        qint32 startIndex, endIndex;
+        SourceField::loadFields(sourceVideo, ldDecodeMetaData, frameNumber, 1,
+                                configuration.getLookBehind(), configuration.getLookAhead(),
+                                fields, startIndex, endIndex);
+
+        QVector<ComponentFrame> componentFrames(1);
+        comb.decodeFrames(fields, startIndex, endIndex, componentFrames);
+        outputFrames.append(componentFrames[0]);
+    }
+
+    return outputFrames;
+}
+
+// Decode every frame with the current code, reusing one Comb for a series of
+// runs of runFrames frames. Each run is split into batches of batchFrames
+// frames, which follow on from each other in the same way as DecoderPool's.
+static QVector<ComponentFrame> decodeRuns(SourceVideo &sourceVideo, LdDecodeMetaData &ldDecodeMetaData,
+                                          const Comb::Configuration &configuration,
+                                          qint32 runFrames, qint32 batchFrames)
+{
+    const LdDecodeMetaData::VideoParameters &videoParameters = ldDecodeMetaData.getVideoParameters();
+    Comb comb;
+    comb.updateConfiguration(videoParameters, configuration);
+
+    QVector<ComponentFrame> outputFrames;
+    QVector<SourceField> fields;
+    qint32 startIndex, endIndex;
+    for (qint32 runStart = 1; runStart <= NUM_FRAMES; runStart += runFrames) {
+        const qint32 runEnd = qMin(runStart + runFrames, NUM_FRAMES + 1);
+
+        for (qint32 batchStart = runStart; batchStart < runEnd; batchStart += batchFrames) {
+            const qint32 numFrames = qMin(batchFrames, runEnd - batchStart);
+            const bool isContinuation = batchStart != runStart;
+            if (isContinuation) {
+                SourceField::continueFields(sourceVideo, ldDecodeMetaData, batchStart, numFrames,
+                                            configuration.getLookBehind(), configuration.getLookAhead(),
+                                            fields, startIndex, endIndex);
+            } else {
+                SourceField::loadFields(sourceVideo, ldDecodeMetaData, batchStart, numFrames,
+                                        configuration.getLookBehind(), configuration.getLookAhead(),
+                                        fields, startIndex, endIndex);
+            }
+
+            QVector<ComponentFrame> componentFrames(numFrames);
+            comb.decodeFrames(fields, startIndex, endIndex, componentFrames, isContinuation);
+            outputFrames.append(componentFrames);
+        }
+    }
+
+    return outputFrames;
+}
+
+// Check that two decoded sequences are exactly the same
+static void compareFrames(const string &name, const QVector<ComponentFrame> &expected, const QVector<ComponentFrame> &actual)
+{
+    if (expected.size() != actual.size()) {
+        cerr << "Mismatch on " << name << ": " << expected.size() << " frames != " << actual.size() << " frames\n";
+        exit(1);
+    }
+
+    for (qint32 frame = 0; frame < expected.size(); frame++) {
+        const qint32 width = expected[frame].getWidth();
+        const qint32 height = expected[frame].getHeight();
+
+        for (qint32 line = 0; line < height; line++) {
+            const double *expectedLines[] = {expected[frame].y(line), expected[frame].u(line), expected[frame].v(line)};
+            const double *actualLines[] = {actual[frame].y(line), actual[frame].u(line), actual[frame].v(line)};
+
+            for (qint32 plane = 0; plane < 3; plane++) {
+                for (qint32 x = 0; x < width; x++) {
+                    if (expectedLines[plane][x] == actualLines[plane][x]) continue;
+
+                    cerr << "Mismatch on " << name << " at frame " << frame << " plane " << "YUV"[plane]
+                         << " line " << line << " sample " << x << ": "
+                         << expectedLines[plane][x] << " != " << actualLines[plane][x] << "\n";
+                    exit(1);
+                }
+            }
+        }
+    }
+}
+
+// Decode the input in one run, and split into runs and batches in various
+// ways, and check that the output is always the same as the reference
+static void testConfiguration(const string &configurationName, const Comb::Configuration &configuration,
+                              bool compareWithOriginal, SourceVideo &sourceVideo, LdDecodeMetaData &ldDecodeMetaData)
+{
+    cerr << "Testing " << configurationName << "\n";
+
+    const QVector<ComponentFrame> singleRun = decodeRuns(sourceVideo, ldDecodeMetaData, configuration, NUM_FRAMES, NUM_FRAMES);
+    if (compareWithOriginal) {
+        const QVector<ComponentFrame> original = decodeOriginal(sourceVideo, ldDecodeMetaData, configuration);
+        compareFrames(configurationName + " single run", original, singleRun);
+    }
+
+    // {run length, batch size}. These cover batches of a single frame, and
+    // runs that aren't a multiple of the batch size so they end with a
+    // shorter batch.
+    static constexpr qint32 splits[][2] = {{1, 1}, {3, 2}, {4, 3}, {NUM_FRAMES, 1}, {NUM_FRAMES, 2}, {NUM_FRAMES, 4}};
+    for (const auto &split : splits) {
+        const string name = configurationName + " runs of " + std::to_string(split[0])
+                            + " in batches of " + std::to_string(split[1]);
+        compareFrames(name, singleRun, decodeRuns(sourceVideo, ldDecodeMetaData, configuration, split[0], split[1]));
+    }
+}
+
+int main()
+{
+    QTemporaryDir tempDir;
+    if (!tempDir.isValid()) {
+        cerr << "Could not create temporary directory\n";
+        return 1;
+    }
+
+    const QString filename = tempDir.filePath("input.tbc");
+    LdDecodeMetaData ldDecodeMetaData;
+    makeInput(filename, ldDecodeMetaData);
+
+    const LdDecodeMetaData::VideoParameters &videoParameters = ldDecodeMetaData.getVideoParameters();
+    SourceVideo sourceVideo;
+    if (!sourceVideo.open(filename, videoParameters.fieldWidth * videoParameters.fieldHeight, videoParameters.fieldWidth)) {
+        cerr << "Could not open " << filename.toStdString() << "\n";
+        return 1;
+    }
+
+    // The noise reduction filters haven't changed, so they're disabled here
+    // and left out of OriginalComb
+    Comb::Configuration configuration;
+    configuration.yNRLevel = 0.0;
+    configuration.cNRLevel = 0.0;
+
+    configuration.dimensions = 2;
+    testConfiguration("2D", configuration, true, sourceVideo, ldDecodeMetaData);
+
+    configuration.dimensions = 3;
+    testConfiguration("3D adaptive", configuration, true, sourceVideo, ldDecodeMetaData);
+
+    configuration.adaptive = false;
+    testConfiguration("3D non-adaptive", configuration, true, sourceVideo, ldDecodeMetaData);
+
+    // Stopping the candidate search early changes which candidate is picked,
+    // so only check that the output doesn't depend on how it's split up
+    configuration.adaptive = true;
+    configuration.adaptiveEarlyExit = true;
+    testConfiguration("3D adaptive with early exit", configuration, false, sourceVideo, ldDecodeMetaData);
+
+    sourceVideo.close();
+    return 0;
+}
@@ -0,0 +1,50 @@
+CONFIG += c++17 testcase
+CONFIG -= app_bundle
+
+SOURCES += \
+    testcomb.cpp \
+    ../comb.cpp \
+    ../combkernels.cpp \
+    ../componentframe.cpp \
+    ../framecanvas.cpp \
+    ../sourcefield.cpp \
+    ../../library/tbc/binarymetadata.cpp \
+    ../../library/tbc/compressedtbc.cpp \
+    ../../library/tbc/dropouts.cpp \
+    ../../library/tbc/fieldcache.cpp \
+    ../../library/tbc/fieldstore.cpp \
+    ../../library/tbc/jsonio.cpp \
+    ../../library/tbc/lddecodemetadata.cpp \
+    ../../library/tbc/parallelfor.cpp \
+    ../../library/tbc/sourcevideo.cpp \
+    ../../library/tbc/tbcparts.cpp \
+    ../../library/tbc/vbidecoder.cpp
+
+HEADERS += \
+    ../comb.h \
+    ../combkernels.h \
+    ../componentframe.h \
+    ../decoder.h \
+    ../framecanvas.h \
+    ../outputwriter.h \
+    ../sourcefield.h \
+    ../../library/filter/deemp.h \
+    ../../library/filter/firfilter.h \
+    ../../library/tbc/binarymetadata.h \
+    ../../library/tbc/compressedtbc.h \
+    ../../library/tbc/dropouts.h \
+    ../../library/tbc/fieldcache.h \
+    ../../library/tbc/fieldstore.h \
+    ../../library/tbc/jsonio.h \
+    ../../library/tbc/lddecodemetadata.h \
+    ../../library/tbc/parallelfor.h \
+    ../../library/tbc/sourcevideo.h \
+    ../../library/tbc/tbcparts.h \
+    ../../library/tbc/vbidecoder.h
+
+INCLUDEPATH += \
+    .. \
+    ../../library/filter \
+    ../../library/tbc
+
+target.CONFIG += no_default_install
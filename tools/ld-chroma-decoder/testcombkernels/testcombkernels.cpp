@@ -0,0 +1,175 @@
+/************************************************************************
+
+    testcombkernels.cpp
+
+    ld-chroma-decoder - Colourisation filter for ld-decode
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-chroma-decoder is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using std::cerr;
+using std::string;
+using std::vector;
+
+#include "combkernels.h"
+
+// Width of the test lines, including a margin that the kernels may read from
+static constexpr int WIDTH = 256;
+static constexpr int MARGIN = 4;
+
+// The filters in Comb work in terms of a 16-bit signal with an IRE scale of about this
+static constexpr double IRESCALE = 327.68;
+
+static std::mt19937 randomGenerator(42);
+
+// Make a line of composite samples
+static vector<quint16> makeComposite()
+{
+    std::uniform_int_distribution<int> dist(0, 65535);
+    vector<quint16> line(WIDTH);
+    for (quint16 &sample : line) sample = static_cast<quint16>(dist(randomGenerator));
+    return line;
+}
+
+// Make a line of chroma samples. These include runs of zeros and small values,
+// so that split2D takes each of its paths.
+static vector<double> makeChroma()
+{
+    std::uniform_int_distribution<int> modeDist(0, 3);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    vector<double> line(WIDTH);
+    for (double &sample : line) {
+        switch (modeDist(randomGenerator)) {
+            case 0: sample = 0.0; break;
+            case 1: sample = dist(randomGenerator) * 10 * IRESCALE; break;
+            default: sample = dist(randomGenerator) * 100 * IRESCALE; break;
+        }
+    }
+    return line;
+}
+
+// Check that two buffers are bit-identical
+template <typename T>
+static void compareBuffers(const string &name, qint32 start, qint32 end, const vector<T> &expected, const vector<T> &actual)
+{
+    if (memcmp(expected.data(), actual.data(), expected.size() * sizeof(T)) == 0) return;
+
+    for (size_t i = 0; i < expected.size(); i++) {
+        if (memcmp(&expected[i], &actual[i], sizeof(T)) != 0) {
+            cerr << "Mismatch on " << name << " (" << start << " to " << end << ") at " << i << ": "
+                 << expected[i] << " != " << actual[i] << "\n";
+            exit(1);
+        }
+    }
+}
+
+// Run each kernel from two implementations on the same input, and check that
+// they produce the same output
+static void testKernels(const CombKernels &expected, const CombKernels &actual, qint32 start, qint32 end)
+{
+    const vector<quint16> composite = makeComposite();
+    const vector<double> previousChroma = makeChroma();
+    vector<double> currentChroma = makeChroma();
+    vector<double> nextChroma = makeChroma();
+
+    // Make some of the lines similar to each other
+    for (int i = 0; i < WIDTH; i += 3) nextChroma[i] = -previousChroma[i];
+    for (int i = 0; i < WIDTH; i += 5) currentChroma[i] = previousChroma[i] * 0.9;
+
+    // split1D
+    {
+        vector<double> expectedChroma(WIDTH, -1.0), actualChroma(WIDTH, -1.0);
+        expected.split1D(composite.data(), expectedChroma.data(), start, end);
+        actual.split1D(composite.data(), actualChroma.data(), start, end);
+        compareBuffers("split1D", start, end, expectedChroma, actualChroma);
+    }
+
+    // split2D
+    {
+        vector<double> expectedChroma(WIDTH, -1.0), actualChroma(WIDTH, -1.0);
+        expected.split2D(previousChroma.data(), currentChroma.data(), nextChroma.data(), 45 * IRESCALE,
+                         expectedChroma.data(), start, end);
+        actual.split2D(previousChroma.data(), currentChroma.data(), nextChroma.data(), 45 * IRESCALE,
+                       actualChroma.data(), start, end);
+        compareBuffers("split2D", start, end, expectedChroma, actualChroma);
+    }
+
+    for (bool linePhase : {false, true}) {
+        const string phaseName = linePhase ? " (linePhase)" : "";
+
+        // splitIQ
+        vector<double> expectedY(WIDTH, -1.0), expectedI(WIDTH, -1.0), expectedQ(WIDTH, -1.0);
+        vector<double> actualY(WIDTH, -1.0), actualI(WIDTH, -1.0), actualQ(WIDTH, -1.0);
+        expected.splitIQ(composite.data(), currentChroma.data(), linePhase,
+                         expectedY.data(), expectedI.data(), expectedQ.data(), start, end);
+        actual.splitIQ(composite.data(), currentChroma.data(), linePhase,
+                       actualY.data(), actualI.data(), actualQ.data(), start, end);
+        compareBuffers("splitIQ Y" + phaseName, start, end, expectedY, actualY);
+        compareBuffers("splitIQ I" + phaseName, start, end, expectedI, actualI);
+        compareBuffers("splitIQ Q" + phaseName, start, end, expectedQ, actualQ);
+
+        // adjustY, using unrelated I and Q so each sample is different
+        expected.adjustY(previousChroma.data(), nextChroma.data(), linePhase, expectedY.data(), start, end);
+        actual.adjustY(previousChroma.data(), nextChroma.data(), linePhase, actualY.data(), start, end);
+        compareBuffers("adjustY" + phaseName, start, end, expectedY, actualY);
+    }
+}
+
+static void testImplementation(const CombKernels &kernels)
+{
+    cerr << "Testing " << kernels.name << " kernels\n";
+
+    const CombKernels &scalarKernels = getScalarCombKernels();
+
+    // Try every alignment of the start and end, including ranges shorter
+    // than a vector
+    for (qint32 start = MARGIN; start < MARGIN + 8; start++) {
+        for (qint32 end = start; end < start + 12; end++) {
+            testKernels(scalarKernels, kernels, start, end);
+        }
+        testKernels(scalarKernels, kernels, start, WIDTH - MARGIN);
+        testKernels(scalarKernels, kernels, start, WIDTH - MARGIN - 1);
+    }
+}
+
+int main()
+{
+    const CombKernels *avx2Kernels = getAvx2CombKernels();
+    if (avx2Kernels != nullptr) {
+        testImplementation(*avx2Kernels);
+    } else {
+        cerr << "AVX2 kernels not supported, skipping\n";
+    }
+
+    // Whichever kernels are selected must be one of the implementations
+    const CombKernels &kernels = getCombKernels();
+    if (&kernels != &getScalarCombKernels() && &kernels != avx2Kernels) {
+        cerr << "getCombKernels returned unknown kernels\n";
+        exit(1);
+    }
+    cerr << "Using " << kernels.name << " kernels\n";
+
+    return 0;
+}
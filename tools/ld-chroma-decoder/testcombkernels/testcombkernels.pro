@@ -0,0 +1,14 @@
+CONFIG += c++17 testcase
+CONFIG -= app_bundle
+
+SOURCES += \
+    testcombkernels.cpp \
+    ../combkernels.cpp
+
+HEADERS += \
+    ../combkernels.h
+
+INCLUDEPATH += \
+    ..
+
+target.CONFIG += no_default_install
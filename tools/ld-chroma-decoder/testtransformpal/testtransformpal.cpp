@@ -0,0 +1,265 @@
+/************************************************************************
+
+    testtransformpal.cpp
+
+    ld-chroma-decoder - Colourisation filter for ld-decode
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-chroma-decoder is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+using std::cerr;
+using std::string;
+using std::vector;
+
+#include "transformfft.h"
+#include "transformpal2d.h"
+#include "transformpal3d.h"
+
+// Dimensions of the tiles used to test TransformFFT (the same as TransformPal3D's)
+static const QVector<qint32> TILE_DIMS = {8, 32, 16};
+static constexpr qint32 TILE_SIZE = 8 * 32 * 16;
+static constexpr qint32 TILE_COMPLEX_SIZE = 8 * 32 * ((16 / 2) + 1);
+
+// Number of tiles planned for TransformFFT. This is the number of tiles in a
+// row for a normal PAL field, which isn't a multiple of the batch size.
+static constexpr qint32 MAX_TILES = 59;
+
+// Differences allowed between the output of the single- and double-precision
+// Transform PAL filters, in 16-bit sample units.
+//
+// With a threshold of 0, the filter keeps every bin, so the only difference is
+// rounding in the float FFTs. That's around 1e-7 relative to the signal, well
+// under 0.01 for 16-bit samples, so check every sample.
+//
+// With a real threshold, a bin whose similarity is very close to the threshold
+// may be kept in one precision and discarded in the other, changing the
+// samples in that tile by a few units. This is rare, so check that the RMS
+// difference over the whole output is under one 16-bit code instead.
+static constexpr double MAX_UNFILTERED_DIFFERENCE = 0.05;
+static constexpr double MAX_FILTERED_RMS_DIFFERENCE = 1.0;
+
+static std::mt19937 randomGenerator(42);
+
+// Check that two values are within tolerance of each other
+static void compareValues(const string &name, qint32 index, double expected, double actual, double tolerance)
+{
+    if (std::fabs(expected - actual) <= tolerance) return;
+
+    cerr << "Mismatch on " << name << " at " << index << ": "
+         << expected << " != " << actual << " (tolerance " << tolerance << ")\n";
+    exit(1);
+}
+
+// Transform a batch of numTiles tiles, and check the results against each
+// tile transformed on its own
+template <typename Real>
+static void testBatch(TransformFFT<Real> &batchFFT, TransformFFT<Real> &singleFFT, qint32 numTiles)
+{
+    // The batch and single-tile plans may use different algorithms, so allow
+    // for rounding error relative to the largest possible output (TILE_SIZE)
+    const double tolerance = 100 * std::numeric_limits<Real>::epsilon() * TILE_SIZE;
+    const string name = "batch of " + std::to_string(numTiles) + " tiles";
+
+    std::uniform_real_distribution<Real> dist(-1.0, 1.0);
+    vector<vector<Real>> input(numTiles, vector<Real>(TILE_SIZE));
+    for (qint32 tile = 0; tile < numTiles; tile++) {
+        for (qint32 i = 0; i < TILE_SIZE; i++) {
+            input[tile][i] = dist(randomGenerator);
+            batchFFT.real(tile)[i] = input[tile][i];
+        }
+    }
+
+    // Forward
+    batchFFT.forward(numTiles);
+    for (qint32 tile = 0; tile < numTiles; tile++) {
+        for (qint32 i = 0; i < TILE_SIZE; i++) singleFFT.real(0)[i] = input[tile][i];
+        singleFFT.forward(1);
+
+        for (qint32 i = 0; i < TILE_COMPLEX_SIZE; i++) {
+            compareValues(name + " forward (real)", i, singleFFT.complexIn(0)[i][0], batchFFT.complexIn(tile)[i][0], tolerance);
+            compareValues(name + " forward (imag)", i, singleFFT.complexIn(0)[i][1], batchFFT.complexIn(tile)[i][1], tolerance);
+        }
+    }
+
+    // Inverse, which should give back the input scaled by TILE_SIZE
+    for (qint32 tile = 0; tile < numTiles; tile++) {
+        for (qint32 i = 0; i < TILE_COMPLEX_SIZE; i++) {
+            batchFFT.complexOut(tile)[i][0] = batchFFT.complexIn(tile)[i][0];
+            batchFFT.complexOut(tile)[i][1] = batchFFT.complexIn(tile)[i][1];
+        }
+    }
+    batchFFT.inverse(numTiles);
+    for (qint32 tile = 0; tile < numTiles; tile++) {
+        for (qint32 i = 0; i < TILE_SIZE; i++) {
+            compareValues(name + " inverse", i, input[tile][i] * TILE_SIZE, batchFFT.real(tile)[i], tolerance);
+        }
+    }
+}
+
+// Check TransformFFT with full batches and with the shorter batch at the end
+// of a row
+template <typename Real>
+static void testTransformFFT(const string &precisionName)
+{
+    cerr << "Testing " << precisionName << " TransformFFT\n";
+
+    TransformFFT<Real> batchFFT, singleFFT;
+    batchFFT.plan(TILE_DIMS, MAX_TILES);
+    singleFFT.plan(TILE_DIMS, 1);
+
+    const qint32 batchSize = batchFFT.getBatchSize();
+    const qint32 tailSize = MAX_TILES % batchSize;
+    if (tailSize == 0) {
+        cerr << "Batch size " << batchSize << " leaves no tail batch\n";
+        exit(1);
+    }
+
+    testBatch(batchFFT, singleFFT, batchSize);
+    testBatch(batchFFT, singleFFT, tailSize);
+    testBatch(batchFFT, singleFFT, 1);
+}
+
+// Make video parameters for a PAL field, matching what ld-decode produces
+static LdDecodeMetaData::VideoParameters makeVideoParameters()
+{
+    LdDecodeMetaData::VideoParameters videoParameters;
+    videoParameters.system = PAL;
+    videoParameters.fieldWidth = 1135;
+    videoParameters.fieldHeight = 313;
+    videoParameters.sampleRate = 17734475.0;
+    videoParameters.fSC = 4433618.75;
+    videoParameters.activeVideoStart = 185;
+    videoParameters.activeVideoEnd = 1107;
+    videoParameters.firstActiveFrameLine = 44;
+    videoParameters.lastActiveFrameLine = 620;
+    videoParameters.white16bIre = 54016;
+    videoParameters.black16bIre = 16384;
+    return videoParameters;
+}
+
+// Make a sequence of fields containing blocks of luma and chroma, with noise.
+// The chroma is at fSC, so it lines up with the 4fSC sample grid, and its
+// phase changes between lines and fields.
+static void makeFields(const LdDecodeMetaData::VideoParameters &videoParameters, qint32 numFields,
+                       vector<SourceVideo::Data> &fieldData, QVector<SourceField> &fields)
+{
+    std::uniform_int_distribution<int> noiseDist(-500, 500);
+
+    fieldData.resize(numFields);
+    fields.resize(numFields);
+    for (qint32 f = 0; f < numFields; f++) {
+        SourceVideo::Data &data = fieldData[f];
+        data.resize(videoParameters.fieldWidth * videoParameters.fieldHeight);
+        for (qint32 y = 0; y < videoParameters.fieldHeight; y++) {
+            for (qint32 x = 0; x < videoParameters.fieldWidth; x++) {
+                const qint32 block = (x / 60) + (y / 30) + f;
+                const double luma = videoParameters.black16bIre + ((block % 4) * 8000);
+                const double chroma = ((block % 3) * 4000) * sin((x * M_PI / 2) + (y * M_PI / 2) + (f * 0.7));
+                data[(y * videoParameters.fieldWidth) + x] = static_cast<quint16>(luma + chroma + noiseDist(randomGenerator));
+            }
+        }
+
+        fields[f].data = SourceVideo::View(data);
+        fields[f].field.isFirstField = (f % 2) == 0;
+        fields[f].field.fieldPhaseID = (f % 8) + 1;
+    }
+}
+
+// Run a Transform PAL filter in double and single precision over the same
+// fields, and return the differences between their outputs
+template <typename Filter>
+static vector<double> comparePrecision(double threshold, qint32 lookBehind, qint32 lookAhead)
+{
+    const LdDecodeMetaData::VideoParameters videoParameters = makeVideoParameters();
+
+    const qint32 numOutputFields = 4;
+    const qint32 startIndex = lookBehind;
+    const qint32 endIndex = startIndex + numOutputFields;
+    vector<SourceVideo::Data> fieldData;
+    QVector<SourceField> fields;
+    makeFields(videoParameters, endIndex + lookAhead, fieldData, fields);
+
+    Filter doubleFilter, singleFilter;
+    doubleFilter.updateConfiguration(videoParameters, threshold, QVector<double>(), false);
+    singleFilter.updateConfiguration(videoParameters, threshold, QVector<double>(), true);
+
+    QVector<const double *> doubleOutput(numOutputFields), singleOutput(numOutputFields);
+    doubleFilter.filterFields(fields, startIndex, endIndex, doubleOutput);
+    singleFilter.filterFields(fields, startIndex, endIndex, singleOutput);
+
+    const qint32 fieldSize = videoParameters.fieldWidth * videoParameters.fieldHeight;
+    vector<double> differences;
+    differences.reserve(numOutputFields * fieldSize);
+    for (qint32 f = 0; f < numOutputFields; f++) {
+        for (qint32 i = 0; i < fieldSize; i++) {
+            differences.push_back(singleOutput[f][i] - doubleOutput[f][i]);
+        }
+    }
+
+    return differences;
+}
+
+template <typename Filter>
+static void testPrecision(const string &filterName, qint32 lookBehind, qint32 lookAhead)
+{
+    cerr << "Comparing single and double precision " << filterName << "\n";
+
+    // Without filtering, every sample must match closely
+    const vector<double> unfiltered = comparePrecision<Filter>(0.0, lookBehind, lookAhead);
+    double maxDifference = 0.0;
+    for (size_t i = 0; i < unfiltered.size(); i++) {
+        compareValues(filterName + " unfiltered", i, 0.0, unfiltered[i], MAX_UNFILTERED_DIFFERENCE);
+        maxDifference = qMax(maxDifference, std::fabs(unfiltered[i]));
+    }
+    cerr << "Largest difference without filtering " << maxDifference << "\n";
+
+    // With the default threshold, the output must match closely overall
+    const vector<double> filtered = comparePrecision<Filter>(0.4, lookBehind, lookAhead);
+    double sumSquares = 0.0;
+    for (double difference : filtered) sumSquares += difference * difference;
+    const double rmsDifference = sqrt(sumSquares / filtered.size());
+    cerr << "RMS difference with filtering " << rmsDifference << "\n";
+    if (rmsDifference > MAX_FILTERED_RMS_DIFFERENCE) {
+        cerr << "RMS difference for " << filterName << " is larger than " << MAX_FILTERED_RMS_DIFFERENCE << "\n";
+        exit(1);
+    }
+}
+
+int main()
+{
+    testTransformFFT<double>("double");
+
+#ifdef HAVE_FFTW3F
+    testTransformFFT<float>("float");
+    testPrecision<TransformPal2D>("TransformPal2D", 0, 0);
+    testPrecision<TransformPal3D>("TransformPal3D", TransformPal3D::getLookBehind() * 2,
+                                  TransformPal3D::getLookAhead() * 2);
+#else
+    cerr << "Single-precision FFTW not available, skipping\n";
+#endif
+
+    return 0;
+}
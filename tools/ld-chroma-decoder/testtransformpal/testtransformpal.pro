@@ -0,0 +1,58 @@
+CONFIG += c++17 testcase
+CONFIG -= app_bundle
+
+SOURCES += \
+    testtransformpal.cpp \
+    ../componentframe.cpp \
+    ../framecanvas.cpp \
+    ../sourcefield.cpp \
+    ../transformfft.cpp \
+    ../transformpal.cpp \
+    ../transformpal2d.cpp \
+    ../transformpal3d.cpp \
+    ../../library/tbc/binarymetadata.cpp \
+    ../../library/tbc/compressedtbc.cpp \
+    ../../library/tbc/dropouts.cpp \
+    ../../library/tbc/fieldcache.cpp \
+    ../../library/tbc/fieldstore.cpp \
+    ../../library/tbc/jsonio.cpp \
+    ../../library/tbc/lddecodemetadata.cpp \
+    ../../library/tbc/parallelfor.cpp \
+    ../../library/tbc/sourcevideo.cpp \
+    ../../library/tbc/tbcparts.cpp \
+    ../../library/tbc/vbidecoder.cpp
+
+HEADERS += \
+    ../componentframe.h \
+    ../framecanvas.h \
+    ../outputwriter.h \
+    ../sourcefield.h \
+    ../transformfft.h \
+    ../transformpal.h \
+    ../transformpal2d.h \
+    ../transformpal3d.h \
+    ../../library/tbc/binarymetadata.h \
+    ../../library/tbc/compressedtbc.h \
+    ../../library/tbc/dropouts.h \
+    ../../library/tbc/fieldcache.h \
+    ../../library/tbc/fieldstore.h \
+    ../../library/tbc/jsonio.h \
+    ../../library/tbc/lddecodemetadata.h \
+    ../../library/tbc/parallelfor.h \
+    ../../library/tbc/sourcevideo.h \
+    ../../library/tbc/tbcparts.h \
+    ../../library/tbc/vbidecoder.h
+
+INCLUDEPATH += \
+    .. \
+    ../../library/tbc
+
+LIBS += -lfftw3
+
+# Single-precision FFTW is optional; the comparison is skipped without it
+packagesExist(fftw3f) {
+    DEFINES += HAVE_FFTW3F
+    LIBS += -lfftw3f
+}
+
+target.CONFIG += no_default_install
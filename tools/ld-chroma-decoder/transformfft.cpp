@@ -0,0 +1,190 @@
+/************************************************************************
+
+    transformfft.cpp
+
+    ld-chroma-decoder - Colourisation filter for ld-decode
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-chroma-decoder is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include "transformfft.h"
+
+#include <cassert>
+#include <cstring>
+
+// The FFTW functions for each precision. FFTW's double and float APIs are
+// identical apart from the fftw_/fftwf_ prefix.
+template <typename Real>
+struct FFTWFunctions;
+
+template <>
+struct FFTWFunctions<double> {
+    static constexpr auto allocReal = fftw_alloc_real;
+    static constexpr auto allocComplex = fftw_alloc_complex;
+    static constexpr auto freeBuffer = fftw_free;
+    static constexpr auto planManyR2C = fftw_plan_many_dft_r2c;
+    static constexpr auto planManyC2R = fftw_plan_many_dft_c2r;
+    static constexpr auto execute = fftw_execute;
+    static constexpr auto destroyPlan = fftw_destroy_plan;
+};
+
+#ifdef HAVE_FFTW3F
+template <>
+struct FFTWFunctions<float> {
+    static constexpr auto allocReal = fftwf_alloc_real;
+    static constexpr auto allocComplex = fftwf_alloc_complex;
+    static constexpr auto freeBuffer = fftwf_free;
+    static constexpr auto planManyR2C = fftwf_plan_many_dft_r2c;
+    static constexpr auto planManyC2R = fftwf_plan_many_dft_c2r;
+    static constexpr auto execute = fftwf_execute;
+    static constexpr auto destroyPlan = fftwf_destroy_plan;
+};
+#endif
+
+template <typename Real>
+TransformFFT<Real>::TransformFFT()
+    : maxTiles(0), batchSize(0), tailSize(0), realSize(0), complexSize(0),
+      realBuf(nullptr), complexInBuf(nullptr), complexOutBuf(nullptr),
+      forwardPlan(nullptr), inversePlan(nullptr), tailForwardPlan(nullptr), tailInversePlan(nullptr)
+{
+}
+
+template <typename Real>
+TransformFFT<Real>::~TransformFFT()
+{
+    release();
+}
+
+// Free FFTW plans and buffers
+template <typename Real>
+void TransformFFT<Real>::release()
+{
+    using F = FFTWFunctions<Real>;
+
+    if (forwardPlan != nullptr) F::destroyPlan(forwardPlan);
+    if (inversePlan != nullptr) F::destroyPlan(inversePlan);
+    if (tailForwardPlan != nullptr) F::destroyPlan(tailForwardPlan);
+    if (tailInversePlan != nullptr) F::destroyPlan(tailInversePlan);
+    if (realBuf != nullptr) F::freeBuffer(realBuf);
+    if (complexInBuf != nullptr) F::freeBuffer(complexInBuf);
+    if (complexOutBuf != nullptr) F::freeBuffer(complexOutBuf);
+
+    forwardPlan = nullptr;
+    inversePlan = nullptr;
+    tailForwardPlan = nullptr;
+    tailInversePlan = nullptr;
+    realBuf = nullptr;
+    complexInBuf = nullptr;
+    complexOutBuf = nullptr;
+    batchSize = 0;
+    tailSize = 0;
+}
+
+template <typename Real>
+void TransformFFT<Real>::plan(const QVector<qint32> &_dims, qint32 _maxTiles)
+{
+    using F = FFTWFunctions<Real>;
+
+    assert(!_dims.empty());
+    assert(_maxTiles > 0);
+
+    // If nothing has changed, the existing plans can be reused
+    if (batchSize != 0 && _dims == dims && _maxTiles == maxTiles) return;
+
+    release();
+    dims = _dims;
+    maxTiles = _maxTiles;
+
+    // r2c produces roughly half the output, because the input data is real
+    // (i.e. contains no negative frequencies)
+    realSize = 1;
+    complexSize = 1;
+    for (qint32 i = 0; i < dims.size(); i++) {
+        realSize *= dims[i];
+        complexSize *= (i == dims.size() - 1) ? ((dims[i] / 2) + 1) : dims[i];
+    }
+
+    batchSize = qBound(1, BATCH_BYTES / static_cast<qint32>(realSize * sizeof(Real)), maxTiles);
+    tailSize = maxTiles % batchSize;
+
+    // Allocate buffers for FFTW. These must be allocated using FFTW's own
+    // functions so they're properly aligned for SIMD operations.
+    realBuf = F::allocReal(batchSize * realSize);
+    complexInBuf = F::allocComplex(batchSize * complexSize);
+    complexOutBuf = F::allocComplex(batchSize * complexSize);
+
+    // Plan FFTW operations. Tiles are stored contiguously, one after another.
+    const int rank = dims.size();
+    const int *n = dims.data();
+    forwardPlan = F::planManyR2C(rank, n, batchSize,
+                                 realBuf, nullptr, 1, realSize,
+                                 complexInBuf, nullptr, 1, complexSize,
+                                 FFTW_MEASURE);
+    inversePlan = F::planManyC2R(rank, n, batchSize,
+                                 complexOutBuf, nullptr, 1, complexSize,
+                                 realBuf, nullptr, 1, realSize,
+                                 FFTW_MEASURE);
+
+    // Plan the shorter batch at the end of a row, which uses the start of the
+    // same buffers. Running the full plan there instead would transform
+    // unused tiles; for 3D tiles that's up to half of an extra batch per row.
+    if (tailSize != 0) {
+        tailForwardPlan = F::planManyR2C(rank, n, tailSize,
+                                         realBuf, nullptr, 1, realSize,
+                                         complexInBuf, nullptr, 1, complexSize,
+                                         FFTW_MEASURE);
+        tailInversePlan = F::planManyC2R(rank, n, tailSize,
+                                         complexOutBuf, nullptr, 1, complexSize,
+                                         realBuf, nullptr, 1, realSize,
+                                         FFTW_MEASURE);
+    }
+
+    // FFTW_MEASURE overwrites the buffers while planning, so clear them
+    // (callers may not fill every tile if they use a full batch for fewer
+    // tiles)
+    memset(realBuf, 0, batchSize * realSize * sizeof(Real));
+    memset(complexInBuf, 0, batchSize * complexSize * sizeof(Complex));
+    memset(complexOutBuf, 0, batchSize * complexSize * sizeof(Complex));
+}
+
+template <typename Real>
+void TransformFFT<Real>::forward(qint32 numTiles)
+{
+    FFTWFunctions<Real>::execute(getPlan(forwardPlan, tailForwardPlan, numTiles));
+}
+
+template <typename Real>
+void TransformFFT<Real>::inverse(qint32 numTiles)
+{
+    FFTWFunctions<Real>::execute(getPlan(inversePlan, tailInversePlan, numTiles));
+}
+
+// Choose the plan for a batch of numTiles tiles. There are only plans for
+// full batches and the tail size, so any other size uses a full batch.
+template <typename Real>
+typename TransformFFT<Real>::Plan TransformFFT<Real>::getPlan(Plan fullPlan, Plan tailPlan, qint32 numTiles) const
+{
+    assert(numTiles > 0 && numTiles <= batchSize);
+
+    return (numTiles == tailSize) ? tailPlan : fullPlan;
+}
+
+template class TransformFFT<double>;
+#ifdef HAVE_FFTW3F
+template class TransformFFT<float>;
+#endif
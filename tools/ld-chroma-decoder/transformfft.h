@@ -0,0 +1,112 @@
+/************************************************************************
+
+    transformfft.h
+
+    ld-chroma-decoder - Colourisation filter for ld-decode
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-chroma-decoder is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef TRANSFORMFFT_H
+#define TRANSFORMFFT_H
+
+#include <QVector>
+#include <fftw3.h>
+#include <type_traits>
+
+// A batch of same-sized real-to-complex FFTs, planned and executed together
+// using FFTW's advanced interface.
+//
+// Real is double or float; the float version uses FFTW's single-precision
+// library, so it's only built if HAVE_FFTW3F is defined.
+template <typename Real>
+class TransformFFT {
+public:
+    // FFTW's complex type for this precision (fftw_complex or fftwf_complex)
+    using Complex = Real[2];
+
+    TransformFFT();
+    ~TransformFFT();
+
+    TransformFFT(const TransformFFT &) = delete;
+    TransformFFT& operator=(const TransformFFT &) = delete;
+
+    // Allocate buffers and plan the transforms for tiles of size dims
+    // (slowest-varying dimension first), transforming up to maxTiles tiles at
+    // once. The batch size is limited so the buffers stay in cache.
+    //
+    // Callers are expected to process maxTiles tiles as full batches plus one
+    // shorter batch at the end (maxTiles % batchSize tiles), so a separate
+    // plan is made for that size.
+    //
+    // FFTW's planner isn't thread-safe, so this must not be called while
+    // another thread is planning.
+    void plan(const QVector<qint32> &dims, qint32 maxTiles);
+
+    // Return the number of tiles in each batch
+    qint32 getBatchSize() const {
+        return batchSize;
+    }
+
+    // Return the time-domain data for a tile
+    Real *real(qint32 tile) {
+        return realBuf + (tile * realSize);
+    }
+
+    // Return the frequency-domain input/output for a tile
+    Complex *complexIn(qint32 tile) {
+        return complexInBuf + (tile * complexSize);
+    }
+    Complex *complexOut(qint32 tile) {
+        return complexOutBuf + (tile * complexSize);
+    }
+
+    // Transform the time-domain data into complexIn, for the first numTiles
+    // tiles
+    void forward(qint32 numTiles);
+
+    // Transform complexOut back into the time-domain data, for the first
+    // numTiles tiles. This overwrites complexOut.
+    void inverse(qint32 numTiles);
+
+private:
+    using Plan = typename std::conditional<std::is_same<Real, float>::value, fftwf_plan, fftw_plan>::type;
+
+    void release();
+    Plan getPlan(Plan fullPlan, Plan tailPlan, qint32 numTiles) const;
+
+    // Size of the real buffer for each batch, in bytes
+    static constexpr qint32 BATCH_BYTES = 256 * 1024;
+
+    QVector<qint32> dims;
+    qint32 maxTiles;
+    qint32 batchSize;
+    qint32 tailSize;
+    qint32 realSize;
+    qint32 complexSize;
+
+    Real *realBuf;
+    Complex *complexInBuf;
+    Complex *complexOutBuf;
+    Plan forwardPlan;
+    Plan inversePlan;
+    Plan tailForwardPlan;
+    Plan tailInversePlan;
+};
+
+#endif
@@ -27,11 +27,13 @@
 
 #include "transformpal.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 
 TransformPal::TransformPal(qint32 _xComplex, qint32 _yComplex, qint32 _zComplex)
-    : xComplex(_xComplex), yComplex(_yComplex), zComplex(_zComplex), configurationSet(false)
+    : xComplex(_xComplex), yComplex(_yComplex), zComplex(_zComplex), configurationSet(false),
+      singlePrecision(false)
 {
 }
 
@@ -40,7 +42,8 @@ TransformPal::~TransformPal()
 }
 
 void TransformPal::updateConfiguration(const LdDecodeMetaData::VideoParameters &_videoParameters,
-                                       double threshold, const QVector<double> &_thresholds)
+                                       double threshold, const QVector<double> &_thresholds,
+                                       bool _singlePrecision)
 {
     videoParameters = _videoParameters;
 
@@ -60,9 +63,50 @@ void TransformPal::updateConfiguration(const LdDecodeMetaData::VideoParameters &
         }
     }
 
+#ifdef HAVE_FFTW3F
+    singlePrecision = _singlePrecision;
+#else
+    // Single-precision FFTW isn't available, so always use double
+    singlePrecision = false;
+#endif
+
+    // Plan the FFTs now, rather than in filterFields, because FFTW's planner
+    // isn't thread-safe
+    planFFTs();
+
+    // The active region may have moved, so don't reuse the old buffers
+    chromaBuf.clear();
+
     configurationSet = true;
 }
 
+void TransformPal::prepareChromaBuf(qint32 numFields, QVector<const double *> &outputFields)
+{
+    const qint32 fieldSize = videoParameters.fieldWidth * videoParameters.fieldHeight;
+
+    // The filters only write to the active region of each buffer, so the rest
+    // stays clear from when the buffer was allocated. Clear the field lines
+    // that are active in either field.
+    const qint32 firstLine = videoParameters.firstActiveFrameLine / 2;
+    const qint32 lastLine = qMin((videoParameters.lastActiveFrameLine + 1) / 2, videoParameters.fieldHeight);
+    const qint32 activeWidth = videoParameters.activeVideoEnd - videoParameters.activeVideoStart;
+
+    chromaBuf.resize(numFields);
+    for (qint32 i = 0; i < numFields; i++) {
+        if (chromaBuf[i].size() != fieldSize) {
+            chromaBuf[i].fill(0.0, fieldSize);
+        } else {
+            double *data = chromaBuf[i].data();
+            for (qint32 y = firstLine; y < lastLine; y++) {
+                double *line = data + (y * videoParameters.fieldWidth) + videoParameters.activeVideoStart;
+                std::fill(line, line + activeWidth, 0.0);
+            }
+        }
+
+        outputFields[i] = chromaBuf[i].data();
+    }
+}
+
 void TransformPal::overlayFFT(qint32 positionX, qint32 positionY,
                               const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
                               QVector<ComponentFrame> &componentFrames)
@@ -74,7 +118,8 @@ void TransformPal::overlayFFT(qint32 positionX, qint32 positionY,
 }
 
 // Overlay the input and output FFT arrays, in either 2D or 3D
-void TransformPal::overlayFFTArrays(const fftw_complex *fftIn, const fftw_complex *fftOut,
+template <typename Real>
+void TransformPal::overlayFFTArrays(const Real (*fftIn)[2], const Real (*fftOut)[2],
                                     FrameCanvas &canvas)
 {
     // Colours
@@ -88,15 +133,15 @@ void TransformPal::overlayFFTArrays(const fftw_complex *fftIn, const fftw_comple
     // Work out a scaling factor to make all values visible.
     double maxValue = 0;
     for (qint32 i = 0; i < xComplex * yComplex * zComplex; i++) {
-        maxValue = qMax(maxValue, fabs(fftIn[i][0]));
-        maxValue = qMax(maxValue, fabs(fftOut[i][0]));
+        maxValue = qMax<double>(maxValue, fabs(fftIn[i][0]));
+        maxValue = qMax<double>(maxValue, fabs(fftOut[i][0]));
     }
     const double valueScale = 65535.0 / log2(maxValue);
 
     // Draw each 2D plane of the array
     for (qint32 z = 0; z < zComplex; z++) {
         for (qint32 column = 0; column < 2; column++) {
-            const fftw_complex *fftData = column == 0 ? fftIn : fftOut;
+            const Real (*fftData)[2] = column == 0 ? fftIn : fftOut;
 
             // Work out where this 2D array starts
             const qint32 yStart = canvas.top() + (z * ((yScale * yComplex) + 1));
@@ -117,3 +162,10 @@ void TransformPal::overlayFFTArrays(const fftw_complex *fftIn, const fftw_comple
         }
     }
 }
+
+template void TransformPal::overlayFFTArrays<double>(const double (*fftIn)[2], const double (*fftOut)[2],
+                                                     FrameCanvas &canvas);
+#ifdef HAVE_FFTW3F
+template void TransformPal::overlayFFTArrays<float>(const float (*fftIn)[2], const float (*fftOut)[2],
+                                                    FrameCanvas &canvas);
+#endif
@@ -49,8 +49,13 @@ public:
     // threshold is the similarity threshold for the filter. Values from 0-1
     // are meaningful, with higher values requiring signals to be more similar
     // to be considered chroma.
+    //
+    // If singlePrecision is true, the FFTs are computed using floats rather
+    // than doubles, which is faster but slightly less accurate. It's ignored
+    // unless HAVE_FFTW3F is defined.
     void updateConfiguration(const LdDecodeMetaData::VideoParameters &videoParameters,
-                             double threshold, const QVector<double> &thresholds);
+                             double threshold, const QVector<double> &thresholds,
+                             bool singlePrecision);
 
     // Filter input fields.
     //
@@ -70,13 +75,21 @@ public:
                     QVector<ComponentFrame> &componentFrames);
 
 protected:
+    // Plan the FFTs for the current configuration.
+    virtual void planFFTs() = 0;
+
+    // Make sure there are numFields buffers in chromaBuf, with their active
+    // regions cleared, and point outputFields at them.
+    void prepareChromaBuf(qint32 numFields, QVector<const double *> &outputFields);
+
     // Overlay a visualisation of one field's FFT.
     // Calls back to overlayFFTArrays to draw the arrays.
     virtual void overlayFFTFrame(qint32 positionX, qint32 positionY,
                                  const QVector<SourceField> &inputFields, qint32 fieldIndex,
                                  ComponentFrame &componentFrame) = 0;
 
-    void overlayFFTArrays(const fftw_complex *fftIn, const fftw_complex *fftOut,
+    template <typename Real>
+    void overlayFFTArrays(const Real (*fftIn)[2], const Real (*fftOut)[2],
                           FrameCanvas &canvas);
 
     // FFT size
@@ -88,6 +101,11 @@ protected:
     bool configurationSet;
     LdDecodeMetaData::VideoParameters videoParameters;
     QVector<double> thresholds;
+    bool singlePrecision;
+
+    // The combined result of all the FFT processing for each input field.
+    // Inverse-FFT results are accumulated into these buffers.
+    QVector<QVector<double>> chromaBuf;
 };
 
 #endif
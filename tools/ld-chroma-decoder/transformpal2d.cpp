@@ -62,26 +62,10 @@ TransformPal2D::TransformPal2D()
             windowFunction[y][x] = windowY * windowX;
         }
     }
-
-    // Allocate buffers for FFTW. These must be allocated using FFTW's own
-    // functions so they're properly aligned for SIMD operations.
-    fftReal = fftw_alloc_real(YTILE * XTILE);
-    fftComplexIn = fftw_alloc_complex(YCOMPLEX * XCOMPLEX);
-    fftComplexOut = fftw_alloc_complex(YCOMPLEX * XCOMPLEX);
-
-    // Plan FFTW operations
-    forwardPlan = fftw_plan_dft_r2c_2d(YTILE, XTILE, fftReal, fftComplexIn, FFTW_MEASURE);
-    inversePlan = fftw_plan_dft_c2r_2d(YTILE, XTILE, fftComplexOut, fftReal, FFTW_MEASURE);
 }
 
 TransformPal2D::~TransformPal2D()
 {
-    // Free FFTW plans and buffers
-    fftw_destroy_plan(forwardPlan);
-    fftw_destroy_plan(inversePlan);
-    fftw_free(fftReal);
-    fftw_free(fftComplexIn);
-    fftw_free(fftComplexOut);
 }
 
 qint32 TransformPal2D::getThresholdsSize()
@@ -90,6 +74,20 @@ qint32 TransformPal2D::getThresholdsSize()
     return YCOMPLEX * ((XCOMPLEX / 4) + 1);
 }
 
+void TransformPal2D::planFFTs()
+{
+    // Each batch can cover up to a whole row of tiles
+    const qint32 tilesPerRow = (videoParameters.activeVideoEnd - videoParameters.activeVideoStart + XTILE - 1) / HALFXTILE;
+
+#ifdef HAVE_FFTW3F
+    if (singlePrecision) {
+        floatFFT.plan({YTILE, XTILE}, tilesPerRow);
+        return;
+    }
+#endif
+    doubleFFT.plan({YTILE, XTILE}, tilesPerRow);
+}
+
 void TransformPal2D::filterFields(const QVector<SourceField> &inputFields, qint32 startIndex, qint32 endIndex,
                                   QVector<const double *> &outputFields)
 {
@@ -102,25 +100,27 @@ void TransformPal2D::filterFields(const QVector<SourceField> &inputFields, qint3
     }
     assert(outputFields.size() == (endIndex - startIndex));
 
-    // Allocate and clear output buffers
-    chromaBuf.resize(endIndex - startIndex);
-    for (qint32 i = 0; i < chromaBuf.size(); i++) {
-        chromaBuf[i].resize(videoParameters.fieldWidth * videoParameters.fieldHeight);
-        chromaBuf[i].fill(0.0);
-
-        outputFields[i] = chromaBuf[i].data();
-    }
+    // Prepare output buffers
+    prepareChromaBuf(endIndex - startIndex, outputFields);
 
     for (qint32 i = startIndex, j = 0; i < endIndex; i++, j++) {
-        filterField(inputFields[i], j);
+#ifdef HAVE_FFTW3F
+        if (singlePrecision) {
+            filterField(floatFFT, inputFields[i], j);
+            continue;
+        }
+#endif
+        filterField(doubleFFT, inputFields[i], j);
     }
 }
 
-// Process one field, writing the reuslt into chromaBuf[outputIndex]
-void TransformPal2D::filterField(const SourceField& inputField, qint32 outputIndex)
+// Process one field, writing the result into chromaBuf[outputIndex]
+template <typename Real>
+void TransformPal2D::filterField(TransformFFT<Real> &fft, const SourceField& inputField, qint32 outputIndex)
 {
     const qint32 firstFieldLine = inputField.getFirstActiveLine(videoParameters);
     const qint32 lastFieldLine = inputField.getLastActiveLine(videoParameters);
+    const qint32 batchSize = fft.getBatchSize();
 
     // Iterate through the overlapping tile positions, covering the active area.
     // (See TransformPal2D member variable documentation for how the tiling works.)
@@ -129,21 +129,35 @@ void TransformPal2D::filterField(const SourceField& inputField, qint32 outputInd
         const qint32 startY = qMax(firstFieldLine - tileY, 0);
         const qint32 endY = qMin(lastFieldLine - tileY, YTILE);
 
-        for (qint32 tileX = videoParameters.activeVideoStart - HALFXTILE; tileX < videoParameters.activeVideoEnd; tileX += HALFXTILE) {
-            // Compute the forward FFT
-            forwardFFTTile(tileX, tileY, startY, endY, inputField);
+        // Process the tiles along this row in batches
+        for (qint32 firstTileX = videoParameters.activeVideoStart - HALFXTILE; firstTileX < videoParameters.activeVideoEnd;
+             firstTileX += batchSize * HALFXTILE) {
+            const qint32 numTiles = qMin(batchSize, (videoParameters.activeVideoEnd - firstTileX + HALFXTILE - 1) / HALFXTILE);
+
+            // Compute the forward FFTs
+            for (qint32 tile = 0, tileX = firstTileX; tile < numTiles; tile++, tileX += HALFXTILE) {
+                forwardFFTTile(tileX, tileY, startY, endY, inputField, fft.real(tile));
+            }
+            fft.forward(numTiles);
 
             // Apply the frequency-domain filter
-            applyFilter();
+            for (qint32 tile = 0; tile < numTiles; tile++) {
+                applyFilter<Real>(fft.complexIn(tile), fft.complexOut(tile));
+            }
 
-            // Compute the inverse FFT
-            inverseFFTTile(tileX, tileY, startY, endY, outputIndex);
+            // Compute the inverse FFTs
+            fft.inverse(numTiles);
+            for (qint32 tile = 0, tileX = firstTileX; tile < numTiles; tile++, tileX += HALFXTILE) {
+                inverseFFTTile(tileX, tileY, startY, endY, outputIndex, fft.real(tile));
+            }
         }
     }
 }
 
-// Apply the forward FFT to an input tile, populating fftComplexIn
-void TransformPal2D::forwardFFTTile(qint32 tileX, qint32 tileY, qint32 startY, qint32 endY, const SourceField &inputField)
+// Copy an input tile into fftReal, ready for the forward FFT
+template <typename Real>
+void TransformPal2D::forwardFFTTile(qint32 tileX, qint32 tileY, qint32 startY, qint32 endY, const SourceField &inputField,
+                                    Real *fftReal)
 {
     // Copy the input signal into fftReal, applying the window function
     const quint16 *inputPtr = inputField.data.data();
@@ -162,21 +176,17 @@ void TransformPal2D::forwardFFTTile(qint32 tileX, qint32 tileY, qint32 startY, q
             fftReal[(y * XTILE) + x] = b[tileX + x] * windowFunction[y][x];
         }
     }
-
-    // Convert time domain in fftReal to frequency domain in fftComplexIn
-    fftw_execute(forwardPlan);
 }
 
-// Apply the inverse FFT to fftComplexOut, overlaying the result into chromaBuf[outputIndex]
-void TransformPal2D::inverseFFTTile(qint32 tileX, qint32 tileY, qint32 startY, qint32 endY, qint32 outputIndex)
+// Overlay the result of the inverse FFT in fftReal into chromaBuf[outputIndex]
+template <typename Real>
+void TransformPal2D::inverseFFTTile(qint32 tileX, qint32 tileY, qint32 startY, qint32 endY, qint32 outputIndex,
+                                    const Real *fftReal)
 {
     // Work out what X range of this tile is inside the active area
     const qint32 startX = qMax(videoParameters.activeVideoStart - tileX, 0);
     const qint32 endX = qMin(videoParameters.activeVideoEnd - tileX, XTILE);
 
-    // Convert frequency domain in fftComplexOut back to time domain in fftReal
-    fftw_execute(inversePlan);
-
     // Overlay the result, normalising the FFTW output, into chromaBuf
     double *outputPtr = chromaBuf[outputIndex].data();
     for (qint32 y = startY; y < endY; y++) {
@@ -187,14 +197,16 @@ void TransformPal2D::inverseFFTTile(qint32 tileX, qint32 tileY, qint32 startY, q
     }
 }
 
-// Return the absolute value squared of an fftw_complex
-static inline double fftwAbsSq(const fftw_complex &value)
+// Return the absolute value squared of an fftw_complex or fftwf_complex
+template <typename Real>
+static inline Real fftwAbsSq(const Real (&value)[2])
 {
     return (value[0] * value[0]) + (value[1] * value[1]);
 }
 
-// Apply the frequency-domain filter.
-void TransformPal2D::applyFilter()
+// Apply the frequency-domain filter, from fftComplexIn to fftComplexOut.
+template <typename Real>
+void TransformPal2D::applyFilter(const Real (*fftComplexIn)[2], Real (*fftComplexOut)[2])
 {
     // Get pointer to squared threshold values
     const double *thresholdsPtr = thresholds.data();
@@ -226,12 +238,12 @@ void TransformPal2D::applyFilter()
         const qint32 y_ref = ((YTILE / 2) + YTILE - y) % YTILE;
 
         // Input data for this line and its reflection
-        const fftw_complex *bi = fftComplexIn + (y * XCOMPLEX);
-        const fftw_complex *bi_ref = fftComplexIn + (y_ref * XCOMPLEX);
+        const Real (*bi)[2] = fftComplexIn + (y * XCOMPLEX);
+        const Real (*bi_ref)[2] = fftComplexIn + (y_ref * XCOMPLEX);
 
         // Output data for this line and its reflection
-        fftw_complex *bo = fftComplexOut + (y * XCOMPLEX);
-        fftw_complex *bo_ref = fftComplexOut + (y_ref * XCOMPLEX);
+        Real (*bo)[2] = fftComplexOut + (y * XCOMPLEX);
+        Real (*bo_ref)[2] = fftComplexOut + (y_ref * XCOMPLEX);
 
         // We only need to look at horizontal frequencies that might be chroma (0.5fSC to 1.5fSC).
         for (qint32 x = XTILE / 8; x <= XTILE / 4; x++) {
@@ -241,8 +253,8 @@ void TransformPal2D::applyFilter()
             // Get the threshold for this bin
             const double threshold_sq = *thresholdsPtr++;
 
-            const fftw_complex &in_val = bi[x];
-            const fftw_complex &ref_val = bi_ref[x_ref];
+            const Real (&in_val)[2] = bi[x];
+            const Real (&ref_val)[2] = bi_ref[x_ref];
 
             if (x == x_ref && y == y_ref) {
                 // This bin is its own reflection (i.e. it's a carrier). Keep it!
@@ -252,8 +264,8 @@ void TransformPal2D::applyFilter()
             }
 
             // Get the squares of the magnitudes (to minimise the number of sqrts)
-            const double m_in_sq = fftwAbsSq(in_val);
-            const double m_ref_sq = fftwAbsSq(ref_val);
+            const double m_in_sq = fftwAbsSq<Real>(in_val);
+            const double m_ref_sq = fftwAbsSq<Real>(ref_val);
 
             // Compare the magnitudes of the two values, and discard both
             // if they are more different than the threshold for this
@@ -276,6 +288,20 @@ void TransformPal2D::applyFilter()
 void TransformPal2D::overlayFFTFrame(qint32 positionX, qint32 positionY,
                                      const QVector<SourceField> &inputFields, qint32 fieldIndex,
                                      ComponentFrame &componentFrame)
+{
+#ifdef HAVE_FFTW3F
+    if (singlePrecision) {
+        overlayFFTTile(floatFFT, positionX, positionY, inputFields, fieldIndex, componentFrame);
+        return;
+    }
+#endif
+    overlayFFTTile(doubleFFT, positionX, positionY, inputFields, fieldIndex, componentFrame);
+}
+
+template <typename Real>
+void TransformPal2D::overlayFFTTile(TransformFFT<Real> &fft, qint32 positionX, qint32 positionY,
+                                    const QVector<SourceField> &inputFields, qint32 fieldIndex,
+                                    ComponentFrame &componentFrame)
 {
     // Do nothing if the tile isn't within the frame
     if (positionX < 0 || positionX + XTILE > videoParameters.fieldWidth
@@ -291,11 +317,12 @@ void TransformPal2D::overlayFFTFrame(qint32 positionX, qint32 positionY,
     const qint32 startY = qMax(firstFieldLine - tileY, 0);
     const qint32 endY = qMin(lastFieldLine - tileY, YTILE);
 
-    // Compute the forward FFT
-    forwardFFTTile(positionX, tileY, startY, endY, inputField);
+    // Compute the forward FFT, using the first tile in the batch
+    forwardFFTTile(positionX, tileY, startY, endY, inputField, fft.real(0));
+    fft.forward(1);
 
     // Apply the frequency-domain filter
-    applyFilter();
+    applyFilter<Real>(fft.complexIn(0), fft.complexOut(0));
 
     // Create a canvas
     FrameCanvas canvas(componentFrame, videoParameters);
@@ -305,5 +332,5 @@ void TransformPal2D::overlayFFTFrame(qint32 positionX, qint32 positionY,
     canvas.drawRectangle(positionX - 1, positionY + inputField.getOffset() - 1, XTILE + 1, (YTILE * 2) + 1, green);
 
     // Draw the arrays
-    overlayFFTArrays(fftComplexIn, fftComplexOut, canvas);
+    overlayFFTArrays<Real>(fft.complexIn(0), fft.complexOut(0), canvas);
 }
@@ -34,6 +34,7 @@
 #include "componentframe.h"
 #include "outputwriter.h"
 #include "sourcefield.h"
+#include "transformfft.h"
 #include "transformpal.h"
 
 class TransformPal2D : public TransformPal {
@@ -48,13 +49,24 @@ public:
                       QVector<const double *> &outputFields) override;
 
 protected:
-    void filterField(const SourceField& inputField, qint32 outputIndex);
-    void forwardFFTTile(qint32 tileX, qint32 tileY, qint32 startY, qint32 endY, const SourceField &inputField);
-    void inverseFFTTile(qint32 tileX, qint32 tileY, qint32 startY, qint32 endY, qint32 outputIndex);
-    void applyFilter();
+    void planFFTs() override;
+    template <typename Real>
+    void filterField(TransformFFT<Real> &fft, const SourceField& inputField, qint32 outputIndex);
+    template <typename Real>
+    void forwardFFTTile(qint32 tileX, qint32 tileY, qint32 startY, qint32 endY, const SourceField &inputField,
+                        Real *fftReal);
+    template <typename Real>
+    void inverseFFTTile(qint32 tileX, qint32 tileY, qint32 startY, qint32 endY, qint32 outputIndex,
+                        const Real *fftReal);
+    template <typename Real>
+    void applyFilter(const Real (*fftComplexIn)[2], Real (*fftComplexOut)[2]);
     void overlayFFTFrame(qint32 positionX, qint32 positionY,
                          const QVector<SourceField> &inputFields, qint32 fieldIndex,
                          ComponentFrame &componentFrame) override;
+    template <typename Real>
+    void overlayFFTTile(TransformFFT<Real> &fft, qint32 positionX, qint32 positionY,
+                        const QVector<SourceField> &inputFields, qint32 fieldIndex,
+                        ComponentFrame &componentFrame);
 
     // FFT input and output sizes.
     // The input field is divided into tiles of XTILE x YTILE, with adjacent
@@ -64,7 +76,7 @@ protected:
     static constexpr qint32 XTILE = 32;
     static constexpr qint32 HALFXTILE = XTILE / 2;
 
-    // Each tile is converted to the frequency domain using forwardPlan, which
+    // Each tile is converted to the frequency domain using a forward FFT, which
     // gives a complex result of size XCOMPLEX x YCOMPLEX (roughly half the
     // size of the input, because the input data was real, i.e. contained no
     // negative frequencies).
@@ -74,17 +86,13 @@ protected:
     // Window function applied before the FFT
     double windowFunction[YTILE][XTILE];
 
-    // FFT input/output buffers
-    double *fftReal;
-    fftw_complex *fftComplexIn;
-    fftw_complex *fftComplexOut;
-
-    // FFT plans
-    fftw_plan forwardPlan, inversePlan;
-
-    // The combined result of all the FFT processing for each input field.
-    // Inverse-FFT results are accumulated into these buffers.
-    QVector<QVector<double>> chromaBuf;
+    // FFT plans and buffers, in double and single precision. Only the one
+    // selected by the configuration is planned. Each batch holds a run of
+    // adjacent tiles from the same row.
+    TransformFFT<double> doubleFFT;
+#ifdef HAVE_FFTW3F
+    TransformFFT<float> floatFFT;
+#endif
 };
 
 #endif
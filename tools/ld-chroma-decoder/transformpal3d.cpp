@@ -68,26 +68,10 @@ TransformPal3D::TransformPal3D()
             }
         }
     }
-
-    // Allocate buffers for FFTW. These must be allocated using FFTW's own
-    // functions so they're properly aligned for SIMD operations.
-    fftReal = fftw_alloc_real(ZTILE * YTILE * XTILE);
-    fftComplexIn = fftw_alloc_complex(ZCOMPLEX * YCOMPLEX * XCOMPLEX);
-    fftComplexOut = fftw_alloc_complex(ZCOMPLEX * YCOMPLEX * XCOMPLEX);
-
-    // Plan FFTW operations
-    forwardPlan = fftw_plan_dft_r2c_3d(ZTILE, YTILE, XTILE, fftReal, fftComplexIn, FFTW_MEASURE);
-    inversePlan = fftw_plan_dft_c2r_3d(ZTILE, YTILE, XTILE, fftComplexOut, fftReal, FFTW_MEASURE);
 }
 
 TransformPal3D::~TransformPal3D()
 {
-    // Free FFTW plans and buffers
-    fftw_destroy_plan(forwardPlan);
-    fftw_destroy_plan(inversePlan);
-    fftw_free(fftReal);
-    fftw_free(fftComplexIn);
-    fftw_free(fftComplexOut);
 }
 
 qint32 TransformPal3D::getThresholdsSize()
@@ -96,6 +80,20 @@ qint32 TransformPal3D::getThresholdsSize()
     return ZCOMPLEX * YCOMPLEX * ((XCOMPLEX / 4) + 1);
 }
 
+void TransformPal3D::planFFTs()
+{
+    // Each batch can cover up to a whole row of tiles
+    const qint32 tilesPerRow = (videoParameters.activeVideoEnd - videoParameters.activeVideoStart + XTILE - 1) / HALFXTILE;
+
+#ifdef HAVE_FFTW3F
+    if (singlePrecision) {
+        floatFFT.plan({ZTILE, YTILE, XTILE}, tilesPerRow);
+        return;
+    }
+#endif
+    doubleFFT.plan({ZTILE, YTILE, XTILE}, tilesPerRow);
+}
+
 qint32 TransformPal3D::getLookBehind()
 {
     // We overlap at most half a tile (in frames) into the past...
@@ -125,36 +123,61 @@ void TransformPal3D::filterFields(const QVector<SourceField> &inputFields, qint3
     assert(startIndex >= HALFZTILE);
     assert((inputFields.size() - endIndex) >= HALFZTILE);
 
-    // Allocate and clear output buffers
-    chromaBuf.resize(endIndex - startIndex);
-    for (qint32 i = 0; i < chromaBuf.size(); i++) {
-        chromaBuf[i].resize(videoParameters.fieldWidth * videoParameters.fieldHeight);
-        chromaBuf[i].fill(0.0);
+    // Prepare output buffers
+    prepareChromaBuf(endIndex - startIndex, outputFields);
 
-        outputFields[i] = chromaBuf[i].data();
+#ifdef HAVE_FFTW3F
+    if (singlePrecision) {
+        filterTiles(floatFFT, inputFields, startIndex, endIndex);
+        return;
     }
+#endif
+    filterTiles(doubleFFT, inputFields, startIndex, endIndex);
+}
+
+// Process all the tiles covering fields startIndex to endIndex, writing the
+// result into chromaBuf
+template <typename Real>
+void TransformPal3D::filterTiles(TransformFFT<Real> &fft, const QVector<SourceField> &inputFields,
+                                 qint32 startIndex, qint32 endIndex)
+{
+    const qint32 batchSize = fft.getBatchSize();
 
     // Iterate through the overlapping tile positions, covering the active area.
     // (See TransformPal3D member variable documentation for how the tiling works;
     // if you change the Z tiling here, also review getLookBehind/getLookAhead above.)
     for (qint32 tileZ = startIndex - HALFZTILE; tileZ < endIndex; tileZ += HALFZTILE) {
         for (qint32 tileY = videoParameters.firstActiveFrameLine - HALFYTILE; tileY < videoParameters.lastActiveFrameLine; tileY += HALFYTILE) {
-            for (qint32 tileX = videoParameters.activeVideoStart - HALFXTILE; tileX < videoParameters.activeVideoEnd; tileX += HALFXTILE) {
-                // Compute the forward FFT
-                forwardFFTTile(tileX, tileY, tileZ, inputFields);
+            // Process the tiles along this row in batches
+            for (qint32 firstTileX = videoParameters.activeVideoStart - HALFXTILE; firstTileX < videoParameters.activeVideoEnd;
+                 firstTileX += batchSize * HALFXTILE) {
+                const qint32 numTiles = qMin(batchSize, (videoParameters.activeVideoEnd - firstTileX + HALFXTILE - 1) / HALFXTILE);
+
+                // Compute the forward FFTs
+                for (qint32 tile = 0, tileX = firstTileX; tile < numTiles; tile++, tileX += HALFXTILE) {
+                    forwardFFTTile(tileX, tileY, tileZ, inputFields, fft.real(tile));
+                }
+                fft.forward(numTiles);
 
                 // Apply the frequency-domain filter
-                applyFilter();
+                for (qint32 tile = 0; tile < numTiles; tile++) {
+                    applyFilter<Real>(fft.complexIn(tile), fft.complexOut(tile));
+                }
 
-                // Compute the inverse FFT
-                inverseFFTTile(tileX, tileY, tileZ, startIndex, endIndex);
+                // Compute the inverse FFTs
+                fft.inverse(numTiles);
+                for (qint32 tile = 0, tileX = firstTileX; tile < numTiles; tile++, tileX += HALFXTILE) {
+                    inverseFFTTile(tileX, tileY, tileZ, startIndex, endIndex, fft.real(tile));
+                }
             }
         }
     }
 }
 
-// Apply the forward FFT to an input tile, populating fftComplexIn
-void TransformPal3D::forwardFFTTile(qint32 tileX, qint32 tileY, qint32 tileZ, const QVector<SourceField> &inputFields)
+// Copy an input tile into fftReal, ready for the forward FFT
+template <typename Real>
+void TransformPal3D::forwardFFTTile(qint32 tileX, qint32 tileY, qint32 tileZ, const QVector<SourceField> &inputFields,
+                                    Real *fftReal)
 {
     // Work out which lines of this tile are within the active region
     const qint32 startY = qMax(videoParameters.firstActiveFrameLine - tileY, 0);
@@ -184,13 +207,12 @@ void TransformPal3D::forwardFFTTile(qint32 tileX, qint32 tileY, qint32 tileZ, co
             }
         }
     }
-
-    // Convert time domain in fftReal to frequency domain in fftComplexIn
-    fftw_execute(forwardPlan);
 }
 
-// Apply the inverse FFT to fftComplexOut, overlaying the result into chromaBuf
-void TransformPal3D::inverseFFTTile(qint32 tileX, qint32 tileY, qint32 tileZ, qint32 startIndex, qint32 endIndex)
+// Overlay the result of the inverse FFT in fftReal into chromaBuf
+template <typename Real>
+void TransformPal3D::inverseFFTTile(qint32 tileX, qint32 tileY, qint32 tileZ, qint32 startIndex, qint32 endIndex,
+                                    const Real *fftReal)
 {
     // Work out what portion of this tile is inside the active area
     const qint32 startX = qMax(videoParameters.activeVideoStart - tileX, 0);
@@ -200,9 +222,6 @@ void TransformPal3D::inverseFFTTile(qint32 tileX, qint32 tileY, qint32 tileZ, qi
     const qint32 startZ = qMax(startIndex - tileZ, 0);
     const qint32 endZ = qMin(endIndex - tileZ, ZTILE);
 
-    // Convert frequency domain in fftComplexOut back to time domain in fftReal
-    fftw_execute(inversePlan);
-
     // Overlay the result, normalising the FFTW output, into the chroma buffers
     for (qint32 z = startZ; z < endZ; z++) {
         const qint32 outputIndex = tileZ + z - startIndex;
@@ -223,14 +242,16 @@ void TransformPal3D::inverseFFTTile(qint32 tileX, qint32 tileY, qint32 tileZ, qi
     }
 }
 
-// Return the absolute value squared of an fftw_complex
-static inline double fftwAbsSq(const fftw_complex &value)
+// Return the absolute value squared of an fftw_complex or fftwf_complex
+template <typename Real>
+static inline Real fftwAbsSq(const Real (&value)[2])
 {
     return (value[0] * value[0]) + (value[1] * value[1]);
 }
 
-// Apply the frequency-domain filter.
-void TransformPal3D::applyFilter()
+// Apply the frequency-domain filter, from fftComplexIn to fftComplexOut.
+template <typename Real>
+void TransformPal3D::applyFilter(const Real (*fftComplexIn)[2], Real (*fftComplexOut)[2])
 {
     // Get pointer to squared threshold values
     const double *thresholdsPtr = thresholds.data();
@@ -268,12 +289,12 @@ void TransformPal3D::applyFilter()
             const qint32 y_ref = ((YTILE / 4) + YTILE - y) % YTILE;
 
             // Input data for this line and its reflection
-            const fftw_complex *bi = fftComplexIn + (((z * YCOMPLEX) + y) * XCOMPLEX);
-            const fftw_complex *bi_ref = fftComplexIn + (((z_ref * YCOMPLEX) + y_ref) * XCOMPLEX);
+            const Real (*bi)[2] = fftComplexIn + (((z * YCOMPLEX) + y) * XCOMPLEX);
+            const Real (*bi_ref)[2] = fftComplexIn + (((z_ref * YCOMPLEX) + y_ref) * XCOMPLEX);
 
             // Output data for this line and its reflection
-            fftw_complex *bo = fftComplexOut + (((z * YCOMPLEX) + y) * XCOMPLEX);
-            fftw_complex *bo_ref = fftComplexOut + (((z_ref * YCOMPLEX) + y_ref) * XCOMPLEX);
+            Real (*bo)[2] = fftComplexOut + (((z * YCOMPLEX) + y) * XCOMPLEX);
+            Real (*bo_ref)[2] = fftComplexOut + (((z_ref * YCOMPLEX) + y_ref) * XCOMPLEX);
 
             // We only need to look at horizontal frequencies that might be chroma (0.5fSC to 1.5fSC).
             for (qint32 x = XTILE / 8; x <= XTILE / 4; x++) {
@@ -283,8 +304,8 @@ void TransformPal3D::applyFilter()
                 // Get the threshold for this bin
                 const double threshold_sq = *thresholdsPtr++;
 
-                const fftw_complex &in_val = bi[x];
-                const fftw_complex &ref_val = bi_ref[x_ref];
+                const Real (&in_val)[2] = bi[x];
+                const Real (&ref_val)[2] = bi_ref[x_ref];
 
                 if (x == x_ref && y == y_ref && z == z_ref) {
                     // This bin is its own reflection (i.e. it's a carrier). Keep it!
@@ -294,8 +315,8 @@ void TransformPal3D::applyFilter()
                 }
 
                 // Get the squares of the magnitudes (to minimise the number of sqrts)
-                const double m_in_sq = fftwAbsSq(in_val);
-                const double m_ref_sq = fftwAbsSq(ref_val);
+                const double m_in_sq = fftwAbsSq<Real>(in_val);
+                const double m_ref_sq = fftwAbsSq<Real>(ref_val);
 
                 // Compare the magnitudes of the two values, and discard
                 // both if they are more different than the threshold for
@@ -319,6 +340,20 @@ void TransformPal3D::applyFilter()
 void TransformPal3D::overlayFFTFrame(qint32 positionX, qint32 positionY,
                                      const QVector<SourceField> &inputFields, qint32 fieldIndex,
                                      ComponentFrame &componentFrame)
+{
+#ifdef HAVE_FFTW3F
+    if (singlePrecision) {
+        overlayFFTTile(floatFFT, positionX, positionY, inputFields, fieldIndex, componentFrame);
+        return;
+    }
+#endif
+    overlayFFTTile(doubleFFT, positionX, positionY, inputFields, fieldIndex, componentFrame);
+}
+
+template <typename Real>
+void TransformPal3D::overlayFFTTile(TransformFFT<Real> &fft, qint32 positionX, qint32 positionY,
+                                    const QVector<SourceField> &inputFields, qint32 fieldIndex,
+                                    ComponentFrame &componentFrame)
 {
     // Do nothing if the tile isn't within the frame
     if (positionX < 0 || positionX + XTILE > videoParameters.fieldWidth
@@ -326,11 +361,12 @@ void TransformPal3D::overlayFFTFrame(qint32 positionX, qint32 positionY,
         return;
     }
 
-    // Compute the forward FFT
-    forwardFFTTile(positionX, positionY, fieldIndex, inputFields);
+    // Compute the forward FFT, using the first tile in the batch
+    forwardFFTTile(positionX, positionY, fieldIndex, inputFields, fft.real(0));
+    fft.forward(1);
 
     // Apply the frequency-domain filter
-    applyFilter();
+    applyFilter<Real>(fft.complexIn(0), fft.complexOut(0));
 
     // Create a canvas
     FrameCanvas canvas(componentFrame, videoParameters);
@@ -340,5 +376,5 @@ void TransformPal3D::overlayFFTFrame(qint32 positionX, qint32 positionY,
     canvas.drawRectangle(positionX - 1, positionY - 1, XTILE + 1, YTILE + 1, green);
 
     // Draw the arrays
-    overlayFFTArrays(fftComplexIn, fftComplexOut, canvas);
+    overlayFFTArrays<Real>(fft.complexIn(0), fft.complexOut(0), canvas);
 }
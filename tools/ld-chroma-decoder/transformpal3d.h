@@ -34,6 +34,7 @@
 #include "componentframe.h"
 #include "outputwriter.h"
 #include "sourcefield.h"
+#include "transformfft.h"
 #include "transformpal.h"
 
 class TransformPal3D : public TransformPal {
@@ -53,12 +54,25 @@ public:
                       QVector<const double *> &outputFields) override;
 
 protected:
-    void forwardFFTTile(qint32 tileX, qint32 tileY, qint32 tileZ, const QVector<SourceField> &inputFields);
-    void inverseFFTTile(qint32 tileX, qint32 tileY, qint32 tileZ, qint32 startFieldIndex, qint32 endFieldIndex);
-    void applyFilter();
+    void planFFTs() override;
+    template <typename Real>
+    void filterTiles(TransformFFT<Real> &fft, const QVector<SourceField> &inputFields,
+                     qint32 startIndex, qint32 endIndex);
+    template <typename Real>
+    void forwardFFTTile(qint32 tileX, qint32 tileY, qint32 tileZ, const QVector<SourceField> &inputFields,
+                        Real *fftReal);
+    template <typename Real>
+    void inverseFFTTile(qint32 tileX, qint32 tileY, qint32 tileZ, qint32 startFieldIndex, qint32 endFieldIndex,
+                        const Real *fftReal);
+    template <typename Real>
+    void applyFilter(const Real (*fftComplexIn)[2], Real (*fftComplexOut)[2]);
     void overlayFFTFrame(qint32 positionX, qint32 positionY,
                          const QVector<SourceField> &inputFields, qint32 fieldIndex,
                          ComponentFrame &componentFrame) override;
+    template <typename Real>
+    void overlayFFTTile(TransformFFT<Real> &fft, qint32 positionX, qint32 positionY,
+                        const QVector<SourceField> &inputFields, qint32 fieldIndex,
+                        ComponentFrame &componentFrame);
 
     // FFT input and output sizes.
     //
@@ -76,7 +90,7 @@ protected:
     static constexpr qint32 XTILE = 16;
     static constexpr qint32 HALFXTILE = XTILE / 2;
 
-    // Each tile is converted to the frequency domain using forwardPlan, which
+    // Each tile is converted to the frequency domain using a forward FFT, which
     // gives a complex result of size XCOMPLEX x YCOMPLEX x ZCOMPLEX (roughly
     // half the size of the input, because the input data was real, i.e.
     // contained no negative frequencies).
@@ -87,17 +101,13 @@ protected:
     // Window function applied before the FFT
     double windowFunction[ZTILE][YTILE][XTILE];
 
-    // FFT input/output buffers
-    double *fftReal;
-    fftw_complex *fftComplexIn;
-    fftw_complex *fftComplexOut;
-
-    // FFT plans
-    fftw_plan forwardPlan, inversePlan;
-
-    // The combined result of all the FFT processing for each input field.
-    // Inverse-FFT results are accumulated into these buffers.
-    QVector<QVector<double>> chromaBuf;
+    // FFT plans and buffers, in double and single precision. Only the one
+    // selected by the configuration is planned. Each batch holds a run of
+    // adjacent tiles from the same row.
+    TransformFFT<double> doubleFFT;
+#ifdef HAVE_FFTW3F
+    TransformFFT<float> floatFFT;
+#endif
 };
 
 #endif
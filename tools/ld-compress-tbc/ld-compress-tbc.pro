@@ -0,0 +1,57 @@
+QT -= gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+# You can make your code fail to compile if it uses deprecated APIs.
+# In order to do so, uncomment the following line.
+#DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
+
+SOURCES += \
+    ../library/tbc/binarymetadata.cpp \
+    ../library/tbc/compressedtbc.cpp \
+    ../library/tbc/dropouts.cpp \
+    ../library/tbc/fieldcache.cpp \
+    ../library/tbc/fieldstore.cpp \
+    ../library/tbc/jsonio.cpp \
+    ../library/tbc/lddecodemetadata.cpp \
+    ../library/tbc/logging.cpp \
+    ../library/tbc/parallelfor.cpp \
+    ../library/tbc/sourcevideo.cpp \
+    ../library/tbc/tbcparts.cpp \
+    ../library/tbc/vbidecoder.cpp \
+    main.cpp
+
+HEADERS += \
+    ../library/tbc/binarymetadata.h \
+    ../library/tbc/compressedtbc.h \
+    ../library/tbc/dropouts.h \
+    ../library/tbc/fieldcache.h \
+    ../library/tbc/fieldstore.h \
+    ../library/tbc/jsonio.h \
+    ../library/tbc/lddecodemetadata.h \
+    ../library/tbc/logging.h \
+    ../library/tbc/parallelfor.h \
+    ../library/tbc/sourcevideo.h \
+    ../library/tbc/tbcparts.h \
+    ../library/tbc/vbidecoder.h
+
+# Add external includes to the include path
+INCLUDEPATH += ../library/tbc
+
+# Include git information definitions
+isEmpty(BRANCH) {
+    BRANCH = "unknown"
+}
+isEmpty(COMMIT) {
+    COMMIT = "unknown"
+}
+DEFINES += APP_BRANCH=\"\\\"$${BRANCH}\\\"\" \
+    APP_COMMIT=\"\\\"$${COMMIT}\\\"\"
+
+# Rules for installation
+isEmpty(PREFIX) {
+    PREFIX = /usr/local
+}
+unix:!android: target.path = $$PREFIX/bin/
+!isEmpty(target.path): INSTALLS += target
@@ -0,0 +1,240 @@
+/************************************************************************
+
+    main.cpp
+
+    ld-compress-tbc - Lossless TBC compression
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-compress-tbc is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QtGlobal>
+#include <QCommandLineParser>
+#include <QThread>
+#include <QFile>
+#include <QFileInfo>
+
+#include "logging.h"
+#include "lddecodemetadata.h"
+#include "compressedtbc.h"
+#include "sourcevideo.h"
+
+// Number of fields to read and write at a time
+static constexpr qint32 BATCH_SIZE = 64;
+
+int main(int argc, char *argv[])
+{
+    // Install the local debug message handler
+    setDebug(true);
+    qInstallMessageHandler(debugOutputHandler);
+
+    QCoreApplication a(argc, argv);
+
+    // Set application name and version
+    QCoreApplication::setApplicationName("ld-compress-tbc");
+    QCoreApplication::setApplicationVersion(QString("Branch: %1 / Commit: %2").arg(APP_BRANCH, APP_COMMIT));
+    QCoreApplication::setOrganizationDomain("domesday86.com");
+
+    // Set up the command line parser ---------------------------------------------------------------------------------
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+                "ld-compress-tbc - Lossless TBC compression\n"
+                "\n"
+                "Compressed TBC files can be read directly by the other ld-decode-tools.\n"
+                "\n"
+                "(c)2026 ld-decode-tools contributors\n"
+                "GPLv3 Open-Source - github: https://github.com/happycube/ld-decode");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    // Add the standard debug options --debug and --quiet
+    addStandardDebugOptions(parser);
+
+    // Option to specify a different JSON input file
+    QCommandLineOption inputJsonOption(QStringList() << "input-json",
+                                       QCoreApplication::translate("main", "Specify the input JSON file (default input.json)"),
+                                       QCoreApplication::translate("main", "filename"));
+    parser.addOption(inputJsonOption);
+
+    // Option to decompress rather than compress (-d)
+    QCommandLineOption decompressOption(QStringList() << "d" << "decompress",
+                                        QCoreApplication::translate("main", "Decompress a compressed TBC file"));
+    parser.addOption(decompressOption);
+
+    // Option to select the number of threads (-t)
+    QCommandLineOption threadsOption(QStringList() << "t" << "threads",
+                                        QCoreApplication::translate("main", "Specify the number of concurrent threads (default is the number of logical CPUs)"),
+                                        QCoreApplication::translate("main", "number"));
+    parser.addOption(threadsOption);
+
+    // Positional arguments to specify input and output TBC files
+    parser.addPositionalArgument("input", QCoreApplication::translate("main", "Specify input TBC file"));
+    parser.addPositionalArgument("output", QCoreApplication::translate("main", "Specify output TBC file"));
+
+    // Process the command line options and arguments given by the user
+    parser.process(a);
+
+    // Standard logging options
+    processStandardDebugOptions(parser);
+
+    // Get the options from the parser
+    bool decompress = parser.isSet(decompressOption);
+
+    qint32 maxThreads = QThread::idealThreadCount();
+    if (parser.isSet(threadsOption)) {
+        maxThreads = parser.value(threadsOption).toInt();
+
+        if (maxThreads < 1) {
+            // Quit with error
+            qCritical("Specified number of threads must be greater than zero");
+            return -1;
+        }
+    }
+
+    // Get the arguments from the parser
+    QString inputFilename;
+    QString outputFilename;
+    QStringList positionalArguments = parser.positionalArguments();
+    if (positionalArguments.count() == 2) {
+        inputFilename = positionalArguments.at(0);
+        outputFilename = positionalArguments.at(1);
+    } else {
+        // Quit with error
+        qCritical("You must specify the input and output TBC files");
+        return -1;
+    }
+
+    if (inputFilename == outputFilename) {
+        // Quit with error
+        qCritical("Input and output files cannot be the same");
+        return -1;
+    }
+
+    // Work out the metadata filenames
+    QString inputJsonFilename = inputFilename + ".json";
+    if (parser.isSet(inputJsonOption)) {
+        inputJsonFilename = parser.value(inputJsonOption);
+    }
+    QString outputJsonFilename = outputFilename + ".json";
+
+    // Open the source video metadata
+    LdDecodeMetaData metaData;
+    qInfo().nospace().noquote() << "Reading JSON metadata from " << inputJsonFilename;
+    if (!metaData.read(inputJsonFilename)) {
+        qCritical() << "Unable to open TBC JSON metadata file";
+        return 1;
+    }
+    const LdDecodeMetaData::VideoParameters &videoParameters = metaData.getVideoParameters();
+    const qint32 fieldWidth = videoParameters.fieldWidth;
+    const qint32 fieldHeight = videoParameters.fieldHeight;
+
+    // Check the input is in the form we expect
+    QFile inputFile(inputFilename);
+    if (!inputFile.open(QIODevice::ReadOnly)) {
+        qCritical() << "Unable to open input TBC file";
+        return 1;
+    }
+    const bool inputCompressed = CompressedTbc::isCompressed(inputFile.read(CompressedTbc::HEADER_SIZE));
+    inputFile.close();
+    if (decompress && !inputCompressed) {
+        qCritical() << "Input TBC file is not compressed";
+        return 1;
+    }
+    if (!decompress && inputCompressed) {
+        qCritical() << "Input TBC file is already compressed";
+        return 1;
+    }
+
+    // Open the input (SourceVideo decodes compressed files itself)
+    SourceVideo sourceVideo;
+    if (!sourceVideo.open(inputFilename, fieldWidth * fieldHeight, fieldWidth)) {
+        qCritical() << "Unable to open input TBC file";
+        return 1;
+    }
+    const qint32 numberOfFields = sourceVideo.getNumberOfAvailableFields();
+
+    // Open the output
+    CompressedTbcWriter compressedWriter;
+    QFile outputFile(outputFilename);
+    if (decompress) {
+        if (!outputFile.open(QIODevice::WriteOnly)) {
+            qCritical() << "Unable to open output TBC file";
+            return 1;
+        }
+    } else {
+        if (!compressedWriter.open(outputFilename, fieldWidth, fieldHeight, maxThreads)) {
+            qCritical() << "Unable to open output TBC file";
+            return 1;
+        }
+    }
+
+    // Copy the fields
+    qInfo().nospace() << (decompress ? "Decompressing " : "Compressing ") << numberOfFields << " fields...";
+    SourceVideo::Data fields;
+    for (qint32 firstField = 1; firstField <= numberOfFields; firstField += BATCH_SIZE) {
+        const qint32 count = qMin(BATCH_SIZE, numberOfFields - firstField + 1);
+        sourceVideo.getVideoFields(firstField, count, fields);
+
+        bool success;
+        if (decompress) {
+            const qint64 length = fields.size() * static_cast<qint64>(sizeof(quint16));
+            success = outputFile.write(reinterpret_cast<const char *>(fields.constData()), length) == length;
+        } else {
+            success = compressedWriter.writeFields(fields.constData(), count);
+        }
+        if (!success) {
+            qCritical() << "Writing to the output TBC file failed";
+            return 1;
+        }
+
+        if ((firstField - 1) % (BATCH_SIZE * 16) == 0) {
+            qInfo().nospace() << "Processed " << firstField - 1 << " of " << numberOfFields << " fields";
+        }
+    }
+
+    sourceVideo.close();
+    if (decompress) {
+        outputFile.close();
+    } else {
+        if (!compressedWriter.close()) {
+            qCritical() << "Writing to the output TBC file failed";
+            return 1;
+        }
+        qInfo().nospace() << "Compressed to " << QFile(outputFilename).size() << " bytes ("
+                          << (100.0 * QFile(outputFilename).size()) / QFile(inputFilename).size() << "% of input size)";
+    }
+
+    // Write the output metadata, replacing any left from an earlier run so it
+    // matches the TBC file just written (unless the input metadata is already
+    // the output's)
+    if (QFileInfo(inputJsonFilename).canonicalFilePath() != QFileInfo(outputJsonFilename).canonicalFilePath()) {
+        qInfo().nospace().noquote() << "Copying JSON metadata to " << outputJsonFilename;
+        if (QFile::exists(outputJsonFilename) && !QFile::remove(outputJsonFilename)) {
+            qCritical() << "Unable to replace existing output JSON metadata file";
+            return 1;
+        }
+        if (!QFile::copy(inputJsonFilename, outputJsonFilename)) {
+            qCritical() << "Unable to copy JSON metadata file";
+            return 1;
+        }
+    }
+
+    // Quit with success
+    return 0;
+}
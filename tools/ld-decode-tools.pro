@@ -5,6 +5,10 @@ SUBDIRS = \
     ld-analyse \
     ld-chroma-decoder \
     ld-chroma-decoder/encoder \
+    ld-chroma-decoder/testcomb \
+    ld-chroma-decoder/testcombkernels \
+    ld-chroma-decoder/testtransformpal \
+    ld-compress-tbc \
     ld-discmap \
     ld-dropout-correct \
     ld-export-metadata \
@@ -14,6 +18,10 @@ SUBDIRS = \
     ld-disc-stacker \
     ld-process-vits \
     library/filter/testfilter \
+    library/tbc/benchjsonreader \
+    library/tbc/testcompressedtbc \
+    library/tbc/testfieldcache \
     library/tbc/testlinenumber \
     library/tbc/testmetadata \
+    library/tbc/testsourcevideo \
     library/tbc/testvbidecoder
@@ -32,6 +32,7 @@
 
 #include "logging.h"
 #include "lddecodemetadata.h"
+#include "fieldcache.h"
 #include "sourcevideo.h"
 #include "stackingpool.h"
 
@@ -85,6 +86,20 @@ int main(int argc, char *argv[])
                                         QCoreApplication::translate("main", "number"));
     parser.addOption(threadsOption);
 
+    // Option to read fields ahead in the background (--prefetch)
+    QCommandLineOption prefetchOption(QStringList() << "prefetch",
+                                        QCoreApplication::translate(
+                                         "main", "Read this many fields ahead of each input in a background thread (default 0, disabled)"),
+                                        QCoreApplication::translate("main", "fields"));
+    parser.addOption(prefetchOption);
+
+    // Option to set the size of the field cache (--cache-mb)
+    QCommandLineOption cacheSizeOption(QStringList() << "cache-mb",
+                                        QCoreApplication::translate(
+                                         "main", "Maximum memory used to cache fields, shared by all inputs, in MiB (default 256)"),
+                                        QCoreApplication::translate("main", "size"));
+    parser.addOption(cacheSizeOption);
+
     // Option to disable differential dropout detection
     QCommandLineOption noDiffDodOption(QStringList() << "no-diffdod",
                                         QCoreApplication::translate(
@@ -128,6 +143,29 @@ int main(int argc, char *argv[])
         }
     }
 
+    qint32 prefetchWindow = 0;
+    if (parser.isSet(prefetchOption)) {
+        prefetchWindow = parser.value(prefetchOption).toInt();
+
+        if (prefetchWindow < 0) {
+            // Quit with error
+            qCritical("Specified prefetch window must not be negative");
+            return -1;
+        }
+    }
+
+    if (parser.isSet(cacheSizeOption)) {
+        const qint32 cacheSize = parser.value(cacheSizeOption).toInt();
+
+        if (cacheSize < 0) {
+            // Quit with error
+            qCritical("Specified cache size must not be negative");
+            return -1;
+        }
+
+        FieldCache::global().setByteLimit(static_cast<qint64>(cacheSize) * 1024 * 1024);
+    }
+
     // Require source and target filenames
     QVector<QString> inputFilenames;
     QString outputFilename = "-";
@@ -272,6 +310,7 @@ int main(int argc, char *argv[])
                     " - input filename is " << inputFilenames[i];
 
         // Open the source TBC
+        sourceVideos[i]->setPrefetchWindow(prefetchWindow);
         if (!sourceVideos[i]->open(inputFilenames[i], videoParameters.fieldWidth * videoParameters.fieldHeight)) {
             // Could not open source video file
             qInfo() << "Unable to open input source" << i;
@@ -316,6 +355,17 @@ int main(int argc, char *argv[])
                                 ldDecodeMetaData, sourceVideos, reverse, noDiffDod, passThrough);
     if (!stackingPool.process()) result = 1;
 
+    // Report on the field cache
+    FieldCache::global().printStatistics();
+
+    // Report on background prefetching
+    if (prefetchWindow > 0) {
+        for (qint32 i = 0; i < totalNumberOfInputFiles; i++) {
+            qInfo().nospace() << "Prefetch for input #" << i << ": " << sourceVideos[i]->getPrefetchHits() << " hits, " <<
+                                 sourceVideos[i]->getPrefetchMisses() << " misses";
+        }
+    }
+
     // Close open source video files
     for (qint32 i = 0; i < totalNumberOfInputFiles; i++) sourceVideos[i]->close();
 
@@ -36,8 +36,8 @@ void Stacker::run()
     qint32 frameNumber;
     QVector<qint32> firstFieldSeqNo;
     QVector<qint32> secondFieldSeqNo;
-    QVector<SourceVideo::Data> firstSourceField;
-    QVector<SourceVideo::Data> secondSourceField;
+    QVector<SourceVideo::View> firstSourceField;
+    QVector<SourceVideo::View> secondSourceField;
     QVector<LdDecodeMetaData::Field> firstFieldMetadata;
     QVector<LdDecodeMetaData::Field> secondFieldMetadata;
     bool reverse;
@@ -72,7 +72,7 @@ void Stacker::run()
 }
 
 // Method to stack fields
-void Stacker::stackField(qint32 frameNumber, QVector<SourceVideo::Data> inputFields,
+void Stacker::stackField(qint32 frameNumber, const QVector<SourceVideo::View> &inputFields,
                                       LdDecodeMetaData::VideoParameters videoParameters,
                                       QVector<LdDecodeMetaData::Field> fieldMetadata,
                                       QVector<qint32> availableSourcesForFrame,
@@ -84,14 +84,27 @@ void Stacker::stackField(qint32 frameNumber, QVector<SourceVideo::Data> inputFie
     bool forceDropout = false;
 
     if (availableSourcesForFrame.size() > 0) {
+        // Index each source's dropouts by line
+        QVector<DropOutIndex> dropOutIndexes(availableSourcesForFrame.size());
+        for (qint32 i = 0; i < availableSourcesForFrame.size(); i++) {
+            dropOutIndexes[i] = DropOutIndex(fieldMetadata[availableSourcesForFrame[i]].dropOuts,
+                                             videoParameters.fieldHeight);
+        }
+        QVector<QVector<bool>> isDropout(availableSourcesForFrame.size(), QVector<bool>(videoParameters.fieldWidth));
+
         // Sources available - process field
         for (qint32 y = 0; y < videoParameters.fieldHeight; y++) {
+            // Find which pixels of this line are dropouts in each source
+            for (qint32 i = 0; i < availableSourcesForFrame.size(); i++) {
+                dropOutIndexes[i].getLineMask(y + 1, isDropout[i]);
+            }
+
             for (qint32 x = videoParameters.colourBurstStart; x < videoParameters.fieldWidth; x++) {
                 // Get input values from the input sources (which are not marked as dropouts)
                 QVector<quint16> inputValues;
                 for (qint32 i = 0; i < availableSourcesForFrame.size(); i++) {
                     // Include the source's pixel data if it's not marked as a dropout
-                    if (!isDropout(fieldMetadata[availableSourcesForFrame[i]].dropOuts, x, y)) {
+                    if (!isDropout[i][x]) {
                         // Pixel is valid
                         inputValues.append(inputFields[availableSourcesForFrame[i]][(videoParameters.fieldWidth * y) + x]);
                     }
@@ -198,19 +211,6 @@ quint16 Stacker::median(QVector<quint16> elements)
     }
 }
 
-// Method returns true if specified pixel is a dropout
-bool Stacker::isDropout(DropOuts dropOuts, qint32 fieldX, qint32 fieldY)
-{
-    for (qint32 i = 0; i < dropOuts.size(); i++) {
-        if ((dropOuts.fieldLine(i) - 1) == fieldY) {
-            if ((fieldX >= dropOuts.startx(i)) && (fieldX <= dropOuts.endx(i)))
-                return true;
-        }
-    }
-
-    return false;
-}
-
 // Use differential dropout detection to remove suspected dropout error
 // values from inputValues to produce the set of output values.  This generally improves everything, but
 // might cause an increase in errors for really noisy frames (where the DOs are in the same place in
@@ -51,11 +51,10 @@ private:
     StackingPool& stackingPool;
     QVector<LdDecodeMetaData::VideoParameters> videoParameters;
 
-    void stackField(qint32 frameNumber, QVector<SourceVideo::Data> inputFields, LdDecodeMetaData::VideoParameters videoParameters,
+    void stackField(qint32 frameNumber, const QVector<SourceVideo::View> &inputFields, LdDecodeMetaData::VideoParameters videoParameters,
                     QVector<LdDecodeMetaData::Field> fieldMetadata, QVector<qint32> availableSourcesForFrame, bool noDiffDod, bool passThrough,
                     SourceVideo::Data &outputField, DropOuts &dropOuts);
     quint16 median(QVector<quint16> v);
-    bool isDropout(DropOuts dropOuts, qint32 fieldX, qint32 fieldY);
     QVector<quint16> diffDod(QVector<quint16> inputValues, LdDecodeMetaData::VideoParameters videoParameters, qint32 xPos);
 };
 
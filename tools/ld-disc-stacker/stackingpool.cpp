@@ -124,8 +124,8 @@ bool StackingPool::process()
 // Returns true if a frame was returned, false if the end of the input has been
 // reached.
 bool StackingPool::getInputFrame(qint32& frameNumber,
-                                  QVector<qint32>& firstFieldNumber, QVector<SourceVideo::Data>& firstFieldVideoData, QVector<LdDecodeMetaData::Field>& firstFieldMetadata,
-                                  QVector<qint32>& secondFieldNumber, QVector<SourceVideo::Data>& secondFieldVideoData, QVector<LdDecodeMetaData::Field>& secondFieldMetadata,
+                                  QVector<qint32>& firstFieldNumber, QVector<SourceVideo::View>& firstFieldVideoData, QVector<LdDecodeMetaData::Field>& firstFieldMetadata,
+                                  QVector<qint32>& secondFieldNumber, QVector<SourceVideo::View>& secondFieldVideoData, QVector<LdDecodeMetaData::Field>& secondFieldMetadata,
                                   QVector<LdDecodeMetaData::VideoParameters>& videoParameters,
                                   bool& _reverse, bool& _noDiffDod, bool& _passThrough,
                                   QVector<qint32>& availableSourcesForFrame)
@@ -196,11 +196,11 @@ bool StackingPool::getInputFrame(qint32& frameNumber,
         if (firstFieldNumber[sourceNo] != -1 && secondFieldNumber[sourceNo] != -1) {
             // Fetch the input data (get the fields in TBC sequence order to save seeking)
             if (firstFieldNumber[sourceNo] < secondFieldNumber[sourceNo]) {
-                firstFieldVideoData[sourceNo] = sourceVideos[sourceNo]->getVideoField(firstFieldNumber[sourceNo]);
-                secondFieldVideoData[sourceNo] = sourceVideos[sourceNo]->getVideoField(secondFieldNumber[sourceNo]);
+                firstFieldVideoData[sourceNo] = sourceVideos[sourceNo]->getVideoFieldView(firstFieldNumber[sourceNo]);
+                secondFieldVideoData[sourceNo] = sourceVideos[sourceNo]->getVideoFieldView(secondFieldNumber[sourceNo]);
             } else {
-                secondFieldVideoData[sourceNo] = sourceVideos[sourceNo]->getVideoField(secondFieldNumber[sourceNo]);
-                firstFieldVideoData[sourceNo] = sourceVideos[sourceNo]->getVideoField(firstFieldNumber[sourceNo]);
+                secondFieldVideoData[sourceNo] = sourceVideos[sourceNo]->getVideoFieldView(secondFieldNumber[sourceNo]);
+                firstFieldVideoData[sourceNo] = sourceVideos[sourceNo]->getVideoFieldView(firstFieldNumber[sourceNo]);
             }
 
             firstFieldMetadata[sourceNo] = ldDecodeMetaData[sourceNo]->getField(firstFieldNumber[sourceNo]);
@@ -313,7 +313,6 @@ bool StackingPool::setMinAndMaxVbiFrames()
 
     for (qint32 sourceNumber = 0; sourceNumber < numberOfSources; sourceNumber++) {
         // Determine the disc type and max/min VBI frame numbers
-        VbiDecoder vbiDecoder;
         qint32 cavCount = 0;
         qint32 clvCount = 0;
         qint32 cavMin = 1000000;
@@ -327,10 +326,8 @@ bool StackingPool::setMinAndMaxVbiFrames()
 
         // Using sequential frame numbering starting from 1
         for (qint32 seqFrame = 1; seqFrame <= ldDecodeMetaData[sourceNumber]->getNumberOfFrames(); seqFrame++) {
-            // Get the VBI data and then decode
-            auto vbi1 = ldDecodeMetaData[sourceNumber]->getFieldVbi(ldDecodeMetaData[sourceNumber]->getFirstFieldNumber(seqFrame)).vbiData;
-            auto vbi2 = ldDecodeMetaData[sourceNumber]->getFieldVbi(ldDecodeMetaData[sourceNumber]->getSecondFieldNumber(seqFrame)).vbiData;
-            VbiDecoder::Vbi vbi = vbiDecoder.decodeFrame(vbi1[0], vbi1[1], vbi1[2], vbi2[0], vbi2[1], vbi2[2]);
+            // Get the decoded VBI data
+            const LdDecodeMetaData::FrameVbi vbi = ldDecodeMetaData[sourceNumber]->getFrameVbi(seqFrame);
 
             // Look for a complete, valid CAV picture number or CLV time-code
             if (vbi.picNo > 0) {
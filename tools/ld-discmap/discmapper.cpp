@@ -658,7 +658,7 @@ bool DiscMapper::saveDiscMap(DiscMap &discMap)
 
     if (!noAudio) {
         // Open the input audio file
-        if (!sourceAudio.open(inputFileInfo)) {
+        if (!sourceAudio.open(inputFileInfo, true)) {
             // Could not open input audio file
             qInfo() << "Cannot open source audio file:" << inputFileInfo.absolutePath() + "/" + inputFileInfo.completeBaseName() + ".pcm";
             sourceVideo.close();
@@ -694,8 +694,7 @@ bool DiscMapper::saveDiscMap(DiscMap &discMap)
     // Create the output video file
     SourceVideo::Data sourceFirstField;
     SourceVideo::Data sourceSecondField;
-    SourceAudio::Data sourceAudioFirstField;
-    SourceAudio::Data sourceAudioSecondField;
+    SourceAudio::Data sourceAudioFrame;
 
     qInfo() << "Saving target video frames...";
     qint32 notifyInterval = discMap.numberOfFrames() / 50;
@@ -732,17 +731,15 @@ bool DiscMapper::saveDiscMap(DiscMap &discMap)
                 // Ensure there is audio to read from the first and second fields
                 if ((discMap.getFirstFieldAudioDataLength(frameNumber) > 0) &&
                         (discMap.getSecondFieldAudioDataLength(frameNumber) > 0)) {
-                    // Read the audio
-                    sourceAudioFirstField = sourceAudio.getAudioData(discMap.getFirstFieldAudioDataStart(frameNumber),
-                                                                     discMap.getFirstFieldAudioDataLength(frameNumber));
-                    sourceAudioSecondField = sourceAudio.getAudioData(discMap.getSecondFieldAudioDataStart(frameNumber),
-                                                                      discMap.getSecondFieldAudioDataLength(frameNumber));
+                    // Read the audio for both fields
+                    sourceAudioFrame = sourceAudio.getAudioData({
+                        {discMap.getFirstFieldAudioDataStart(frameNumber), discMap.getFirstFieldAudioDataLength(frameNumber)},
+                        {discMap.getSecondFieldAudioDataStart(frameNumber), discMap.getSecondFieldAudioDataLength(frameNumber)},
+                    });
 
                     // Write the audio
-                    if (!targetAudio.write(reinterpret_cast<const char *>(sourceAudioFirstField.data()),
-                                           sourceAudioFirstField.size() * 2)) writeFail = true;
-                    if (!targetAudio.write(reinterpret_cast<const char *>(sourceAudioSecondField.data()),
-                                           sourceAudioSecondField.size() * 2)) writeFail = true;
+                    if (!targetAudio.write(reinterpret_cast<const char *>(sourceAudioFrame.data()),
+                                           sourceAudioFrame.size() * 2)) writeFail = true;
                 } else {
                     if (discMap.getFirstFieldAudioDataLength(frameNumber) < 1) {
                         qInfo() << "Warning: Input file seems to have zero audio data in the first field of frame number #" << frameNumber;
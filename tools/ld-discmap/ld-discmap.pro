@@ -15,12 +15,18 @@ DEFINES += QT_DEPRECATED_WARNINGS
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
+    ../library/tbc/binarymetadata.cpp \
+    ../library/tbc/compressedtbc.cpp \
     ../library/tbc/dropouts.cpp \
+    ../library/tbc/fieldcache.cpp \
+    ../library/tbc/fieldstore.cpp \
     ../library/tbc/jsonio.cpp \
     ../library/tbc/lddecodemetadata.cpp \
     ../library/tbc/logging.cpp \
+    ../library/tbc/parallelfor.cpp \
     ../library/tbc/sourceaudio.cpp \
     ../library/tbc/sourcevideo.cpp \
+    ../library/tbc/tbcparts.cpp \
     ../library/tbc/vbidecoder.cpp \
     discmap.cpp \
     discmapper.cpp \
@@ -28,12 +34,18 @@ SOURCES += \
     main.cpp
 
 HEADERS += \
+    ../library/tbc/binarymetadata.h \
+    ../library/tbc/compressedtbc.h \
     ../library/tbc/dropouts.h \
+    ../library/tbc/fieldcache.h \
+    ../library/tbc/fieldstore.h \
     ../library/tbc/jsonio.h \
     ../library/tbc/lddecodemetadata.h \
     ../library/tbc/logging.h \
+    ../library/tbc/parallelfor.h \
     ../library/tbc/sourceaudio.h \
     ../library/tbc/sourcevideo.h \
+    ../library/tbc/tbcparts.h \
     ../library/tbc/vbidecoder.h \
     discmap.h \
     discmapper.h \
@@ -28,6 +28,7 @@
 #include <QCommandLineParser>
 #include <QFileInfo>
 
+#include "binarymetadata.h"
 #include "logging.h"
 #include "discmapper.h"
 
@@ -143,9 +144,11 @@ int main(int argc, char *argv[])
         return -1;
     }
 
-    // Check that the required input TBC metadata file exists
+    // Check that the required input TBC metadata file exists (as JSON, or as
+    // binary metadata in its place)
     QFileInfo inputMetadataFileInfo(inputFileInfo.filePath() + ".json");
-    if (!inputMetadataFileInfo.exists()) {
+    if (!inputMetadataFileInfo.exists()
+        && BinaryMetadata::getSidecarFileName(inputMetadataFileInfo.filePath()).isEmpty()) {
         qCritical("The specified input file metadata does not exist");
         return -1;
     }
@@ -27,10 +27,11 @@
 
 CorrectorPool::CorrectorPool(QString _outputFilename, QString _outputJsonFilename,
                              qint32 _maxThreads, QVector<LdDecodeMetaData *> &_ldDecodeMetaData, QVector<SourceVideo *> &_sourceVideos,
-                             bool _reverse, bool _intraField, bool _overCorrect, QObject *parent)
+                             bool _reverse, bool _intraField, bool _overCorrect, QString _followJsonFilename,
+                             QObject *parent)
     : QObject(parent), outputFilename(_outputFilename), outputJsonFilename(_outputJsonFilename),
       maxThreads(_maxThreads), reverse(_reverse), intraField(_intraField), overCorrect(_overCorrect),
-      abort(false), ldDecodeMetaData(_ldDecodeMetaData), sourceVideos(_sourceVideos)
+      followJsonFilename(_followJsonFilename), abort(false), ldDecodeMetaData(_ldDecodeMetaData), sourceVideos(_sourceVideos)
 {
 }
 
@@ -80,7 +81,11 @@ bool CorrectorPool::process()
     }
 
     // Show some information for the user
-    qInfo() << "Using" << maxThreads << "threads to process" << ldDecodeMetaData[0]->getNumberOfFrames() << "frames";
+    if (followJsonFilename.isEmpty()) {
+        qInfo() << "Using" << maxThreads << "threads to process" << ldDecodeMetaData[0]->getNumberOfFrames() << "frames";
+    } else {
+        qInfo() << "Using" << maxThreads << "threads to process frames as the input is written";
+    }
 
     // Initialise reporting
     sameSourceConcealmentTotal = 0;
@@ -91,6 +96,7 @@ bool CorrectorPool::process()
     inputFrameNumber = 1;
     outputFrameNumber = 1;
     lastFrameNumber = ldDecodeMetaData[0]->getNumberOfFrames();
+    inputFinished = followJsonFilename.isEmpty();
     totalTimer.start();
 
     // Start a vector of decoding threads to process the video
@@ -133,14 +139,17 @@ bool CorrectorPool::process()
 // Returns true if a frame was returned, false if the end of the input has been
 // reached.
 bool CorrectorPool::getInputFrame(qint32& frameNumber,
-                                  QVector<qint32>& firstFieldNumber, QVector<SourceVideo::Data>& firstFieldVideoData, QVector<LdDecodeMetaData::Field>& firstFieldMetadata,
-                                  QVector<qint32>& secondFieldNumber, QVector<SourceVideo::Data>& secondFieldVideoData, QVector<LdDecodeMetaData::Field>& secondFieldMetadata,
+                                  QVector<qint32>& firstFieldNumber, QVector<SourceVideo::View>& firstFieldVideoData, QVector<LdDecodeMetaData::Field>& firstFieldMetadata,
+                                  QVector<qint32>& secondFieldNumber, QVector<SourceVideo::View>& secondFieldVideoData, QVector<LdDecodeMetaData::Field>& secondFieldMetadata,
                                   QVector<LdDecodeMetaData::VideoParameters>& videoParameters,
                                   bool& _reverse, bool& _intraField, bool& _overCorrect,
                                   QVector<qint32>& availableSourcesForFrame, QVector<qreal>& sourceFrameQuality)
 {
     QMutexLocker locker(&inputMutex);
 
+    // If the input is still being written, wait for the next frame
+    if (inputFrameNumber > lastFrameNumber && !inputFinished) followInput(inputFrameNumber);
+
     if (inputFrameNumber > lastFrameNumber) {
         // No more input frames
         return false;
@@ -210,11 +219,11 @@ bool CorrectorPool::getInputFrame(qint32& frameNumber,
         if (firstFieldNumber[sourceNo] != -1 && secondFieldNumber[sourceNo] != -1) {
             // Fetch the input data (get the fields in TBC sequence order to save seeking)
             if (firstFieldNumber[sourceNo] < secondFieldNumber[sourceNo]) {
-                firstFieldVideoData[sourceNo] = sourceVideos[sourceNo]->getVideoField(firstFieldNumber[sourceNo]);
-                secondFieldVideoData[sourceNo] = sourceVideos[sourceNo]->getVideoField(secondFieldNumber[sourceNo]);
+                firstFieldVideoData[sourceNo] = sourceVideos[sourceNo]->getVideoFieldView(firstFieldNumber[sourceNo]);
+                secondFieldVideoData[sourceNo] = sourceVideos[sourceNo]->getVideoFieldView(secondFieldNumber[sourceNo]);
             } else {
-                secondFieldVideoData[sourceNo] = sourceVideos[sourceNo]->getVideoField(secondFieldNumber[sourceNo]);
-                firstFieldVideoData[sourceNo] = sourceVideos[sourceNo]->getVideoField(firstFieldNumber[sourceNo]);
+                secondFieldVideoData[sourceNo] = sourceVideos[sourceNo]->getVideoFieldView(secondFieldNumber[sourceNo]);
+                firstFieldVideoData[sourceNo] = sourceVideos[sourceNo]->getVideoFieldView(firstFieldNumber[sourceNo]);
             }
 
             firstFieldMetadata[sourceNo] = ldDecodeMetaData[sourceNo]->getField(firstFieldNumber[sourceNo]);
@@ -239,6 +248,37 @@ bool CorrectorPool::getInputFrame(qint32& frameNumber,
     return true;
 }
 
+// Wait until the input metadata and TBC file both contain requiredFrameNumber,
+// or the input has stopped growing, and update lastFrameNumber to match. You
+// must hold inputMutex to call this.
+void CorrectorPool::followInput(qint32 requiredFrameNumber)
+{
+    // Count the frames in the metadata whose fields have both been written to
+    // the TBC file
+    auto getAvailableFrames = [&]() {
+        qint32 availableFrames = ldDecodeMetaData[0]->getNumberOfFrames();
+        const qint32 availableFields = sourceVideos[0]->getNumberOfAvailableFields();
+        while (availableFrames > 0
+               && qMax(ldDecodeMetaData[0]->getFirstFieldNumber(availableFrames),
+                       ldDecodeMetaData[0]->getSecondFieldNumber(availableFrames)) > availableFields) {
+            availableFrames--;
+        }
+        return availableFrames;
+    };
+
+    qint32 availableFrames = getAvailableFrames();
+    while (!inputFinished && availableFrames < requiredFrameNumber) {
+        // Wait for another field to be written, then read any new metadata.
+        // The JSON is written after the fields it describes, so read it once
+        // more after the TBC file stops growing.
+        if (!sourceVideos[0]->waitForFields(sourceVideos[0]->getNumberOfAvailableFields() + 1)) inputFinished = true;
+        ldDecodeMetaData[0]->refreshFields(followJsonFilename);
+        availableFrames = getAvailableFrames();
+    }
+
+    lastFrameNumber = qMax(availableFrames, inputFrameNumber - 1);
+}
+
 // Put a corrected frame into the output stream.
 //
 // The worker threads will complete frames in an arbitrary order, so we can't
@@ -343,7 +383,6 @@ bool CorrectorPool::setMinAndMaxVbiFrames()
 
     for (qint32 sourceNumber = 0; sourceNumber < numberOfSources; sourceNumber++) {
         // Determine the disc type and max/min VBI frame numbers
-        VbiDecoder vbiDecoder;
         qint32 cavCount = 0;
         qint32 clvCount = 0;
         qint32 cavMin = 1000000;
@@ -357,10 +396,8 @@ bool CorrectorPool::setMinAndMaxVbiFrames()
 
         // Using sequential frame numbering starting from 1
         for (qint32 seqFrame = 1; seqFrame <= ldDecodeMetaData[sourceNumber]->getNumberOfFrames(); seqFrame++) {
-            // Get the VBI data and then decode
-            auto vbi1 = ldDecodeMetaData[sourceNumber]->getFieldVbi(ldDecodeMetaData[sourceNumber]->getFirstFieldNumber(seqFrame)).vbiData;
-            auto vbi2 = ldDecodeMetaData[sourceNumber]->getFieldVbi(ldDecodeMetaData[sourceNumber]->getSecondFieldNumber(seqFrame)).vbiData;
-            VbiDecoder::Vbi vbi = vbiDecoder.decodeFrame(vbi1[0], vbi1[1], vbi1[2], vbi2[0], vbi2[1], vbi2[2]);
+            // Get the decoded VBI data
+            const LdDecodeMetaData::FrameVbi vbi = ldDecodeMetaData[sourceNumber]->getFrameVbi(seqFrame);
 
             // Look for a complete, valid CAV picture number or CLV time-code
             if (vbi.picNo > 0) {
@@ -42,14 +42,15 @@ class CorrectorPool : public QObject
 public:
     explicit CorrectorPool(QString _outputFilename, QString _outputJsonFilename,
                            qint32 _maxThreads, QVector<LdDecodeMetaData *> &_ldDecodeMetaData, QVector<SourceVideo *> &_sourceVideos,
-                           bool _reverse, bool _intraField, bool _overCorrect, QObject *parent = nullptr);
+                           bool _reverse, bool _intraField, bool _overCorrect, QString _followJsonFilename = QString(),
+                           QObject *parent = nullptr);
 
     bool process();
 
     // Member functions used by worker threads
     bool getInputFrame(qint32& frameNumber,
-                       QVector<qint32> &firstFieldNumber, QVector<SourceVideo::Data> &firstFieldVideoData, QVector<LdDecodeMetaData::Field> &firstFieldMetadata,
-                       QVector<qint32> &secondFieldNumber, QVector<SourceVideo::Data> &secondFieldVideoData, QVector<LdDecodeMetaData::Field> &secondFieldMetadata,
+                       QVector<qint32> &firstFieldNumber, QVector<SourceVideo::View> &firstFieldVideoData, QVector<LdDecodeMetaData::Field> &firstFieldMetadata,
+                       QVector<qint32> &secondFieldNumber, QVector<SourceVideo::View> &secondFieldVideoData, QVector<LdDecodeMetaData::Field> &secondFieldMetadata,
                        QVector<LdDecodeMetaData::VideoParameters> &videoParameters,
                        bool& _reverse, bool& _intraField, bool& _overCorrect, QVector<qint32> &availableSourcesForFrame, QVector<qreal> &sourceFrameQuality);
 
@@ -70,6 +71,7 @@ private:
     bool reverse;
     bool intraField;
     bool overCorrect;
+    QString followJsonFilename;
     QElapsedTimer totalTimer;
 
     // Atomic abort flag shared by worker threads; workers watch this, and shut
@@ -80,6 +82,7 @@ private:
     QMutex inputMutex;
     qint32 inputFrameNumber;
     qint32 lastFrameNumber;
+    bool inputFinished;
     QVector<LdDecodeMetaData *> &ldDecodeMetaData;
     QVector<SourceVideo *> &sourceVideos;
 
@@ -113,6 +116,7 @@ private:
     qint32 multiSourceConcealmentTotal;
     qint32 multiSourceCorrectionTotal;
 
+    void followInput(qint32 requiredFrameNumber);
     bool setMinAndMaxVbiFrames();
     qint32 convertSequentialFrameNumberToVbi(qint32 sequentialFrameNumber, qint32 sourceNumber);
     qint32 convertVbiFrameNumberToSequential(qint32 vbiFrameNumber, qint32 sourceNumber);
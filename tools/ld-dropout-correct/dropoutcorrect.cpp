@@ -38,8 +38,8 @@ void DropOutCorrect::run()
     qint32 frameNumber;
     QVector<qint32> firstFieldSeqNo;
     QVector<qint32> secondFieldSeqNo;
-    QVector<SourceVideo::Data> firstSourceField;
-    QVector<SourceVideo::Data> secondSourceField;
+    QVector<SourceVideo::View> firstSourceField;
+    QVector<SourceVideo::View> secondSourceField;
     QVector<LdDecodeMetaData::Field> firstFieldMetadata;
     QVector<LdDecodeMetaData::Field> secondFieldMetadata;
     bool reverse, intraField, overCorrect;
@@ -69,11 +69,13 @@ void DropOutCorrect::run()
         qDebug().nospace() << "DropOutCorrect::process(): Frame #" << frameNumber << " - There are " << totalAvailableSources << " sources available of which " <<
                               availableSourcesForFrame.size() << " contain the required frame";
 
-        // Copy the input frames' data to the target frames.
-        // We'll use these both as source and target during correction, which
-        // is OK because we're careful not to copy data from another dropout.
-        QVector<SourceVideo::Data> firstFieldData = firstSourceField;
-        QVector<SourceVideo::Data> secondFieldData = secondSourceField;
+        // Copy the first source's data to the target frames (the other
+        // sources are only read from, so they don't need copying).
+        // We'll use the target frames both as source and target during
+        // correction, which is OK because we're careful not to copy data from
+        // another dropout.
+        SourceVideo::Data firstFieldData = firstSourceField[0].toData();
+        SourceVideo::Data secondFieldData = secondSourceField[0].toData();
 
         // Check if the frame contains drop-outs
         if (firstFieldMetadata[0].dropOuts.empty() && secondFieldMetadata[0].dropOuts.empty()) {
@@ -103,25 +105,35 @@ void DropOutCorrect::run()
                     secondFieldDropouts[currentSource] = setDropOutLocations(populateDropoutsVector(secondFieldMetadata[currentSource], overCorrect));
             }
 
+            // Index the drop out locations by line, for finding replacement lines
+            QVector<DropOutIndex> firstFieldIndexes(totalAvailableSources);
+            QVector<DropOutIndex> secondFieldIndexes(totalAvailableSources);
+            for (qint32 i = 0; i < availableSourcesForFrame.size(); i++) {
+                qint32 currentSource = availableSourcesForFrame[i];
+                firstFieldIndexes[currentSource] = indexDropOutLocations(firstFieldDropouts[currentSource]);
+                secondFieldIndexes[currentSource] = indexDropOutLocations(secondFieldDropouts[currentSource]);
+            }
+
             // Correct the first field
-            correctField(firstFieldDropouts, secondFieldDropouts, firstFieldData, secondFieldData, true, intraField, availableSourcesForFrame, sourceFrameQuality,
-                         statistics);
+            correctField(firstFieldDropouts, firstFieldIndexes, secondFieldIndexes, firstFieldData, secondFieldData, firstSourceField, secondSourceField,
+                         true, intraField, availableSourcesForFrame, sourceFrameQuality, statistics);
 
             // Correct the second field
-            correctField(secondFieldDropouts, firstFieldDropouts, secondFieldData, firstFieldData, false, intraField, availableSourcesForFrame, sourceFrameQuality,
-                         statistics);
+            correctField(secondFieldDropouts, secondFieldIndexes, firstFieldIndexes, secondFieldData, firstFieldData, secondSourceField, firstSourceField,
+                         false, intraField, availableSourcesForFrame, sourceFrameQuality, statistics);
         }
 
         // Return the processed fields
-        correctorPool.setOutputFrame(frameNumber, firstFieldData[0], secondFieldData[0], firstFieldSeqNo[0], secondFieldSeqNo[0],
+        correctorPool.setOutputFrame(frameNumber, firstFieldData, secondFieldData, firstFieldSeqNo[0], secondFieldSeqNo[0],
                 statistics.sameSourceConcealment, statistics.multiSourceConcealment, statistics.multiSourceCorrection ,statistics.totalReplacementDistance);
     }
 }
 
 // Correct dropouts within one field
 void DropOutCorrect::correctField(const QVector<QVector<DropOutLocation>> &thisFieldDropouts,
-                                  const QVector<QVector<DropOutLocation>> &otherFieldDropouts,
-                                  QVector<SourceVideo::Data> &thisFieldData, const QVector<SourceVideo::Data> &otherFieldData,
+                                  const QVector<DropOutIndex> &thisFieldIndexes, const QVector<DropOutIndex> &otherFieldIndexes,
+                                  SourceVideo::Data &thisFieldData, const SourceVideo::Data &otherFieldData,
+                                  const QVector<SourceVideo::View> &thisSourceFields, const QVector<SourceVideo::View> &otherSourceFields,
                                   bool thisFieldIsFirst, bool intraField, const QVector<qint32> &availableSourcesForFrame,
                                   const QVector<qreal> &sourceFrameQuality, Statistics &statistics)
 {
@@ -130,7 +142,7 @@ void DropOutCorrect::correctField(const QVector<QVector<DropOutLocation>> &thisF
 
         // Is the current dropout in the colour burst?
         if (thisFieldDropouts[0][dropoutIndex].location == Location::colourBurst) {
-            replacement = findReplacementLine(thisFieldDropouts, otherFieldDropouts,
+            replacement = findReplacementLine(thisFieldDropouts, thisFieldIndexes, otherFieldIndexes,
                                               dropoutIndex, thisFieldIsFirst, true,
                                               true, intraField, availableSourcesForFrame,
                                               sourceFrameQuality);
@@ -139,18 +151,19 @@ void DropOutCorrect::correctField(const QVector<QVector<DropOutLocation>> &thisF
         // Is the current dropout in the visible video line?
         if (thisFieldDropouts[0][dropoutIndex].location == Location::visibleLine) {
             // Find separate replacements for luma and chroma
-            replacement = findReplacementLine(thisFieldDropouts, otherFieldDropouts,
+            replacement = findReplacementLine(thisFieldDropouts, thisFieldIndexes, otherFieldIndexes,
                                               dropoutIndex, thisFieldIsFirst, false,
                                               false, intraField, availableSourcesForFrame,
                                               sourceFrameQuality);
-            chromaReplacement = findReplacementLine(thisFieldDropouts, otherFieldDropouts,
+            chromaReplacement = findReplacementLine(thisFieldDropouts, thisFieldIndexes, otherFieldIndexes,
                                                     dropoutIndex, thisFieldIsFirst, true,
                                                     false, intraField, availableSourcesForFrame,
                                                     sourceFrameQuality);
         }
 
         // Correct the data
-        correctDropOut(thisFieldDropouts[0][dropoutIndex], replacement, chromaReplacement, thisFieldData, otherFieldData, statistics);
+        correctDropOut(thisFieldDropouts[0][dropoutIndex], replacement, chromaReplacement, thisFieldData, otherFieldData,
+                       thisSourceFields, otherSourceFields, statistics);
     }
 }
 
@@ -249,11 +262,23 @@ QVector<DropOutCorrect::DropOutLocation> DropOutCorrect::setDropOutLocations(QVe
     return dropOuts;
 }
 
+// Index drop out locations by line
+DropOutIndex DropOutCorrect::indexDropOutLocations(const QVector<DropOutLocation> &dropOuts)
+{
+    DropOuts lineDropOuts(dropOuts.size());
+    for (const DropOutLocation &dropOut : dropOuts) {
+        lineDropOuts.append(dropOut.startx, dropOut.endx, dropOut.fieldLine);
+    }
+
+    return DropOutIndex(lineDropOuts, videoParameters[0].fieldHeight);
+}
+
 // Find a replacement line to take replacement data from.  This method looks both up and down the field
 // for the nearest replacement line that doesn't contain a drop-out itself (to prevent copying bad data
 // over bad data).
 DropOutCorrect::Replacement DropOutCorrect::findReplacementLine(const QVector<QVector<DropOutLocation>> &thisFieldDropouts,
-                                                                const QVector<QVector<DropOutLocation>> &otherFieldDropouts,
+                                                                const QVector<DropOutIndex> &thisFieldIndexes,
+                                                                const QVector<DropOutIndex> &otherFieldIndexes,
                                                                 qint32 dropOutIndex, bool thisFieldIsFirst, bool matchChromaPhase,
                                                                 bool isColourBurst, bool intraField,
                                                                 const QVector<qint32> &availableSourcesForFrame,
@@ -320,13 +345,13 @@ DropOutCorrect::Replacement DropOutCorrect::findReplacementLine(const QVector<QV
 
         // Look up the field for a replacement
         findPotentialReplacementLine(thisFieldDropouts, dropOutIndex,
-                                     thisFieldDropouts, true, 0, -stepAmount,
+                                     thisFieldIndexes, true, 0, -stepAmount,
                                      currentSource, sourceFrameQuality,
                                      candidates);
 
         // Look down the field for a replacement
         findPotentialReplacementLine(thisFieldDropouts, dropOutIndex,
-                                     thisFieldDropouts, true, stepAmount, stepAmount,
+                                     thisFieldIndexes, true, stepAmount, stepAmount,
                                      currentSource, sourceFrameQuality,
                                      candidates);
 
@@ -336,13 +361,13 @@ DropOutCorrect::Replacement DropOutCorrect::findReplacementLine(const QVector<QV
 
             // Look up the field for a replacement
             findPotentialReplacementLine(thisFieldDropouts, dropOutIndex,
-                                         otherFieldDropouts, false, otherFieldOffset, -stepAmount,
+                                         otherFieldIndexes, false, otherFieldOffset, -stepAmount,
                                          currentSource, sourceFrameQuality,
                                          candidates);
 
             // Look down the field for a replacement
             findPotentialReplacementLine(thisFieldDropouts, dropOutIndex,
-                                         otherFieldDropouts, false, otherFieldOffset + stepAmount, stepAmount,
+                                         otherFieldIndexes, false, otherFieldOffset + stepAmount, stepAmount,
                                          currentSource, sourceFrameQuality,
                                          candidates);
         }
@@ -404,7 +429,7 @@ DropOutCorrect::Replacement DropOutCorrect::findReplacementLine(const QVector<QV
 // Given a dropout, scan through a source field for the nearest replacement line that doesn't have overlapping dropouts.
 // Adds a Replacement to candidates if one was found.
 void DropOutCorrect::findPotentialReplacementLine(const QVector<QVector<DropOutLocation>> &targetDropouts, qint32 targetIndex,
-                                                  const QVector<QVector<DropOutLocation>> &sourceDropouts, bool isSameField,
+                                                  const QVector<DropOutIndex> &sourceIndexes, bool isSameField,
                                                   qint32 sourceOffset, qint32 stepAmount,
                                                   qint32 sourceNo, const QVector<qreal> &sourceFrameQuality,
                                                   QVector<Replacement> &candidates)
@@ -423,18 +448,10 @@ void DropOutCorrect::findPotentialReplacementLine(const QVector<QVector<DropOutL
     while ((sourceLine - 1) >= videoParameters[sourceNo].firstActiveFieldLine
            && (sourceLine - 1) < videoParameters[sourceNo].lastActiveFieldLine) {
         // Is there a dropout that overlaps the one we're trying to replace?
-        bool hasOverlap = false;
-        for (qint32 sourceIndex = 0; sourceIndex < sourceDropouts[sourceNo].size(); sourceIndex++) {
-            if (sourceDropouts[sourceNo][sourceIndex].fieldLine == sourceLine &&
-                (targetDropouts[0][targetIndex].endx - sourceDropouts[sourceNo][sourceIndex].startx) >= 0 &&
-                (sourceDropouts[sourceNo][sourceIndex].endx - targetDropouts[0][targetIndex].startx) >= 0) {
-                // Overlap -- can't use this line
-                sourceLine += stepAmount;
-                hasOverlap = true;
-                break;
-            }
-        }
-        if (!hasOverlap) {
+        if (sourceIndexes[sourceNo].overlaps(sourceLine, targetDropouts[0][targetIndex].startx, targetDropouts[0][targetIndex].endx)) {
+            // Overlap -- can't use this line
+            sourceLine += stepAmount;
+        } else {
             // No overlaps -- we can use this line
             Replacement replacement;
             replacement.isSameField = isSameField;
@@ -455,7 +472,8 @@ void DropOutCorrect::findPotentialReplacementLine(const QVector<QVector<DropOutL
 // Correct a dropout by copying data from a replacement line.
 void DropOutCorrect::correctDropOut(const DropOutLocation &dropOut,
                                     const Replacement &replacement, const Replacement &chromaReplacement,
-                                    QVector<SourceVideo::Data> &thisFieldData, const QVector<SourceVideo::Data> &otherFieldData,
+                                    SourceVideo::Data &thisFieldData, const SourceVideo::Data &otherFieldData,
+                                    const QVector<SourceVideo::View> &thisSourceFields, const QVector<SourceVideo::View> &otherSourceFields,
                                     Statistics &statistics)
 {
     if (replacement.fieldLine == -1) {
@@ -463,10 +481,16 @@ void DropOutCorrect::correctDropOut(const DropOutLocation &dropOut,
         return;
     }
 
-    const quint16 *sourceLine = (replacement.isSameField ? thisFieldData[replacement.sourceNumber].data()
-                                                         : otherFieldData[replacement.sourceNumber].data())
+    // Get a pointer to a source's field data. The first source's data comes
+    // from the target fields, so it includes any corrections made so far.
+    auto getFieldData = [&](bool isSameField, qint32 sourceNumber) -> const quint16 * {
+        if (sourceNumber == 0) return isSameField ? thisFieldData.data() : otherFieldData.data();
+        return isSameField ? thisSourceFields[sourceNumber].data() : otherSourceFields[sourceNumber].data();
+    };
+
+    const quint16 *sourceLine = getFieldData(replacement.isSameField, replacement.sourceNumber)
                                 + ((replacement.fieldLine - 1) * videoParameters[0].fieldWidth);
-    quint16 *targetLine = thisFieldData[0].data() + ((dropOut.fieldLine - 1) * videoParameters[0].fieldWidth);
+    quint16 *targetLine = thisFieldData.data() + ((dropOut.fieldLine - 1) * videoParameters[0].fieldWidth);
 
     // Choose whole signal or just chroma replacement
     // Don't use chroma if the source of the replacement is > 0 and coming from the same line in another source
@@ -507,8 +531,7 @@ void DropOutCorrect::correctDropOut(const DropOutLocation &dropOut,
         }
 
         // Extract HF from chromaReplacement (by extracting LF, then subtracting from the original)
-        const quint16 *chromaLine = (chromaReplacement.isSameField ? thisFieldData[replacement.sourceNumber].data()
-                                                                   : otherFieldData[replacement.sourceNumber].data())
+        const quint16 *chromaLine = getFieldData(chromaReplacement.isSameField, replacement.sourceNumber)
                                     + ((chromaReplacement.fieldLine - 1) * videoParameters[0].fieldWidth);
         for (qint32 pixel = 0; pixel < videoParameters[0].fieldWidth; pixel++) {
             lineBuf[pixel] = chromaLine[pixel];
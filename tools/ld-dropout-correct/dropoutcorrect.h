@@ -88,25 +88,29 @@ private:
     QVector<LdDecodeMetaData::VideoParameters> videoParameters;
 
     void correctField(const QVector<QVector<DropOutLocation> > &thisFieldDropouts,
-                      const QVector<QVector<DropOutLocation> > &otherFieldDropouts,
-                      QVector<SourceVideo::Data> &thisFieldData, const QVector<SourceVideo::Data> &otherFieldData,
+                      const QVector<DropOutIndex> &thisFieldIndexes, const QVector<DropOutIndex> &otherFieldIndexes,
+                      SourceVideo::Data &thisFieldData, const SourceVideo::Data &otherFieldData,
+                      const QVector<SourceVideo::View> &thisSourceFields, const QVector<SourceVideo::View> &otherSourceFields,
                       bool thisFieldIsFirst, bool intraField, const QVector<qint32> &availableSourcesForFrame,
                       const QVector<qreal> &sourceFrameQuality, Statistics &statistics);
     QVector<DropOutLocation> populateDropoutsVector(LdDecodeMetaData::Field field, bool overCorrect);
     QVector<DropOutLocation> setDropOutLocations(QVector<DropOutLocation> dropOuts);
+    DropOutIndex indexDropOutLocations(const QVector<DropOutLocation> &dropOuts);
     Replacement findReplacementLine(const QVector<QVector<DropOutLocation>> &thisFieldDropouts,
-                                    const QVector<QVector<DropOutLocation>> &otherFieldDropouts,
+                                    const QVector<DropOutIndex> &thisFieldIndexes,
+                                    const QVector<DropOutIndex> &otherFieldIndexes,
                                     qint32 dropOutIndex, bool thisFieldIsFirst, bool matchChromaPhase,
                                     bool isColourBurst, bool intraField, const QVector<qint32> &availableSourcesForFrame,
                                     const QVector<qreal> &sourceFrameQuality);
     void findPotentialReplacementLine(const QVector<QVector<DropOutLocation>> &targetDropouts, qint32 targetIndex,
-                                      const QVector<QVector<DropOutLocation>> &sourceDropouts, bool isSameField,
+                                      const QVector<DropOutIndex> &sourceIndexes, bool isSameField,
                                       qint32 sourceOffset, qint32 stepAmount,
                                       qint32 sourceNo, const QVector<qreal> &sourceFrameQuality,
                                       QVector<Replacement> &candidates);
     void correctDropOut(const DropOutLocation &dropOut,
                         const Replacement &replacement, const Replacement &chromaReplacement,
-                        QVector<SourceVideo::Data> &thisFieldData, const QVector<SourceVideo::Data> &otherFieldData,
+                        SourceVideo::Data &thisFieldData, const SourceVideo::Data &otherFieldData,
+                        const QVector<SourceVideo::View> &thisSourceFields, const QVector<SourceVideo::View> &otherSourceFields,
                         Statistics &statistics);
 };
 
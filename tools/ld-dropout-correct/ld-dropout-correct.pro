@@ -18,24 +18,36 @@ SOURCES += \
     correctorpool.cpp \
     main.cpp \
     dropoutcorrect.cpp \
+    ../library/tbc/binarymetadata.cpp \
+    ../library/tbc/compressedtbc.cpp \
     ../library/tbc/dropouts.cpp \
+    ../library/tbc/fieldcache.cpp \
+    ../library/tbc/fieldstore.cpp \
     ../library/tbc/filters.cpp \
     ../library/tbc/jsonio.cpp \
     ../library/tbc/lddecodemetadata.cpp \
     ../library/tbc/logging.cpp \
+    ../library/tbc/parallelfor.cpp \
     ../library/tbc/sourcevideo.cpp \
+    ../library/tbc/tbcparts.cpp \
     ../library/tbc/vbidecoder.cpp
 
 HEADERS += \
     correctorpool.h \
     dropoutcorrect.h \
     ../library/filter/firfilter.h \
+    ../library/tbc/binarymetadata.h \
+    ../library/tbc/compressedtbc.h \
     ../library/tbc/dropouts.h \
+    ../library/tbc/fieldcache.h \
+    ../library/tbc/fieldstore.h \
     ../library/tbc/filters.h \
     ../library/tbc/jsonio.h \
     ../library/tbc/lddecodemetadata.h \
     ../library/tbc/logging.h \
+    ../library/tbc/parallelfor.h \
     ../library/tbc/sourcevideo.h \
+    ../library/tbc/tbcparts.h \
     ../library/tbc/vbidecoder.h
 
 # Add external includes to the include path
@@ -32,6 +32,11 @@
 
 #include "logging.h"
 #include "correctorpool.h"
+#include "fieldcache.h"
+
+// Number of fields to keep when reading from stdin. Frames are read in order,
+// so this only needs to cover the fields of the current and previous frames.
+static constexpr qint32 STREAM_WINDOW = 4;
 
 int main(int argc, char *argv[])
 {
@@ -94,6 +99,26 @@ int main(int argc, char *argv[])
                                         QCoreApplication::translate("main", "number"));
     parser.addOption(threadsOption);
 
+    // Option to read fields ahead in the background (--prefetch)
+    QCommandLineOption prefetchOption(QStringList() << "prefetch",
+                                        QCoreApplication::translate(
+                                         "main", "Read this many fields ahead of each input in a background thread (default 0, disabled)"),
+                                        QCoreApplication::translate("main", "fields"));
+    parser.addOption(prefetchOption);
+
+    // Option to follow an input that's still being written (--follow)
+    QCommandLineOption followOption(QStringList() << "follow",
+                                        QCoreApplication::translate(
+                                         "main", "Process a single input TBC and JSON while they are still being written, until they stop growing"));
+    parser.addOption(followOption);
+
+    // Option to set the size of the field cache (--cache-mb)
+    QCommandLineOption cacheSizeOption(QStringList() << "cache-mb",
+                                        QCoreApplication::translate(
+                                         "main", "Maximum memory used to cache fields, shared by all inputs, in MiB (default 256)"),
+                                        QCoreApplication::translate("main", "size"));
+    parser.addOption(cacheSizeOption);
+
     // Positional argument to specify input video file
     parser.addPositionalArgument("inputs", QCoreApplication::translate(
                                      "main", "Specify input TBC files (- as first source for piped input)"));
@@ -125,6 +150,29 @@ int main(int argc, char *argv[])
         }
     }
 
+    qint32 prefetchWindow = 0;
+    if (parser.isSet(prefetchOption)) {
+        prefetchWindow = parser.value(prefetchOption).toInt();
+
+        if (prefetchWindow < 0) {
+            // Quit with error
+            qCritical("Specified prefetch window must not be negative");
+            return -1;
+        }
+    }
+
+    if (parser.isSet(cacheSizeOption)) {
+        const qint32 cacheSize = parser.value(cacheSizeOption).toInt();
+
+        if (cacheSize < 0) {
+            // Quit with error
+            qCritical("Specified cache size must not be negative");
+            return -1;
+        }
+
+        FieldCache::global().setByteLimit(static_cast<qint64>(cacheSize) * 1024 * 1024);
+    }
+
     // Require source and target filenames
     QVector<QString> inputFilenames;
     QString outputFilename = "-";
@@ -161,6 +209,14 @@ int main(int argc, char *argv[])
         return -1;
     }
 
+    // Following the input only works for a single input file
+    const bool follow = parser.isSet(followOption);
+    if (follow && (totalNumberOfInputFiles > 1 || inputFilenames[0] == "-")) {
+        // Quit with error
+        qCritical("With --follow, you must specify a single input file (not piped input)");
+        return -1;
+    }
+
     // If the output filename is "-" (piped output) - verify a JSON file has been specified
     if (outputFilename == "-" && !parser.isSet(outputJsonOption)) {
         // Quit with error
@@ -212,6 +268,7 @@ int main(int argc, char *argv[])
     // Open the source video metadata
     qDebug() << "main(): Opening source video metadata files..";
     QVector<LdDecodeMetaData *> ldDecodeMetaData;
+    QString followJsonFilename;
     ldDecodeMetaData.resize(totalNumberOfInputFiles);
     for (qint32 i = 0; i < totalNumberOfInputFiles; i++) {
         // Create an object for the source video
@@ -222,6 +279,7 @@ int main(int argc, char *argv[])
         // Work out the metadata filename
         QString jsonFilename = inputFilenames[i] + ".json";
         if (parser.isSet(inputJsonOption) && i == 0) jsonFilename = parser.value(inputJsonOption);
+        if (follow && i == 0) followJsonFilename = jsonFilename;
         qInfo().nospace().noquote() << "Reading input #" << i << " JSON metadata from " << jsonFilename;
 
         // Open it
@@ -264,6 +322,9 @@ int main(int argc, char *argv[])
                     " - input filename is " << inputFilenames[i];
 
         // Open the source TBC
+        sourceVideos[i]->setPrefetchWindow(prefetchWindow);
+        sourceVideos[i]->setStreamWindow(STREAM_WINDOW);
+        sourceVideos[i]->setFollowMode(follow);
         if (!sourceVideos[i]->open(inputFilenames[i], videoParameters.fieldWidth * videoParameters.fieldHeight)) {
             // Could not open source video file
             qInfo() << "Unable to open input source" << i;
@@ -271,8 +332,8 @@ int main(int argc, char *argv[])
             return 1;
         }
 
-        // Verify TBC and JSON input fields match
-        if (sourceVideos[i]->getNumberOfAvailableFields() != ldDecodeMetaData[i]->getNumberOfFields()) {
+        // Verify TBC and JSON input fields match (unless they're still being written)
+        if (!follow && sourceVideos[i]->getNumberOfAvailableFields() != ldDecodeMetaData[i]->getNumberOfFields()) {
             qInfo() << "Warning: TBC file contains" << sourceVideos[i]->getNumberOfAvailableFields() <<
                        "fields but the JSON indicates" << ldDecodeMetaData[i]->getNumberOfFields() <<
                        "fields - some fields will be ignored";
@@ -307,7 +368,7 @@ int main(int argc, char *argv[])
     qint32 result = 0;
     CorrectorPool correctorPool(outputFilename, outputJsonFilename, maxThreads,
                                 ldDecodeMetaData, sourceVideos,
-                                reverse, intraField, overCorrect);
+                                reverse, intraField, overCorrect, followJsonFilename);
     if (!correctorPool.process()) result = 1;
 
     // Report on the result of the correction process
@@ -328,6 +389,17 @@ int main(int argc, char *argv[])
                    correctorPool.getMultiSourceCorrectionTotal();
     }
 
+    // Report on the field cache
+    FieldCache::global().printStatistics();
+
+    // Report on background prefetching
+    if (prefetchWindow > 0) {
+        for (qint32 i = 0; i < totalNumberOfInputFiles; i++) {
+            qInfo().nospace() << "Prefetch for input #" << i << ": " << sourceVideos[i]->getPrefetchHits() << " hits, " <<
+                                 sourceVideos[i]->getPrefetchMisses() << " misses";
+        }
+    }
+
     // Close open source video files
     for (qint32 i = 0; i < totalNumberOfInputFiles; i++) sourceVideos[i]->close();
 
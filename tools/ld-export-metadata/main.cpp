@@ -86,10 +86,24 @@ int main(int argc, char *argv[])
                                              QCoreApplication::translate("main", "file"));
     parser.addOption(writeClosedCaptionsOption);
 
+    QCommandLineOption writeJsonOption("json",
+                                       QCoreApplication::translate("main", "Write all metadata as JSON"),
+                                       QCoreApplication::translate("main", "file"));
+    parser.addOption(writeJsonOption);
+
+    QCommandLineOption writeBinaryOption("binary",
+                                         QCoreApplication::translate("main", "Write all metadata as binary columnar metadata (.ldmeta)"),
+                                         QCoreApplication::translate("main", "file"));
+    parser.addOption(writeBinaryOption);
+
+    QCommandLineOption compactOption("compact",
+                                     QCoreApplication::translate("main", "Fold the input JSON file's journal of changes back into it"));
+    parser.addOption(compactOption);
+
     // -- Positional arguments --
 
     // Positional argument to specify input video file
-    parser.addPositionalArgument("input", QCoreApplication::translate("main", "Specify input JSON file"));
+    parser.addPositionalArgument("input", QCoreApplication::translate("main", "Specify input JSON (or .ldmeta) file"));
 
     // Process the command line options and arguments given by the user
     parser.process(a);
@@ -144,6 +158,27 @@ int main(int argc, char *argv[])
         }
     }
 
+    if (parser.isSet(writeJsonOption)) {
+        const QString &fileName = parser.value(writeJsonOption);
+        if (!metaData.writeJson(fileName)) {
+            qCritical() << "Failed to write output file:" << fileName;
+            return 1;
+        }
+    }
+    if (parser.isSet(writeBinaryOption)) {
+        const QString &fileName = parser.value(writeBinaryOption);
+        if (!metaData.writeBinary(fileName)) {
+            qCritical() << "Failed to write output file:" << fileName;
+            return 1;
+        }
+    }
+    if (parser.isSet(compactOption)) {
+        if (!metaData.compactJournal(inputFileName)) {
+            qCritical() << "Failed to compact journal for input file:" << inputFileName;
+            return 1;
+        }
+    }
+
     // Quit with success
     return 0;
 }
@@ -25,9 +25,11 @@
 #include "decoderpool.h"
 
 DecoderPool::DecoderPool(QString _inputFilename, QString _outputJsonFilename,
-                         qint32 _maxThreads, LdDecodeMetaData &_ldDecodeMetaData)
+                         qint32 _maxThreads, LdDecodeMetaData &_ldDecodeMetaData,
+                         qint32 _prefetchWindow, QString _followJsonFilename)
     : inputFilename(_inputFilename), outputJsonFilename(_outputJsonFilename),
-      maxThreads(_maxThreads), ldDecodeMetaData(_ldDecodeMetaData)
+      maxThreads(_maxThreads), prefetchWindow(_prefetchWindow), followJsonFilename(_followJsonFilename),
+      ldDecodeMetaData(_ldDecodeMetaData)
 {
 }
 
@@ -39,25 +41,36 @@ bool DecoderPool::process()
                 videoParameters.fieldHeight;
 
     // Open the source video
+    sourceVideo.setPrefetchWindow(prefetchWindow);
+    sourceVideo.setFollowMode(!followJsonFilename.isEmpty());
     if (!sourceVideo.open(inputFilename, videoParameters.fieldWidth * videoParameters.fieldHeight, videoParameters.fieldWidth)) {
         // Could not open source video file
         qCritical() << "Source TBC file could not be opened";
         return false;
     }
 
-    // Check TBC and JSON field numbers match
-    if (sourceVideo.getNumberOfAvailableFields() != ldDecodeMetaData.getNumberOfFields()) {
+    // Check TBC and JSON field numbers match (unless they're still being written)
+    if (!followJsonFilename.isEmpty()) {
+        qInfo() << "Following the input as it is written";
+    } else if (sourceVideo.getNumberOfAvailableFields() != ldDecodeMetaData.getNumberOfFields()) {
         qWarning() << "Warning: TBC file contains" << sourceVideo.getNumberOfAvailableFields() <<
                    "fields but the JSON indicates" << ldDecodeMetaData.getNumberOfFields() <<
                    "fields - some fields will be ignored";
     }
 
     // Show some information for the user
-    qInfo() << "Using" << maxThreads << "threads to process" << ldDecodeMetaData.getNumberOfFields() << "fields";
+    if (followJsonFilename.isEmpty()) {
+        qInfo() << "Using" << maxThreads << "threads to process" << ldDecodeMetaData.getNumberOfFields() << "fields";
+    } else {
+        qInfo() << "Using" << maxThreads << "threads";
+    }
 
     // Initialise processing state
     inputFieldNumber = 1;
     lastFieldNumber = ldDecodeMetaData.getNumberOfFields();
+    inputFinished = followJsonFilename.isEmpty();
+    batchFirstFieldNumber = 1;
+    batchFieldCount = 0;
     totalTimer.start();
 
     // Start a vector of decoding threads to process the video
@@ -84,6 +97,9 @@ bool DecoderPool::process()
     qreal totalSecs = (static_cast<qreal>(totalTimer.elapsed()) / 1000.0);
     qInfo() << "VBI Processing complete -" << lastFieldNumber << "fields in" << totalSecs << "seconds (" <<
                lastFieldNumber / totalSecs << "FPS )";
+    if (prefetchWindow > 0) {
+        qInfo() << "Prefetch:" << sourceVideo.getPrefetchHits() << "hits," << sourceVideo.getPrefetchMisses() << "misses";
+    }
 
     // Write the JSON metadata file
     qInfo() << "Writing JSON metadata file...";
@@ -105,6 +121,9 @@ bool DecoderPool::getInputField(qint32 &fieldNumber, SourceVideo::Data &fieldVid
 {
     QMutexLocker locker(&inputMutex);
 
+    // If the input is still being written, wait for the next field
+    if (inputFieldNumber > lastFieldNumber && !inputFinished) followInput(inputFieldNumber);
+
     if (inputFieldNumber > lastFieldNumber) {
         // No more input fields
         return false;
@@ -116,14 +135,49 @@ bool DecoderPool::getInputField(qint32 &fieldNumber, SourceVideo::Data &fieldVid
     // Show what we are about to process
     qDebug() << "DecoderPool::process(): Processing field number" << fieldNumber;
 
+    // Read the next batch of fields from the input, if needed. Only a few
+    // lines from each field are used, so read just those lines from a batch
+    // of fields at once, rather than seeking and reading each field.
+    if (fieldNumber >= batchFirstFieldNumber + batchFieldCount) {
+        batchFirstFieldNumber = fieldNumber;
+        batchFieldCount = qMin(BATCH_SIZE, lastFieldNumber + 1 - fieldNumber);
+        sourceVideo.getVideoFieldLines(batchFirstFieldNumber, batchFieldCount,
+                                       VbiLineDecoder::startFieldLine, VbiLineDecoder::endFieldLine, batchData);
+    }
+
     // Fetch the input data
-    fieldVideoData = sourceVideo.getVideoField(fieldNumber, VbiLineDecoder::startFieldLine, VbiLineDecoder::endFieldLine);
+    const qint32 fieldLength = batchData.size() / batchFieldCount;
+    fieldVideoData = batchData.mid((fieldNumber - batchFirstFieldNumber) * fieldLength, fieldLength);
     fieldMetadata = ldDecodeMetaData.getField(fieldNumber);
     videoParameters = ldDecodeMetaData.getVideoParameters();
 
     return true;
 }
 
+// Wait until the input metadata and TBC file both contain requiredFieldNumber,
+// or the input has stopped growing, and update lastFieldNumber to match. You
+// must hold inputMutex to call this.
+void DecoderPool::followInput(qint32 requiredFieldNumber)
+{
+    auto getAvailableFields = [&]() {
+        return qMin(ldDecodeMetaData.getNumberOfFields(), sourceVideo.getNumberOfAvailableFields());
+    };
+
+    while (!inputFinished && getAvailableFields() < requiredFieldNumber) {
+        // Wait for another field to be written, then read any new metadata.
+        // The JSON is written after the fields it describes, so read it once
+        // more after the TBC file stops growing.
+        if (!sourceVideo.waitForFields(sourceVideo.getNumberOfAvailableFields() + 1)) inputFinished = true;
+
+        // Adding fields may move the existing ones, so the workers mustn't be
+        // updating them at the same time
+        QMutexLocker locker(&outputMutex);
+        ldDecodeMetaData.refreshFields(followJsonFilename);
+    }
+
+    lastFieldNumber = getAvailableFields();
+}
+
 // Put a decoded frame into the output stream.
 //
 // Returns true on success, false on failure.
@@ -39,7 +39,8 @@ class DecoderPool
 public:
     // Public methods
     explicit DecoderPool(QString _inputFilename, QString _outputJsonFilename,
-                        qint32 _maxThreads, LdDecodeMetaData &_ldDecodeMetaData);
+                        qint32 _maxThreads, LdDecodeMetaData &_ldDecodeMetaData,
+                        qint32 _prefetchWindow = 0, QString _followJsonFilename = QString());
     bool process();
 
     // Member functions used by worker threads
@@ -47,9 +48,16 @@ public:
     bool setOutputField(qint32 fieldNumber, LdDecodeMetaData::Field fieldMetadata);
 
 private:
+    void followInput(qint32 requiredFieldNumber);
+
+    // Number of fields to read from the input at once
+    static constexpr qint32 BATCH_SIZE = 256;
+
     QString inputFilename;
     QString outputJsonFilename;
     qint32 maxThreads;
+    qint32 prefetchWindow;
+    QString followJsonFilename;
     QElapsedTimer totalTimer;
 
     // Atomic abort flag shared by worker threads; workers watch this, and shut
@@ -60,9 +68,15 @@ private:
     QMutex inputMutex;
     qint32 inputFieldNumber;
     qint32 lastFieldNumber;
+    bool inputFinished;
     LdDecodeMetaData &ldDecodeMetaData;
     SourceVideo sourceVideo;
 
+    // The current batch of field lines read from the input
+    SourceVideo::Data batchData;
+    qint32 batchFirstFieldNumber;
+    qint32 batchFieldCount;
+
     // Output stream information (all guarded by outputMutex while threads are running)
     QMutex outputMutex;
     QFile targetJson;
@@ -30,6 +30,7 @@
 
 #include "logging.h"
 #include "decoderpool.h"
+#include "fieldcache.h"
 
 int main(int argc, char *argv[])
 {
@@ -74,12 +75,34 @@ int main(int argc, char *argv[])
                                        QCoreApplication::translate("main", "Do not create a backup of the input JSON metadata"));
     parser.addOption(showNoBackupOption);
 
+    // Option to record changes in a journal (--journal)
+    QCommandLineOption journalOption(QStringList() << "journal",
+                                       QCoreApplication::translate("main", "Record changes in a journal alongside the input JSON, rather than rewriting it"));
+    parser.addOption(journalOption);
+
     // Option to select the number of threads (-t)
     QCommandLineOption threadsOption(QStringList() << "t" << "threads",
                                         QCoreApplication::translate("main", "Specify the number of concurrent threads (default is the number of logical CPUs)"),
                                         QCoreApplication::translate("main", "number"));
     parser.addOption(threadsOption);
 
+    // Option to read fields ahead in the background (--prefetch)
+    QCommandLineOption prefetchOption(QStringList() << "prefetch",
+                                        QCoreApplication::translate("main", "Read this many fields ahead in a background thread (default 0, disabled)"),
+                                        QCoreApplication::translate("main", "fields"));
+    parser.addOption(prefetchOption);
+
+    // Option to follow an input that's still being written (--follow)
+    QCommandLineOption followOption(QStringList() << "follow",
+                                        QCoreApplication::translate("main", "Process the input TBC and JSON while they are still being written, until they stop growing"));
+    parser.addOption(followOption);
+
+    // Option to set the size of the field cache (--cache-mb)
+    QCommandLineOption cacheSizeOption(QStringList() << "cache-mb",
+                                        QCoreApplication::translate("main", "Maximum memory used to cache fields, in MiB (default 256)"),
+                                        QCoreApplication::translate("main", "size"));
+    parser.addOption(cacheSizeOption);
+
     // Positional argument to specify input TBC file
     parser.addPositionalArgument("input", QCoreApplication::translate("main", "Specify input TBC file"));
 
@@ -91,6 +114,7 @@ int main(int argc, char *argv[])
 
     // Get the options from the parser
     bool noBackup = parser.isSet(showNoBackupOption);
+    bool journal = parser.isSet(journalOption);
 
     qint32 maxThreads = QThread::idealThreadCount();
     if (parser.isSet(threadsOption)) {
@@ -103,6 +127,32 @@ int main(int argc, char *argv[])
         }
     }
 
+    qint32 prefetchWindow = 0;
+    if (parser.isSet(prefetchOption)) {
+        prefetchWindow = parser.value(prefetchOption).toInt();
+
+        if (prefetchWindow < 0) {
+            // Quit with error
+            qCritical("Specified prefetch window must not be negative");
+            return -1;
+        }
+    }
+
+    if (parser.isSet(cacheSizeOption)) {
+        const qint32 cacheSize = parser.value(cacheSizeOption).toInt();
+
+        if (cacheSize < 0) {
+            // Quit with error
+            qCritical("Specified cache size must not be negative");
+            return -1;
+        }
+
+        FieldCache::global().setByteLimit(static_cast<qint64>(cacheSize) * 1024 * 1024);
+    }
+
+    // Fields are processed in order, so only the most recent fields are worth caching
+    FieldCache::global().setEvictionPolicy(FieldCache::SEQUENTIAL);
+
     // Get the arguments from the parser
     QString inputFilename;
     QStringList positionalArguments = parser.positionalArguments();
@@ -124,8 +174,25 @@ int main(int argc, char *argv[])
         outputJsonFilename = parser.value(outputJsonOption);
     }
 
+    // The input JSON will be rewritten by whatever is writing the input, so it
+    // can't also be the output
+    const bool follow = parser.isSet(followOption);
+    if (follow && inputJsonFilename == outputJsonFilename) {
+        // Quit with error
+        qCritical("With --follow, you must specify a different output JSON file");
+        return -1;
+    }
+
+    // The journal is kept alongside the input JSON file, so it must also be the output
+    if (journal && inputJsonFilename != outputJsonFilename) {
+        // Quit with error
+        qCritical("With --journal, the output JSON file must be the input JSON file");
+        return -1;
+    }
+
     // Open the source video metadata
     LdDecodeMetaData metaData;
+    metaData.setJournalling(journal);
     qInfo().nospace().noquote() << "Reading JSON metadata from " << inputJsonFilename;
     if (!metaData.read(inputJsonFilename)) {
         qCritical() << "Unable to open TBC JSON metadata file";
@@ -133,7 +200,7 @@ int main(int argc, char *argv[])
     }
 
     // If we're overwriting the input JSON file, back it up first
-    if (inputJsonFilename == outputJsonFilename && !noBackup) {
+    if (inputJsonFilename == outputJsonFilename && !noBackup && !journal) {
         qInfo().nospace().noquote() << "Backing up JSON metadata to " << inputJsonFilename << ".bup";
         if (!QFile::copy(inputJsonFilename, inputJsonFilename + ".bup")) {
             qCritical() << "Unable to back-up input JSON metadata file - back-up already exists?";
@@ -143,8 +210,10 @@ int main(int argc, char *argv[])
 
     // Perform the processing
     qInfo() << "Beginning VBI processing...";
-    DecoderPool decoderPool(inputFilename, outputJsonFilename, maxThreads, metaData);
+    DecoderPool decoderPool(inputFilename, outputJsonFilename, maxThreads, metaData, prefetchWindow,
+                            follow ? inputJsonFilename : QString());
     if (!decoderPool.process()) return 1;
+    FieldCache::global().printStatistics();
 
     // Quit with success
     return 0;
@@ -32,6 +32,7 @@
 
 #include "logging.h"
 #include "lddecodemetadata.h"
+#include "fieldcache.h"
 #include "sourcevideo.h"
 #include "processingpool.h"
 
@@ -78,12 +79,29 @@ int main(int argc, char *argv[])
                                        QCoreApplication::translate("main", "Do not create a backup of the input JSON metadata"));
     parser.addOption(showNoBackupOption);
 
+    // Option to record changes in a journal (--journal)
+    QCommandLineOption journalOption(QStringList() << "journal",
+                                       QCoreApplication::translate("main", "Record changes in a journal alongside the input JSON, rather than rewriting it"));
+    parser.addOption(journalOption);
+
     // Option to select the number of threads (-t)
     QCommandLineOption threadsOption(QStringList() << "t" << "threads",
                                         QCoreApplication::translate("main", "Specify the number of concurrent threads (default is the number of logical CPUs)"),
                                         QCoreApplication::translate("main", "number"));
     parser.addOption(threadsOption);
 
+    // Option to read fields ahead in the background (--prefetch)
+    QCommandLineOption prefetchOption(QStringList() << "prefetch",
+                                        QCoreApplication::translate("main", "Read this many fields ahead in a background thread (default 0, disabled)"),
+                                        QCoreApplication::translate("main", "fields"));
+    parser.addOption(prefetchOption);
+
+    // Option to set the size of the field cache (--cache-mb)
+    QCommandLineOption cacheSizeOption(QStringList() << "cache-mb",
+                                        QCoreApplication::translate("main", "Maximum memory used to cache fields, in MiB (default 256)"),
+                                        QCoreApplication::translate("main", "size"));
+    parser.addOption(cacheSizeOption);
+
     // Positional argument to specify input TBC file
     parser.addPositionalArgument("input", QCoreApplication::translate("main", "Specify input TBC file"));
 
@@ -95,6 +113,7 @@ int main(int argc, char *argv[])
 
     // Get the options from the parser
     bool noBackup = parser.isSet(showNoBackupOption);
+    bool journal = parser.isSet(journalOption);
 
     qint32 maxThreads = QThread::idealThreadCount();
     if (parser.isSet(threadsOption)) {
@@ -107,6 +126,32 @@ int main(int argc, char *argv[])
         }
     }
 
+    qint32 prefetchWindow = 0;
+    if (parser.isSet(prefetchOption)) {
+        prefetchWindow = parser.value(prefetchOption).toInt();
+
+        if (prefetchWindow < 0) {
+            // Quit with error
+            qCritical("Specified prefetch window must not be negative");
+            return -1;
+        }
+    }
+
+    if (parser.isSet(cacheSizeOption)) {
+        const qint32 cacheSize = parser.value(cacheSizeOption).toInt();
+
+        if (cacheSize < 0) {
+            // Quit with error
+            qCritical("Specified cache size must not be negative");
+            return -1;
+        }
+
+        FieldCache::global().setByteLimit(static_cast<qint64>(cacheSize) * 1024 * 1024);
+    }
+
+    // Fields are processed in order, so only the most recent fields are worth caching
+    FieldCache::global().setEvictionPolicy(FieldCache::SEQUENTIAL);
+
     // Get the arguments from the parser
     QString inputFilename;
     QStringList positionalArguments = parser.positionalArguments();
@@ -128,8 +173,16 @@ int main(int argc, char *argv[])
         outputJsonFilename = parser.value(outputJsonOption);
     }
 
+    // The journal is kept alongside the input JSON file, so it must also be the output
+    if (journal && inputJsonFilename != outputJsonFilename) {
+        // Quit with error
+        qCritical("With --journal, the output JSON file must be the input JSON file");
+        return -1;
+    }
+
     // Open the source video metadata
     LdDecodeMetaData metaData;
+    metaData.setJournalling(journal);
     qInfo().nospace().noquote() << "Reading JSON metadata from " << inputJsonFilename;
     if (!metaData.read(inputJsonFilename)) {
         qCritical() << "Unable to open TBC JSON metadata file";
@@ -137,7 +190,7 @@ int main(int argc, char *argv[])
     }
 
     // If we're overwriting the input JSON file, back it up first
-    if (inputJsonFilename == outputJsonFilename && !noBackup) {
+    if (inputJsonFilename == outputJsonFilename && !noBackup && !journal) {
         qInfo().nospace().noquote() << "Backing up JSON metadata to " << inputJsonFilename << ".vbup";
         if (!QFile::copy(inputJsonFilename, inputJsonFilename + ".vbup")) {
             qCritical() << "Unable to back-up input JSON metadata file - back-up already exists?";
@@ -147,8 +200,9 @@ int main(int argc, char *argv[])
 
     // Perform the processing
     qInfo() << "Beginning VITS processing...";
-    ProcessingPool processingPool(inputFilename, outputJsonFilename, maxThreads, metaData);
+    ProcessingPool processingPool(inputFilename, outputJsonFilename, maxThreads, metaData, prefetchWindow);
     if (!processingPool.process()) return 1;
+    FieldCache::global().printStatistics();
 
     // Quit with success
     return 0;
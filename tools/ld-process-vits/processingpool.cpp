@@ -25,9 +25,10 @@
 #include "processingpool.h"
 
 ProcessingPool::ProcessingPool(QString _inputFilename, QString _outputJsonFilename,
-                         qint32 _maxThreads, LdDecodeMetaData &_ldDecodeMetaData)
+                         qint32 _maxThreads, LdDecodeMetaData &_ldDecodeMetaData,
+                         qint32 _prefetchWindow)
     : inputFilename(_inputFilename), outputJsonFilename(_outputJsonFilename),
-      maxThreads(_maxThreads), ldDecodeMetaData(_ldDecodeMetaData)
+      maxThreads(_maxThreads), prefetchWindow(_prefetchWindow), ldDecodeMetaData(_ldDecodeMetaData)
 {
 }
 
@@ -39,6 +40,7 @@ bool ProcessingPool::process()
                 videoParameters.fieldHeight;
 
     // Open the source video
+    sourceVideo.setPrefetchWindow(prefetchWindow);
     if (!sourceVideo.open(inputFilename, videoParameters.fieldWidth * videoParameters.fieldHeight, videoParameters.fieldWidth)) {
         // Could not open source video file
         qCritical() << "Source TBC file could not be opened";
@@ -58,6 +60,8 @@ bool ProcessingPool::process()
     // Initialise processing state
     inputFieldNumber = 1;
     lastFieldNumber = ldDecodeMetaData.getNumberOfFields();
+    batchFirstFieldNumber = 1;
+    batchFieldCount = 0;
     totalTimer.start();
 
     // Start a vector of decoding threads to process the video
@@ -84,6 +88,9 @@ bool ProcessingPool::process()
     qreal totalSecs = (static_cast<qreal>(totalTimer.elapsed()) / 1000.0);
     qInfo() << "VITS Processing complete -" << lastFieldNumber << "fields in" << totalSecs << "seconds (" <<
                lastFieldNumber / totalSecs << "FPS )";
+    if (prefetchWindow > 0) {
+        qInfo() << "Prefetch:" << sourceVideo.getPrefetchHits() << "hits," << sourceVideo.getPrefetchMisses() << "misses";
+    }
 
     // Write the JSON metadata file
     qInfo() << "Writing JSON metadata file...";
@@ -115,8 +122,19 @@ bool ProcessingPool::getInputField(qint32 &fieldNumber, SourceVideo::Data &field
     // Show what we are about to process
     //qDebug() << "Processing field number" << fieldNumber;
 
+    // Read the next batch of fields from the input, if needed. Only a few
+    // lines from each field are used, so read just those lines from a batch
+    // of fields at once, rather than seeking and reading each field.
+    if (fieldNumber >= batchFirstFieldNumber + batchFieldCount) {
+        batchFirstFieldNumber = fieldNumber;
+        batchFieldCount = qMin(BATCH_SIZE, lastFieldNumber + 1 - fieldNumber);
+        sourceVideo.getVideoFieldLines(batchFirstFieldNumber, batchFieldCount,
+                                       VitsAnalyser::startFieldLine, VitsAnalyser::endFieldLine, batchData);
+    }
+
     // Fetch the input data
-    fieldVideoData = sourceVideo.getVideoField(fieldNumber);
+    const qint32 fieldLength = batchData.size() / batchFieldCount;
+    fieldVideoData = batchData.mid((fieldNumber - batchFirstFieldNumber) * fieldLength, fieldLength);
     fieldMetadata = ldDecodeMetaData.getField(fieldNumber);
     videoParameters = ldDecodeMetaData.getVideoParameters();
 
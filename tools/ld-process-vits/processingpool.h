@@ -38,7 +38,8 @@ class ProcessingPool
 {
 public:
     explicit ProcessingPool(QString _inputFilename, QString _outputJsonFilename,
-                        qint32 _maxThreads, LdDecodeMetaData &_ldDecodeMetaData);
+                        qint32 _maxThreads, LdDecodeMetaData &_ldDecodeMetaData,
+                        qint32 _prefetchWindow = 0);
     bool process();
 
     // Member functions used by worker threads
@@ -46,9 +47,13 @@ public:
     bool setOutputField(qint32 fieldNumber, LdDecodeMetaData::Field fieldMetadata);
 
 private:
+    // Number of fields to read from the input at once
+    static constexpr qint32 BATCH_SIZE = 256;
+
     QString inputFilename;
     QString outputJsonFilename;
     qint32 maxThreads;
+    qint32 prefetchWindow;
     QElapsedTimer totalTimer;
 
     // Atomic abort flag shared by worker threads; workers watch this, and shut
@@ -62,6 +67,11 @@ private:
     LdDecodeMetaData &ldDecodeMetaData;
     SourceVideo sourceVideo;
 
+    // The current batch of field lines read from the input
+    SourceVideo::Data batchData;
+    qint32 batchFirstFieldNumber;
+    qint32 batchFieldCount;
+
     // Output stream information (all guarded by outputMutex while threads are running)
     QMutex outputMutex;
     QFile targetJson;
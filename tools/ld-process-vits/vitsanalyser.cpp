@@ -112,10 +112,10 @@ void VitsAnalyser::run()
 QVector<double> VitsAnalyser::getFieldLineSlice(const SourceVideo::Data &sourceField, qint32 fieldLine, qint32 startUs, qint32 lengthUs)
 {
     QVector<double> returnData;
-    fieldLine--; // Adjust for field offset
+    fieldLine -= startFieldLine; // Adjust for field offset (the first line read from the input)
 
     // Range-check the field line
-    if (fieldLine < 0 || fieldLine >= videoParameters.fieldHeight) {
+    if (fieldLine < 0 || fieldLine > endFieldLine - startFieldLine || fieldLine >= videoParameters.fieldHeight) {
         qWarning() << "Cannot generate field-line data, line number is out of bounds! Scan line =" << fieldLine;
         return returnData;
     }
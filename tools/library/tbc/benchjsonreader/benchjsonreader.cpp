@@ -0,0 +1,332 @@
+/************************************************************************
+
+    benchjsonreader.cpp
+
+    Microbenchmark for JsonReader
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include <QElapsedTimer>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <stack>
+#include <string>
+
+#include "jsonio.h"
+
+// The previous JsonReader, which reads a character at a time from an
+// istream, for comparison. Booleans and escapes aren't needed here.
+class StreamJsonReader
+{
+public:
+    StreamJsonReader(std::istream &_input) : input(_input), atStart(true) {}
+
+    void read(double &value) {
+        readNumber(value);
+    }
+
+    void beginArray() {
+        if (spaceGet() != '[') fail();
+        atStarts.push(atStart);
+        atStart = true;
+    }
+
+    bool readElement() {
+        char c = spaceGet();
+        if (c == ']') {
+            unget();
+            return false;
+        }
+        if (atStart) {
+            unget();
+        } else if (c != ',') {
+            fail();
+        }
+        atStart = false;
+        return true;
+    }
+
+    void endArray() {
+        if (spaceGet() != ']') fail();
+        atStart = atStarts.top();
+        atStarts.pop();
+    }
+
+    void discard() {
+        char c = spaceGet();
+        unget();
+
+        if (c == '-' || isAsciiDigit(c)) {
+            double dummy;
+            readNumber(dummy);
+        } else if (c == 't' || c == 'f') {
+            c = get();
+            const char *rest = (c == 't') ? "rue" : "alse";
+            while (*rest) {
+                if (get() != *rest++) fail();
+            }
+        } else if (c == '"') {
+            readString(buf);
+        } else if (c == '{') {
+            if (spaceGet() != '{') fail();
+            atStarts.push(atStart);
+            atStart = true;
+            while (true) {
+                c = spaceGet();
+                if (c == '}') break;
+                if (atStart) {
+                    unget();
+                } else if (c != ',') {
+                    fail();
+                }
+                atStart = false;
+                readString(buf);
+                if (spaceGet() != ':') fail();
+                discard();
+            }
+            atStart = atStarts.top();
+            atStarts.pop();
+        } else if (c == '[') {
+            beginArray();
+            while (readElement()) discard();
+            endArray();
+        } else {
+            fail();
+        }
+    }
+
+private:
+    [[noreturn]] void fail() {
+        std::cerr << "StreamJsonReader: invalid input\n";
+        exit(1);
+    }
+
+    static bool isAsciiDigit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    char get() {
+        char c;
+        input.get(c);
+        if (!input.good()) return 0;
+        return c;
+    }
+
+    char spaceGet() {
+        char c;
+        do {
+            c = get();
+        } while (c == ' ' || c == '\t' || c == '\n' || c == '\r');
+        return c;
+    }
+
+    void unget() {
+        input.unget();
+    }
+
+    void readString(std::string &value) {
+        if (spaceGet() != '"') fail();
+        value.clear();
+        while (true) {
+            char c = get();
+            if (c == 0 || c == '\\') fail();
+            if (c == '"') return;
+            value.push_back(c);
+        }
+    }
+
+    void readNumber(double &value) {
+        buf.clear();
+        char c = spaceGet();
+        while (c == '-' || c == '+' || c == '.' || c == 'e' || isAsciiDigit(c)) {
+            buf.push_back(c);
+            c = get();
+        }
+        value = std::stod(buf);
+        unget();
+    }
+
+    std::istream &input;
+    bool atStart;
+    std::stack<bool> atStarts;
+    std::string buf;
+};
+
+// Make a JSON document that looks like ld-decode's metadata
+static std::string makeDocument(int numberOfFields)
+{
+    std::ostringstream output;
+    JsonWriter writer(output);
+
+    writer.beginObject();
+    writer.writeMember("fields");
+    writer.beginArray();
+    for (int i = 0; i < numberOfFields; i++) {
+        writer.writeElement();
+        writer.beginObject();
+        writer.writeMember("audioSamples", 882 + (i % 3));
+        writer.writeMember("dropOuts");
+        writer.beginObject();
+        for (const char *name : {"endx", "fieldLine", "startx"}) {
+            writer.writeMember(name);
+            writer.beginArray();
+            for (int j = 0; j < i % 4; j++) {
+                writer.writeElement();
+                writer.write(100 * j + (i % 280));
+            }
+            writer.endArray();
+        }
+        writer.endObject();
+        writer.writeMember("fieldPhaseID", i % 8);
+        writer.writeMember("isFirstField", (i % 2) == 0);
+        writer.writeMember("medianBurstIRE", 12.5 + (i % 100) / 37.0);
+        writer.writeMember("pad", false);
+        writer.writeMember("seqNo", i + 1);
+        writer.writeMember("syncConf", 100);
+        writer.writeMember("vbi");
+        writer.beginObject();
+        writer.writeMember("vbiData");
+        writer.beginArray();
+        for (int value : {0x8ba000 + (i % 1000), 0xf80000 + i, 0xf80000 + i}) {
+            writer.writeElement();
+            writer.write(value);
+        }
+        writer.endArray();
+        writer.endObject();
+        writer.writeMember("vitsMetrics");
+        writer.beginObject();
+        writer.writeMember("bPSNR", 35.0 + (i % 50) / 3.0);
+        writer.writeMember("wSNR", 40.0 + (i % 100) / 7.0);
+        writer.endObject();
+        writer.endObject();
+    }
+    writer.endArray();
+    writer.writeMember("videoParameters");
+    writer.beginObject();
+    writer.writeMember("gitBranch", "main");
+    writer.writeMember("system", "PAL");
+    writer.endObject();
+    writer.endObject();
+
+    return output.str();
+}
+
+// Make a JSON array of numbers
+static std::string makeNumberArray(int numberOfValues)
+{
+    std::ostringstream output;
+    JsonWriter writer(output);
+
+    writer.beginArray();
+    for (int i = 0; i < numberOfValues; i++) {
+        writer.writeElement();
+        if ((i % 2) == 0) {
+            writer.write(i * 37);
+        } else {
+            writer.write(i / 7.0);
+        }
+    }
+    writer.endArray();
+
+    return output.str();
+}
+
+// Read all the numbers in an array, returning their sum
+template <typename Reader>
+static double sumNumberArray(Reader &reader)
+{
+    double sum = 0.0;
+    reader.beginArray();
+    while (reader.readElement()) {
+        double value;
+        reader.read(value);
+        sum += value;
+    }
+    reader.endArray();
+    return sum;
+}
+
+// Run a reader over the document several times, and print its throughput
+template <typename Function>
+static void runBenchmark(const char *name, const std::string &document, int repeats, Function function)
+{
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < repeats; i++) function();
+    const double seconds = timer.nsecsElapsed() / 1e9;
+
+    const double megabytes = (static_cast<double>(document.size()) * repeats) / (1024.0 * 1024.0);
+    printf("%-32s %8.1f MB/s\n", name, megabytes / seconds);
+}
+
+int main(int argc, char *argv[])
+{
+    // The number of fields can be given on the command line
+    const int numberOfFields = argc > 1 ? atoi(argv[1]) : 100000;
+    const int repeats = 3;
+
+    // Skip over a whole metadata document
+    const std::string document = makeDocument(numberOfFields);
+    printf("Metadata document: %d fields, %zu bytes\n", numberOfFields, document.size());
+
+    runBenchmark("Previous reader (istream)", document, repeats, [&]() {
+        std::istringstream input(document);
+        StreamJsonReader reader(input);
+        reader.discard();
+    });
+    runBenchmark("JsonReader (istream)", document, repeats, [&]() {
+        std::istringstream input(document);
+        JsonReader reader(input);
+        reader.discard();
+    });
+    runBenchmark("JsonReader (memory)", document, repeats, [&]() {
+        JsonReader reader(document.data(), document.size());
+        reader.discard();
+    });
+
+    // Convert numbers
+    const std::string numbers = makeNumberArray(numberOfFields * 10);
+    printf("Number array: %d values, %zu bytes\n", numberOfFields * 10, numbers.size());
+
+    double expectedSum;
+    {
+        std::istringstream input(numbers);
+        StreamJsonReader reader(input);
+        expectedSum = sumNumberArray(reader);
+    }
+
+    runBenchmark("Previous reader (istream)", numbers, repeats, [&]() {
+        std::istringstream input(numbers);
+        StreamJsonReader reader(input);
+        if (sumNumberArray(reader) != expectedSum) exit(1);
+    });
+    runBenchmark("JsonReader (istream)", numbers, repeats, [&]() {
+        std::istringstream input(numbers);
+        JsonReader reader(input);
+        if (sumNumberArray(reader) != expectedSum) exit(1);
+    });
+    runBenchmark("JsonReader (memory)", numbers, repeats, [&]() {
+        JsonReader reader(numbers.data(), numbers.size());
+        if (sumNumberArray(reader) != expectedSum) exit(1);
+    });
+
+    return 0;
+}
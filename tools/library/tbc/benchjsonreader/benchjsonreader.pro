@@ -0,0 +1,14 @@
+CONFIG += c++17
+CONFIG -= app_bundle
+
+SOURCES += \
+    benchjsonreader.cpp \
+    ../jsonio.cpp
+
+HEADERS += \
+    ../jsonio.h
+
+INCLUDEPATH += \
+    ..
+
+target.CONFIG += no_default_install
@@ -0,0 +1,251 @@
+/************************************************************************
+
+    binarymetadata.cpp
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include "binarymetadata.h"
+
+#include <QDebug>
+#include <QFileInfo>
+
+static const char MAGIC[] = "LDMETA\0\1";
+static constexpr qint32 MAGIC_SIZE = 8;
+
+const char BinaryMetadata::FILE_SUFFIX[] = ".ldmeta";
+
+// Round a file position up to a multiple of 8 bytes
+static qint64 alignPosition(qint64 position)
+{
+    return (position + 7) & ~static_cast<qint64>(7);
+}
+
+// Return the size in bytes of an element of a column type, or 0 if the type
+// is unknown
+static qint64 elementSize(quint32 type)
+{
+    switch (type) {
+    case BinaryMetadata::TYPE_INT32:
+    case BinaryMetadata::TYPE_UINT32:
+        return 4;
+    case BinaryMetadata::TYPE_INT64:
+    case BinaryMetadata::TYPE_DOUBLE:
+        return 8;
+    default:
+        return 0;
+    }
+}
+
+// Return true if fileName is a binary metadata file (regardless of its name)
+bool BinaryMetadata::isBinary(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    return file.read(MAGIC_SIZE) == QByteArray(MAGIC, MAGIC_SIZE);
+}
+
+// If jsonFileName is a .json file that doesn't exist, but there is a binary
+// metadata file with the same name (with FILE_SUFFIX in place of .json),
+// return the binary file's name. Otherwise, return an empty string.
+QString BinaryMetadata::getSidecarFileName(const QString &jsonFileName)
+{
+    if (!jsonFileName.endsWith(".json") || QFileInfo::exists(jsonFileName)) return QString();
+
+    const QString binaryFileName = jsonFileName.left(jsonFileName.size() - 5) + FILE_SUFFIX;
+    if (!QFileInfo::exists(binaryFileName)) return QString();
+
+    return binaryFileName;
+}
+
+// BinaryMetadataReader -------------------------------------------------------------------------------------------
+
+BinaryMetadataReader::BinaryMetadataReader()
+{
+    mappedFile = nullptr;
+    fileData = nullptr;
+    fileSize = 0;
+    numberOfFields = 0;
+    numberOfDropOuts = 0;
+    parametersLength = 0;
+}
+
+BinaryMetadataReader::~BinaryMetadataReader()
+{
+    close();
+}
+
+// Open a binary metadata file, and check its header and column directory.
+// Returns true on success.
+bool BinaryMetadataReader::open(const QString &fileName)
+{
+    close();
+
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCritical() << "Opening binary metadata file" << fileName << "failed:" << file.errorString();
+        return false;
+    }
+
+    // Map the file if possible; if not, read all of it
+    fileSize = file.size();
+    mappedFile = fileSize > 0 ? file.map(0, fileSize) : nullptr;
+    if (mappedFile != nullptr) {
+        fileData = mappedFile;
+    } else {
+        fileContents = file.readAll();
+        if (fileContents.size() != fileSize) {
+            qCritical() << "Reading binary metadata file" << fileName << "failed:" << file.errorString();
+            close();
+            return false;
+        }
+        fileData = reinterpret_cast<const uchar *>(fileContents.constData());
+    }
+
+    // Read the header
+    if (fileSize < BinaryMetadata::HEADER_SIZE || memcmp(fileData, MAGIC, MAGIC_SIZE) != 0) {
+        qCritical() << "Binary metadata file" << fileName << "has an invalid header";
+        close();
+        return false;
+    }
+    numberOfFields = static_cast<qint32>(BinaryMetadata::load<quint32>(fileData + 8));
+    const qint32 numberOfColumns = static_cast<qint32>(BinaryMetadata::load<quint32>(fileData + 12));
+    numberOfDropOuts = static_cast<qint64>(BinaryMetadata::load<quint64>(fileData + 16));
+    parametersLength = static_cast<qint64>(BinaryMetadata::load<quint64>(fileData + 24));
+
+    const qint64 directoryPosition = alignPosition(BinaryMetadata::HEADER_SIZE + parametersLength);
+    if (numberOfFields < 0 || numberOfColumns < 0 || numberOfDropOuts < 0 || parametersLength < 0
+        || directoryPosition + (static_cast<qint64>(numberOfColumns) * BinaryMetadata::DIRECTORY_ENTRY_SIZE) > fileSize) {
+        qCritical() << "Binary metadata file" << fileName << "is truncated";
+        close();
+        return false;
+    }
+
+    // Read the column directory, checking each column is within the file
+    for (qint32 i = 0; i < numberOfColumns; i++) {
+        const uchar *entry = fileData + directoryPosition + (static_cast<qint64>(i) * BinaryMetadata::DIRECTORY_ENTRY_SIZE);
+        const quint32 id = BinaryMetadata::load<quint32>(entry);
+        const quint32 type = BinaryMetadata::load<quint32>(entry + 4);
+        const qint64 count = static_cast<qint64>(BinaryMetadata::load<quint64>(entry + 8));
+        const qint64 position = static_cast<qint64>(BinaryMetadata::load<quint64>(entry + 16));
+
+        const qint64 size = elementSize(type);
+        if (size == 0) continue;
+
+        if (count < 0 || position < 0 || count > (fileSize / size) || position > fileSize - (count * size)) {
+            qCritical() << "Binary metadata file" << fileName << "has a corrupt column directory";
+            close();
+            return false;
+        }
+
+        columns.insert(id, ColumnEntry {static_cast<BinaryMetadata::ColumnType>(type), count, position});
+    }
+
+    return true;
+}
+
+void BinaryMetadataReader::close()
+{
+    if (mappedFile != nullptr) {
+        file.unmap(const_cast<uchar *>(mappedFile));
+        mappedFile = nullptr;
+    }
+    file.close();
+    fileContents.clear();
+    fileData = nullptr;
+    fileSize = 0;
+    numberOfFields = 0;
+    numberOfDropOuts = 0;
+    parametersLength = 0;
+    columns.clear();
+}
+
+// Get the parameters, as JSON
+std::string BinaryMetadataReader::getParameters() const
+{
+    return std::string(reinterpret_cast<const char *>(fileData + BinaryMetadata::HEADER_SIZE),
+                       static_cast<size_t>(parametersLength));
+}
+
+// BinaryMetadataWriter -------------------------------------------------------------------------------------------
+
+BinaryMetadataWriter::BinaryMetadataWriter(qint32 _numberOfFields, qint64 _numberOfDropOuts)
+    : numberOfFields(_numberOfFields), numberOfDropOuts(_numberOfDropOuts)
+{
+}
+
+// Set the parameters, as JSON
+void BinaryMetadataWriter::setParameters(const std::string &_parameters)
+{
+    parameters = QByteArray(_parameters.data(), static_cast<qint32>(_parameters.size()));
+}
+
+// Write the file. Returns true on success.
+bool BinaryMetadataWriter::write(const QString &fileName) const
+{
+    // Lay out the file
+    const qint64 directoryPosition = alignPosition(BinaryMetadata::HEADER_SIZE + parameters.size());
+    qint64 position = alignPosition(directoryPosition
+                                    + (static_cast<qint64>(columns.size()) * BinaryMetadata::DIRECTORY_ENTRY_SIZE));
+
+    QByteArray header(static_cast<qint32>(directoryPosition + (columns.size() * BinaryMetadata::DIRECTORY_ENTRY_SIZE)),
+                      '\0');
+    uchar *headerData = reinterpret_cast<uchar *>(header.data());
+    memcpy(headerData, MAGIC, MAGIC_SIZE);
+    BinaryMetadata::store<quint32>(static_cast<quint32>(numberOfFields), headerData + 8);
+    BinaryMetadata::store<quint32>(static_cast<quint32>(columns.size()), headerData + 12);
+    BinaryMetadata::store<quint64>(static_cast<quint64>(numberOfDropOuts), headerData + 16);
+    BinaryMetadata::store<quint64>(static_cast<quint64>(parameters.size()), headerData + 24);
+    memcpy(headerData + BinaryMetadata::HEADER_SIZE, parameters.constData(), static_cast<size_t>(parameters.size()));
+
+    QVector<qint64> positions;
+    for (qint32 i = 0; i < columns.size(); i++) {
+        uchar *entry = headerData + directoryPosition + (i * BinaryMetadata::DIRECTORY_ENTRY_SIZE);
+        BinaryMetadata::store<quint32>(columns[i].id, entry);
+        BinaryMetadata::store<quint32>(columns[i].type, entry + 4);
+        BinaryMetadata::store<quint64>(static_cast<quint64>(columns[i].count), entry + 8);
+        BinaryMetadata::store<quint64>(static_cast<quint64>(position), entry + 16);
+
+        positions.append(position);
+        position = alignPosition(position + columns[i].data.size());
+    }
+
+    // Write the header, directory and columns
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCritical() << "Opening binary metadata output file" << fileName << "failed:" << file.errorString();
+        return false;
+    }
+
+    bool success = file.write(header) == header.size();
+    for (qint32 i = 0; success && i < columns.size(); i++) {
+        const QByteArray padding(static_cast<qint32>(positions[i] - file.pos()), '\0');
+        success = file.write(padding) == padding.size() && file.write(columns[i].data) == columns[i].data.size();
+    }
+    file.close();
+
+    if (!success) {
+        qCritical() << "Writing binary metadata output file" << fileName << "failed";
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,267 @@
+/************************************************************************
+
+    binarymetadata.h
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef BINARYMETADATA_H
+#define BINARYMETADATA_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <QtEndian>
+#include <cstring>
+#include <string>
+
+// Binary columnar metadata files.
+//
+// These hold the same information as a .tbc.json file, but are much quicker
+// to read: each per-field value is stored in a column of fixed-width values,
+// so reading a column is a single pass over memory, and the file can be mapped
+// rather than parsed. The layout is (all integers little-endian, and doubles
+// as little-endian IEEE 754 bit patterns, so values round-trip exactly):
+//
+//   Header (HEADER_SIZE bytes):
+//     8 bytes   magic "LDMETA\0\1"
+//     quint32   number of fields
+//     quint32   number of columns
+//     quint64   number of dropouts
+//     quint64   length of the parameters, in bytes
+//   Parameters: the videoParameters and pcmAudioParameters members of the
+//     JSON metadata, as a JSON object
+//   Column directory: for each column, 24 bytes:
+//     quint32   column ID (see ColumnId)
+//     quint32   element type (see ColumnType)
+//     quint64   number of elements
+//     quint64   position of the first element in the file (8-byte aligned)
+//   Columns
+//
+// Field columns have one element per field. The dropouts for all the fields
+// are kept in a separate table of DROPOUT_* columns, with one element per
+// dropout; the FIELD_DROPOUTS_START column gives the index of each field's
+// first dropout in the table, with an extra element at the end. Columns that
+// are missing take their default values, and unknown columns are ignored.
+class BinaryMetadata
+{
+public:
+    static constexpr qint32 HEADER_SIZE = 32;
+    static constexpr qint32 DIRECTORY_ENTRY_SIZE = 24;
+
+    // The suffix used for binary metadata files, in place of .json
+    static const char FILE_SUFFIX[];
+
+    enum ColumnId : quint32 {
+        FIELD_SEQ_NO = 1,
+        FIELD_FLAGS,
+        FIELD_SYNC_CONF,
+        FIELD_MEDIAN_BURST_IRE,
+        FIELD_FIELD_PHASE_ID,
+        FIELD_AUDIO_SAMPLES,
+        FIELD_DISK_LOC,
+        FIELD_FILE_LOC,
+        FIELD_DECODE_FAULTS,
+        FIELD_EFM_T_VALUES,
+        FIELD_VITS_WSNR,
+        FIELD_VITS_BPSNR,
+        FIELD_VBI_DATA_0,
+        FIELD_VBI_DATA_1,
+        FIELD_VBI_DATA_2,
+        FIELD_NTSC_FM_CODE_DATA,
+        FIELD_NTSC_CC_DATA_0,
+        FIELD_NTSC_CC_DATA_1,
+        FIELD_DROPOUTS_START,
+        DROPOUT_STARTX,
+        DROPOUT_ENDX,
+        DROPOUT_FIELD_LINE,
+    };
+
+    // Bits in the FIELD_FLAGS column
+    enum FieldFlag : quint32 {
+        FLAG_IS_FIRST_FIELD = 1 << 0,
+        FLAG_PAD = 1 << 1,
+        FLAG_VITS_IN_USE = 1 << 2,
+        FLAG_VBI_IN_USE = 1 << 3,
+        FLAG_NTSC_IN_USE = 1 << 4,
+        FLAG_NTSC_IS_FM_CODE_DATA_VALID = 1 << 5,
+        FLAG_NTSC_FIELD_FLAG = 1 << 6,
+        FLAG_NTSC_WHITE_FLAG = 1 << 7,
+    };
+
+    enum ColumnType : quint32 {
+        TYPE_INT32 = 1,
+        TYPE_UINT32,
+        TYPE_INT64,
+        TYPE_DOUBLE,
+    };
+
+    static bool isBinary(const QString &fileName);
+    static QString getSidecarFileName(const QString &jsonFileName);
+
+    // Element types and conversions to and from the file's byte order
+    static ColumnType typeOf(qint32) { return TYPE_INT32; }
+    static ColumnType typeOf(quint32) { return TYPE_UINT32; }
+    static ColumnType typeOf(qint64) { return TYPE_INT64; }
+    static ColumnType typeOf(double) { return TYPE_DOUBLE; }
+
+    template <typename T>
+    static T load(const uchar *src) {
+        return qFromLittleEndian<T>(src);
+    }
+    template <typename T>
+    static void store(T value, uchar *dest) {
+        qToLittleEndian<T>(value, dest);
+    }
+};
+
+template <>
+inline double BinaryMetadata::load<double>(const uchar *src)
+{
+    const quint64 bits = qFromLittleEndian<quint64>(src);
+    double value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+template <>
+inline void BinaryMetadata::store<double>(double value, uchar *dest)
+{
+    quint64 bits;
+    memcpy(&bits, &value, sizeof(bits));
+    qToLittleEndian<quint64>(bits, dest);
+}
+
+// Reader for binary metadata files. The file is mapped into memory if
+// possible, and columns are read directly from the mapping.
+class BinaryMetadataReader
+{
+public:
+    // A read-only view of a column. If the column isn't in the file (or has
+    // the wrong type), the view is empty.
+    template <typename T>
+    class Column
+    {
+    public:
+        qint64 size() const {
+            return count;
+        }
+        bool empty() const {
+            return count == 0;
+        }
+        T operator[](qint64 index) const {
+            return BinaryMetadata::load<T>(data + (index * static_cast<qint64>(sizeof(T))));
+        }
+
+    private:
+        friend class BinaryMetadataReader;
+
+        const uchar *data = nullptr;
+        qint64 count = 0;
+    };
+
+    BinaryMetadataReader();
+    ~BinaryMetadataReader();
+
+    // Prevent copying or assignment
+    BinaryMetadataReader(const BinaryMetadataReader &) = delete;
+    BinaryMetadataReader& operator=(const BinaryMetadataReader &) = delete;
+
+    bool open(const QString &fileName);
+    void close();
+
+    qint32 getNumberOfFields() const {
+        return numberOfFields;
+    }
+    qint64 getNumberOfDropOuts() const {
+        return numberOfDropOuts;
+    }
+    std::string getParameters() const;
+
+    template <typename T>
+    Column<T> getColumn(BinaryMetadata::ColumnId id) const {
+        Column<T> column;
+        if (!columns.contains(id)) return column;
+
+        const ColumnEntry entry = columns.value(id);
+        if (entry.type == BinaryMetadata::typeOf(T())) {
+            column.data = fileData + entry.position;
+            column.count = entry.count;
+        }
+        return column;
+    }
+
+private:
+    struct ColumnEntry {
+        BinaryMetadata::ColumnType type;
+        qint64 count;
+        qint64 position;
+    };
+
+    QFile file;
+    const uchar *mappedFile;
+    QByteArray fileContents;
+    const uchar *fileData;
+    qint64 fileSize;
+
+    qint32 numberOfFields;
+    qint64 numberOfDropOuts;
+    qint64 parametersLength;
+    QHash<quint32, ColumnEntry> columns;
+};
+
+// Writer for binary metadata files
+class BinaryMetadataWriter
+{
+public:
+    BinaryMetadataWriter(qint32 numberOfFields, qint64 numberOfDropOuts);
+
+    void setParameters(const std::string &parameters);
+
+    template <typename T>
+    void addColumn(BinaryMetadata::ColumnId id, const QVector<T> &values) {
+        QByteArray data(values.size() * static_cast<qint32>(sizeof(T)), '\0');
+        uchar *dest = reinterpret_cast<uchar *>(data.data());
+        for (const T &value : values) {
+            BinaryMetadata::store<T>(value, dest);
+            dest += sizeof(T);
+        }
+        columns.append({id, BinaryMetadata::typeOf(T()), values.size(), data});
+    }
+
+    bool write(const QString &fileName) const;
+
+private:
+    struct ColumnData {
+        BinaryMetadata::ColumnId id;
+        BinaryMetadata::ColumnType type;
+        qint64 count;
+        QByteArray data;
+    };
+
+    qint32 numberOfFields;
+    qint64 numberOfDropOuts;
+    QByteArray parameters;
+    QVector<ColumnData> columns;
+};
+
+#endif // BINARYMETADATA_H
@@ -0,0 +1,397 @@
+/************************************************************************
+
+    compressedtbc.cpp
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include "compressedtbc.h"
+
+#include "parallelfor.h"
+
+#include <QtEndian>
+
+#include <cstring>
+#include <vector>
+
+// The file magic, including the format version
+static const char MAGIC[8] = {'L', 'D', 'T', 'B', 'C', 'Z', '\0', '\1'};
+
+// Predictors that can be selected for each line
+enum Predictor {
+    PREDICT_LEFT = 0,   // Previous sample on the same line
+    PREDICT_UP1 = 1,    // Same sample, 1 line above
+    PREDICT_UP2 = 2,    // Same sample, 2 lines above (same NTSC subcarrier phase)
+    PREDICT_UP4 = 3,    // Same sample, 4 lines above (same PAL subcarrier phase)
+    NUM_PREDICTORS = 4
+};
+
+// Number of lines above the current line that each predictor uses
+static const qint32 PREDICTOR_LINES[NUM_PREDICTORS] = {0, 1, 2, 4};
+
+// Rice coding parameters. Residuals whose quotient would be ESCAPE_QUOTIENT or
+// more are written as ESCAPE_QUOTIENT 1 bits followed by the raw value.
+static constexpr qint32 MAX_RICE_K = 16;
+static constexpr qint32 ESCAPE_QUOTIENT = 24;
+static constexpr qint32 RAW_BITS = 17;
+static constexpr qint32 PREDICTOR_BITS = 2;
+static constexpr qint32 RICE_K_BITS = 5;
+
+// Get the prediction for sample x of a line
+static inline qint32 predict(const quint16 *line, qint32 x, qint32 fieldWidth, qint32 predictor)
+{
+    if (predictor == PREDICT_LEFT) {
+        // The first sample on the line has nothing to predict from
+        return (x != 0) ? line[x - 1] : 0;
+    }
+
+    return line[x - (PREDICTOR_LINES[predictor] * fieldWidth)];
+}
+
+// Map a signed residual to an unsigned value (0, -1, 1, -2, 2...)
+static inline quint32 zigZag(qint32 value)
+{
+    return (static_cast<quint32>(value) << 1) ^ static_cast<quint32>(value >> 31);
+}
+
+static inline qint32 unZigZag(quint32 value)
+{
+    return static_cast<qint32>(value >> 1) ^ -static_cast<qint32>(value & 1);
+}
+
+// Write bits MSB-first into a buffer that's big enough for the worst case
+class BitWriter
+{
+public:
+    explicit BitWriter(quint8 *_output)
+        : output(_output), position(0), buffer(0), bufferBits(0) {}
+
+    // Write the low bits of value (bits <= 32)
+    void write(quint32 value, qint32 bits) {
+        if (bits == 0) return;
+        buffer = (buffer << bits) | (value & (0xFFFFFFFFULL >> (32 - bits)));
+        bufferBits += bits;
+        while (bufferBits >= 8) {
+            bufferBits -= 8;
+            output[position++] = static_cast<quint8>(buffer >> bufferBits);
+        }
+    }
+
+    // Pad to a byte boundary, and return the number of bytes written
+    qint64 finish() {
+        if (bufferBits > 0) write(0, 8 - bufferBits);
+        return position;
+    }
+
+private:
+    quint8 *output;
+    qint64 position;
+    quint64 buffer;
+    qint32 bufferBits;
+};
+
+// Read bits MSB-first. Reading past the end of the input returns 0 bits, and
+// sets the overrun flag.
+class BitReader
+{
+public:
+    BitReader(const quint8 *_input, qint64 _length)
+        : input(_input), length(_length), position(0), buffer(0), bufferBits(0), overrun(false) {}
+
+    quint32 read(qint32 bits) {
+        if (bits == 0) return 0;
+        refill();
+        const quint32 value = static_cast<quint32>(buffer >> (64 - bits));
+        consume(bits);
+        return value;
+    }
+
+    // Count up to maxOnes leading 1 bits. If there are fewer than maxOnes,
+    // the terminating 0 bit is also consumed.
+    qint32 readUnary(qint32 maxOnes) {
+        refill();
+        const quint64 inverted = ~buffer;
+        qint32 ones;
+        if (inverted == 0) {
+            ones = 64;
+        } else {
+#if defined(__GNUC__) || defined(__clang__)
+            ones = __builtin_clzll(inverted);
+#else
+            ones = 0;
+            while ((inverted & (0x8000000000000000ULL >> ones)) == 0) ones++;
+#endif
+        }
+
+        if (ones >= maxOnes) {
+            consume(maxOnes);
+            return maxOnes;
+        }
+        consume(ones + 1);
+        return ones;
+    }
+
+    bool isOverrun() const {
+        return overrun;
+    }
+
+private:
+    void refill() {
+        while (bufferBits <= 56) {
+            if (position < length) buffer |= static_cast<quint64>(input[position]) << (56 - bufferBits);
+            else padBits += 8;
+            position++;
+            bufferBits += 8;
+        }
+    }
+
+    void consume(qint32 bits) {
+        buffer <<= bits;
+        bufferBits -= bits;
+        if (bufferBits < padBits) overrun = true;
+    }
+
+    const quint8 *input;
+    const qint64 length;
+    qint64 position;
+    quint64 buffer;
+    qint32 bufferBits;
+    qint32 padBits = 0;
+    bool overrun;
+};
+
+// Container handling -------------------------------------------------------------------------------------------------
+
+// Return true if start (the first bytes of a file) is a compressed TBC header
+bool CompressedTbc::isCompressed(const QByteArray &start)
+{
+    return start.size() >= static_cast<qint32>(sizeof(MAGIC)) && memcmp(start.constData(), MAGIC, sizeof(MAGIC)) == 0;
+}
+
+// Parse a header. Returns false if it's not valid.
+bool CompressedTbc::readHeader(const QByteArray &data, Header &header)
+{
+    if (data.size() < HEADER_SIZE || !isCompressed(data)) return false;
+
+    const uchar *bytes = reinterpret_cast<const uchar *>(data.constData());
+    header.fieldWidth = static_cast<qint32>(qFromLittleEndian<quint32>(bytes + 8));
+    header.fieldHeight = static_cast<qint32>(qFromLittleEndian<quint32>(bytes + 12));
+    header.numberOfFields = static_cast<qint32>(qFromLittleEndian<quint32>(bytes + 16));
+    header.indexPosition = static_cast<qint64>(qFromLittleEndian<quint64>(bytes + 24));
+
+    return header.fieldWidth > 0 && header.fieldHeight > 0 && header.numberOfFields >= 0
+           && header.indexPosition >= HEADER_SIZE;
+}
+
+QByteArray CompressedTbc::makeHeader(const Header &header)
+{
+    QByteArray data(HEADER_SIZE, '\0');
+    uchar *bytes = reinterpret_cast<uchar *>(data.data());
+
+    memcpy(bytes, MAGIC, sizeof(MAGIC));
+    qToLittleEndian<quint32>(static_cast<quint32>(header.fieldWidth), bytes + 8);
+    qToLittleEndian<quint32>(static_cast<quint32>(header.fieldHeight), bytes + 12);
+    qToLittleEndian<quint32>(static_cast<quint32>(header.numberOfFields), bytes + 16);
+    qToLittleEndian<quint64>(static_cast<quint64>(header.indexPosition), bytes + 24);
+
+    return data;
+}
+
+// Field coding -------------------------------------------------------------------------------------------------------
+
+// Compress a field, replacing the contents of output
+void CompressedTbc::encodeField(const quint16 *samples, qint32 fieldWidth, qint32 fieldHeight, QByteArray &output)
+{
+    // Allocate enough space for the worst case
+    const qint64 maxBits = static_cast<qint64>(fieldHeight) * (PREDICTOR_BITS + RICE_K_BITS)
+                           + static_cast<qint64>(fieldWidth) * fieldHeight * (ESCAPE_QUOTIENT + RAW_BITS);
+    std::vector<quint8> buffer(static_cast<size_t>((maxBits + 7) / 8));
+    BitWriter writer(buffer.data());
+
+    for (qint32 y = 0; y < fieldHeight; y++) {
+        const quint16 *line = samples + (static_cast<qint64>(y) * fieldWidth);
+
+        // Choose the predictor that gives the smallest residuals
+        qint32 bestPredictor = PREDICT_LEFT;
+        quint64 bestSum = ~0ULL;
+        for (qint32 predictor = 0; predictor < NUM_PREDICTORS; predictor++) {
+            if (y < PREDICTOR_LINES[predictor]) continue;
+
+            quint64 sum = 0;
+            for (qint32 x = 0; x < fieldWidth; x++) {
+                sum += zigZag(static_cast<qint32>(line[x]) - predict(line, x, fieldWidth, predictor));
+            }
+            if (sum < bestSum) {
+                bestSum = sum;
+                bestPredictor = predictor;
+            }
+        }
+
+        // Choose the Rice parameter, so 2^k is roughly the mean residual
+        qint32 k = 0;
+        while (k < MAX_RICE_K && (static_cast<quint64>(fieldWidth) << (k + 1)) <= bestSum) k++;
+
+        writer.write(static_cast<quint32>(bestPredictor), PREDICTOR_BITS);
+        writer.write(static_cast<quint32>(k), RICE_K_BITS);
+
+        // Write the residuals
+        for (qint32 x = 0; x < fieldWidth; x++) {
+            const quint32 value = zigZag(static_cast<qint32>(line[x]) - predict(line, x, fieldWidth, bestPredictor));
+            const quint32 quotient = value >> k;
+
+            if (quotient < static_cast<quint32>(ESCAPE_QUOTIENT)) {
+                // quotient 1 bits, a 0 bit, then the low k bits
+                writer.write((1U << (quotient + 1)) - 2, static_cast<qint32>(quotient) + 1);
+                writer.write(value, k);
+            } else {
+                writer.write((1U << ESCAPE_QUOTIENT) - 1, ESCAPE_QUOTIENT);
+                writer.write(value, RAW_BITS);
+            }
+        }
+    }
+
+    const qint64 length = writer.finish();
+    output = QByteArray(reinterpret_cast<const char *>(buffer.data()), static_cast<qint32>(length));
+}
+
+// Decompress a field into samples (which must have space for the whole field).
+// Returns false if the input is corrupt.
+bool CompressedTbc::decodeField(const char *input, qint64 inputLength, qint32 fieldWidth, qint32 fieldHeight,
+                                quint16 *samples)
+{
+    BitReader reader(reinterpret_cast<const quint8 *>(input), inputLength);
+
+    for (qint32 y = 0; y < fieldHeight; y++) {
+        quint16 *line = samples + (static_cast<qint64>(y) * fieldWidth);
+
+        const qint32 predictor = static_cast<qint32>(reader.read(PREDICTOR_BITS));
+        const qint32 k = static_cast<qint32>(reader.read(RICE_K_BITS));
+        if (y < PREDICTOR_LINES[predictor] || k > MAX_RICE_K) return false;
+
+        for (qint32 x = 0; x < fieldWidth; x++) {
+            const qint32 quotient = reader.readUnary(ESCAPE_QUOTIENT);
+            quint32 value;
+            if (quotient < ESCAPE_QUOTIENT) {
+                value = (static_cast<quint32>(quotient) << k) | reader.read(k);
+            } else {
+                value = reader.read(RAW_BITS);
+            }
+
+            const qint32 sample = predict(line, x, fieldWidth, predictor) + unZigZag(value);
+            if (sample < 0 || sample > 65535) return false;
+            line[x] = static_cast<quint16>(sample);
+        }
+
+        if (reader.isOverrun()) return false;
+    }
+
+    return true;
+}
+
+// CompressedTbcWriter ------------------------------------------------------------------------------------------------
+
+CompressedTbcWriter::CompressedTbcWriter()
+{
+    isOpen = false;
+    maxThreads = 1;
+}
+
+CompressedTbcWriter::~CompressedTbcWriter()
+{
+    if (isOpen) close();
+}
+
+// Create a compressed TBC file. Returns true on success.
+bool CompressedTbcWriter::open(QString filename, qint32 fieldWidth, qint32 fieldHeight, qint32 _maxThreads)
+{
+    outputFile.setFileName(filename);
+    if (!outputFile.open(QIODevice::WriteOnly)) {
+        qWarning() << "Could not open" << filename << "as compressed TBC output file";
+        return false;
+    }
+
+    header.fieldWidth = fieldWidth;
+    header.fieldHeight = fieldHeight;
+    header.numberOfFields = 0;
+    header.indexPosition = 0;
+    maxThreads = _maxThreads;
+    fieldPositions.clear();
+
+    // Write a placeholder header; the real one is written by close()
+    if (outputFile.write(CompressedTbc::makeHeader(header)) != CompressedTbc::HEADER_SIZE) {
+        qWarning() << "Could not write to compressed TBC output file";
+        outputFile.close();
+        return false;
+    }
+    fieldPositions.append(CompressedTbc::HEADER_SIZE);
+
+    isOpen = true;
+    return true;
+}
+
+// Compress and write count fields, stored one after another in samples.
+// Returns true on success.
+bool CompressedTbcWriter::writeFields(const quint16 *samples, qint32 count)
+{
+    const qint64 fieldLength = static_cast<qint64>(header.fieldWidth) * header.fieldHeight;
+
+    // Compress the fields in parallel
+    QVector<QByteArray> compressedFields(count);
+    parallelFor(count, maxThreads, [&](qint32 i) {
+        CompressedTbc::encodeField(samples + (fieldLength * i), header.fieldWidth, header.fieldHeight,
+                                   compressedFields[i]);
+    });
+
+    // Write them out in order
+    for (qint32 i = 0; i < count; i++) {
+        if (outputFile.write(compressedFields[i]) != compressedFields[i].size()) {
+            qWarning() << "Could not write to compressed TBC output file";
+            return false;
+        }
+        fieldPositions.append(fieldPositions.last() + compressedFields[i].size());
+        header.numberOfFields++;
+    }
+
+    return true;
+}
+
+// Write the field index and header, and close the file. Returns true on success.
+bool CompressedTbcWriter::close()
+{
+    if (!isOpen) return false;
+    isOpen = false;
+
+    // Write the field index
+    header.indexPosition = fieldPositions.last();
+    QByteArray index(fieldPositions.size() * static_cast<qint32>(sizeof(quint64)), '\0');
+    for (qint32 i = 0; i < fieldPositions.size(); i++) {
+        qToLittleEndian<quint64>(static_cast<quint64>(fieldPositions[i]),
+                                 reinterpret_cast<uchar *>(index.data()) + (i * sizeof(quint64)));
+    }
+
+    // Rewrite the header, now the number of fields and the index position are known
+    bool success = outputFile.write(index) == index.size()
+                   && outputFile.seek(0)
+                   && outputFile.write(CompressedTbc::makeHeader(header)) == CompressedTbc::HEADER_SIZE;
+    if (!success) qWarning() << "Could not write to compressed TBC output file";
+
+    outputFile.close();
+    return success;
+}
@@ -0,0 +1,102 @@
+/************************************************************************
+
+    compressedtbc.h
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef COMPRESSEDTBC_H
+#define COMPRESSEDTBC_H
+
+#include <QByteArray>
+#include <QDebug>
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+// Lossless compressed TBC files.
+//
+// A compressed TBC file contains the same fields as a raw TBC file, but each
+// field is compressed separately, so any field can be read without decoding
+// the rest of the file. The layout is (all integers little-endian):
+//
+//   Header (HEADER_SIZE bytes):
+//     8 bytes   magic "LDTBCZ\0\1"
+//     quint32   field width, in samples
+//     quint32   field height, in lines
+//     quint32   number of fields
+//     quint32   reserved (0)
+//     quint64   position of the field index
+//   Compressed fields, one after another
+//   Field index: (number of fields + 1) quint64 positions. Entry N is the
+//     position of field N (zero-based); the last entry is the end of the
+//     last field.
+//
+// Each line of a field is coded with one of several predictors (the previous
+// sample, or the sample 1, 2 or 4 lines above, which follow the chroma
+// subcarrier phase for NTSC and PAL), chosen per line by the encoder. The
+// prediction residuals are Rice-coded, with a per-line Rice parameter.
+class CompressedTbc
+{
+public:
+    static constexpr qint32 HEADER_SIZE = 32;
+
+    struct Header {
+        qint32 fieldWidth;
+        qint32 fieldHeight;
+        qint32 numberOfFields;
+        qint64 indexPosition;
+    };
+
+    // Container handling
+    static bool isCompressed(const QByteArray &start);
+    static bool readHeader(const QByteArray &data, Header &header);
+    static QByteArray makeHeader(const Header &header);
+
+    // Field coding
+    static void encodeField(const quint16 *samples, qint32 fieldWidth, qint32 fieldHeight, QByteArray &output);
+    static bool decodeField(const char *input, qint64 inputLength, qint32 fieldWidth, qint32 fieldHeight,
+                            quint16 *samples);
+};
+
+// Writer for compressed TBC files
+class CompressedTbcWriter
+{
+public:
+    CompressedTbcWriter();
+    ~CompressedTbcWriter();
+
+    // Prevent copying or assignment
+    CompressedTbcWriter(const CompressedTbcWriter &) = delete;
+    CompressedTbcWriter& operator=(const CompressedTbcWriter &) = delete;
+
+    bool open(QString filename, qint32 fieldWidth, qint32 fieldHeight, qint32 maxThreads);
+    bool writeFields(const quint16 *samples, qint32 count);
+    bool close();
+
+private:
+    QFile outputFile;
+    bool isOpen;
+    qint32 maxThreads;
+    CompressedTbc::Header header;
+    QVector<qint64> fieldPositions;
+};
+
+#endif // COMPRESSEDTBC_H
@@ -26,6 +26,7 @@
 
 #include "jsonio.h"
 
+#include <algorithm>
 #include <cassert>
 
 DropOuts::DropOuts(const QVector<qint32> &startx, const QVector<qint32> &endx, const QVector<qint32> &fieldLine)
@@ -202,3 +203,109 @@ void DropOuts::writeArray(JsonWriter &writer, const QVector<qint32> &array) cons
 
     writer.endArray();
 }
+
+// Build the index for a field's dropouts, for a field with lines 1 to
+// fieldHeight. Dropouts with invalid lines or positions can never match, so
+// they're left out.
+DropOutIndex::DropOutIndex(const DropOuts &dropOuts, qint32 fieldHeight)
+{
+    // Sort the dropouts by line, then by start position
+    QVector<qint32> order;
+    order.reserve(dropOuts.size());
+    for (qint32 i = 0; i < dropOuts.size(); i++) {
+        const qint32 fieldLine = dropOuts.fieldLine(i);
+        if (fieldLine >= 1 && fieldLine <= fieldHeight && dropOuts.endx(i) >= dropOuts.startx(i)) order.append(i);
+    }
+    if (order.empty()) return;
+
+    std::sort(order.begin(), order.end(), [&](qint32 a, qint32 b) {
+        if (dropOuts.fieldLine(a) != dropOuts.fieldLine(b)) return dropOuts.fieldLine(a) < dropOuts.fieldLine(b);
+        return dropOuts.startx(a) < dropOuts.startx(b);
+    });
+
+    // Merge overlapping or adjacent dropouts on each line, counting the
+    // intervals for each line in m_lineStart[line + 1]
+    m_lineStart.fill(0, dropOuts.fieldLine(order.last()) + 2);
+    m_startx.reserve(order.size());
+    m_endx.reserve(order.size());
+    qint32 lastLine = -1;
+    for (qint32 i : order) {
+        const qint32 fieldLine = dropOuts.fieldLine(i);
+        if (fieldLine == lastLine && (dropOuts.startx(i) - 1) <= m_endx.last()) {
+            m_endx.last() = qMax(m_endx.last(), dropOuts.endx(i));
+        } else {
+            m_startx.append(dropOuts.startx(i));
+            m_endx.append(dropOuts.endx(i));
+            m_lineStart[fieldLine + 1]++;
+            lastLine = fieldLine;
+        }
+    }
+
+    // Turn the counts into positions
+    for (qint32 line = 1; line < m_lineStart.size(); line++) {
+        m_lineStart[line] += m_lineStart[line - 1];
+    }
+}
+
+// Clear the index
+void DropOutIndex::clear()
+{
+    m_lineStart.clear();
+    m_startx.clear();
+    m_endx.clear();
+}
+
+// Is pixel x of a line in a dropout?
+bool DropOutIndex::contains(qint32 x, qint32 fieldLine) const
+{
+    qint32 first, last;
+    if (!getLineRange(fieldLine, first, last)) return false;
+
+    // Find the last interval starting at or before x
+    const auto it = std::upper_bound(m_startx.cbegin() + first, m_startx.cbegin() + last, x);
+    if (it == m_startx.cbegin() + first) return false;
+
+    return m_endx[static_cast<qint32>(it - m_startx.cbegin()) - 1] >= x;
+}
+
+// Does any dropout on a line overlap the pixels from startx to endx inclusive?
+bool DropOutIndex::overlaps(qint32 fieldLine, qint32 startx, qint32 endx) const
+{
+    qint32 first, last;
+    if (!getLineRange(fieldLine, first, last)) return false;
+
+    // The intervals don't overlap, so their ends are sorted too. Find the
+    // first interval ending at or after startx.
+    const auto it = std::lower_bound(m_endx.cbegin() + first, m_endx.cbegin() + last, startx);
+    if (it == m_endx.cbegin() + last) return false;
+
+    return m_startx[static_cast<qint32>(it - m_endx.cbegin())] <= endx;
+}
+
+// Set each element of mask to true if that pixel of the line is in a
+// dropout, or false otherwise
+void DropOutIndex::getLineMask(qint32 fieldLine, QVector<bool> &mask) const
+{
+    mask.fill(false);
+
+    qint32 first, last;
+    if (!getLineRange(fieldLine, first, last)) return;
+
+    const qint32 width = mask.size();
+    for (qint32 i = first; i < last; i++) {
+        const qint32 startx = qMax(m_startx[i], 0);
+        const qint32 endx = qMin(m_endx[i], width - 1);
+        for (qint32 x = startx; x <= endx; x++) mask[x] = true;
+    }
+}
+
+// Get the range of positions holding a line's intervals. Returns false if
+// there aren't any.
+bool DropOutIndex::getLineRange(qint32 fieldLine, qint32 &first, qint32 &last) const
+{
+    if (fieldLine < 1 || fieldLine + 1 >= m_lineStart.size()) return false;
+
+    first = m_lineStart[fieldLine];
+    last = m_lineStart[fieldLine + 1];
+    return first != last;
+}
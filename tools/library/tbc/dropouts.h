@@ -28,6 +28,7 @@
 #include <QDebug>
 #include <QtGlobal>
 #include <QMetaType>
+#include <QVector>
 
 class JsonReader;
 class JsonWriter;
@@ -82,4 +83,46 @@ private:
     void writeArray(JsonWriter &writer, const QVector<qint32> &array) const;
 };
 
+// An index of a field's dropouts by line, for answering "is this pixel a
+// dropout?" without scanning every dropout. Each line's dropouts are kept as a
+// sorted list of non-overlapping intervals, so queries are a binary search
+// within the line.
+//
+// Lines are numbered from 1, as in DropOuts::fieldLine. As elsewhere in the
+// tools, a dropout covers the pixels from startx to endx inclusive.
+// Dropouts on lines outside the field (which can only come from bad metadata)
+// are left out of the index.
+class DropOutIndex
+{
+public:
+    DropOutIndex() = default;
+    DropOutIndex(const DropOuts &dropOuts, qint32 fieldHeight);
+
+    void clear();
+
+    // Return true if there are no dropouts
+    bool empty() const {
+        return m_startx.empty();
+    }
+
+    // Is pixel x of a line in a dropout?
+    bool contains(qint32 x, qint32 fieldLine) const;
+
+    // Does any dropout on a line overlap the pixels from startx to endx inclusive?
+    bool overlaps(qint32 fieldLine, qint32 startx, qint32 endx) const;
+
+    // Set each element of mask to true if that pixel of the line is in a
+    // dropout, or false otherwise
+    void getLineMask(qint32 fieldLine, QVector<bool> &mask) const;
+
+private:
+    // The intervals for line L are at positions m_lineStart[L] to
+    // m_lineStart[L + 1] - 1
+    QVector<qint32> m_lineStart;
+    QVector<qint32> m_startx;
+    QVector<qint32> m_endx;
+
+    bool getLineRange(qint32 fieldLine, qint32 &first, qint32 &last) const;
+};
+
 #endif // DROPOUTS_H
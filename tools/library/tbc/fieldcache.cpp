@@ -0,0 +1,339 @@
+/************************************************************************
+
+    fieldcache.cpp
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include "fieldcache.h"
+
+#include <list>
+#include <set>
+#include <utility>
+
+// Pack a key into a single integer, for use as a hash key
+static quint64 packKey(const FieldCache::Key &key)
+{
+    return (static_cast<quint64>(static_cast<quint32>(key.sourceId)) << 32) | static_cast<quint32>(key.fieldNumber);
+}
+
+// Eviction policies ----------------------------------------------------------------------------------------------
+
+// Evict the least recently inserted or accessed field
+class LruEvictionPolicy : public FieldCache::EvictionPolicy
+{
+public:
+    void inserted(const FieldCache::Key &key) override {
+        order.push_front(key);
+        positions.insert(packKey(key), order.begin());
+    }
+
+    void accessed(const FieldCache::Key &key) override {
+        // Move the field to the front of the list
+        auto it = positions.value(packKey(key));
+        order.splice(order.begin(), order, it);
+    }
+
+    void removed(const FieldCache::Key &key) override {
+        order.erase(positions.take(packKey(key)));
+    }
+
+    FieldCache::Key victim() override {
+        return order.back();
+    }
+
+private:
+    // Most recently used at the front
+    std::list<FieldCache::Key> order;
+    QHash<quint64, std::list<FieldCache::Key>::iterator> positions;
+};
+
+// Evict the lowest-numbered field, regardless of when it was used. When the
+// application is scanning forwards through the input, the fields it'll need
+// again are the most recent ones (its lookbehind), so this keeps those.
+class SequentialEvictionPolicy : public FieldCache::EvictionPolicy
+{
+public:
+    void inserted(const FieldCache::Key &key) override {
+        order.insert(std::make_pair(key.fieldNumber, key.sourceId));
+    }
+
+    void accessed(const FieldCache::Key &) override {
+    }
+
+    void removed(const FieldCache::Key &key) override {
+        order.erase(std::make_pair(key.fieldNumber, key.sourceId));
+    }
+
+    FieldCache::Key victim() override {
+        return FieldCache::Key {order.begin()->second, order.begin()->first};
+    }
+
+private:
+    std::set<std::pair<qint32, qint32>> order;
+};
+
+// FieldCache -----------------------------------------------------------------------------------------------------
+
+// One shard of the cache (everything guarded by mutex)
+struct FieldCache::Shard {
+    QMutex mutex;
+    QHash<quint64, Data> fields;
+    std::unique_ptr<EvictionPolicy> policy;
+    qint64 bytes = 0;
+
+    qint64 hits = 0;
+    qint64 misses = 0;
+    qint64 evictions = 0;
+};
+
+FieldCache::FieldCache(qint64 _byteLimit)
+    : shards(new Shard[NUM_SHARDS]), totalBytes(0), byteLimit(_byteLimit), nextSourceId(0)
+{
+    for (qint32 i = 0; i < NUM_SHARDS; i++) {
+        shards[i].policy = makeEvictionPolicy(LRU);
+    }
+}
+
+FieldCache::~FieldCache()
+{
+}
+
+FieldCache &FieldCache::global()
+{
+    static FieldCache cache;
+    return cache;
+}
+
+// Set the maximum total size of the fields in the cache, in bytes
+void FieldCache::setByteLimit(qint64 _byteLimit)
+{
+    byteLimit.storeRelaxed(_byteLimit);
+    evict(0);
+}
+
+qint64 FieldCache::getByteLimit()
+{
+    return byteLimit.loadRelaxed();
+}
+
+// Change the eviction policy. This empties the cache.
+void FieldCache::setEvictionPolicy(EvictionPolicyType type)
+{
+    for (qint32 i = 0; i < NUM_SHARDS; i++) {
+        Shard &shard = shards[i];
+        QMutexLocker locker(&shard.mutex);
+        shard.fields.clear();
+        totalBytes.fetchAndAddRelaxed(-shard.bytes);
+        shard.bytes = 0;
+        shard.policy = makeEvictionPolicy(type);
+    }
+}
+
+qint32 FieldCache::registerSource(const QString &name)
+{
+    QMutexLocker locker(&sourceMutex);
+
+    qint32 sourceId;
+    if (!name.isEmpty() && sourceIds.contains(name)) {
+        sourceId = sourceIds.value(name);
+    } else {
+        sourceId = nextSourceId++;
+        if (!name.isEmpty()) sourceIds.insert(name, sourceId);
+    }
+
+    sourceRefCounts[sourceId]++;
+    return sourceId;
+}
+
+// Release a source ID returned by registerSource. When the last user of a
+// source releases it, its fields are removed from the cache.
+void FieldCache::releaseSource(qint32 sourceId)
+{
+    {
+        QMutexLocker locker(&sourceMutex);
+
+        if (--sourceRefCounts[sourceId] > 0) return;
+
+        sourceRefCounts.remove(sourceId);
+        for (auto it = sourceIds.begin(); it != sourceIds.end(); ) {
+            if (it.value() == sourceId) it = sourceIds.erase(it);
+            else ++it;
+        }
+    }
+
+    for (qint32 i = 0; i < NUM_SHARDS; i++) {
+        Shard &shard = shards[i];
+        QMutexLocker locker(&shard.mutex);
+
+        for (auto it = shard.fields.begin(); it != shard.fields.end(); ) {
+            const Key key {static_cast<qint32>(it.key() >> 32), static_cast<qint32>(it.key() & 0xFFFFFFFF)};
+            if (key.sourceId == sourceId) {
+                const qint64 dataBytes = it.value().size() * static_cast<qint64>(sizeof(quint16));
+                shard.bytes -= dataBytes;
+                totalBytes.fetchAndAddRelaxed(-dataBytes);
+                shard.policy->removed(key);
+                it = shard.fields.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+// Look up a field. Returns true, and sets data to the field, if it's in the
+// cache.
+bool FieldCache::find(qint32 sourceId, qint32 fieldNumber, Data &data)
+{
+    Shard &shard = shards[getShardIndex(sourceId, fieldNumber)];
+    QMutexLocker locker(&shard.mutex);
+
+    const Key key {sourceId, fieldNumber};
+    auto it = shard.fields.find(packKey(key));
+    if (it == shard.fields.end()) {
+        shard.misses++;
+        return false;
+    }
+
+    shard.hits++;
+    shard.policy->accessed(key);
+    data = it.value();
+    return true;
+}
+
+// Add a field to the cache, evicting other fields if necessary
+void FieldCache::insert(qint32 sourceId, qint32 fieldNumber, const Data &data)
+{
+    const qint64 dataBytes = data.size() * static_cast<qint64>(sizeof(quint16));
+    if (dataBytes > byteLimit.loadRelaxed()) {
+        // The field would never fit
+        return;
+    }
+
+    const qint32 shardIndex = getShardIndex(sourceId, fieldNumber);
+    {
+        Shard &shard = shards[shardIndex];
+        QMutexLocker locker(&shard.mutex);
+
+        const Key key {sourceId, fieldNumber};
+        auto it = shard.fields.find(packKey(key));
+        if (it != shard.fields.end()) {
+            // Replace the existing entry
+            const qint64 oldBytes = it.value().size() * static_cast<qint64>(sizeof(quint16));
+            shard.bytes -= oldBytes;
+            totalBytes.fetchAndAddRelaxed(-oldBytes);
+            shard.policy->removed(key);
+            shard.fields.erase(it);
+        }
+
+        shard.fields.insert(packKey(key), data);
+        shard.policy->inserted(key);
+        shard.bytes += dataBytes;
+        totalBytes.fetchAndAddRelaxed(dataBytes);
+    }
+
+    // Visit the shard that was just inserted into last, so the new field is
+    // only evicted if nothing else can be
+    evict((shardIndex + 1) % NUM_SHARDS);
+}
+
+FieldCache::Statistics FieldCache::getStatistics()
+{
+    Statistics statistics {0, 0, 0, 0};
+
+    for (qint32 i = 0; i < NUM_SHARDS; i++) {
+        Shard &shard = shards[i];
+        QMutexLocker locker(&shard.mutex);
+
+        statistics.hits += shard.hits;
+        statistics.misses += shard.misses;
+        statistics.evictions += shard.evictions;
+    }
+    statistics.bytes = totalBytes.loadRelaxed();
+
+    return statistics;
+}
+
+// Show the hit rate for the user (if the cache has been used at all)
+void FieldCache::printStatistics()
+{
+    const Statistics statistics = getStatistics();
+    const qint64 lookups = statistics.hits + statistics.misses;
+    if (lookups == 0) return;
+
+    qInfo().nospace() << "Field cache: " << statistics.hits << " hits, " << statistics.misses << " misses ("
+                      << (100.0 * statistics.hits) / lookups << "% hit rate), " << statistics.evictions << " evictions";
+}
+
+// Choose the shard for a field. Consecutive fields go in different shards, so
+// that threads working on nearby fields don't contend for the same lock.
+qint32 FieldCache::getShardIndex(qint32 sourceId, qint32 fieldNumber)
+{
+    const quint32 index = static_cast<quint32>(fieldNumber) + (static_cast<quint32>(sourceId) * 7);
+    return static_cast<qint32>(index % NUM_SHARDS);
+}
+
+std::unique_ptr<FieldCache::EvictionPolicy> FieldCache::makeEvictionPolicy(EvictionPolicyType type)
+{
+    switch (type) {
+    case SEQUENTIAL:
+        return std::unique_ptr<EvictionPolicy>(new SequentialEvictionPolicy);
+    case LRU:
+    default:
+        return std::unique_ptr<EvictionPolicy>(new LruEvictionPolicy);
+    }
+}
+
+// Evict fields until the cache is within its limit. Shards are visited in
+// turn, starting with firstShard, and each gives up one field (chosen by its
+// eviction policy) per visit. Only one shard's lock is held at a time.
+void FieldCache::evict(qint32 firstShard)
+{
+    // Stop after a full pass over empty shards, in case other threads are
+    // inserting as fast as we can evict
+    qint32 emptyShards = 0;
+    for (qint32 i = firstShard; totalBytes.loadRelaxed() > byteLimit.loadRelaxed() && emptyShards < NUM_SHARDS; i = (i + 1) % NUM_SHARDS) {
+        Shard &shard = shards[i];
+        QMutexLocker locker(&shard.mutex);
+
+        if (shard.fields.isEmpty()) {
+            emptyShards++;
+            continue;
+        }
+
+        emptyShards = 0;
+        evictOne(shard);
+    }
+}
+
+// Evict one field from a shard, which must not be empty. The shard's lock
+// must be held.
+void FieldCache::evictOne(Shard &shard)
+{
+    const Key key = shard.policy->victim();
+    const quint64 packedKey = packKey(key);
+
+    const qint64 dataBytes = shard.fields.value(packedKey).size() * static_cast<qint64>(sizeof(quint16));
+    shard.bytes -= dataBytes;
+    totalBytes.fetchAndAddRelaxed(-dataBytes);
+    shard.fields.remove(packedKey);
+    shard.policy->removed(key);
+    shard.evictions++;
+}
@@ -0,0 +1,141 @@
+/************************************************************************
+
+    fieldcache.h
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef FIELDCACHE_H
+#define FIELDCACHE_H
+
+#include <QAtomicInteger>
+#include <QDebug>
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QVector>
+#include <memory>
+
+// A cache of whole TBC fields, shared between all the SourceVideo objects in
+// a process, so one memory limit applies to all of them.
+//
+// The cache is limited by the total size of the fields it holds, rather than
+// the number of fields. It is split into shards, each with its own lock, so
+// threads reading different fields don't contend with each other. The limit
+// applies to the cache as a whole; when it's exceeded, the shards are visited
+// in turn and each one's eviction policy chooses a field to discard.
+class FieldCache
+{
+public:
+    using Data = QVector<quint16>;
+
+    // The default limit on the size of the cache, in bytes
+    static constexpr qint64 DEFAULT_BYTE_LIMIT = 256 * 1024 * 1024;
+
+    // Available eviction policies
+    enum EvictionPolicyType {
+        LRU,            // Evict the least recently used field
+        SEQUENTIAL,     // Evict the lowest-numbered field (for a forward scan, this keeps only the lookbehind)
+    };
+
+    // A field within a source
+    struct Key {
+        qint32 sourceId;
+        qint32 fieldNumber;
+    };
+
+    // Interface for eviction policies. Each shard of the cache has its own
+    // policy object, which is only called with the shard's lock held.
+    class EvictionPolicy
+    {
+    public:
+        virtual ~EvictionPolicy() = default;
+
+        // A field has been added to the shard
+        virtual void inserted(const Key &key) = 0;
+
+        // A field in the shard has been returned by find
+        virtual void accessed(const Key &key) = 0;
+
+        // A field has been removed from the shard
+        virtual void removed(const Key &key) = 0;
+
+        // Choose the next field to evict (the shard will not be empty)
+        virtual Key victim() = 0;
+    };
+
+    struct Statistics {
+        qint64 hits;
+        qint64 misses;
+        qint64 evictions;
+        qint64 bytes;
+    };
+
+    FieldCache(qint64 byteLimit = DEFAULT_BYTE_LIMIT);
+    ~FieldCache();
+
+    // Prevent copying or assignment
+    FieldCache(const FieldCache &) = delete;
+    FieldCache& operator=(const FieldCache &) = delete;
+
+    // Get the cache shared by the whole process
+    static FieldCache &global();
+
+    // Configuration. Both of these discard fields if necessary.
+    void setByteLimit(qint64 byteLimit);
+    qint64 getByteLimit();
+    void setEvictionPolicy(EvictionPolicyType type);
+
+    // Get an ID for a source. Sources with the same non-empty name share the
+    // same ID (and so the same cached fields); an empty name gets a new ID.
+    qint32 registerSource(const QString &name);
+    void releaseSource(qint32 sourceId);
+
+    // Field access
+    bool find(qint32 sourceId, qint32 fieldNumber, Data &data);
+    void insert(qint32 sourceId, qint32 fieldNumber, const Data &data);
+
+    // Statistics
+    Statistics getStatistics();
+    void printStatistics();
+
+private:
+    static constexpr qint32 NUM_SHARDS = 16;
+
+    struct Shard;
+    std::unique_ptr<Shard[]> shards;
+
+    // Total size of the fields in all the shards, and the limit on it
+    QAtomicInteger<qint64> totalBytes;
+    QAtomicInteger<qint64> byteLimit;
+
+    // Source registration (guarded by sourceMutex)
+    QMutex sourceMutex;
+    QHash<QString, qint32> sourceIds;
+    QHash<qint32, qint32> sourceRefCounts;
+    qint32 nextSourceId;
+
+    qint32 getShardIndex(qint32 sourceId, qint32 fieldNumber);
+    static std::unique_ptr<EvictionPolicy> makeEvictionPolicy(EvictionPolicyType type);
+    void evict(qint32 firstShard);
+    void evictOne(Shard &shard);
+};
+
+#endif // FIELDCACHE_H
@@ -0,0 +1,429 @@
+/************************************************************************
+
+    fieldstore.cpp
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include "fieldstore.h"
+
+// The pool isn't rebuilt until it has at least this many unused positions
+static constexpr qint32 POOL_COMPACT_MIN_UNUSED = 4096;
+
+// The default values here must match those in LdDecodeMetaData::Field
+FieldStore::FieldStore()
+    : flags(0), seqNo(0), syncConf(0), medianBurstIRE(0.0), fieldPhaseID(-1), audioSamples(-1),
+      diskLoc(-1), fileLoc(-1), decodeFaults(-1), efmTValues(-1), wSNR(0.0), bPSNR(0.0),
+      vbiData0(0), vbiData1(0), vbiData2(0), fmCodeData(0), ccData0(0), ccData1(0),
+      dropOutsStart(0), dropOutsCount(0)
+{
+    numberOfFields = 0;
+    poolUnused = 0;
+}
+
+// Return the number of fields
+qint32 FieldStore::size() const
+{
+    QReadLocker locker(&lock);
+
+    return numberOfFields;
+}
+
+// Remove all the fields, and free their memory
+void FieldStore::clear()
+{
+    QWriteLocker locker(&lock);
+
+    numberOfFields = 0;
+    forEachColumn([](auto &column) { column.clear(); });
+    poolStartx = QVector<qint32>();
+    poolEndx = QVector<qint32>();
+    poolFieldLine = QVector<qint32>();
+    poolUnused = 0;
+}
+
+// Change the number of fields. New fields have the default values.
+void FieldStore::resize(qint32 size)
+{
+    QWriteLocker locker(&lock);
+
+    // Release the pool positions used by any fields being removed
+    for (qint32 i = size; i < numberOfFields; i++) poolUnused += dropOutsCount.get(i);
+
+    numberOfFields = size;
+    forEachColumn([size](auto &column) { column.resize(size); });
+}
+
+// Add a field to the end
+void FieldStore::append(const Field &field)
+{
+    QWriteLocker locker(&lock);
+
+    numberOfFields++;
+    forEachColumn([this](auto &column) { column.resize(numberOfFields); });
+    setLocked(numberOfFields - 1, field);
+}
+
+FieldStore::Field FieldStore::get(qint32 index) const
+{
+    QReadLocker locker(&lock);
+
+    return getLocked(index);
+}
+
+void FieldStore::set(qint32 index, const Field &field)
+{
+    QWriteLocker locker(&lock);
+
+    setLocked(index, field);
+}
+
+void FieldStore::set(qint32 index, const QVector<Field> &fields)
+{
+    QWriteLocker locker(&lock);
+
+    for (qint32 i = 0; i < fields.size(); i++) setLocked(index + i, fields[i]);
+}
+
+bool FieldStore::getIsFirstField(qint32 index) const
+{
+    QReadLocker locker(&lock);
+
+    return getFlag(index, FLAG_IS_FIRST_FIELD);
+}
+
+qint32 FieldStore::getAudioSamples(qint32 index) const
+{
+    QReadLocker locker(&lock);
+
+    return audioSamples.get(index);
+}
+
+FieldStore::VitsMetrics FieldStore::getVitsMetrics(qint32 index) const
+{
+    QReadLocker locker(&lock);
+
+    return getVitsMetricsLocked(index);
+}
+
+void FieldStore::setVitsMetrics(qint32 index, const VitsMetrics &vitsMetrics)
+{
+    QWriteLocker locker(&lock);
+
+    setVitsMetricsLocked(index, vitsMetrics);
+}
+
+FieldStore::Vbi FieldStore::getVbi(qint32 index) const
+{
+    QReadLocker locker(&lock);
+
+    return getVbiLocked(index);
+}
+
+void FieldStore::setVbi(qint32 index, const Vbi &vbi)
+{
+    QWriteLocker locker(&lock);
+
+    setVbiLocked(index, vbi);
+}
+
+FieldStore::Ntsc FieldStore::getNtsc(qint32 index) const
+{
+    QReadLocker locker(&lock);
+
+    return getNtscLocked(index);
+}
+
+void FieldStore::setNtsc(qint32 index, const Ntsc &ntsc)
+{
+    QWriteLocker locker(&lock);
+
+    setNtscLocked(index, ntsc);
+}
+
+DropOuts FieldStore::getDropOuts(qint32 index) const
+{
+    QReadLocker locker(&lock);
+
+    return getDropOutsLocked(index);
+}
+
+void FieldStore::setDropOuts(qint32 index, const DropOuts &dropOuts)
+{
+    QWriteLocker locker(&lock);
+
+    setDropOutsLocked(index, dropOuts);
+}
+
+qint64 FieldStore::getMemoryUsage() const
+{
+    QReadLocker locker(&lock);
+
+    qint64 bytes = 0;
+    forEachColumn([&bytes](const auto &column) { bytes += column.getMemoryUsage(); });
+    bytes += static_cast<qint64>(poolStartx.capacity() + poolEndx.capacity() + poolFieldLine.capacity())
+             * static_cast<qint64>(sizeof(qint32));
+    return bytes;
+}
+
+// Call function for each of the columns
+template <typename Function>
+void FieldStore::forEachColumn(Function function)
+{
+    function(flags);
+    function(seqNo);
+    function(syncConf);
+    function(medianBurstIRE);
+    function(fieldPhaseID);
+    function(audioSamples);
+    function(diskLoc);
+    function(fileLoc);
+    function(decodeFaults);
+    function(efmTValues);
+    function(wSNR);
+    function(bPSNR);
+    function(vbiData0);
+    function(vbiData1);
+    function(vbiData2);
+    function(fmCodeData);
+    function(ccData0);
+    function(ccData1);
+    function(dropOutsStart);
+    function(dropOutsCount);
+}
+
+template <typename Function>
+void FieldStore::forEachColumn(Function function) const
+{
+    const_cast<FieldStore *>(this)->forEachColumn([&function](const auto &column) { function(column); });
+}
+
+bool FieldStore::getFlag(qint32 index, Flag flag) const
+{
+    return (flags.get(index) & flag) != 0;
+}
+
+void FieldStore::setFlag(qint32 index, Flag flag, bool value)
+{
+    const quint8 oldFlags = flags.get(index);
+    flags.set(index, static_cast<quint8>(value ? (oldFlags | flag) : (oldFlags & ~flag)), numberOfFields);
+}
+
+FieldStore::Field FieldStore::getLocked(qint32 index) const
+{
+    Field field;
+    field.seqNo = seqNo.get(index);
+    field.isFirstField = getFlag(index, FLAG_IS_FIRST_FIELD);
+    field.syncConf = syncConf.get(index);
+    field.medianBurstIRE = medianBurstIRE.get(index);
+    field.fieldPhaseID = fieldPhaseID.get(index);
+    field.audioSamples = audioSamples.get(index);
+    field.vitsMetrics = getVitsMetricsLocked(index);
+    field.vbi = getVbiLocked(index);
+    field.ntsc = getNtscLocked(index);
+    field.dropOuts = getDropOutsLocked(index);
+    field.pad = getFlag(index, FLAG_PAD);
+    field.diskLoc = diskLoc.get(index);
+    field.fileLoc = fileLoc.get(index);
+    field.decodeFaults = decodeFaults.get(index);
+    field.efmTValues = efmTValues.get(index);
+    return field;
+}
+
+void FieldStore::setLocked(qint32 index, const Field &field)
+{
+    seqNo.set(index, field.seqNo, numberOfFields);
+    setFlag(index, FLAG_IS_FIRST_FIELD, field.isFirstField);
+    syncConf.set(index, field.syncConf, numberOfFields);
+    medianBurstIRE.set(index, field.medianBurstIRE, numberOfFields);
+    fieldPhaseID.set(index, field.fieldPhaseID, numberOfFields);
+    audioSamples.set(index, field.audioSamples, numberOfFields);
+    setVitsMetricsLocked(index, field.vitsMetrics);
+    setVbiLocked(index, field.vbi);
+    setNtscLocked(index, field.ntsc);
+    setDropOutsLocked(index, field.dropOuts);
+    setFlag(index, FLAG_PAD, field.pad);
+    diskLoc.set(index, field.diskLoc, numberOfFields);
+    fileLoc.set(index, field.fileLoc, numberOfFields);
+    decodeFaults.set(index, field.decodeFaults, numberOfFields);
+    efmTValues.set(index, field.efmTValues, numberOfFields);
+}
+
+FieldStore::VitsMetrics FieldStore::getVitsMetricsLocked(qint32 index) const
+{
+    VitsMetrics vitsMetrics;
+    vitsMetrics.inUse = getFlag(index, FLAG_VITS_IN_USE);
+    vitsMetrics.wSNR = wSNR.get(index);
+    vitsMetrics.bPSNR = bPSNR.get(index);
+    return vitsMetrics;
+}
+
+void FieldStore::setVitsMetricsLocked(qint32 index, const VitsMetrics &vitsMetrics)
+{
+    setFlag(index, FLAG_VITS_IN_USE, vitsMetrics.inUse);
+    wSNR.set(index, vitsMetrics.wSNR, numberOfFields);
+    bPSNR.set(index, vitsMetrics.bPSNR, numberOfFields);
+}
+
+FieldStore::Vbi FieldStore::getVbiLocked(qint32 index) const
+{
+    Vbi vbi;
+    vbi.inUse = getFlag(index, FLAG_VBI_IN_USE);
+    vbi.vbiData = { vbiData0.get(index), vbiData1.get(index), vbiData2.get(index) };
+    return vbi;
+}
+
+void FieldStore::setVbiLocked(qint32 index, const Vbi &vbi)
+{
+    setFlag(index, FLAG_VBI_IN_USE, vbi.inUse);
+    vbiData0.set(index, vbi.vbiData[0], numberOfFields);
+    vbiData1.set(index, vbi.vbiData[1], numberOfFields);
+    vbiData2.set(index, vbi.vbiData[2], numberOfFields);
+}
+
+FieldStore::Ntsc FieldStore::getNtscLocked(qint32 index) const
+{
+    Ntsc ntsc;
+    ntsc.inUse = getFlag(index, FLAG_NTSC_IN_USE);
+    ntsc.isFmCodeDataValid = getFlag(index, FLAG_NTSC_IS_FM_CODE_DATA_VALID);
+    ntsc.fmCodeData = fmCodeData.get(index);
+    ntsc.fieldFlag = getFlag(index, FLAG_NTSC_FIELD_FLAG);
+    ntsc.whiteFlag = getFlag(index, FLAG_NTSC_WHITE_FLAG);
+    ntsc.ccData0 = ccData0.get(index);
+    ntsc.ccData1 = ccData1.get(index);
+    return ntsc;
+}
+
+void FieldStore::setNtscLocked(qint32 index, const Ntsc &ntsc)
+{
+    setFlag(index, FLAG_NTSC_IN_USE, ntsc.inUse);
+    setFlag(index, FLAG_NTSC_IS_FM_CODE_DATA_VALID, ntsc.isFmCodeDataValid);
+    fmCodeData.set(index, ntsc.fmCodeData, numberOfFields);
+    setFlag(index, FLAG_NTSC_FIELD_FLAG, ntsc.fieldFlag);
+    setFlag(index, FLAG_NTSC_WHITE_FLAG, ntsc.whiteFlag);
+    ccData0.set(index, ntsc.ccData0, numberOfFields);
+    ccData1.set(index, ntsc.ccData1, numberOfFields);
+}
+
+DropOuts FieldStore::getDropOutsLocked(qint32 index) const
+{
+    const qint32 count = dropOutsCount.get(index);
+    if (count == 0) return DropOuts();
+
+    const qint32 start = dropOutsStart.get(index);
+    return DropOuts(poolStartx.mid(start, count), poolEndx.mid(start, count), poolFieldLine.mid(start, count));
+}
+
+void FieldStore::setDropOutsLocked(qint32 index, const DropOuts &dropOuts)
+{
+    const qint32 oldCount = dropOutsCount.get(index);
+    const qint32 count = dropOuts.size();
+
+    qint32 start;
+    if (count <= oldCount) {
+        // Reuse the field's existing positions
+        start = (count == 0) ? 0 : dropOutsStart.get(index);
+        poolUnused += oldCount - count;
+    } else {
+        // Add new positions to the end of the pool
+        start = poolStartx.size();
+        poolUnused += oldCount;
+        poolStartx.resize(start + count);
+        poolEndx.resize(start + count);
+        poolFieldLine.resize(start + count);
+    }
+
+    for (qint32 i = 0; i < count; i++) {
+        poolStartx[start + i] = dropOuts.startx(i);
+        poolEndx[start + i] = dropOuts.endx(i);
+        poolFieldLine[start + i] = dropOuts.fieldLine(i);
+    }
+    dropOutsStart.set(index, start, numberOfFields);
+    dropOutsCount.set(index, count, numberOfFields);
+
+    compactPoolIfUnused();
+}
+
+// Rebuild the dropout pool if enough of it is unused
+void FieldStore::compactPoolIfUnused()
+{
+    if (poolUnused >= POOL_COMPACT_MIN_UNUSED && poolUnused > poolStartx.size() / 2) compactPool();
+}
+
+// Rebuild the dropout pool without the unused positions
+void FieldStore::compactPool()
+{
+    QVector<qint32> newStartx, newEndx, newFieldLine;
+    const qint32 poolSize = poolStartx.size() - poolUnused;
+    newStartx.reserve(poolSize);
+    newEndx.reserve(poolSize);
+    newFieldLine.reserve(poolSize);
+
+    for (qint32 index = 0; index < numberOfFields; index++) {
+        const qint32 count = dropOutsCount.get(index);
+        if (count == 0) continue;
+
+        const qint32 start = dropOutsStart.get(index);
+        dropOutsStart.set(index, newStartx.size(), numberOfFields);
+        for (qint32 i = start; i < start + count; i++) {
+            newStartx.append(poolStartx[i]);
+            newEndx.append(poolEndx[i]);
+            newFieldLine.append(poolFieldLine[i]);
+        }
+    }
+
+    poolStartx = newStartx;
+    poolEndx = newEndx;
+    poolFieldLine = newFieldLine;
+    poolUnused = 0;
+}
+
+FieldStore::Column<qint32> &FieldStore::intColumn(IntColumn id)
+{
+    switch (id) {
+    case SEQ_NO: return seqNo;
+    case SYNC_CONF: return syncConf;
+    case FIELD_PHASE_ID: return fieldPhaseID;
+    case AUDIO_SAMPLES: return audioSamples;
+    case DISK_LOC: return diskLoc;
+    case FILE_LOC: return fileLoc;
+    case DECODE_FAULTS: return decodeFaults;
+    case EFM_T_VALUES: return efmTValues;
+    case VBI_DATA_0: return vbiData0;
+    case VBI_DATA_1: return vbiData1;
+    case VBI_DATA_2: return vbiData2;
+    case NTSC_FM_CODE_DATA: return fmCodeData;
+    case NTSC_CC_DATA_0: return ccData0;
+    case NTSC_CC_DATA_1: return ccData1;
+    }
+
+    qFatal("FieldStore: unknown column");
+}
+
+FieldStore::Column<double> &FieldStore::doubleColumn(DoubleColumn id)
+{
+    switch (id) {
+    case MEDIAN_BURST_IRE: return medianBurstIRE;
+    case VITS_WSNR: return wSNR;
+    case VITS_BPSNR: return bPSNR;
+    }
+
+    qFatal("FieldStore: unknown column");
+}
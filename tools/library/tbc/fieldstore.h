@@ -0,0 +1,282 @@
+/************************************************************************
+
+    fieldstore.h
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef FIELDSTORE_H
+#define FIELDSTORE_H
+
+#include <QReadWriteLock>
+#include <QVector>
+#include <QtGlobal>
+#include <cstring>
+
+#include "dropouts.h"
+#include "lddecodemetadata.h"
+
+// Compact in-memory storage for the metadata of a sequence of fields.
+//
+// Rather than a Field structure per field (with three separately-allocated
+// vectors for its dropouts), each value is kept in a column with one element
+// per field, and the dropouts for all the fields are kept in one pool, with
+// each field's dropouts in a range of positions within it. A column that only
+// holds its default value (e.g. the NTSC values for a PAL source, or the VITS
+// metrics before ld-process-vits has been run) isn't allocated at all.
+//
+// Fields are copied in and out by value. The methods are thread-safe, so one
+// thread can update fields while others are reading them.
+class FieldStore
+{
+public:
+    using Field = LdDecodeMetaData::Field;
+    using VitsMetrics = LdDecodeMetaData::VitsMetrics;
+    using Vbi = LdDecodeMetaData::Vbi;
+    using Ntsc = LdDecodeMetaData::Ntsc;
+
+    FieldStore();
+
+    // Prevent copying or assignment
+    FieldStore(const FieldStore &) = delete;
+    FieldStore& operator=(const FieldStore &) = delete;
+
+    qint32 size() const;
+    void clear();
+    void resize(qint32 size);
+    void append(const Field &field);
+
+    // Get or set a field (numbered from 0)
+    Field get(qint32 index) const;
+    void set(qint32 index, const Field &field);
+
+    // Set a run of fields, starting at index
+    void set(qint32 index, const QVector<Field> &fields);
+
+    // Get or set parts of a field
+    bool getIsFirstField(qint32 index) const;
+    qint32 getAudioSamples(qint32 index) const;
+    VitsMetrics getVitsMetrics(qint32 index) const;
+    void setVitsMetrics(qint32 index, const VitsMetrics &vitsMetrics);
+    Vbi getVbi(qint32 index) const;
+    void setVbi(qint32 index, const Vbi &vbi);
+    Ntsc getNtsc(qint32 index) const;
+    void setNtsc(qint32 index, const Ntsc &ntsc);
+    DropOuts getDropOuts(qint32 index) const;
+    void setDropOuts(qint32 index, const DropOuts &dropOuts);
+
+    // Return the number of bytes allocated for the fields
+    qint64 getMemoryUsage() const;
+
+    // Bulk loading, for data that's already in columns (as in a binary
+    // metadata file), without making a Field for each field. Each of these
+    // sets one value for every field; values can be anything indexable by
+    // field number (or dropout number), with at least size() elements.
+    enum IntColumn {
+        SEQ_NO, SYNC_CONF, FIELD_PHASE_ID, AUDIO_SAMPLES, DISK_LOC, FILE_LOC, DECODE_FAULTS, EFM_T_VALUES,
+        VBI_DATA_0, VBI_DATA_1, VBI_DATA_2, NTSC_FM_CODE_DATA, NTSC_CC_DATA_0, NTSC_CC_DATA_1,
+    };
+    enum DoubleColumn {
+        MEDIAN_BURST_IRE, VITS_WSNR, VITS_BPSNR,
+    };
+
+    // The boolean members of a field, for loadFlags
+    enum Flag : quint8 {
+        FLAG_IS_FIRST_FIELD = 1 << 0,
+        FLAG_PAD = 1 << 1,
+        FLAG_VITS_IN_USE = 1 << 2,
+        FLAG_VBI_IN_USE = 1 << 3,
+        FLAG_NTSC_IN_USE = 1 << 4,
+        FLAG_NTSC_IS_FM_CODE_DATA_VALID = 1 << 5,
+        FLAG_NTSC_FIELD_FLAG = 1 << 6,
+        FLAG_NTSC_WHITE_FLAG = 1 << 7,
+    };
+
+    template <typename Values>
+    void loadColumn(IntColumn id, const Values &values);
+    template <typename Values>
+    void loadColumn(DoubleColumn id, const Values &values);
+    template <typename Values>
+    void loadFlags(const Values &values);
+
+    // Replace all the fields' dropouts. Field i's dropouts are positions
+    // fieldStart[i] to fieldStart[i + 1] - 1 of startx, endx and fieldLine,
+    // which the caller must have checked are valid.
+    template <typename Starts, typename Values>
+    void loadDropOuts(const Starts &fieldStart, const Values &startx, const Values &endx, const Values &fieldLine);
+
+private:
+    // A column of values, one per field. The values aren't allocated until
+    // one of them is set to something other than the default.
+    template <typename T>
+    class Column
+    {
+    public:
+        explicit Column(T _defaultValue) : defaultValue(_defaultValue) {}
+
+        T get(qint32 index) const {
+            return values.empty() ? defaultValue : values[index];
+        }
+        void set(qint32 index, T value, qint32 size) {
+            if (values.empty()) {
+                // Compare the bits, so -0.0 isn't taken for 0.0
+                if (memcmp(&value, &defaultValue, sizeof(T)) == 0) return;
+                values.fill(defaultValue, size);
+            }
+            values[index] = value;
+        }
+        template <typename Values>
+        void load(const Values &source, qint32 size) {
+            for (qint32 i = 0; i < size; i++) set(i, source[i], size);
+        }
+        void resize(qint32 size) {
+            if (values.empty()) return;
+            const qint32 oldSize = values.size();
+            values.resize(size);
+            for (qint32 i = oldSize; i < size; i++) values[i] = defaultValue;
+        }
+        void clear() {
+            values = QVector<T>();
+        }
+        qint64 getMemoryUsage() const {
+            return static_cast<qint64>(values.capacity()) * static_cast<qint64>(sizeof(T));
+        }
+
+    private:
+        T defaultValue;
+        QVector<T> values;
+    };
+
+    mutable QReadWriteLock lock;
+    qint32 numberOfFields;
+
+    Column<quint8> flags;
+    Column<qint32> seqNo;
+    Column<qint32> syncConf;
+    Column<double> medianBurstIRE;
+    Column<qint32> fieldPhaseID;
+    Column<qint32> audioSamples;
+    Column<qint32> diskLoc;
+    Column<qint32> fileLoc;
+    Column<qint32> decodeFaults;
+    Column<qint32> efmTValues;
+    Column<double> wSNR;
+    Column<double> bPSNR;
+    Column<qint32> vbiData0;
+    Column<qint32> vbiData1;
+    Column<qint32> vbiData2;
+    Column<qint32> fmCodeData;
+    Column<qint32> ccData0;
+    Column<qint32> ccData1;
+
+    // Each field's dropouts are at dropOutsCount positions in the pool,
+    // starting at dropOutsStart. When a field's dropouts are replaced by a
+    // larger set, the new set goes at the end of the pool, and the old
+    // positions become unused; once more than half of the pool is unused, the
+    // pool is rebuilt.
+    Column<qint32> dropOutsStart;
+    Column<qint32> dropOutsCount;
+    QVector<qint32> poolStartx;
+    QVector<qint32> poolEndx;
+    QVector<qint32> poolFieldLine;
+    qint32 poolUnused;
+
+    template <typename Function>
+    void forEachColumn(Function function);
+    template <typename Function>
+    void forEachColumn(Function function) const;
+
+    bool getFlag(qint32 index, Flag flag) const;
+    void setFlag(qint32 index, Flag flag, bool value);
+
+    // These must be called with the lock held
+    Field getLocked(qint32 index) const;
+    void setLocked(qint32 index, const Field &field);
+    VitsMetrics getVitsMetricsLocked(qint32 index) const;
+    void setVitsMetricsLocked(qint32 index, const VitsMetrics &vitsMetrics);
+    Vbi getVbiLocked(qint32 index) const;
+    void setVbiLocked(qint32 index, const Vbi &vbi);
+    Ntsc getNtscLocked(qint32 index) const;
+    void setNtscLocked(qint32 index, const Ntsc &ntsc);
+    DropOuts getDropOutsLocked(qint32 index) const;
+    void setDropOutsLocked(qint32 index, const DropOuts &dropOuts);
+    void compactPoolIfUnused();
+    void compactPool();
+    Column<qint32> &intColumn(IntColumn id);
+    Column<double> &doubleColumn(DoubleColumn id);
+};
+
+template <typename Values>
+void FieldStore::loadColumn(IntColumn id, const Values &values)
+{
+    QWriteLocker locker(&lock);
+
+    intColumn(id).load(values, numberOfFields);
+}
+
+template <typename Values>
+void FieldStore::loadColumn(DoubleColumn id, const Values &values)
+{
+    QWriteLocker locker(&lock);
+
+    doubleColumn(id).load(values, numberOfFields);
+}
+
+template <typename Values>
+void FieldStore::loadFlags(const Values &values)
+{
+    QWriteLocker locker(&lock);
+
+    flags.load(values, numberOfFields);
+}
+
+template <typename Starts, typename Values>
+void FieldStore::loadDropOuts(const Starts &fieldStart, const Values &startx, const Values &endx,
+                              const Values &fieldLine)
+{
+    QWriteLocker locker(&lock);
+
+    // The fields' existing positions in the pool are no longer used
+    for (qint32 index = 0; index < numberOfFields; index++) poolUnused += dropOutsCount.get(index);
+
+    // Copy the new dropouts onto the end of the pool
+    const qint32 offset = poolStartx.size();
+    const qint32 count = static_cast<qint32>(fieldStart[numberOfFields] - fieldStart[0]);
+    poolStartx.resize(offset + count);
+    poolEndx.resize(offset + count);
+    poolFieldLine.resize(offset + count);
+    for (qint32 i = 0; i < count; i++) {
+        const qint64 position = fieldStart[0] + i;
+        poolStartx[offset + i] = startx[position];
+        poolEndx[offset + i] = endx[position];
+        poolFieldLine[offset + i] = fieldLine[position];
+    }
+
+    for (qint32 index = 0; index < numberOfFields; index++) {
+        const qint32 fieldCount = static_cast<qint32>(fieldStart[index + 1] - fieldStart[index]);
+        dropOutsStart.set(index, (fieldCount == 0) ? 0 : offset + static_cast<qint32>(fieldStart[index] - fieldStart[0]),
+                          numberOfFields);
+        dropOutsCount.set(index, fieldCount, numberOfFields);
+    }
+
+    compactPoolIfUnused();
+}
+
+#endif // FIELDSTORE_H
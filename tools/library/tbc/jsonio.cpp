@@ -24,8 +24,22 @@
 
 #include "jsonio.h"
 
+#include <charconv>
 #include <cmath>
+#include <cstring>
 #include <limits>
+#include <locale>
+#include <sstream>
+
+// Size of the buffer for reading from a stream
+static constexpr size_t INPUT_BUFFER_SIZE = 64 * 1024;
+
+// Size of the buffer for writing to a stream
+static constexpr size_t OUTPUT_BUFFER_SIZE = 256 * 1024;
+
+// Number of significant digits needed to write a double without losing
+// precision
+static constexpr int DOUBLE_PRECISION = std::numeric_limits<double>::digits10 + 1;
 
 // Recognise JSON space characters
 static bool isAsciiSpace(char c)
@@ -40,21 +54,64 @@ static bool isAsciiDigit(char c)
 }
 
 JsonReader::JsonReader(std::istream &_input)
-    : input(_input), position(0), atStart(true)
+    : input(&_input), inputBuffer(INPUT_BUFFER_SIZE), atStart(true)
+{
+    bufferStart = bufferEnd = current = inputBuffer.data();
+    bufferPosition = 0;
+    atEnd = false;
+    keepStart = nullptr;
+}
+
+JsonReader::JsonReader(const char *data, size_t size)
+    : input(nullptr), atStart(true)
 {
+    setInput(data, size);
+}
+
+// Start reading a different block of memory, as if a new reader had been
+// created. This is quicker than creating a new reader for each small block.
+void JsonReader::setInput(const char *data, size_t size)
+{
+    input = nullptr;
+    bufferStart = current = data;
+    bufferEnd = data + size;
+    bufferPosition = 0;
+    atEnd = false;
+    keepStart = nullptr;
+
+    atStart = true;
+    while (!atStarts.empty()) atStarts.pop();
 }
 
 void JsonReader::read(int &value)
 {
+    const char *start, *end;
+    if (readNumber(start, end)) {
+        // It's written as an integer, so try parsing it directly
+        const auto result = std::from_chars(start, end, value);
+        if (result.ec == std::errc()) return;
+    }
+
     // Round to the nearest integer
-    double d;
-    readNumber(d);
-    value = static_cast<int>(std::lround(d));
+    value = static_cast<int>(std::lround(parseDouble(start, end)));
+}
+
+void JsonReader::read(long long &value)
+{
+    const char *start, *end;
+    if (readNumber(start, end)) {
+        const auto result = std::from_chars(start, end, value);
+        if (result.ec == std::errc()) return;
+    }
+
+    value = std::llround(parseDouble(start, end));
 }
 
 void JsonReader::read(double &value)
 {
-    readNumber(value);
+    const char *start, *end;
+    readNumber(start, end);
+    value = parseDouble(start, end);
 }
 
 void JsonReader::read(bool &value)
@@ -171,8 +228,8 @@ void JsonReader::discard()
     unget();
 
     if (c == '-' || isAsciiDigit(c)) {
-        double dummy;
-        readNumber(dummy);
+        const char *start, *end;
+        readNumber(start, end);
     } else if (c == 't' || c == 'f') {
         bool dummy;
         read(dummy);
@@ -192,33 +249,137 @@ void JsonReader::discard()
     }
 }
 
-// Get the next input character, returning 0 on EOF or error
-char JsonReader::get()
-{
-    char c;
-    input.get(c);
-    if (!input.good()) return 0;
-    ++position;
-    return c;
-}
+// Find the elements of an array in a JSON document in memory. The document
+// must be an object, with a member called memberName whose value is an array
+// of objects. This checks the document's structure (matching brackets and
+// quotes) but doesn't parse any values, so it's much quicker than reading the
+// whole document.
+//
+// On success, returns true, and sets arrayStart and arrayEnd to the positions
+// of the array's [ and ], and elementStarts to the position of the { at the
+// start of each element. Returns false if the document doesn't have the
+// expected structure (in which case parsing it normally will show why).
+bool JsonReader::findArrayElements(const char *data, size_t size, const char *memberName,
+                                   size_t &arrayStart, size_t &arrayEnd, std::vector<size_t> &elementStarts)
+{
+    const size_t memberNameLength = strlen(memberName);
+
+    elementStarts.clear();
+    bool foundArray = false;
+    bool inArray = false;
+
+    // Nesting depth of objects and arrays (1 is the top-level object)
+    qint32 depth = 0;
+    // Position and length of the last string that was read
+    size_t stringStart = 0;
+    size_t stringLength = 0;
+    // True if the last string read at depth 1 was memberName followed by :
+    bool atMember = false;
+    // True if we're in the array and expecting an element (after [ or ,)
+    bool expectElement = false;
+
+    for (size_t i = 0; i < size; i++) {
+        const char c = data[i];
+        if (isAsciiSpace(c)) continue;
+
+        if (inArray && depth == 2) {
+            // Between the array's elements, only objects and separators are allowed
+            if (c == '{') {
+                if (!expectElement) return false;
+                elementStarts.push_back(i);
+                expectElement = false;
+            } else if (c == ',') {
+                if (expectElement) return false;
+                expectElement = true;
+                continue;
+            } else if (c == ']') {
+                if (expectElement && !elementStarts.empty()) return false;
+                arrayEnd = i;
+                inArray = false;
+                depth--;
+                continue;
+            } else {
+                return false;
+            }
+        } else if (atMember) {
+            // This is the member's value
+            atMember = false;
+            if (c != '[' || foundArray) return false;
+            arrayStart = i;
+            foundArray = true;
+            inArray = true;
+            expectElement = true;
+            depth++;
+            continue;
+        }
 
-// Get the next input character, discarding spaces before it
-char JsonReader::spaceGet()
-{
-    char c;
-    do {
-        c = get();
-    } while (isAsciiSpace(c));
-    return c;
+        switch (c) {
+        case '"':
+            // Skip over the string
+            stringStart = ++i;
+            while (i < size && data[i] != '"') {
+                if (data[i] == '\\') i++;
+                i++;
+            }
+            if (i >= size) return false;
+            stringLength = i - stringStart;
+            break;
+        case ':':
+            atMember = depth == 1 && stringLength == memberNameLength
+                       && memcmp(data + stringStart, memberName, memberNameLength) == 0;
+            break;
+        case '{':
+        case '[':
+            if (depth == 0 && c != '{') return false;
+            depth++;
+            break;
+        case '}':
+        case ']':
+            if (depth == 0) return false;
+            depth--;
+
+            // Anything after the top-level object is ignored, as JsonReader does
+            if (depth == 0) return foundArray;
+            break;
+        default:
+            if (depth == 0) return false;
+            break;
+        }
+    }
+
+    // The document is incomplete
+    return false;
 }
 
-// Put back an input character to be read again
-void JsonReader::unget()
+// Refill the buffer from the input stream. Returns false if there's no more
+// input.
+bool JsonReader::fillBuffer()
 {
-    // We assume the input stream supports unget.
-    // (If this becomes a problem in the future, we could simulate it.)
-    input.unget();
-    --position;
+    if (input == nullptr) return false;
+
+    // Keep the token that's being read, moving it to the start of the buffer
+    const size_t keep = keepStart != nullptr ? static_cast<size_t>(bufferEnd - keepStart) : 0;
+    bufferPosition += static_cast<unsigned long>((bufferEnd - bufferStart) - keep);
+    if (keep + INPUT_BUFFER_SIZE > inputBuffer.size()) {
+        std::vector<char> newBuffer(keep + INPUT_BUFFER_SIZE);
+        if (keep != 0) memcpy(newBuffer.data(), keepStart, keep);
+        inputBuffer.swap(newBuffer);
+    } else if (keep != 0) {
+        memmove(inputBuffer.data(), keepStart, keep);
+    }
+
+    // Read from the stream's buffer directly, so reaching the end of the input
+    // doesn't change the stream's state
+    std::streambuf *streamBuffer = input->rdbuf();
+    const std::streamsize count = streamBuffer == nullptr ? 0
+        : streamBuffer->sgetn(inputBuffer.data() + keep, static_cast<std::streamsize>(inputBuffer.size() - keep));
+
+    bufferStart = inputBuffer.data();
+    if (keepStart != nullptr) keepStart = bufferStart;
+    current = bufferStart + keep;
+    bufferEnd = current + count;
+
+    return count > 0;
 }
 
 // Read a JSON string. The result is unescaped and doesn't include the quotes.
@@ -230,6 +391,15 @@ void JsonReader::readString(std::string &value)
     value.clear();
 
     while (true) {
+        // Copy everything up to the next quote or backslash at once
+        const size_t available = static_cast<size_t>(bufferEnd - current);
+        const char *stop = static_cast<const char *>(memchr(current, '"', available));
+        if (stop == nullptr) stop = bufferEnd;
+        const char *backslash = static_cast<const char *>(memchr(current, '\\', static_cast<size_t>(stop - current)));
+        if (backslash != nullptr) stop = backslash;
+        value.append(current, static_cast<size_t>(stop - current));
+        current = stop;
+
         c = get();
         switch (c) {
         case 0:
@@ -268,112 +438,177 @@ void JsonReader::readString(std::string &value)
             }
             break;
         default:
-            value.push_back(c);
+            // The buffer was empty, so get refilled it
+            unget();
             break;
         }
     }
 }
 
-// Read a JSON number
-void JsonReader::readNumber(double &value)
+// Read a JSON number, without converting it. Sets start and end to the
+// position of the number in the buffer (valid until the next read). Returns
+// true if the number is written as an integer (with no fraction or exponent).
+bool JsonReader::readNumber(const char *&start, const char *&end)
 {
     // JSON only has "numbers"; it doesn't distinguish between floating point
-    // and integers. This means we have to parse as a double, since a value
-    // we're expecting to use as an integer might be written as 1.234e3 or
-    // similar.
+    // and integers. This means a value we're expecting to use as an integer
+    // might be written as 1.234e3 or similar, so callers must be prepared to
+    // parse any number as a double.
 
     // Check that the number matches JSON's number syntax, which is more
     // restrictive than the C/C++ parsers accept.
 
-    // XXX could track if we only saw the int part, and parse straight to int
-
-    buf.clear();
+    bool isInteger = true;
 
     char c = spaceGet();
+    keepStart = current - 1;
     if (c == '-') {
-        buf.push_back(c);
         c = get();
     }
     if (!isAsciiDigit(c)) throwError("expected - or digit");
-    buf.push_back(c);
     c = get();
 
     while (isAsciiDigit(c)) {
-        buf.push_back(c);
         c = get();
     }
 
     if (c == '.') {
-        buf.push_back(c);
+        isInteger = false;
         c = get();
         if (!isAsciiDigit(c)) throwError("expected digit after .");
-        buf.push_back(c);
         while (true) {
             c = get();
             if (!isAsciiDigit(c)) break;
-            buf.push_back(c);
         }
     }
 
-    if (c == 'e') {
-        buf.push_back(c);
+    if (c == 'e' || c == 'E') {
+        isInteger = false;
         c = get();
         if (c == '-' || c == '+') {
-            buf.push_back(c);
             c = get();
         }
         if (!isAsciiDigit(c)) throwError("expected digit after e");
-        buf.push_back(c);
         while (true) {
             c = get();
             if (!isAsciiDigit(c)) break;
-            buf.push_back(c);
         }
     }
 
-    // XXX In C++17 we could use std::from_chars instead, which is slightly more efficient
-    value = std::stod(buf);
-
     // We've read one character beyond the end of the number (there's no way to
     // tell where the end is otherwise), so we must unget the last char
     unget();
+
+    start = keepStart;
+    end = current;
+    keepStart = nullptr;
+
+    return isInteger;
+}
+
+// Convert a number that has been checked by readNumber to a double
+double JsonReader::parseDouble(const char *start, const char *end)
+{
+#if defined(__cpp_lib_to_chars)
+    double value;
+    const auto result = std::from_chars(start, end, value);
+    if (result.ec != std::errc()) throwError("number out of range");
+    return value;
+#else
+    // This standard library can't parse doubles with from_chars
+    try {
+        return std::stod(std::string(start, end));
+    } catch (std::out_of_range &) {
+        throwError("number out of range");
+    }
+#endif
 }
 
 JsonWriter::JsonWriter(std::ostream &_output)
-    : output(_output), atStart(true)
+    : output(&_output), buffer(ownBuffer), atStart(true)
 {
-    // Use maximum double precision for floating-point output
-    output.precision(std::numeric_limits<double>::digits10 + 1);
+    buffer.reserve(OUTPUT_BUFFER_SIZE + 4096);
+}
+
+JsonWriter::JsonWriter(std::string &_output)
+    : output(nullptr), buffer(_output), atStart(true)
+{
+}
+
+JsonWriter::~JsonWriter()
+{
+    flush();
+}
+
+void JsonWriter::flush()
+{
+    if (output == nullptr || buffer.empty()) return;
+
+    output->write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    buffer.clear();
 }
 
 void JsonWriter::write(int value)
 {
-    output << value;
+    char text[16];
+    const auto result = std::to_chars(text, text + sizeof(text), value);
+    buffer.append(text, result.ptr - text);
+
+    endValue();
+}
+
+void JsonWriter::write(long long value)
+{
+    char text[24];
+    const auto result = std::to_chars(text, text + sizeof(text), value);
+    buffer.append(text, result.ptr - text);
+
+    endValue();
 }
 
 void JsonWriter::write(double value)
 {
-    output << value;
+    // Use maximum double precision for floating-point output, in the same
+    // format as printf's %g
+#if defined(__cpp_lib_to_chars)
+    char text[32];
+    const auto result = std::to_chars(text, text + sizeof(text), value, std::chars_format::general, DOUBLE_PRECISION);
+    buffer.append(text, result.ptr - text);
+#else
+    std::ostringstream text;
+    text.imbue(std::locale::classic());
+    text.precision(DOUBLE_PRECISION);
+    text << value;
+    buffer += text.str();
+#endif
+
+    endValue();
 }
 
 void JsonWriter::write(bool value)
 {
-    output << (value ? "true" : "false");
+    buffer += value ? "true" : "false";
+
+    endValue();
 }
 
 void JsonWriter::write(const char *value)
 {
     writeString(value);
+
+    endValue();
 }
 
 void JsonWriter::write(const QString &value)
 {
     writeString(value.toUtf8());
+
+    endValue();
 }
 
 void JsonWriter::beginObject()
 {
-    output.put('{');
+    put('{');
 
     atStarts.push(atStart);
     atStart = true;
@@ -381,25 +616,27 @@ void JsonWriter::beginObject()
 
 void JsonWriter::writeMember(const char *member)
 {
-    if (!atStart) output.put(',');
+    if (!atStart) put(',');
 
     writeString(member);
-    output << ":";
+    put(':');
 
     atStart = false;
 }
 
 void JsonWriter::endObject()
 {
-    output.put('}');
+    put('}');
 
     atStart = atStarts.top();
     atStarts.pop();
+
+    endValue();
 }
 
 void JsonWriter::beginArray()
 {
-    output.put('[');
+    put('[');
 
     atStarts.push(atStart);
     atStart = true;
@@ -407,50 +644,76 @@ void JsonWriter::beginArray()
 
 void JsonWriter::writeElement()
 {
-    if (!atStart) output.put(',');
+    if (!atStart) put(',');
 
     atStart = false;
 }
 
 void JsonWriter::endArray()
 {
-    output.put(']');
+    put(']');
 
     atStart = atStarts.top();
     atStarts.pop();
+
+    endValue();
+}
+
+void JsonWriter::writeElements(const std::string &elements)
+{
+    if (elements.empty()) return;
+
+    writeElement();
+    buffer += elements;
+
+    endValue();
+}
+
+// Called after each value has been written. Write the buffer to the stream if
+// the outermost value is complete, or if the buffer is full.
+void JsonWriter::endValue()
+{
+    if (atStarts.empty() || buffer.size() >= OUTPUT_BUFFER_SIZE) flush();
 }
 
 void JsonWriter::writeString(const char *str)
 {
-    output.put('"');
+    put('"');
+
+    while (true) {
+        // Copy characters that don't need escaping in one go
+        const char *span = str;
+        while (*str != '\0' && *str != '"' && *str != '\\' && static_cast<unsigned char>(*str) >= 0x20) str++;
+        buffer.append(span, str - span);
 
-    while (char c = *str++) {
+        const char c = *str++;
         switch (c) {
+        case '\0':
+            put('"');
+            return;
         case '"':
         case '\\':
-            output.put('\\');
-            output.put(c);
+            put('\\');
+            put(c);
             break;
         case '\b':
-            output << "\\b";
+            buffer += "\\b";
             break;
         case '\f':
-            output << "\\f";
+            buffer += "\\f";
             break;
         case '\n':
-            output << "\\n";
+            buffer += "\\n";
             break;
         case '\r':
-            output << "\\r";
+            buffer += "\\r";
             break;
         case '\t':
-            output << "\\t";
+            buffer += "\\t";
             break;
         default:
-            output.put(c);
+            put(c);
             break;
         }
     }
-
-    output.put('"');
 }
@@ -32,11 +32,20 @@
 #include <stdexcept>
 #include <string>
 #include <stack>
+#include <vector>
 
+// Reader for JSON documents. The input is read from a contiguous block of
+// memory: either one supplied by the caller, or a buffer that is refilled from
+// a stream (in which case the reader may read further ahead in the stream
+// than the end of the value it's parsing).
 class JsonReader
 {
 public:
     JsonReader(std::istream &_input);
+    JsonReader(const char *data, size_t size);
+
+    // Start reading a different block of memory
+    void setInput(const char *data, size_t size);
 
     // Exception class to be thrown when parsing fails
     class Error : public std::runtime_error
@@ -47,11 +56,13 @@ public:
 
     // Throw an Error exception with the given message
     [[noreturn]] void throwError(std::string message) {
-        throw Error(message + " at byte " + std::to_string(position));
+        keepStart = nullptr;
+        throw Error(message + " at byte " + std::to_string(getPosition()));
     }
 
     // Numbers
     void read(int &value);
+    void read(long long &value);
     void read(double &value);
 
     // Booleans
@@ -74,17 +85,64 @@ public:
     // Read and discard the next value, whatever type it is
     void discard();
 
+    // Get the number of bytes read from the input so far
+    unsigned long getPosition() const {
+        return bufferPosition + static_cast<unsigned long>(current - bufferStart);
+    }
+
+    // Find the elements of an array of objects in a JSON document in memory,
+    // without fully parsing it
+    static bool findArrayElements(const char *data, size_t size, const char *memberName,
+                                  size_t &arrayStart, size_t &arrayEnd, std::vector<size_t> &elementStarts);
+
 private:
-    char get();
-    char spaceGet();
-    void unget();
+    // Get the next input character, returning 0 on EOF or error
+    char get() {
+        if (current == bufferEnd && !fillBuffer()) {
+            atEnd = true;
+            return 0;
+        }
+        return *current++;
+    }
 
-    void readString(std::string &value);
-    void readNumber(double &value);
+    // Get the next input character, discarding spaces before it
+    char spaceGet() {
+        char c;
+        do {
+            c = get();
+        } while (c == ' ' || c == '\t' || c == '\n' || c == '\r');
+        return c;
+    }
 
-    // The input stream
-    std::istream &input;
-    unsigned long position;
+    // Put back the character that was just read by get
+    void unget() {
+        if (atEnd) {
+            atEnd = false;
+        } else {
+            --current;
+        }
+    }
+
+    bool fillBuffer();
+    void readString(std::string &value);
+    bool readNumber(const char *&start, const char *&end);
+    double parseDouble(const char *start, const char *end);
+
+    // The input stream, or nullptr if reading from memory
+    std::istream *input;
+    // Buffer for reading from the input stream
+    std::vector<char> inputBuffer;
+
+    // The block of memory being read, the current position in it, and the
+    // number of bytes read before its start
+    const char *bufferStart;
+    const char *bufferEnd;
+    const char *current;
+    unsigned long bufferPosition;
+    // True if the last get reached the end of the input
+    bool atEnd;
+    // If not nullptr, the start of a token that fillBuffer must keep in the buffer
+    const char *keepStart;
 
     // True if we're at the start of a { or [ construct
     bool atStart;
@@ -94,13 +152,28 @@ private:
     std::string buf;
 };
 
+// Writer for JSON. Output is built up in a buffer, which is written to the
+// stream when it gets large, when the outermost value is complete, and when
+// the writer is destroyed. A writer can also write into a string, so that
+// parts of a document can be produced separately (e.g. on different threads)
+// and then joined together with writeElements.
 class JsonWriter
 {
 public:
     JsonWriter(std::ostream &_output);
+    JsonWriter(std::string &_output);
+    ~JsonWriter();
+
+    // Prevent copying or assignment
+    JsonWriter(const JsonWriter &) = delete;
+    JsonWriter& operator=(const JsonWriter &) = delete;
+
+    // Write any buffered output to the stream
+    void flush();
 
     // Numbers
     void write(int value);
+    void write(long long value);
     void write(double value);
 
     // Booleans
@@ -125,11 +198,23 @@ public:
     void writeElement();
     void endArray();
 
+    // Write a sequence of array elements that has already been produced by
+    // another JsonWriter writing elements into a string
+    void writeElements(const std::string &elements);
+
 private:
+    void put(char c) {
+        buffer.push_back(c);
+    }
     void writeString(const char *str);
+    void endValue();
+
+    // The output stream, or nullptr if writing into a string
+    std::ostream *output;
 
-    // The output stream
-    std::ostream &output;
+    // The output buffer, which is ownBuffer when writing to a stream
+    std::string ownBuffer;
+    std::string &buffer;
 
     // True if we're at the start of a [ or { construct
     bool atStart;
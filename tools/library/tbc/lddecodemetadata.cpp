@@ -26,10 +26,26 @@
 
 #include "lddecodemetadata.h"
 
+#include "binarymetadata.h"
+#include "fieldstore.h"
 #include "jsonio.h"
+#include "parallelfor.h"
+#include "tbcparts.h"
+
+#include <QAtomicInt>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QThread>
 
 #include <cassert>
+#include <cstring>
 #include <fstream>
+#include <limits>
+#include <sstream>
+#include <streambuf>
+#include <utility>
+#include <vector>
 
 // Default values used when configuring VideoParameters for a particular video system.
 // See the comments in VideoParameters for the meanings of these values.
@@ -415,11 +431,50 @@ void LdDecodeMetaData::Field::write(JsonWriter &writer) const
     writer.endObject();
 }
 
+const char LdDecodeMetaData::FIELD_INDEX_SUFFIX[] = ".idx";
+
+// Field index files start with a header of FIELD_INDEX_HEADER_SIZE bytes:
+//   8 bytes   magic "LDJIDX\0\2"
+//   quint64   size of the JSON file
+//   qint64    modification time of the JSON file, in ms since the epoch
+//   quint32   number of fields
+//   quint32   reserved (0)
+//   quint64   length of the parameters, in bytes
+// followed by the parameters (as for binary metadata files), and then for
+// each field, FIELD_INDEX_ENTRY_SIZE bytes:
+//   quint64   position of the field in the JSON file
+//   qint32    the field's audioSamples
+//   quint32   the field's isFirstField (0 or 1)
+// All integers are little-endian.
+static const char FIELD_INDEX_MAGIC[] = "LDJIDX\0\2";
+static constexpr qint32 FIELD_INDEX_MAGIC_SIZE = 8;
+static constexpr qint32 FIELD_INDEX_HEADER_SIZE = 40;
+static constexpr qint32 FIELD_INDEX_ENTRY_SIZE = 16;
+
+// Files with fewer fields than this are parsed serially
+static constexpr qint32 PARALLEL_MIN_FIELDS = 1000;
+// The number of fields each thread parses at a time when parsing in parallel
+static constexpr qint32 PARALLEL_CHUNK_FIELDS = 256;
+// The number of chunks per thread serialised in each batch when writing in
+// parallel
+static constexpr qint32 PARALLEL_BATCH_CHUNKS = 4;
+
 LdDecodeMetaData::LdDecodeMetaData()
+    : fields(new FieldStore)
 {
+    lazyLoading = false;
+    lazyPersistIndex = false;
+    maxThreads = QThread::idealThreadCount();
+    journalling = false;
+    vbiIndexValid = false;
+
     clear();
 }
 
+LdDecodeMetaData::~LdDecodeMetaData()
+{
+}
+
 // Reset the metadata to the defaults
 void LdDecodeMetaData::clear()
 {
@@ -430,31 +485,385 @@ void LdDecodeMetaData::clear()
     videoParameters = VideoParameters();
     pcmAudioParameters = PcmAudioParameters();
 
-    fields.clear();
+    fields->clear();
+
+    refreshLastModified = QDateTime();
+    refreshSize = -1;
+
+    lazyFieldsInUse = false;
+    if (lazyFile.is_open()) lazyFile.close();
+    lazyFieldPositions.clear();
+    lazyFieldAudioSamples.clear();
+    lazyFieldIsFirstField.clear();
+    lazyFields.clear();
+    nextFirstFields.clear();
+    invalidateVbiIndex(true);
+
+    journalFileName.clear();
+    journalNumberOfFields = 0;
+    clearChanges();
+}
+
+// Choose whether read() should parse the fields of a JSON file only when
+// they're first used. This makes reading a large file much quicker if only
+// some of the fields are needed, at the cost of keeping the file open. The
+// position of each field is found by scanning the file; if persistIndex is
+// set, the positions are saved to an index file alongside the JSON file (with
+// FIELD_INDEX_SUFFIX added to its name) so later reads can skip the scan.
+// Binary metadata files are always read in full.
+void LdDecodeMetaData::setLazyLoading(bool lazy, bool persistIndex)
+{
+    lazyLoading = lazy;
+    lazyPersistIndex = persistIndex;
+}
+
+// Set the maximum number of threads read() uses to parse JSON files (by
+// default, the number of logical CPUs). Large files are parsed in parallel.
+void LdDecodeMetaData::setMaxThreads(qint32 _maxThreads)
+{
+    maxThreads = _maxThreads;
 }
 
-// Read all metadata from a JSON file
+// Choose whether write() should record changes in a journal, rather than
+// rewriting the whole file, when it's writing to the JSON file the metadata was
+// read from. The journal is a file alongside the JSON file (with
+// JOURNAL_SUFFIX added to its name), to which the changes made by the
+// updateField* methods are appended; read() applies the journal when it reads
+// the JSON file, and compactJournal() folds it back into the JSON file.
+void LdDecodeMetaData::setJournalling(bool _journalling)
+{
+    journalling = _journalling;
+}
+
+// Read the whole of a stream into a string. Returns true on success.
+static bool readWholeStream(std::istream &stream, std::string &contents)
+{
+    stream.seekg(0, std::ios::end);
+    const std::streamoff size = stream.tellg();
+    if (size < 0) {
+        // The stream isn't seekable, so read it in blocks
+        stream.clear();
+        std::ostringstream buffer;
+        buffer << stream.rdbuf();
+        contents = buffer.str();
+        return true;
+    }
+
+    stream.seekg(0, std::ios::beg);
+    contents.resize(static_cast<size_t>(size));
+    stream.read(&contents[0], size);
+    return stream.gcount() == size;
+}
+
+// Read all metadata from a JSON file, or a binary metadata file (see
+// binarymetadata.h). If a .json file doesn't exist, but there's a binary
+// metadata file with the same name, or it's the JSON file for a manifest of a
+// split capture (see tbcparts.h), read that instead.
 bool LdDecodeMetaData::read(QString fileName)
 {
-    std::ifstream jsonFile(fileName.toStdString());
-    if (jsonFile.fail()) {
-        qCritical("Opening JSON input file failed: JSON file cannot be opened/does not exist");
+    QStringList partFileNames;
+    const QString binaryFileName = BinaryMetadata::getSidecarFileName(fileName);
+    if (!binaryFileName.isEmpty()) {
+        fileName = binaryFileName;
+    } else if (TbcParts::getJsonPartFileNames(fileName, partFileNames)) {
+        return readParts(partFileNames);
+    }
+
+    if (BinaryMetadata::isBinary(fileName)) {
+        if (!readBinary(fileName)) return false;
+    } else if (lazyLoading) {
+        if (!readLazy(fileName)) return false;
+    } else {
+        std::ifstream jsonFile(fileName.toStdString(), std::ios::binary);
+        if (jsonFile.fail()) {
+            qCritical("Opening JSON input file failed: JSON file cannot be opened/does not exist");
+            return false;
+        }
+
+        clear();
+        if (maxThreads > 1) {
+            // Read the whole file into memory, so the fields can be parsed in parallel
+            std::string contents;
+            if (!readWholeStream(jsonFile, contents)) {
+                qCritical("Reading JSON input file failed");
+                return false;
+            }
+
+            if (!readJsonParallel(contents.data(), contents.size())) {
+                // Parse it serially instead; if it's invalid, this reports why
+                clear();
+                JsonReader reader(contents.data(), contents.size());
+                if (!readJson(reader)) return false;
+            }
+        } else {
+            JsonReader reader(jsonFile);
+            if (!readJson(reader)) return false;
+        }
+        jsonFile.close();
+    }
+
+    // Check we saw VideoParameters - if not, we can't do anything useful!
+    if (!videoParameters.isValid) {
+        qCritical("JSON file invalid: videoParameters object is not defined");
+        return false;
+    }
+
+    // Check numberOfSequentialFields is consistent
+    if (videoParameters.numberOfSequentialFields != getNumberOfFields()) {
+        qCritical("JSON file invalid: numberOfSequentialFields does not match fields array");
+        return false;
+    }
+
+    // Apply any changes recorded in the JSON file's journal
+    if (!BinaryMetadata::isBinary(fileName)) {
+        if (!readJournal(fileName)) return false;
+
+        journalFileName = fileName;
+        journalNumberOfFields = getNumberOfFields();
+    }
+
+    // Now we know the video system, initialise the rest of VideoParameters
+    initialiseVideoSystemParameters();
+
+    // Generate the PCM audio and frame maps based on the field metadata
+    generatePcmAudioMap();
+    generateFrameMap();
+
+    // The VBI index can be kept alongside this file (until the VBI changes)
+    vbiIndexFileName = fileName;
+
+    return true;
+}
+
+// Parse JSON metadata into this object. Returns true on success.
+bool LdDecodeMetaData::readJson(JsonReader &reader)
+{
+    try {
+        readMembers(reader);
+    } catch (JsonReader::Error &error) {
+        qCritical() << "Parsing JSON file failed:" << error.what();
+        return false;
+    }
+
+    return true;
+}
+
+// Parse JSON metadata from memory into this object, parsing the fields on
+// multiple threads. The result is the same as for readJson. Returns false if
+// the JSON is invalid (without reporting why), or if it's not worth parsing in
+// parallel; in either case, readJson should be used instead.
+bool LdDecodeMetaData::readJsonParallel(const char *data, size_t size)
+{
+    // Find where each field is
+    size_t arrayStart, arrayEnd;
+    std::vector<size_t> fieldStarts;
+    if (!JsonReader::findArrayElements(data, size, "fields", arrayStart, arrayEnd, fieldStarts)) return false;
+    const qint32 numberOfFields = static_cast<qint32>(fieldStarts.size());
+    if (numberOfFields < PARALLEL_MIN_FIELDS || maxThreads <= 1) return false;
+
+    // Parse everything else, with the fields array left empty
+    std::string otherMembers(data, arrayStart + 1);
+    otherMembers.append(data + arrayEnd, size - arrayEnd);
+    JsonReader otherReader(otherMembers.data(), otherMembers.size());
+    try {
+        readMembers(otherReader);
+    } catch (JsonReader::Error &) {
         return false;
     }
 
+    // Parse the fields in chunks, spread across threads. Each field is read
+    // from its own section of the file, so parsing a field can't overrun into
+    // the next. A chunk is parsed into its own buffer, then stored all at
+    // once, so the threads only contend for the store's lock once per chunk.
+    fields->resize(numberOfFields);
+    const qint32 numberOfChunks = (numberOfFields + PARALLEL_CHUNK_FIELDS - 1) / PARALLEL_CHUNK_FIELDS;
+    QAtomicInt failed(0);
+
+    const qint32 numThreads = qMin(numberOfChunks, maxThreads);
+    qDebug() << "LdDecodeMetaData::readJsonParallel(): Parsing" << numberOfFields << "fields using" << numThreads << "threads";
+    parallelFor(numberOfChunks, maxThreads, [&](qint32 chunk) {
+        if (failed.loadRelaxed() != 0) return;
+
+        const qint32 firstField = chunk * PARALLEL_CHUNK_FIELDS;
+        const qint32 lastField = qMin(firstField + PARALLEL_CHUNK_FIELDS, numberOfFields);
+        JsonReader reader(data, 0);
+        QVector<Field> chunkFields(lastField - firstField);
+        for (qint32 i = firstField; i < lastField; i++) {
+            const size_t fieldEnd = (i + 1 < numberOfFields) ? fieldStarts[i + 1] : arrayEnd;
+            reader.setInput(data + fieldStarts[i], fieldEnd - fieldStarts[i]);
+
+            try {
+                chunkFields[i - firstField].read(reader);
+            } catch (JsonReader::Error &) {
+                failed.storeRelaxed(1);
+                return;
+            }
+        }
+        fields->set(firstField, chunkFields);
+    });
+
+    return failed.loadRelaxed() == 0;
+}
+
+// Parse the members of the top-level JSON object
+void LdDecodeMetaData::readMembers(JsonReader &reader)
+{
+    reader.beginObject();
+
+    std::string member;
+    while (reader.readMember(member)) {
+        if (member == "fields") readFields(reader);
+        else if (member == "pcmAudioParameters") pcmAudioParameters.read(reader);
+        else if (member == "videoParameters") videoParameters.read(reader);
+        else reader.discard();
+    }
+
+    reader.endObject();
+}
+
+// Read all metadata from a binary metadata file. Returns true on success.
+bool LdDecodeMetaData::readBinary(QString fileName)
+{
+    BinaryMetadataReader reader;
+    if (!reader.open(fileName)) return false;
+
+    clear();
+
+    // The parameters are stored as JSON
+    const std::string parameters = reader.getParameters();
+    JsonReader parametersReader(parameters.data(), parameters.size());
+    if (!readJson(parametersReader)) return false;
+
+    // Load the columns straight from the file into the store (leaving the
+    // defaults for any that are missing)
+    const qint32 numberOfFields = reader.getNumberOfFields();
+    fields->resize(numberOfFields);
+
+    auto loadColumn = [&](BinaryMetadata::ColumnId id, auto storeId, auto type) {
+        const auto column = reader.getColumn<decltype(type)>(id);
+        if (column.size() == numberOfFields) fields->loadColumn(storeId, column);
+    };
+
+    loadColumn(BinaryMetadata::FIELD_SEQ_NO, FieldStore::SEQ_NO, qint32());
+    loadColumn(BinaryMetadata::FIELD_SYNC_CONF, FieldStore::SYNC_CONF, qint32());
+    loadColumn(BinaryMetadata::FIELD_MEDIAN_BURST_IRE, FieldStore::MEDIAN_BURST_IRE, double());
+    loadColumn(BinaryMetadata::FIELD_FIELD_PHASE_ID, FieldStore::FIELD_PHASE_ID, qint32());
+    loadColumn(BinaryMetadata::FIELD_AUDIO_SAMPLES, FieldStore::AUDIO_SAMPLES, qint32());
+    loadColumn(BinaryMetadata::FIELD_DISK_LOC, FieldStore::DISK_LOC, qint32());
+    loadColumn(BinaryMetadata::FIELD_FILE_LOC, FieldStore::FILE_LOC, qint32());
+    loadColumn(BinaryMetadata::FIELD_DECODE_FAULTS, FieldStore::DECODE_FAULTS, qint32());
+    loadColumn(BinaryMetadata::FIELD_EFM_T_VALUES, FieldStore::EFM_T_VALUES, qint32());
+    loadColumn(BinaryMetadata::FIELD_VITS_WSNR, FieldStore::VITS_WSNR, double());
+    loadColumn(BinaryMetadata::FIELD_VITS_BPSNR, FieldStore::VITS_BPSNR, double());
+    loadColumn(BinaryMetadata::FIELD_VBI_DATA_0, FieldStore::VBI_DATA_0, qint32());
+    loadColumn(BinaryMetadata::FIELD_VBI_DATA_1, FieldStore::VBI_DATA_1, qint32());
+    loadColumn(BinaryMetadata::FIELD_VBI_DATA_2, FieldStore::VBI_DATA_2, qint32());
+    loadColumn(BinaryMetadata::FIELD_NTSC_FM_CODE_DATA, FieldStore::NTSC_FM_CODE_DATA, qint32());
+    loadColumn(BinaryMetadata::FIELD_NTSC_CC_DATA_0, FieldStore::NTSC_CC_DATA_0, qint32());
+    loadColumn(BinaryMetadata::FIELD_NTSC_CC_DATA_1, FieldStore::NTSC_CC_DATA_1, qint32());
+
+    // Translate the file's flags into the store's
+    struct FlagsColumn {
+        BinaryMetadataReader::Column<quint32> column;
+
+        quint8 operator[](qint32 index) const {
+            static constexpr std::pair<quint32, quint8> FLAGS[] = {
+                {BinaryMetadata::FLAG_IS_FIRST_FIELD, FieldStore::FLAG_IS_FIRST_FIELD},
+                {BinaryMetadata::FLAG_PAD, FieldStore::FLAG_PAD},
+                {BinaryMetadata::FLAG_VITS_IN_USE, FieldStore::FLAG_VITS_IN_USE},
+                {BinaryMetadata::FLAG_VBI_IN_USE, FieldStore::FLAG_VBI_IN_USE},
+                {BinaryMetadata::FLAG_NTSC_IN_USE, FieldStore::FLAG_NTSC_IN_USE},
+                {BinaryMetadata::FLAG_NTSC_IS_FM_CODE_DATA_VALID, FieldStore::FLAG_NTSC_IS_FM_CODE_DATA_VALID},
+                {BinaryMetadata::FLAG_NTSC_FIELD_FLAG, FieldStore::FLAG_NTSC_FIELD_FLAG},
+                {BinaryMetadata::FLAG_NTSC_WHITE_FLAG, FieldStore::FLAG_NTSC_WHITE_FLAG},
+            };
+
+            const quint32 fileFlags = column[index];
+            quint8 storeFlags = 0;
+            for (const auto &flag : FLAGS) {
+                if ((fileFlags & flag.first) != 0) storeFlags |= flag.second;
+            }
+            return storeFlags;
+        }
+    };
+    const FlagsColumn flagsColumn {reader.getColumn<quint32>(BinaryMetadata::FIELD_FLAGS)};
+    if (flagsColumn.column.size() == numberOfFields) fields->loadFlags(flagsColumn);
+
+    // Check the dropout table before loading it into the store's pool
+    const auto dropOutsStart = reader.getColumn<qint64>(BinaryMetadata::FIELD_DROPOUTS_START);
+    const auto startx = reader.getColumn<qint32>(BinaryMetadata::DROPOUT_STARTX);
+    const auto endx = reader.getColumn<qint32>(BinaryMetadata::DROPOUT_ENDX);
+    const auto fieldLine = reader.getColumn<qint32>(BinaryMetadata::DROPOUT_FIELD_LINE);
+    const qint64 numberOfDropOuts = reader.getNumberOfDropOuts();
+    if (numberOfDropOuts > 0) {
+        if (numberOfDropOuts > std::numeric_limits<qint32>::max()
+            || dropOutsStart.size() != numberOfFields + 1 || startx.size() != numberOfDropOuts
+            || endx.size() != numberOfDropOuts || fieldLine.size() != numberOfDropOuts) {
+            qCritical() << "Binary metadata file" << fileName << "has an invalid dropout table";
+            fields->clear();
+            return false;
+        }
+
+        for (qint32 i = 0; i < numberOfFields; i++) {
+            const qint64 first = dropOutsStart[i];
+            const qint64 last = dropOutsStart[i + 1];
+            if (first < 0 || last < first || last > numberOfDropOuts) {
+                qCritical() << "Binary metadata file" << fileName << "has an invalid dropout table";
+                fields->clear();
+                return false;
+            }
+        }
+
+        fields->loadDropOuts(dropOutsStart, startx, endx, fieldLine);
+    }
+
+    return true;
+}
+
+// Read metadata from a JSON file, but rather than parsing the fields, just
+// find where each one is in the file; loadField parses them when they're
+// used. Returns true on success.
+bool LdDecodeMetaData::readLazy(QString fileName)
+{
     clear();
 
-    JsonReader reader(jsonFile);
+    lazyFile.open(fileName.toStdString(), std::ios::binary);
+    if (lazyFile.fail()) {
+        qCritical("Opening JSON input file failed: JSON file cannot be opened/does not exist");
+        return false;
+    }
+    lazyFieldsInUse = true;
+
+    // Use the index file if there's an up-to-date one
+    const QString indexFileName = fileName + FIELD_INDEX_SUFFIX;
+    if (lazyPersistIndex && readFieldIndex(fileName, indexFileName)) return true;
 
+    // Scan the file. Each field still needs parsing to find where it ends, but
+    // only its position, audioSamples and isFirstField (needed for the PCM
+    // audio and frame maps) are kept.
+    JsonReader reader(lazyFile);
     try {
         reader.beginObject();
 
         std::string member;
         while (reader.readMember(member)) {
-            if (member == "fields") readFields(reader);
-            else if (member == "pcmAudioParameters") pcmAudioParameters.read(reader);
-            else if (member == "videoParameters") videoParameters.read(reader);
-            else reader.discard();
+            if (member == "fields") {
+                reader.beginArray();
+                while (reader.readElement()) {
+                    lazyFieldPositions.append(static_cast<qint64>(reader.getPosition()));
+                    Field field;
+                    field.read(reader);
+                    lazyFieldAudioSamples.append(field.audioSamples);
+                    lazyFieldIsFirstField.append(field.isFirstField);
+                }
+                reader.endArray();
+            } else if (member == "pcmAudioParameters") {
+                pcmAudioParameters.read(reader);
+            } else if (member == "videoParameters") {
+                videoParameters.read(reader);
+            } else {
+                reader.discard();
+            }
         }
 
         reader.endObject();
@@ -462,41 +871,539 @@ bool LdDecodeMetaData::read(QString fileName)
         qCritical() << "Parsing JSON file failed:" << error.what();
         return false;
     }
+    lazyFields.resize(lazyFieldPositions.size());
 
-    jsonFile.close();
+    if (lazyPersistIndex) writeFieldIndex(fileName, indexFileName);
 
-    // Check we saw VideoParameters - if not, we can't do anything useful!
-    if (!videoParameters.isValid) {
-        qCritical("JSON file invalid: videoParameters object is not defined");
+    return true;
+}
+
+// Read the field positions and parameters from a field index file, if it
+// exists and matches the JSON file. Returns true on success.
+bool LdDecodeMetaData::readFieldIndex(const QString &jsonFileName, const QString &indexFileName)
+{
+    QFile indexFile(indexFileName);
+    if (!indexFile.open(QIODevice::ReadOnly)) return false;
+    const QByteArray index = indexFile.readAll();
+    indexFile.close();
+    const uchar *data = reinterpret_cast<const uchar *>(index.constData());
+
+    if (index.size() < FIELD_INDEX_HEADER_SIZE || memcmp(data, FIELD_INDEX_MAGIC, FIELD_INDEX_MAGIC_SIZE) != 0) {
+        qDebug() << "LdDecodeMetaData::readFieldIndex(): Ignoring invalid index file" << indexFileName;
         return false;
     }
 
-    // Check numberOfSequentialFields is consistent
-    if (videoParameters.numberOfSequentialFields != fields.size()) {
-        qCritical("JSON file invalid: numberOfSequentialFields does not match fields array");
+    // Check the index was made from this version of the JSON file
+    const QFileInfo jsonInfo(jsonFileName);
+    if (BinaryMetadata::load<quint64>(data + 8) != static_cast<quint64>(jsonInfo.size())
+        || BinaryMetadata::load<qint64>(data + 16) != jsonInfo.lastModified().toMSecsSinceEpoch()) {
+        qDebug() << "LdDecodeMetaData::readFieldIndex(): Index file" << indexFileName << "is out of date";
         return false;
     }
 
-    // Now we know the video system, initialise the rest of VideoParameters
-    initialiseVideoSystemParameters();
+    const qint32 numberOfFields = static_cast<qint32>(BinaryMetadata::load<quint32>(data + 24));
+    const qint64 parametersLength = static_cast<qint64>(BinaryMetadata::load<quint64>(data + 32));
+    if (numberOfFields < 0 || parametersLength < 0
+        || index.size() != FIELD_INDEX_HEADER_SIZE + parametersLength
+                           + (static_cast<qint64>(numberOfFields) * FIELD_INDEX_ENTRY_SIZE)) {
+        qDebug() << "LdDecodeMetaData::readFieldIndex(): Ignoring truncated index file" << indexFileName;
+        return false;
+    }
+
+    JsonReader parametersReader(index.constData() + FIELD_INDEX_HEADER_SIZE, static_cast<size_t>(parametersLength));
+    if (!readJson(parametersReader)) {
+        videoParameters = VideoParameters();
+        pcmAudioParameters = PcmAudioParameters();
+        return false;
+    }
+
+    lazyFieldPositions.resize(numberOfFields);
+    lazyFieldAudioSamples.resize(numberOfFields);
+    lazyFieldIsFirstField.resize(numberOfFields);
+    const uchar *entry = data + FIELD_INDEX_HEADER_SIZE + parametersLength;
+    for (qint32 i = 0; i < numberOfFields; i++) {
+        lazyFieldPositions[i] = static_cast<qint64>(BinaryMetadata::load<quint64>(entry));
+        lazyFieldAudioSamples[i] = BinaryMetadata::load<qint32>(entry + 8);
+        lazyFieldIsFirstField[i] = BinaryMetadata::load<quint32>(entry + 12) != 0;
+        entry += FIELD_INDEX_ENTRY_SIZE;
+    }
+    lazyFields.resize(numberOfFields);
+
+    qDebug() << "LdDecodeMetaData::readFieldIndex(): Read" << numberOfFields << "fields from index file" << indexFileName;
+    return true;
+}
+
+// Write the field positions and parameters to a field index file. The index
+// is only an optimisation, so failing to write it isn't an error.
+void LdDecodeMetaData::writeFieldIndex(const QString &jsonFileName, const QString &indexFileName) const
+{
+    const QFileInfo jsonInfo(jsonFileName);
+    const std::string parameters = getParametersJson();
+    const qint32 numberOfFields = lazyFieldPositions.size();
+
+    QByteArray index(static_cast<qint32>(FIELD_INDEX_HEADER_SIZE + parameters.size()
+                                         + (static_cast<size_t>(numberOfFields) * FIELD_INDEX_ENTRY_SIZE)), '\0');
+    uchar *data = reinterpret_cast<uchar *>(index.data());
+    memcpy(data, FIELD_INDEX_MAGIC, FIELD_INDEX_MAGIC_SIZE);
+    BinaryMetadata::store<quint64>(static_cast<quint64>(jsonInfo.size()), data + 8);
+    BinaryMetadata::store<qint64>(jsonInfo.lastModified().toMSecsSinceEpoch(), data + 16);
+    BinaryMetadata::store<quint32>(static_cast<quint32>(numberOfFields), data + 24);
+    BinaryMetadata::store<quint64>(static_cast<quint64>(parameters.size()), data + 32);
+    memcpy(data + FIELD_INDEX_HEADER_SIZE, parameters.data(), parameters.size());
+
+    uchar *entry = data + FIELD_INDEX_HEADER_SIZE + parameters.size();
+    for (qint32 i = 0; i < numberOfFields; i++) {
+        BinaryMetadata::store<quint64>(static_cast<quint64>(lazyFieldPositions[i]), entry);
+        BinaryMetadata::store<qint32>(lazyFieldAudioSamples[i], entry + 8);
+        BinaryMetadata::store<quint32>(lazyFieldIsFirstField[i] ? 1 : 0, entry + 12);
+        entry += FIELD_INDEX_ENTRY_SIZE;
+    }
+
+    QFile indexFile(indexFileName);
+    if (!indexFile.open(QIODevice::WriteOnly | QIODevice::Truncate) || indexFile.write(index) != index.size()) {
+        qDebug() << "LdDecodeMetaData::writeFieldIndex(): Couldn't write index file" << indexFileName;
+        indexFile.close();
+        indexFile.remove();
+        return;
+    }
+    indexFile.close();
+}
+
+const char LdDecodeMetaData::JOURNAL_SUFFIX[] = ".journal";
+
+// Journal files are text, with one JSON object per line. The first line is a
+// header identifying the version of the JSON file the journal applies to (see
+// getJournalHeader). Each following line is a record of the changes to one
+// field, with members:
+//   "field"        the sequential field number
+//   "replace"      the whole field, replacing the existing one
+//   "dropOuts", "ntsc", "vbi", "vitsMetrics"
+//                  the new value of that part of the field
+//   "remove"       an array of the names of parts that are now empty or
+//                  not in use
+// Records are applied in order. A record without a newline at the end is
+// incomplete (because writing it was interrupted), and is ignored.
+
+// Get the header line for the journal of a JSON file
+std::string LdDecodeMetaData::getJournalHeader(const QString &jsonFileName) const
+{
+    const QFileInfo jsonInfo(jsonFileName);
+
+    std::string header;
+    JsonWriter writer(header);
+    writer.beginObject();
+    writer.writeMember("baseModified", static_cast<long long>(jsonInfo.lastModified().toMSecsSinceEpoch()));
+    writer.writeMember("baseSize", static_cast<long long>(jsonInfo.size()));
+    writer.writeMember("numberOfFields", journalNumberOfFields);
+    writer.writeMember("version", 1);
+    writer.endObject();
+
+    return header;
+}
+
+// Apply the changes in a JSON file's journal, if it has one. A journal for a
+// different version of the JSON file is ignored. Returns false if the journal
+// is invalid.
+bool LdDecodeMetaData::readJournal(const QString &jsonFileName)
+{
+    QFile journalFile(jsonFileName + JOURNAL_SUFFIX);
+    if (!journalFile.exists()) return true;
+    if (!journalFile.open(QIODevice::ReadOnly)) {
+        qCritical() << "Opening journal file" << journalFile.fileName() << "failed:" << journalFile.errorString();
+        return false;
+    }
+    const QByteArray contents = journalFile.readAll();
+    journalFile.close();
+
+    journalNumberOfFields = getNumberOfFields();
+    const std::string header = getJournalHeader(jsonFileName);
+    qint32 lineStart = 0;
+    qint32 numberOfRecords = 0;
+    while (true) {
+        const qint32 lineEnd = contents.indexOf('\n', lineStart);
+        if (lineEnd == -1) {
+            if (lineStart != contents.size()) {
+                qWarning() << "Ignoring incomplete record at the end of journal file" << journalFile.fileName();
+            }
+            break;
+        }
+
+        const char *line = contents.constData() + lineStart;
+        const size_t lineLength = static_cast<size_t>(lineEnd - lineStart);
+        if (lineStart == 0) {
+            if (header.compare(0, std::string::npos, line, lineLength) != 0) {
+                qWarning() << "Ignoring journal file" << journalFile.fileName() << "as it doesn't match" << jsonFileName;
+                return true;
+            }
+        } else {
+            JsonReader reader(line, lineLength);
+            try {
+                readJournalRecord(reader);
+            } catch (JsonReader::Error &error) {
+                qCritical() << "Parsing journal file" << journalFile.fileName() << "failed:" << error.what();
+                return false;
+            }
+            numberOfRecords++;
+        }
+
+        lineStart = lineEnd + 1;
+    }
+
+    qDebug() << "LdDecodeMetaData::readJournal(): Applied" << numberOfRecords << "records from journal file" << journalFile.fileName();
+    return true;
+}
+
+// Read a journal record, and apply it to the fields
+void LdDecodeMetaData::readJournalRecord(JsonReader &reader)
+{
+    // Parts that are being removed are left at their defaults in update
+    Field update;
+    qint32 seqNo = -1;
+    quint8 parts = 0;
+
+    reader.beginObject();
+
+    std::string member;
+    while (reader.readMember(member)) {
+        if (member == "dropOuts") {
+            update.dropOuts.read(reader);
+            parts |= JOURNAL_DROPOUTS;
+        } else if (member == "field") {
+            reader.read(seqNo);
+        } else if (member == "ntsc") {
+            update.ntsc.read(reader);
+            parts |= JOURNAL_NTSC;
+        } else if (member == "remove") {
+            reader.beginArray();
+            while (reader.readElement()) {
+                reader.read(member);
+                if (member == "dropOuts") parts |= JOURNAL_DROPOUTS;
+                else if (member == "ntsc") parts |= JOURNAL_NTSC;
+                else if (member == "vbi") parts |= JOURNAL_VBI;
+                else if (member == "vitsMetrics") parts |= JOURNAL_VITS_METRICS;
+            }
+            reader.endArray();
+        } else if (member == "replace") {
+            update.read(reader);
+            parts |= JOURNAL_FIELD;
+        } else if (member == "vbi") {
+            update.vbi.read(reader);
+            parts |= JOURNAL_VBI;
+        } else if (member == "vitsMetrics") {
+            update.vitsMetrics.read(reader);
+            parts |= JOURNAL_VITS_METRICS;
+        } else {
+            reader.discard();
+        }
+    }
+
+    reader.endObject();
+
+    if (seqNo < 1 || seqNo > getNumberOfFields()) reader.throwError("field number out of range");
 
-    // Generate the PCM audio map based on the field metadata
+    Field field = fieldAt(seqNo - 1);
+    if ((parts & JOURNAL_FIELD) != 0) field = update;
+    if ((parts & JOURNAL_VITS_METRICS) != 0) field.vitsMetrics = update.vitsMetrics;
+    if ((parts & JOURNAL_VBI) != 0) field.vbi = update.vbi;
+    if ((parts & JOURNAL_NTSC) != 0) field.ntsc = update.ntsc;
+    if ((parts & JOURNAL_DROPOUTS) != 0) field.dropOuts = update.dropOuts;
+    setFieldAt(seqNo - 1, field);
+}
+
+// Append the changes made to the fields to the journal of the JSON file the
+// metadata was read from (see setJournalling), creating it if necessary.
+// Returns true on success.
+bool LdDecodeMetaData::writeJournal(QString fileName) const
+{
+    if (journalFileName.isEmpty() || fileName != journalFileName) {
+        qCritical("Writing journal failed: the metadata was not read from this JSON file");
+        return false;
+    }
+    if (getNumberOfFields() != journalNumberOfFields) {
+        qCritical("Writing journal failed: fields have been added since the JSON file was read");
+        return false;
+    }
+
+    // If there's already a journal for this version of the JSON file, add to
+    // it; otherwise, start a new one
+    const std::string header = getJournalHeader(fileName);
+    QFile existingFile(fileName + JOURNAL_SUFFIX);
+    bool append = false;
+    if (existingFile.open(QIODevice::ReadOnly)) {
+        append = existingFile.readLine() == QByteArray::fromStdString(header + "\n");
+        existingFile.close();
+    }
+
+    std::ofstream journalFile((fileName + JOURNAL_SUFFIX).toStdString(),
+                              std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+    if (journalFile.fail()) {
+        qCritical("Opening journal file failed");
+        return false;
+    }
+
+    std::string records;
+    if (!append) records = header + "\n";
+    for (qint32 fieldNumber : journalChangedFields) {
+        const Field field = fieldAt(fieldNumber);
+        const quint8 parts = journalChanges[fieldNumber];
+
+        // Keep members in alphabetical order
+        JsonWriter writer(records);
+        writer.beginObject();
+        if ((parts & JOURNAL_DROPOUTS) != 0 && !field.dropOuts.empty()) {
+            writer.writeMember("dropOuts");
+            field.dropOuts.write(writer);
+        }
+        writer.writeMember("field", fieldNumber + 1);
+        if ((parts & JOURNAL_NTSC) != 0 && field.ntsc.inUse) {
+            writer.writeMember("ntsc");
+            field.ntsc.write(writer);
+        }
+
+        // Parts that have changed, but are now empty
+        const struct {
+            quint8 part;
+            const char *name;
+            bool isPresent;
+        } removableParts[] = {
+            {JOURNAL_DROPOUTS, "dropOuts", !field.dropOuts.empty()},
+            {JOURNAL_NTSC, "ntsc", field.ntsc.inUse},
+            {JOURNAL_VBI, "vbi", field.vbi.inUse},
+            {JOURNAL_VITS_METRICS, "vitsMetrics", field.vitsMetrics.inUse},
+        };
+        bool anyRemoved = false;
+        for (const auto &removable : removableParts) {
+            if ((parts & removable.part) == 0 || removable.isPresent) continue;
+            if (!anyRemoved) {
+                writer.writeMember("remove");
+                writer.beginArray();
+                anyRemoved = true;
+            }
+            writer.writeElement();
+            writer.write(removable.name);
+        }
+        if (anyRemoved) writer.endArray();
+
+        if ((parts & JOURNAL_FIELD) != 0) {
+            writer.writeMember("replace");
+            field.write(writer);
+        }
+        if ((parts & JOURNAL_VBI) != 0 && field.vbi.inUse) {
+            writer.writeMember("vbi");
+            field.vbi.write(writer);
+        }
+        if ((parts & JOURNAL_VITS_METRICS) != 0 && field.vitsMetrics.inUse) {
+            writer.writeMember("vitsMetrics");
+            field.vitsMetrics.write(writer);
+        }
+        writer.endObject();
+        records += '\n';
+    }
+
+    journalFile.write(records.data(), static_cast<std::streamsize>(records.size()));
+    journalFile.close();
+    if (journalFile.fail()) {
+        qCritical("Writing journal file failed");
+        return false;
+    }
+
+    qDebug() << "LdDecodeMetaData::writeJournal(): Wrote" << journalChangedFields.size() << "records to journal file"
+             << fileName + JOURNAL_SUFFIX;
+    clearChanges();
+    return true;
+}
+
+// A std::streambuf that writes to a QIODevice, so a JsonWriter can write to a
+// QSaveFile. Output is collected in a buffer, so the device isn't called for
+// every small write the JsonWriter makes.
+class IODeviceStreamBuf : public std::streambuf
+{
+public:
+    IODeviceStreamBuf(QIODevice &_device) : device(_device), buffer(BUFFER_SIZE) {
+        setp(buffer.data(), buffer.data() + buffer.size());
+    }
+
+protected:
+    int_type overflow(int_type c) override {
+        if (!flushBuffer()) return traits_type::eof();
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    int sync() override {
+        return flushBuffer() ? 0 : -1;
+    }
+
+private:
+    static constexpr qint32 BUFFER_SIZE = 64 * 1024;
+
+    // Write out the buffered data, returning false on error
+    bool flushBuffer() {
+        const qint64 count = pptr() - pbase();
+        if (count != 0 && device.write(pbase(), count) != count) return false;
+        setp(buffer.data(), buffer.data() + buffer.size());
+        return true;
+    }
+
+    QIODevice &device;
+    std::vector<char> buffer;
+};
+
+// Rewrite a JSON file in full from this metadata, which must have been read
+// from it, folding in its journal. Returns true on success.
+bool LdDecodeMetaData::compactJournal(QString fileName) const
+{
+    if (journalFileName.isEmpty() || fileName != journalFileName) {
+        qCritical("Compacting journal failed: the metadata was not read from this JSON file");
+        return false;
+    }
+
+    return writeJson(fileName);
+}
+
+// Note that some parts of a field have changed, for the journal
+void LdDecodeMetaData::recordChange(qint32 fieldNumber, quint8 parts)
+{
+    if (!journalling || journalFileName.isEmpty()) return;
+
+    if (journalChanges.size() <= fieldNumber) journalChanges.resize(getNumberOfFields());
+    if (journalChanges[fieldNumber] == 0) journalChangedFields.append(fieldNumber);
+    journalChanges[fieldNumber] |= parts;
+}
+
+// Forget the changes recorded for the journal
+void LdDecodeMetaData::clearChanges() const
+{
+    journalChanges.clear();
+    journalChangedFields.clear();
+}
+
+// Read the metadata for a capture that has been split into several parts, from
+// each part's JSON file in order. The parts' fields are joined into a single
+// sequence, as if the TBC files had been joined together.
+bool LdDecodeMetaData::readParts(QStringList fileNames)
+{
+    if (fileNames.isEmpty()) {
+        qCritical("Opening JSON input files failed: no parts given");
+        return false;
+    }
+
+    // The first part supplies the parameters
+    if (!read(fileNames.first())) return false;
+
+    for (qint32 i = 1; i < fileNames.size(); i++) {
+        LdDecodeMetaData partMetaData;
+        if (!partMetaData.read(fileNames[i])) return false;
+
+        // The video must be in the same format throughout
+        const VideoParameters &partParameters = partMetaData.videoParameters;
+        if (partParameters.system != videoParameters.system
+            || partParameters.fieldWidth != videoParameters.fieldWidth
+            || partParameters.fieldHeight != videoParameters.fieldHeight) {
+            qCritical() << "JSON file" << fileNames[i] << "has different video parameters from the first part";
+            return false;
+        }
+
+        // Renumber the part's fields to follow on from the previous parts (the
+        // field's dropouts and other metadata go with it)
+        const qint32 firstSeqNo = getNumberOfFields();
+        for (qint32 j = 0; j < partMetaData.getNumberOfFields(); j++) {
+            Field field = partMetaData.fieldAt(j);
+            field.seqNo += firstSeqNo;
+            appendField(field);
+        }
+    }
+
+    // The audio map covers all the fields, so it needs regenerating
+    generatePcmAudioMap();
+
+    return true;
+}
+
+// Re-read a JSON file that is still being written (e.g. by ld-decode), and
+// append any fields that have been added to it. Fields that have already been
+// read are left as they are, so changes the application has made to them are
+// kept. Returns true if any fields were added.
+bool LdDecodeMetaData::refreshFields(QString fileName)
+{
+    // Don't re-read the file if it hasn't changed
+    const QFileInfo fileInfo(fileName);
+    if (!fileInfo.exists()
+        || (fileInfo.lastModified() == refreshLastModified && fileInfo.size() == refreshSize)) {
+        return false;
+    }
+
+    // If the read fails (e.g. because the writer was part way through
+    // updating the file), try again next time. The file's state is recorded
+    // from before the read, so a change during the read is picked up later.
+    LdDecodeMetaData newMetaData;
+    if (!newMetaData.read(fileName)) return false;
+    refreshLastModified = fileInfo.lastModified();
+    refreshSize = fileInfo.size();
+
+    const qint32 numberOfFields = newMetaData.getNumberOfFields();
+    if (numberOfFields <= getNumberOfFields()) return false;
+
+    qDebug() << "LdDecodeMetaData::refreshFields(): Adding" << numberOfFields - getNumberOfFields() << "fields";
+    for (qint32 i = getNumberOfFields(); i < numberOfFields; i++) {
+        appendField(newMetaData.fieldAt(i));
+    }
+
+    // The audio map covers all the fields, so it needs regenerating
     generatePcmAudioMap();
 
     return true;
 }
 
-// Write all metadata out to a JSON file
+// Write all metadata out to a file. If the filename ends with
+// BinaryMetadata::FILE_SUFFIX, write a binary metadata file; if journalling is
+// enabled and it's the JSON file the metadata was read from, add the changes
+// to its journal; otherwise, write JSON.
 bool LdDecodeMetaData::write(QString fileName) const
 {
-    std::ofstream jsonFile(fileName.toStdString());
-    if (jsonFile.fail()) {
-        qCritical("Opening JSON output file failed");
+    if (fileName.endsWith(BinaryMetadata::FILE_SUFFIX)) return writeBinary(fileName);
+    if (journalling && fileName == journalFileName) return writeJournal(fileName);
+
+    return writeJson(fileName);
+}
+
+// Write all metadata out to a JSON file. The file is written with QSaveFile,
+// so it atomically replaces any existing file, which is left untouched if
+// writing fails.
+bool LdDecodeMetaData::writeJson(QString fileName) const
+{
+    QSaveFile jsonFile(fileName);
+    if (!jsonFile.open(QIODevice::WriteOnly)) {
+        qCritical() << "Opening JSON output file" << fileName << "failed:" << jsonFile.errorString();
         return false;
     }
 
-    JsonWriter writer(jsonFile);
+    IODeviceStreamBuf streamBuf(jsonFile);
+    std::ostream stream(&streamBuf);
+    {
+        JsonWriter writer(stream);
+        writeMembers(writer);
+    }
+    stream.flush();
+
+    if (stream.fail() || !jsonFile.commit()) {
+        qCritical() << "Writing JSON output file" << fileName << "failed:" << jsonFile.errorString();
+        return false;
+    }
+
+    // Any journal for the old version of the file no longer applies
+    QFile::remove(fileName + JOURNAL_SUFFIX);
+    if (fileName == journalFileName) clearChanges();
+
+    return true;
+}
 
+// Write all metadata out as a JSON object
+void LdDecodeMetaData::writeMembers(JsonWriter &writer) const
+{
     writer.beginObject();
 
     // Keep members in alphabetical order
@@ -510,10 +1417,109 @@ bool LdDecodeMetaData::write(QString fileName) const
     videoParameters.write(writer);
 
     writer.endObject();
+}
 
-    jsonFile.close();
+// Write all metadata out to a binary metadata file
+bool LdDecodeMetaData::writeBinary(QString fileName) const
+{
+    const qint32 numberOfFields = getNumberOfFields();
+
+    // Gather the values for each column
+    QVector<qint32> seqNo(numberOfFields), syncConf(numberOfFields), fieldPhaseID(numberOfFields);
+    QVector<qint32> audioSamples(numberOfFields), diskLoc(numberOfFields), fileLoc(numberOfFields);
+    QVector<qint32> decodeFaults(numberOfFields), efmTValues(numberOfFields);
+    QVector<qint32> vbiData0(numberOfFields), vbiData1(numberOfFields), vbiData2(numberOfFields);
+    QVector<qint32> fmCodeData(numberOfFields), ccData0(numberOfFields), ccData1(numberOfFields);
+    QVector<quint32> flags(numberOfFields);
+    QVector<double> medianBurstIRE(numberOfFields), wSNR(numberOfFields), bPSNR(numberOfFields);
+    QVector<qint64> dropOutsStart(numberOfFields + 1);
+    QVector<qint32> startx, endx, fieldLine;
+
+    for (qint32 i = 0; i < numberOfFields; i++) {
+        const Field field = fieldAt(i);
+
+        seqNo[i] = field.seqNo;
+        syncConf[i] = field.syncConf;
+        medianBurstIRE[i] = field.medianBurstIRE;
+        fieldPhaseID[i] = field.fieldPhaseID;
+        audioSamples[i] = field.audioSamples;
+        diskLoc[i] = field.diskLoc;
+        fileLoc[i] = field.fileLoc;
+        decodeFaults[i] = field.decodeFaults;
+        efmTValues[i] = field.efmTValues;
+        wSNR[i] = field.vitsMetrics.wSNR;
+        bPSNR[i] = field.vitsMetrics.bPSNR;
+        vbiData0[i] = field.vbi.vbiData[0];
+        vbiData1[i] = field.vbi.vbiData[1];
+        vbiData2[i] = field.vbi.vbiData[2];
+        fmCodeData[i] = field.ntsc.fmCodeData;
+        ccData0[i] = field.ntsc.ccData0;
+        ccData1[i] = field.ntsc.ccData1;
+
+        quint32 fieldFlags = 0;
+        if (field.isFirstField) fieldFlags |= BinaryMetadata::FLAG_IS_FIRST_FIELD;
+        if (field.pad) fieldFlags |= BinaryMetadata::FLAG_PAD;
+        if (field.vitsMetrics.inUse) fieldFlags |= BinaryMetadata::FLAG_VITS_IN_USE;
+        if (field.vbi.inUse) fieldFlags |= BinaryMetadata::FLAG_VBI_IN_USE;
+        if (field.ntsc.inUse) fieldFlags |= BinaryMetadata::FLAG_NTSC_IN_USE;
+        if (field.ntsc.isFmCodeDataValid) fieldFlags |= BinaryMetadata::FLAG_NTSC_IS_FM_CODE_DATA_VALID;
+        if (field.ntsc.fieldFlag) fieldFlags |= BinaryMetadata::FLAG_NTSC_FIELD_FLAG;
+        if (field.ntsc.whiteFlag) fieldFlags |= BinaryMetadata::FLAG_NTSC_WHITE_FLAG;
+        flags[i] = fieldFlags;
+
+        dropOutsStart[i] = startx.size();
+        for (qint32 j = 0; j < field.dropOuts.size(); j++) {
+            startx.append(field.dropOuts.startx(j));
+            endx.append(field.dropOuts.endx(j));
+            fieldLine.append(field.dropOuts.fieldLine(j));
+        }
+    }
+    dropOutsStart[numberOfFields] = startx.size();
+
+    BinaryMetadataWriter binaryWriter(numberOfFields, startx.size());
+    binaryWriter.setParameters(getParametersJson());
+    binaryWriter.addColumn(BinaryMetadata::FIELD_SEQ_NO, seqNo);
+    binaryWriter.addColumn(BinaryMetadata::FIELD_FLAGS, flags);
+    binaryWriter.addColumn(BinaryMetadata::FIELD_SYNC_CONF, syncConf);
+    binaryWriter.addColumn(BinaryMetadata::FIELD_MEDIAN_BURST_IRE, medianBurstIRE);
+    binaryWriter.addColumn(BinaryMetadata::FIELD_FIELD_PHASE_ID, fieldPhaseID);
+    binaryWriter.addColumn(BinaryMetadata::FIELD_AUDIO_SAMPLES, audioSamples);
+    binaryWriter.addColumn(BinaryMetadata::FIELD_DISK_LOC, diskLoc);
+    binaryWriter.addColumn(BinaryMetadata::FIELD_FILE_LOC, fileLoc);
+    binaryWriter.addColumn(BinaryMetadata::FIELD_DECODE_FAULTS, decodeFaults);
+    binaryWriter.addColumn(BinaryMetadata::FIELD_EFM_T_VALUES, efmTValues);
+    binaryWriter.addColumn(BinaryMetadata::FIELD_VITS_WSNR, wSNR);
+    binaryWriter.addColumn(BinaryMetadata::FIELD_VITS_BPSNR, bPSNR);
+    binaryWriter.addColumn(BinaryMetadata::FIELD_VBI_DATA_0, vbiData0);
+    binaryWriter.addColumn(BinaryMetadata::FIELD_VBI_DATA_1, vbiData1);
+    binaryWriter.addColumn(BinaryMetadata::FIELD_VBI_DATA_2, vbiData2);
+    binaryWriter.addColumn(BinaryMetadata::FIELD_NTSC_FM_CODE_DATA, fmCodeData);
+    binaryWriter.addColumn(BinaryMetadata::FIELD_NTSC_CC_DATA_0, ccData0);
+    binaryWriter.addColumn(BinaryMetadata::FIELD_NTSC_CC_DATA_1, ccData1);
+    binaryWriter.addColumn(BinaryMetadata::FIELD_DROPOUTS_START, dropOutsStart);
+    binaryWriter.addColumn(BinaryMetadata::DROPOUT_STARTX, startx);
+    binaryWriter.addColumn(BinaryMetadata::DROPOUT_ENDX, endx);
+    binaryWriter.addColumn(BinaryMetadata::DROPOUT_FIELD_LINE, fieldLine);
+
+    return binaryWriter.write(fileName);
+}
 
-    return true;
+// Get the videoParameters and pcmAudioParameters members of the metadata, as
+// a JSON object
+std::string LdDecodeMetaData::getParametersJson() const
+{
+    std::ostringstream parameters;
+    JsonWriter writer(parameters);
+    writer.beginObject();
+    if (pcmAudioParameters.isValid) {
+        writer.writeMember("pcmAudioParameters");
+        pcmAudioParameters.write(writer);
+    }
+    writer.writeMember("videoParameters");
+    videoParameters.write(writer);
+    writer.endObject();
+
+    return parameters.str();
 }
 
 // Read array of Fields from JSON
@@ -524,7 +1530,7 @@ void LdDecodeMetaData::readFields(JsonReader &reader)
     while (reader.readElement()) {
         Field field;
         field.read(reader);
-        fields.push_back(field);
+        fields->append(field);
     }
 
     reader.endArray();
@@ -535,9 +1541,44 @@ void LdDecodeMetaData::writeFields(JsonWriter &writer) const
 {
     writer.beginArray();
 
-    for (const Field &field : fields) {
-        writer.writeElement();
-        field.write(writer);
+    const qint32 numberOfFields = getNumberOfFields();
+    if (numberOfFields < PARALLEL_MIN_FIELDS || maxThreads <= 1) {
+        for (qint32 i = 0; i < numberOfFields; i++) {
+            writer.writeElement();
+            fieldAt(i).write(writer);
+        }
+
+        writer.endArray();
+        return;
+    }
+
+    // Serialise the fields in batches of chunks. The chunks in a batch are
+    // spread across threads, each written into that chunk's string; once the
+    // batch is finished, the strings are written out in order, so the output
+    // is the same as writing the fields one at a time.
+    const qint32 numberOfChunks = (numberOfFields + PARALLEL_CHUNK_FIELDS - 1) / PARALLEL_CHUNK_FIELDS;
+    const qint32 batchChunks = maxThreads * PARALLEL_BATCH_CHUNKS;
+    std::vector<std::string> chunkTexts(static_cast<size_t>(qMin(batchChunks, numberOfChunks)));
+
+    for (qint32 firstChunk = 0; firstChunk < numberOfChunks; firstChunk += batchChunks) {
+        const qint32 lastChunk = qMin(firstChunk + batchChunks, numberOfChunks);
+
+        parallelFor(lastChunk - firstChunk, maxThreads, [&](qint32 batchIndex) {
+            std::string &chunkText = chunkTexts[batchIndex];
+            chunkText.clear();
+            JsonWriter chunkWriter(chunkText);
+
+            const qint32 firstField = (firstChunk + batchIndex) * PARALLEL_CHUNK_FIELDS;
+            const qint32 lastField = qMin(firstField + PARALLEL_CHUNK_FIELDS, numberOfFields);
+            for (qint32 i = firstField; i < lastField; i++) {
+                chunkWriter.writeElement();
+                fieldAt(i).write(chunkWriter);
+            }
+        });
+
+        for (qint32 chunk = firstChunk; chunk < lastChunk; chunk++) {
+            writer.writeElements(chunkTexts[chunk - firstChunk]);
+        }
     }
 
     writer.endArray();
@@ -663,59 +1704,120 @@ void LdDecodeMetaData::LineParameters::applyTo(LdDecodeMetaData::VideoParameters
     videoParameters.lastActiveFrameLine = lastActiveFrameLine;
 }
 
+// Get a field by its index (from 0), loading it first if necessary
+LdDecodeMetaData::Field LdDecodeMetaData::fieldAt(qint32 fieldNumber) const
+{
+    if (lazyFieldsInUse) return loadField(fieldNumber);
+
+    return fields->get(fieldNumber);
+}
+
+// Replace a field by its index (from 0)
+void LdDecodeMetaData::setFieldAt(qint32 fieldNumber, const Field &field)
+{
+    if (lazyFieldsInUse) {
+        loadField(fieldNumber) = field;
+    } else {
+        fields->set(fieldNumber, field);
+    }
+}
+
+// When loading lazily, get a field by its index (from 0), parsing it from the
+// JSON file if it hasn't been used before. Fields stay loaded once they've
+// been parsed, so references to them remain valid.
+LdDecodeMetaData::Field &LdDecodeMetaData::loadField(qint32 fieldNumber) const
+{
+    QMutexLocker locker(&lazyMutex);
+
+    std::unique_ptr<Field> &field = lazyFields[fieldNumber];
+    if (!field) {
+        field.reset(new Field);
+
+        // If the next field's position is known, read only up to there;
+        // otherwise, let the reader read ahead as far as it needs to
+        const qint64 start = lazyFieldPositions[fieldNumber];
+        const qint64 end = (fieldNumber + 1 < lazyFieldPositions.size()) ? lazyFieldPositions[fieldNumber + 1] : -1;
+        lazyFile.clear();
+        lazyFile.seekg(start);
+        try {
+            if (end > start) {
+                std::string text(static_cast<size_t>(end - start), '\0');
+                lazyFile.read(&text[0], static_cast<std::streamsize>(text.size()));
+                JsonReader reader(text.data(), static_cast<size_t>(lazyFile.gcount()));
+                field->read(reader);
+            } else {
+                JsonReader reader(lazyFile);
+                field->read(reader);
+            }
+        } catch (JsonReader::Error &error) {
+            qFatal("Parsing JSON file failed: field %d: %s", fieldNumber + 1, error.what());
+        }
+    }
+
+    return *field;
+}
+
 // This method gets the metadata for the specified sequential field number (indexed from 1 (not 0!))
-const LdDecodeMetaData::Field &LdDecodeMetaData::getField(qint32 sequentialFieldNumber)
+LdDecodeMetaData::Field LdDecodeMetaData::getField(qint32 sequentialFieldNumber)
 {
     qint32 fieldNumber = sequentialFieldNumber - 1;
     if (fieldNumber < 0 || fieldNumber >= getNumberOfFields()) {
         qCritical() << "LdDecodeMetaData::getField(): Requested field number" << sequentialFieldNumber << "out of bounds!";
     }
 
-    return fields[fieldNumber];
+    return fieldAt(fieldNumber);
 }
 
 // This method gets the VITS metrics metadata for the specified sequential field number
-const LdDecodeMetaData::VitsMetrics &LdDecodeMetaData::getFieldVitsMetrics(qint32 sequentialFieldNumber)
+LdDecodeMetaData::VitsMetrics LdDecodeMetaData::getFieldVitsMetrics(qint32 sequentialFieldNumber)
 {
     qint32 fieldNumber = sequentialFieldNumber - 1;
     if (fieldNumber < 0 || fieldNumber >= getNumberOfFields()) {
         qCritical() << "LdDecodeMetaData::getFieldVitsMetrics(): Requested field number" << sequentialFieldNumber << "out of bounds!";
     }
 
-    return fields[fieldNumber].vitsMetrics;
+    if (lazyFieldsInUse) return loadField(fieldNumber).vitsMetrics;
+
+    return fields->getVitsMetrics(fieldNumber);
 }
 
 // This method gets the VBI metadata for the specified sequential field number
-const LdDecodeMetaData::Vbi &LdDecodeMetaData::getFieldVbi(qint32 sequentialFieldNumber)
+LdDecodeMetaData::Vbi LdDecodeMetaData::getFieldVbi(qint32 sequentialFieldNumber)
 {
     qint32 fieldNumber = sequentialFieldNumber - 1;
     if (fieldNumber < 0 || fieldNumber >= getNumberOfFields()) {
         qCritical() << "LdDecodeMetaData::getFieldVbi(): Requested field number" << sequentialFieldNumber << "out of bounds!";
     }
 
-    return fields[fieldNumber].vbi;
+    if (lazyFieldsInUse) return loadField(fieldNumber).vbi;
+
+    return fields->getVbi(fieldNumber);
 }
 
 // This method gets the NTSC metadata for the specified sequential field number
-const LdDecodeMetaData::Ntsc &LdDecodeMetaData::getFieldNtsc(qint32 sequentialFieldNumber)
+LdDecodeMetaData::Ntsc LdDecodeMetaData::getFieldNtsc(qint32 sequentialFieldNumber)
 {
     qint32 fieldNumber = sequentialFieldNumber - 1;
     if (fieldNumber < 0 || fieldNumber >= getNumberOfFields()) {
         qCritical() << "LdDecodeMetaData::getFieldNtsc(): Requested field number" << sequentialFieldNumber << "out of bounds!";
     }
 
-    return fields[fieldNumber].ntsc;
+    if (lazyFieldsInUse) return loadField(fieldNumber).ntsc;
+
+    return fields->getNtsc(fieldNumber);
 }
 
 // This method gets the drop-out metadata for the specified sequential field number
-const DropOuts &LdDecodeMetaData::getFieldDropOuts(qint32 sequentialFieldNumber)
+DropOuts LdDecodeMetaData::getFieldDropOuts(qint32 sequentialFieldNumber)
 {
     qint32 fieldNumber = sequentialFieldNumber - 1;
     if (fieldNumber < 0 || fieldNumber >= getNumberOfFields()) {
         qCritical() << "LdDecodeMetaData::getFieldDropOuts(): Requested field number" << sequentialFieldNumber << "out of bounds!";
     }
 
-    return fields[fieldNumber].dropOuts;
+    if (lazyFieldsInUse) return loadField(fieldNumber).dropOuts;
+
+    return fields->getDropOuts(fieldNumber);
 }
 
 // This method sets the field metadata for a field
@@ -726,7 +1828,12 @@ void LdDecodeMetaData::updateField(const LdDecodeMetaData::Field &field, qint32
         qCritical() << "LdDecodeMetaData::updateFieldVitsMetrics(): Requested field number" << sequentialFieldNumber << "out of bounds!";
     }
 
-    fields[fieldNumber] = field;
+    const bool wasFirstField = isFirstFieldAt(fieldNumber);
+    setFieldAt(fieldNumber, field);
+    recordChange(fieldNumber, JOURNAL_FIELD);
+    invalidateVbiIndex(true);
+
+    if (field.isFirstField != wasFirstField) updateFrameMap(fieldNumber);
 }
 
 // This method sets the field VBI metadata for a field
@@ -737,7 +1844,12 @@ void LdDecodeMetaData::updateFieldVitsMetrics(const LdDecodeMetaData::VitsMetric
         qCritical() << "LdDecodeMetaData::updateFieldVitsMetrics(): Requested field number" << sequentialFieldNumber << "out of bounds!";
     }
 
-    fields[fieldNumber].vitsMetrics = vitsMetrics;
+    if (lazyFieldsInUse) {
+        loadField(fieldNumber).vitsMetrics = vitsMetrics;
+    } else {
+        fields->setVitsMetrics(fieldNumber, vitsMetrics);
+    }
+    recordChange(fieldNumber, JOURNAL_VITS_METRICS);
 }
 
 // This method sets the field VBI metadata for a field
@@ -748,7 +1860,13 @@ void LdDecodeMetaData::updateFieldVbi(const LdDecodeMetaData::Vbi &vbi, qint32 s
         qCritical() << "LdDecodeMetaData::updateFieldVbi(): Requested field number" << sequentialFieldNumber << "out of bounds!";
     }
 
-    fields[fieldNumber].vbi = vbi;
+    if (lazyFieldsInUse) {
+        loadField(fieldNumber).vbi = vbi;
+    } else {
+        fields->setVbi(fieldNumber, vbi);
+    }
+    recordChange(fieldNumber, JOURNAL_VBI);
+    invalidateVbiIndex(true);
 }
 
 // This method sets the field NTSC metadata for a field
@@ -759,7 +1877,12 @@ void LdDecodeMetaData::updateFieldNtsc(const LdDecodeMetaData::Ntsc &ntsc, qint3
         qCritical() << "LdDecodeMetaData::updateFieldNtsc(): Requested field number" << sequentialFieldNumber << "out of bounds!";
     }
 
-    fields[fieldNumber].ntsc = ntsc;
+    if (lazyFieldsInUse) {
+        loadField(fieldNumber).ntsc = ntsc;
+    } else {
+        fields->setNtsc(fieldNumber, ntsc);
+    }
+    recordChange(fieldNumber, JOURNAL_NTSC);
 }
 
 // This method sets the field dropout metadata for a field
@@ -770,7 +1893,12 @@ void LdDecodeMetaData::updateFieldDropOuts(const DropOuts &dropOuts, qint32 sequ
         qCritical() << "LdDecodeMetaData::updateFieldDropOuts(): Requested field number" << sequentialFieldNumber << "out of bounds!";
     }
 
-    fields[fieldNumber].dropOuts = dropOuts;
+    if (lazyFieldsInUse) {
+        loadField(fieldNumber).dropOuts = dropOuts;
+    } else {
+        fields->setDropOuts(fieldNumber, dropOuts);
+    }
+    recordChange(fieldNumber, JOURNAL_DROPOUTS);
 }
 
 // This method clears the field dropout metadata for a field
@@ -781,21 +1909,41 @@ void LdDecodeMetaData::clearFieldDropOuts(qint32 sequentialFieldNumber)
         qCritical() << "LdDecodeMetaData::clearFieldDropOuts(): Requested field number" << sequentialFieldNumber << "out of bounds!";
     }
 
-    fields[fieldNumber].dropOuts.clear();
+    if (lazyFieldsInUse) {
+        loadField(fieldNumber).dropOuts.clear();
+    } else {
+        fields->setDropOuts(fieldNumber, DropOuts());
+    }
+    recordChange(fieldNumber, JOURNAL_DROPOUTS);
 }
 
 // This method appends a new field to the existing metadata
 void LdDecodeMetaData::appendField(const LdDecodeMetaData::Field &field)
 {
-    fields.append(field);
+    if (lazyFieldsInUse) {
+        // The new field isn't in the file, so it's loaded already
+        QMutexLocker locker(&lazyMutex);
+        lazyFieldPositions.append(-1);
+        lazyFieldAudioSamples.append(field.audioSamples);
+        lazyFieldIsFirstField.append(field.isFirstField);
+        lazyFields.emplace_back(new Field(field));
+    } else {
+        fields->append(field);
+    }
+
+    videoParameters.numberOfSequentialFields = getNumberOfFields();
 
-    videoParameters.numberOfSequentialFields = fields.size();
+    nextFirstFields.append(-1);
+    updateFrameMap(getNumberOfFields() - 1);
+    invalidateVbiIndex(true);
 }
 
 // Method to get the available number of fields (according to the metadata)
-qint32 LdDecodeMetaData::getNumberOfFields()
+qint32 LdDecodeMetaData::getNumberOfFields() const
 {
-    return fields.size();
+    if (lazyFieldsInUse) return lazyFieldPositions.size();
+
+    return fields->size();
 }
 
 // Method to set the available number of fields
@@ -868,16 +2016,19 @@ void LdDecodeMetaData::setNumberOfFields(qint32 numberOfFields)
 // Method to get the available number of still-frames
 qint32 LdDecodeMetaData::getNumberOfFrames()
 {
+    if (getNumberOfFields() == 0) return 0;
+
     qint32 frameOffset = 0;
 
     // If the first field in the TBC input isn't the expected first field,
     // skip it when counting the number of still-frames
+    const bool startsWithFirstField = nextFirstFields[0] == 0;
     if (isFirstFieldFirst) {
         // Expecting first field first
-        if (!getField(1).isFirstField) frameOffset = 1;
+        if (!startsWithFirstField) frameOffset = 1;
     } else {
         // Expecting second field first
-        if (getField(1).isFirstField) frameOffset = 1;
+        if (startsWithFirstField) frameOffset = 1;
     }
 
     return (getNumberOfFields() / 2) - frameOffset;
@@ -896,49 +2047,38 @@ qint32 LdDecodeMetaData::getFieldNumber(qint32 frameNumber, qint32 field)
         return -1;
     }
 
-    // Calculate the first and last fields based on the position in the TBC
+    // Calculate the first field based on the position in the TBC
     if (isFirstFieldFirst) {
         // Expecting TBC file to provide still-frames as first field / second field
         firstFieldNumber = (frameNumber * 2) - 1;
-        secondFieldNumber = firstFieldNumber + 1;
     } else {
         // Expecting TBC file to provide still-frames as second field / first field
-        secondFieldNumber = (frameNumber * 2) - 1;
-        firstFieldNumber = secondFieldNumber + 1;
+        firstFieldNumber = frameNumber * 2;
     }
 
     // If the field number pointed to by firstFieldNumber doesn't have
-    // isFirstField set, move forward field by field until the current
-    // field does
-    while (!getField(firstFieldNumber).isFirstField) {
-        firstFieldNumber++;
-        secondFieldNumber++;
-
-        // Give up if we reach the end of the available fields
-        if (firstFieldNumber > getNumberOfFields() || secondFieldNumber > getNumberOfFields()) {
-            qCritical() << "Attempting to get field number failed - no isFirstField in JSON before end of file";
-            firstFieldNumber = -1;
-            secondFieldNumber = -1;
-            break;
-        }
-    }
-
-    // Range check the first field number
+    // isFirstField set, move forward to the next field that does
     if (firstFieldNumber > getNumberOfFields()) {
         qCritical() << "LdDecodeMetaData::getFieldNumber(): First field number exceed the available number of fields!";
-        firstFieldNumber = -1;
-        secondFieldNumber = -1;
+        return -1;
     }
+    firstFieldNumber = nextFirstFields[firstFieldNumber - 1] + 1;
+    if (firstFieldNumber == 0) {
+        qCritical() << "Attempting to get field number failed - no isFirstField in JSON before end of file";
+        return -1;
+    }
+
+    // The second field follows the first field, or precedes it
+    secondFieldNumber = isFirstFieldFirst ? firstFieldNumber + 1 : firstFieldNumber - 1;
 
     // Range check the second field number
     if (secondFieldNumber > getNumberOfFields()) {
         qCritical() << "LdDecodeMetaData::getFieldNumber(): Second field number exceed the available number of fields!";
-        firstFieldNumber = -1;
-        secondFieldNumber = -1;
+        return -1;
     }
 
     // Test for a buggy TBC file...
-    if (getField(secondFieldNumber).isFirstField) {
+    if (isFirstFieldAt(secondFieldNumber - 1)) {
         qCritical() << "LdDecodeMetaData::getFieldNumber(): Both of the determined fields have isFirstField set - the TBC source video is probably broken...";
     }
 
@@ -961,6 +2101,7 @@ qint32 LdDecodeMetaData::getSecondFieldNumber(qint32 frameNumber)
 void LdDecodeMetaData::setIsFirstFieldFirst(bool flag)
 {
     isFirstFieldFirst = flag;
+    invalidateVbiIndex(false);
 }
 
 // Method to get the isFirstFieldFirst flag
@@ -969,6 +2110,232 @@ bool LdDecodeMetaData::getIsFirstFieldFirst()
     return isFirstFieldFirst;
 }
 
+const char LdDecodeMetaData::VBI_INDEX_SUFFIX[] = ".vbi";
+
+// VBI index files hold the decoded VBI for each frame. They start with a
+// header of VBI_INDEX_HEADER_SIZE bytes:
+//   8 bytes   magic "LDVBIX\0\1"
+//   quint64   size of the metadata file
+//   qint64    modification time of the metadata file, in ms since the epoch
+//   quint64   size of the metadata file's journal (0 if there isn't one)
+//   qint64    modification time of the journal, in ms since the epoch (0 if there isn't one)
+//   quint32   number of frames
+//   quint32   1 if isFirstFieldFirst was set, otherwise 0
+// followed by VBI_INDEX_ENTRY_SIZE bytes for each frame:
+//   qint32    type, picNo, chNo, clvHr, clvMin, clvSec, clvPicNo
+//   quint32   flags (bit 0 picStop, bit 1 leadIn, bit 2 leadOut)
+// All integers are little-endian.
+static const char VBI_INDEX_MAGIC[] = "LDVBIX\0\1";
+static constexpr qint32 VBI_INDEX_MAGIC_SIZE = 8;
+static constexpr qint32 VBI_INDEX_HEADER_SIZE = 48;
+static constexpr qint32 VBI_INDEX_ENTRY_SIZE = 32;
+
+// The number of frames each thread decodes at a time when generating the VBI index
+static constexpr qint32 VBI_INDEX_CHUNK_FRAMES = 1024;
+
+// Get the decoded VBI for a frame (numbered from 1). The VBI for all the
+// frames is decoded the first time this is used.
+LdDecodeMetaData::FrameVbi LdDecodeMetaData::getFrameVbi(qint32 frameNumber)
+{
+    QMutexLocker locker(&vbiIndexMutex);
+    if (!vbiIndexValid) generateVbiIndex();
+
+    if (frameNumber < 1 || frameNumber > frameVbis.size()) {
+        qCritical() << "LdDecodeMetaData::getFrameVbi(): Requested frame number" << frameNumber << "out of bounds!";
+        return FrameVbi();
+    }
+
+    return frameVbis[frameNumber - 1];
+}
+
+// Find the first frame (numbered from 1) with a VBI frame number -- either a
+// CAV picture number, or a CLV timecode converted to a frame number. Returns
+// -1 if there isn't one.
+qint32 LdDecodeMetaData::getFrameNumberForVbiFrame(qint32 vbiFrameNumber)
+{
+    QMutexLocker locker(&vbiIndexMutex);
+    if (!vbiIndexValid) generateVbiIndex();
+
+    return vbiFrameNumbers.value(vbiFrameNumber, -1);
+}
+
+// Decode the VBI for every frame, or read it from the VBI index file if
+// there's an up-to-date one. The caller must hold vbiIndexMutex.
+void LdDecodeMetaData::generateVbiIndex()
+{
+    const qint32 numberOfFrames = getNumberOfFrames();
+
+    if (vbiIndexFileName.isEmpty() || !readVbiIndex(numberOfFrames)) {
+        // Decode the frames in chunks, spread across threads
+        frameVbis.resize(numberOfFrames);
+        FrameVbi *frameVbiData = frameVbis.data();
+        const qint32 numberOfChunks = (numberOfFrames + VBI_INDEX_CHUNK_FRAMES - 1) / VBI_INDEX_CHUNK_FRAMES;
+
+        const qint32 numThreads = qMax(1, qMin(numberOfChunks, maxThreads));
+        qDebug() << "LdDecodeMetaData::generateVbiIndex(): Decoding VBI for" << numberOfFrames << "frames using" << numThreads << "threads";
+        parallelFor(numberOfChunks, maxThreads, [&](qint32 chunk) {
+            VbiDecoder vbiDecoder;
+
+            const qint32 firstFrame = chunk * VBI_INDEX_CHUNK_FRAMES;
+            const qint32 lastFrame = qMin(firstFrame + VBI_INDEX_CHUNK_FRAMES, numberOfFrames);
+            for (qint32 i = firstFrame; i < lastFrame; i++) {
+                const Vbi vbi1 = getFieldVbi(getFirstFieldNumber(i + 1));
+                const Vbi vbi2 = getFieldVbi(getSecondFieldNumber(i + 1));
+                const VbiDecoder::Vbi vbi = vbiDecoder.decodeFrame(vbi1.vbiData[0], vbi1.vbiData[1], vbi1.vbiData[2],
+                                                                   vbi2.vbiData[0], vbi2.vbiData[1], vbi2.vbiData[2]);
+
+                FrameVbi &frameVbi = frameVbiData[i];
+                frameVbi.type = vbi.type;
+                frameVbi.picNo = vbi.picNo;
+                frameVbi.chNo = vbi.chNo;
+                frameVbi.clvHr = vbi.clvHr;
+                frameVbi.clvMin = vbi.clvMin;
+                frameVbi.clvSec = vbi.clvSec;
+                frameVbi.clvPicNo = vbi.clvPicNo;
+                frameVbi.picStop = vbi.picStop;
+                frameVbi.leadIn = vbi.leadIn;
+                frameVbi.leadOut = vbi.leadOut;
+            }
+        });
+
+        if (!vbiIndexFileName.isEmpty()) writeVbiIndex();
+    }
+
+    // Map each VBI frame number to the first frame that has it
+    vbiFrameNumbers.clear();
+    for (qint32 i = 0; i < numberOfFrames; i++) {
+        const FrameVbi &frameVbi = frameVbis[i];
+
+        qint32 vbiFrameNumber = -1;
+        if (frameVbi.picNo > 0) {
+            vbiFrameNumber = frameVbi.picNo;
+        } else {
+            ClvTimecode timecode;
+            timecode.hours = frameVbi.clvHr;
+            timecode.minutes = frameVbi.clvMin;
+            timecode.seconds = frameVbi.clvSec;
+            timecode.pictureNumber = frameVbi.clvPicNo;
+            vbiFrameNumber = convertClvTimecodeToFrameNumber(timecode);
+        }
+
+        if (vbiFrameNumber != -1 && !vbiFrameNumbers.contains(vbiFrameNumber)) {
+            vbiFrameNumbers.insert(vbiFrameNumber, i + 1);
+        }
+    }
+
+    vbiIndexValid = true;
+}
+
+// Read the VBI index for vbiIndexFileName. Returns true on success, or false
+// if there isn't an up-to-date index.
+bool LdDecodeMetaData::readVbiIndex(qint32 numberOfFrames)
+{
+    const QString indexFileName = vbiIndexFileName + VBI_INDEX_SUFFIX;
+    QFile indexFile(indexFileName);
+    if (!indexFile.open(QIODevice::ReadOnly)) return false;
+    const QByteArray index = indexFile.readAll();
+    indexFile.close();
+
+    // Check the index was made from this version of the metadata
+    if (index.size() != VBI_INDEX_HEADER_SIZE + (static_cast<qint64>(numberOfFrames) * VBI_INDEX_ENTRY_SIZE)
+        || index.left(VBI_INDEX_HEADER_SIZE) != getVbiIndexHeader(numberOfFrames)) {
+        qDebug() << "LdDecodeMetaData::readVbiIndex(): Index file" << indexFileName << "is out of date";
+        return false;
+    }
+
+    frameVbis.resize(numberOfFrames);
+    const uchar *entry = reinterpret_cast<const uchar *>(index.constData()) + VBI_INDEX_HEADER_SIZE;
+    for (qint32 i = 0; i < numberOfFrames; i++) {
+        FrameVbi &frameVbi = frameVbis[i];
+        frameVbi.type = static_cast<VbiDecoder::VbiDiscTypes>(BinaryMetadata::load<qint32>(entry));
+        frameVbi.picNo = BinaryMetadata::load<qint32>(entry + 4);
+        frameVbi.chNo = BinaryMetadata::load<qint32>(entry + 8);
+        frameVbi.clvHr = BinaryMetadata::load<qint32>(entry + 12);
+        frameVbi.clvMin = BinaryMetadata::load<qint32>(entry + 16);
+        frameVbi.clvSec = BinaryMetadata::load<qint32>(entry + 20);
+        frameVbi.clvPicNo = BinaryMetadata::load<qint32>(entry + 24);
+        const quint32 flags = BinaryMetadata::load<quint32>(entry + 28);
+        frameVbi.picStop = (flags & 1) != 0;
+        frameVbi.leadIn = (flags & 2) != 0;
+        frameVbi.leadOut = (flags & 4) != 0;
+        entry += VBI_INDEX_ENTRY_SIZE;
+    }
+
+    qDebug() << "LdDecodeMetaData::readVbiIndex(): Read" << numberOfFrames << "frames from index file" << indexFileName;
+    return true;
+}
+
+// Write the VBI index for vbiIndexFileName. Failing to write it isn't an
+// error, since it can be regenerated.
+void LdDecodeMetaData::writeVbiIndex() const
+{
+    const qint32 numberOfFrames = frameVbis.size();
+    QByteArray index = getVbiIndexHeader(numberOfFrames);
+    index.resize(VBI_INDEX_HEADER_SIZE + (numberOfFrames * VBI_INDEX_ENTRY_SIZE));
+
+    uchar *entry = reinterpret_cast<uchar *>(index.data()) + VBI_INDEX_HEADER_SIZE;
+    for (const FrameVbi &frameVbi : frameVbis) {
+        BinaryMetadata::store<qint32>(frameVbi.type, entry);
+        BinaryMetadata::store<qint32>(frameVbi.picNo, entry + 4);
+        BinaryMetadata::store<qint32>(frameVbi.chNo, entry + 8);
+        BinaryMetadata::store<qint32>(frameVbi.clvHr, entry + 12);
+        BinaryMetadata::store<qint32>(frameVbi.clvMin, entry + 16);
+        BinaryMetadata::store<qint32>(frameVbi.clvSec, entry + 20);
+        BinaryMetadata::store<qint32>(frameVbi.clvPicNo, entry + 24);
+        quint32 flags = 0;
+        if (frameVbi.picStop) flags |= 1;
+        if (frameVbi.leadIn) flags |= 2;
+        if (frameVbi.leadOut) flags |= 4;
+        BinaryMetadata::store<quint32>(flags, entry + 28);
+        entry += VBI_INDEX_ENTRY_SIZE;
+    }
+
+    const QString indexFileName = vbiIndexFileName + VBI_INDEX_SUFFIX;
+    QFile indexFile(indexFileName);
+    if (!indexFile.open(QIODevice::WriteOnly | QIODevice::Truncate) || indexFile.write(index) != index.size()) {
+        qDebug() << "LdDecodeMetaData::writeVbiIndex(): Couldn't write index file" << indexFileName;
+        indexFile.close();
+        indexFile.remove();
+        return;
+    }
+    indexFile.close();
+}
+
+// Get the header a VBI index file for the current version of vbiIndexFileName
+// (and its journal) should have
+QByteArray LdDecodeMetaData::getVbiIndexHeader(qint32 numberOfFrames) const
+{
+    const QFileInfo fileInfo(vbiIndexFileName);
+    const QFileInfo journalInfo(vbiIndexFileName + JOURNAL_SUFFIX);
+
+    QByteArray header(VBI_INDEX_HEADER_SIZE, '\0');
+    uchar *data = reinterpret_cast<uchar *>(header.data());
+    memcpy(data, VBI_INDEX_MAGIC, VBI_INDEX_MAGIC_SIZE);
+    BinaryMetadata::store<quint64>(static_cast<quint64>(fileInfo.size()), data + 8);
+    BinaryMetadata::store<qint64>(fileInfo.lastModified().toMSecsSinceEpoch(), data + 16);
+    if (journalInfo.exists()) {
+        BinaryMetadata::store<quint64>(static_cast<quint64>(journalInfo.size()), data + 24);
+        BinaryMetadata::store<qint64>(journalInfo.lastModified().toMSecsSinceEpoch(), data + 32);
+    }
+    BinaryMetadata::store<quint32>(static_cast<quint32>(numberOfFrames), data + 40);
+    BinaryMetadata::store<quint32>(isFirstFieldFirst ? 1 : 0, data + 44);
+
+    return header;
+}
+
+// Discard the VBI index, because the frames have changed. If vbiChanged is
+// set, the fields' VBI has changed too, so the index can't be kept alongside
+// the file the metadata was read from.
+void LdDecodeMetaData::invalidateVbiIndex(bool vbiChanged)
+{
+    QMutexLocker locker(&vbiIndexMutex);
+
+    vbiIndexValid = false;
+    frameVbis.clear();
+    vbiFrameNumbers.clear();
+    if (vbiChanged) vbiIndexFileName.clear();
+}
+
 // Method to convert a CLV time code into an equivalent frame number (to make
 // processing the timecodes easier)
 qint32 LdDecodeMetaData::convertClvTimecodeToFrameNumber(LdDecodeMetaData::ClvTimecode clvTimeCode)
@@ -1064,7 +2431,14 @@ void LdDecodeMetaData::generatePcmAudioMap()
 
     for (qint32 fieldNo = 0; fieldNo < numberOfFields; fieldNo++) {
         // Each audio sample is 16 bit - and there are 2 samples per stereo pair
-        pcmAudioFieldLengthMap[fieldNo] = static_cast<qint32>(getField(fieldNo+1).audioSamples);
+        // (When loading lazily, use the value from the index unless the field has been loaded)
+        if (!lazyFieldsInUse) {
+            pcmAudioFieldLengthMap[fieldNo] = fields->getAudioSamples(fieldNo);
+        } else if (!lazyFields[fieldNo]) {
+            pcmAudioFieldLengthMap[fieldNo] = lazyFieldAudioSamples[fieldNo];
+        } else {
+            pcmAudioFieldLengthMap[fieldNo] = loadField(fieldNo).audioSamples;
+        }
 
         if (fieldNo == 0) {
             // First field starts at 0 units
@@ -1076,6 +2450,49 @@ void LdDecodeMetaData::generatePcmAudioMap()
     }
 }
 
+// Return true if a field (numbered from 0) has isFirstField set
+bool LdDecodeMetaData::isFirstFieldAt(qint32 fieldNumber) const
+{
+    if (!lazyFieldsInUse) return fields->getIsFirstField(fieldNumber);
+
+    // When loading lazily, use the value from the index unless the field has been loaded
+    if (!lazyFields[fieldNumber]) return lazyFieldIsFirstField[fieldNumber];
+
+    return loadField(fieldNumber).isFirstField;
+}
+
+// Generate the map used to find the fields in each frame
+void LdDecodeMetaData::generateFrameMap()
+{
+    const qint32 numberOfFields = getNumberOfFields();
+    nextFirstFields.resize(numberOfFields);
+
+    qint32 nextFirstField = -1;
+    for (qint32 fieldNumber = numberOfFields - 1; fieldNumber >= 0; fieldNumber--) {
+        if (isFirstFieldAt(fieldNumber)) nextFirstField = fieldNumber;
+        nextFirstFields[fieldNumber] = nextFirstField;
+    }
+
+    invalidateVbiIndex(false);
+}
+
+// Update the frame map after a field (numbered from 0) has been added or its
+// isFirstField has changed. Only the fields before it back to the previous
+// first field are affected.
+void LdDecodeMetaData::updateFrameMap(qint32 fieldNumber)
+{
+    const qint32 numberOfFields = getNumberOfFields();
+
+    for (qint32 i = fieldNumber; i >= 0; i--) {
+        qint32 nextFirstField = -1;
+        if (isFirstFieldAt(i)) nextFirstField = i;
+        else if (i + 1 < numberOfFields) nextFirstField = nextFirstFields[i + 1];
+
+        if (i != fieldNumber && nextFirstFields[i] == nextFirstField) break;
+        nextFirstFields[i] = nextFirstField;
+    }
+}
+
 // Method to get the start sample location of the specified sequential field number
 qint32 LdDecodeMetaData::getFieldPcmAudioStart(qint32 sequentialFieldNumber)
 {
@@ -27,15 +27,23 @@
 #ifndef LDDECODEMETADATA_H
 #define LDDECODEMETADATA_H
 
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
 #include <QString>
+#include <QStringList>
 #include <QVector>
 #include <QTemporaryFile>
 #include <QDebug>
 #include <array>
+#include <fstream>
+#include <memory>
+#include <vector>
 
 #include "vbidecoder.h"
 #include "dropouts.h"
 
+class FieldStore;
 class JsonReader;
 class JsonWriter;
 
@@ -193,15 +201,47 @@ public:
         qint32 pictureNumber;
     };
 
+    // Decoded VBI for a frame (see getFrameVbi). The members are as in
+    // VbiDecoder::Vbi.
+    struct FrameVbi {
+        VbiDecoder::VbiDiscTypes type = VbiDecoder::VbiDiscTypes::unknownDiscType;
+        qint32 picNo = -1;
+        qint32 chNo = -1;
+        qint32 clvHr = -1;
+        qint32 clvMin = -1;
+        qint32 clvSec = -1;
+        qint32 clvPicNo = -1;
+        bool picStop = false;
+        bool leadIn = false;
+        bool leadOut = false;
+    };
+
+    // The suffix added to a JSON file's name for its field index (see setLazyLoading)
+    static const char FIELD_INDEX_SUFFIX[];
+    // The suffix added to a JSON file's name for its journal (see setJournalling)
+    static const char JOURNAL_SUFFIX[];
+    // The suffix added to a metadata file's name for its VBI index (see getFrameVbi)
+    static const char VBI_INDEX_SUFFIX[];
+
     LdDecodeMetaData();
+    ~LdDecodeMetaData();
 
     // Prevent copying or assignment
     LdDecodeMetaData(const LdDecodeMetaData &) = delete;
     LdDecodeMetaData& operator=(const LdDecodeMetaData &) = delete;
 
     void clear();
+    void setLazyLoading(bool lazy, bool persistIndex = true);
+    void setMaxThreads(qint32 maxThreads);
+    void setJournalling(bool journalling);
     bool read(QString fileName);
+    bool readParts(QStringList fileNames);
     bool write(QString fileName) const;
+    bool writeJson(QString fileName) const;
+    bool writeBinary(QString fileName) const;
+    bool writeJournal(QString fileName) const;
+    bool compactJournal(QString fileName) const;
+    bool refreshFields(QString fileName);
     void readFields(JsonReader &reader);
     void writeFields(JsonWriter &writer) const;
 
@@ -215,11 +255,11 @@ public:
     void processLineParameters(LdDecodeMetaData::LineParameters &_lineParameters);
 
     // Get field metadata
-    const Field &getField(qint32 sequentialFieldNumber);
-    const VitsMetrics &getFieldVitsMetrics(qint32 sequentialFieldNumber);
-    const Vbi &getFieldVbi(qint32 sequentialFieldNumber);
-    const Ntsc &getFieldNtsc(qint32 sequentialFieldNumber);
-    const DropOuts &getFieldDropOuts(qint32 sequentialFieldNumber);
+    Field getField(qint32 sequentialFieldNumber);
+    VitsMetrics getFieldVitsMetrics(qint32 sequentialFieldNumber);
+    Vbi getFieldVbi(qint32 sequentialFieldNumber);
+    Ntsc getFieldNtsc(qint32 sequentialFieldNumber);
+    DropOuts getFieldDropOuts(qint32 sequentialFieldNumber);
 
     // Set field metadata
     void updateField(const Field &field, qint32 sequentialFieldNumber);
@@ -232,7 +272,7 @@ public:
     void appendField(const Field &field);
 
     void setNumberOfFields(qint32 numberOfFields);
-    qint32 getNumberOfFields();
+    qint32 getNumberOfFields() const;
     qint32 getNumberOfFrames();
     qint32 getFirstFieldNumber(qint32 frameNumber);
     qint32 getSecondFieldNumber(qint32 frameNumber);
@@ -240,6 +280,10 @@ public:
     void setIsFirstFieldFirst(bool flag);
     bool getIsFirstFieldFirst();
 
+    // Decoded VBI for each frame
+    FrameVbi getFrameVbi(qint32 frameNumber);
+    qint32 getFrameNumberForVbiFrame(qint32 vbiFrameNumber);
+
     qint32 convertClvTimecodeToFrameNumber(LdDecodeMetaData::ClvTimecode clvTimeCode);
     LdDecodeMetaData::ClvTimecode convertFrameNumberToClvTimecode(qint32 clvFrameNumber);
 
@@ -254,13 +298,92 @@ private:
     bool isFirstFieldFirst;
     VideoParameters videoParameters;
     PcmAudioParameters pcmAudioParameters;
-    QVector<Field> fields;
+    std::unique_ptr<FieldStore> fields;
     QVector<qint32> pcmAudioFieldStartSampleMap;
     QVector<qint32> pcmAudioFieldLengthMap;
 
+    // For each field (numbered from 0), the number of the first field at or
+    // after it that has isFirstField set, or -1 if there isn't one. This is
+    // used to find the fields making up a frame (see getFieldNumber).
+    QVector<qint32> nextFirstFields;
+
+    // The decoded VBI for each frame (numbered from 0), and the first frame
+    // (numbered from 1) with each VBI frame number. These are generated when
+    // they're first used, and cleared when the frames change.
+    // vbiIndexFileName is the file the metadata was read from, if the VBI
+    // hasn't been changed since, so the index can be kept alongside it.
+    QMutex vbiIndexMutex;
+    bool vbiIndexValid;
+    QVector<FrameVbi> frameVbis;
+    QHash<qint32, qint32> vbiFrameNumbers;
+    QString vbiIndexFileName;
+
+    // The state of the JSON file when refreshFields last read it
+    QDateTime refreshLastModified;
+    qint64 refreshSize;
+
+    // The number of threads to use when parsing or writing JSON
+    qint32 maxThreads;
+
+    // Lazy loading (see setLazyLoading). When lazyFieldsInUse is set, the
+    // fields are in lazyFields rather than fields, and each one is parsed from
+    // lazyFile at its position in lazyFieldPositions when it's first used.
+    bool lazyLoading;
+    bool lazyPersistIndex;
+    bool lazyFieldsInUse;
+    mutable QMutex lazyMutex;
+    mutable std::ifstream lazyFile;
+    QVector<qint64> lazyFieldPositions;
+    QVector<qint32> lazyFieldAudioSamples;
+    QVector<bool> lazyFieldIsFirstField;
+    mutable std::vector<std::unique_ptr<Field>> lazyFields;
+
+    // Journalling (see setJournalling). journalFileName is the JSON file the
+    // metadata was read from, which had journalNumberOfFields fields. Each
+    // field that has been updated since then (or since the journal was last
+    // written) is in journalChangedFields, with the parts that changed in
+    // journalChanges.
+    enum JournalPart : quint8 {
+        JOURNAL_FIELD = 1 << 0,
+        JOURNAL_VITS_METRICS = 1 << 1,
+        JOURNAL_VBI = 1 << 2,
+        JOURNAL_NTSC = 1 << 3,
+        JOURNAL_DROPOUTS = 1 << 4,
+    };
+    bool journalling;
+    QString journalFileName;
+    qint32 journalNumberOfFields;
+    mutable QVector<quint8> journalChanges;
+    mutable QVector<qint32> journalChangedFields;
+
+    bool readJson(JsonReader &reader);
+    bool readJsonParallel(const char *data, size_t size);
+    void readMembers(JsonReader &reader);
+    void writeMembers(JsonWriter &writer) const;
+    bool readBinary(QString fileName);
+    bool readLazy(QString fileName);
+    bool readFieldIndex(const QString &jsonFileName, const QString &indexFileName);
+    void writeFieldIndex(const QString &jsonFileName, const QString &indexFileName) const;
+    std::string getParametersJson() const;
+    bool readJournal(const QString &jsonFileName);
+    void readJournalRecord(JsonReader &reader);
+    std::string getJournalHeader(const QString &jsonFileName) const;
+    void recordChange(qint32 fieldNumber, quint8 parts);
+    void clearChanges() const;
+    Field fieldAt(qint32 fieldNumber) const;
+    void setFieldAt(qint32 fieldNumber, const Field &field);
+    Field &loadField(qint32 fieldNumber) const;
     void initialiseVideoSystemParameters();
     qint32 getFieldNumber(qint32 frameNumber, qint32 field);
     void generatePcmAudioMap();
+    bool isFirstFieldAt(qint32 fieldNumber) const;
+    void generateFrameMap();
+    void updateFrameMap(qint32 fieldNumber);
+    void generateVbiIndex();
+    bool readVbiIndex(qint32 numberOfFrames);
+    void writeVbiIndex() const;
+    QByteArray getVbiIndexHeader(qint32 numberOfFrames) const;
+    void invalidateVbiIndex(bool vbiChanged);
 };
 
 #endif // LDDECODEMETADATA_H
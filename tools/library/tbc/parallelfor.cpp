@@ -0,0 +1,105 @@
+/************************************************************************
+
+    parallelfor.cpp
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include "parallelfor.h"
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QWaitCondition>
+
+#include <memory>
+
+// Shared state for a parallelFor call. Helpers hold a reference to this, so
+// one that only starts after the call has returned can still check it safely.
+struct ParallelForState {
+    ParallelForState(qint32 _count, const std::function<void(qint32)> &_function)
+        : count(_count), function(_function), nextIndex(0), completed(0) {}
+
+    const qint32 count;
+    const std::function<void(qint32)> &function;
+    QAtomicInt nextIndex;
+
+    QMutex mutex;
+    QWaitCondition allCompleted;
+    qint32 completed;
+
+    // Call function for indexes until there are none left
+    void work() {
+        qint32 i;
+        qint32 done = 0;
+        while ((i = nextIndex.fetchAndAddRelaxed(1)) < count) {
+            function(i);
+            done++;
+        }
+        if (done == 0) return;
+
+        QMutexLocker locker(&mutex);
+        completed += done;
+        if (completed == count) allCompleted.wakeAll();
+    }
+};
+
+class ParallelForRunnable : public QRunnable
+{
+public:
+    ParallelForRunnable(const std::shared_ptr<ParallelForState> &_state)
+        : state(_state) {}
+
+    void run() override {
+        state->work();
+    }
+
+private:
+    std::shared_ptr<ParallelForState> state;
+};
+
+// Run function(0) ... function(count - 1), spreading the calls across up to
+// maxThreads threads (including the calling thread).
+//
+// The helpers run in the global thread pool, so no threads are created per
+// call. The calling thread works too, and only waits for calls that helpers
+// have already started, so this makes progress even if the pool is busy (or
+// the caller is itself running in the pool).
+void parallelFor(qint32 count, qint32 maxThreads, const std::function<void(qint32)> &function)
+{
+    const qint32 numThreads = qMin(count, maxThreads);
+    if (numThreads <= 1) {
+        for (qint32 i = 0; i < count; i++) function(i);
+        return;
+    }
+
+    auto state = std::make_shared<ParallelForState>(count, function);
+    QThreadPool *pool = QThreadPool::globalInstance();
+    for (qint32 i = 1; i < numThreads; i++) {
+        pool->start(new ParallelForRunnable(state));
+    }
+    state->work();
+
+    // Helpers that start after this point find nothing left to do, so they
+    // never call function
+    QMutexLocker locker(&state->mutex);
+    while (state->completed < count) state->allCompleted.wait(&state->mutex);
+}
@@ -0,0 +1,34 @@
+/************************************************************************
+
+    parallelfor.h
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef PARALLELFOR_H
+#define PARALLELFOR_H
+
+#include <QtGlobal>
+#include <functional>
+
+// Call function(i) for i in [0, count), using up to maxThreads threads
+void parallelFor(qint32 count, qint32 maxThreads, const std::function<void(qint32)> &function);
+
+#endif
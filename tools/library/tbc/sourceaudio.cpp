@@ -23,8 +23,12 @@
 ************************************************************************/
 
 #include "sourceaudio.h"
+#include "tbcparts.h"
 
-#include <QDataStream>
+#include <QtEndian>
+
+#include <algorithm>
+#include <cstring>
 
 SourceAudio::SourceAudio()
 {
@@ -33,45 +37,108 @@ SourceAudio::SourceAudio()
 
 SourceAudio::~SourceAudio()
 {
-    if (audioFileByteLength != 0) inputAudioFile.close();
+    if (audioFileByteLength != 0) close();
 }
 
-// Open an audio source file
-bool SourceAudio::open(QFileInfo inputFileInfo)
+// Open an audio source file. If mapFile is true, try to map the whole file
+// into memory (falling back to reading it if that isn't possible).
+//
+// If inputFileInfo is a manifest for a split capture, open the audio source
+// file for each part, and read them as if they were joined together.
+bool SourceAudio::open(QFileInfo inputFileInfo, bool mapFile)
 {
-    // Get the input audio fileinfo from the input TBC fileinfo:
-    QFileInfo inputAudioFileInfo(inputFileInfo.absolutePath() + "/" + inputFileInfo.baseName() + ".pcm");
+    QStringList inputFileNames;
+    if (TbcParts::isManifest(inputFileInfo.filePath())) {
+        if (!TbcParts::readManifest(inputFileInfo.filePath(), inputFileNames)) {
+            qFatal("Could not read TBC parts manifest!");
+            return false;
+        }
+    } else {
+        inputFileNames.append(inputFileInfo.filePath());
+    }
+
+    fileStartBytes.clear();
+    fileStartBytes.append(0);
+    for (const QString &inputFileName : inputFileNames) {
+        // Get the input audio fileinfo from the input TBC fileinfo:
+        const QFileInfo partFileInfo(inputFileName);
+        if (!openFile(partFileInfo.absolutePath() + "/" + partFileInfo.baseName() + ".pcm", mapFile)) return false;
+    }
+    audioFileByteLength = fileStartBytes.last();
+
+    return true;
+}
 
+// Open one audio source file, and add it to the end of the combined audio
+bool SourceAudio::openFile(const QString &fileName, bool mapFile)
+{
     // Open the audio source data file
-    inputAudioFile.setFileName(inputAudioFileInfo.filePath());
-    if (!inputAudioFile.open(QIODevice::ReadOnly)) {
+    std::unique_ptr<QFile> inputAudioFile(new QFile(fileName));
+    if (!inputAudioFile->open(QIODevice::ReadOnly)) {
         // Failed to open named input file
-        qDebug() << "Could not open" << inputAudioFileInfo.filePath() << "as source audio input file";
+        qDebug() << "Could not open" << fileName << "as source audio input file";
         qFatal("Could not open PCM audio file!");
         return false;
     }
 
     // Get the length of the PCM audio file
-    audioFileByteLength = inputAudioFileInfo.size();
-    if (audioFileByteLength == 0) {
-        qDebug() << "Could get file size of" << inputAudioFileInfo.filePath() << "(or file was 0 bytes length)";
+    const qint64 fileByteLength = inputAudioFile->size();
+    if (fileByteLength == 0) {
+        qDebug() << "Could get file size of" << fileName << "(or file was 0 bytes length)";
         qFatal("Could not get PCM audio file length!");
         return false;
     }
 
+    const uchar *mappedFile = nullptr;
+    if (mapFile) {
+        mappedFile = inputAudioFile->map(0, fileByteLength);
+        if (mappedFile == nullptr) {
+            qDebug() << "SourceAudio::open(): Could not map input file:" << inputAudioFile->errorString();
+        }
+    }
+
+    inputAudioFiles.push_back(std::move(inputAudioFile));
+    mappedFiles.append(mappedFile);
+    fileStartBytes.append(fileStartBytes.last() + fileByteLength);
+
     return true;
 }
 
 // Close an audio source file
 void SourceAudio::close()
 {
-    // Close the audio source data file
-    inputAudioFile.close();
+    for (qint32 i = 0; i < mappedFiles.size(); i++) {
+        if (mappedFiles[i] != nullptr) inputAudioFiles[i]->unmap(const_cast<uchar *>(mappedFiles[i]));
+    }
+
+    // Close the audio source data files
+    inputAudioFiles.clear();
+    mappedFiles.clear();
+    fileStartBytes.clear();
     audioFileByteLength = 0;
 }
 
+// Return true if the audio source file is memory-mapped
+bool SourceAudio::isSourceMapped()
+{
+    if (mappedFiles.isEmpty()) return false;
+
+    for (const uchar *mappedFile : mappedFiles) {
+        if (mappedFile == nullptr) return false;
+    }
+    return true;
+}
+
 // Get audio data for a single field from the audio source file
 SourceAudio::Data SourceAudio::getAudioData(qint32 startSample, qint32 numberOfSamples)
+{
+    return getAudioData(QVector<Range> {{startSample, numberOfSamples}});
+}
+
+// Get audio data for several ranges (e.g. both fields of a frame) from the
+// audio source file, one after another. Ranges that follow on from each other
+// in the file are read together.
+SourceAudio::Data SourceAudio::getAudioData(const QVector<Range> &ranges)
 {
     // Create a buffer for the sample data
     SourceAudio::Data sampleData;
@@ -82,55 +149,94 @@ SourceAudio::Data SourceAudio::getAudioData(qint32 startSample, qint32 numberOfS
         return sampleData;
     }
 
-    // Translate the start and number from stereo 16-bit pair samples to bytes (x4)
-    qint64 startByte = static_cast<qint64>(startSample) * 4;
-    qint64 lengthInBytes = static_cast<qint64>(numberOfSamples) * 4;
+    // Translate the starts and numbers from stereo 16-bit pair samples to
+    // bytes (x4), and check them
+    qint64 totalLengthInBytes = 0;
+    for (const Range &range : ranges) {
+        const qint64 lengthInBytes = static_cast<qint64>(range.numberOfSamples) * 4;
+        checkRange(static_cast<qint64>(range.startSample) * 4, lengthInBytes);
+        totalLengthInBytes += lengthInBytes;
+    }
+    sampleData.resize(static_cast<qint32>(totalLengthInBytes / 2));
+
+    // Read the data, merging adjacent ranges
+    qint64 outputByte = 0;
+    qint32 i = 0;
+    while (i < ranges.size()) {
+        const qint64 startByte = static_cast<qint64>(ranges[i].startSample) * 4;
+        qint64 lengthInBytes = static_cast<qint64>(ranges[i].numberOfSamples) * 4;
+        i++;
+        while (i < ranges.size() && static_cast<qint64>(ranges[i].startSample) * 4 == startByte + lengthInBytes) {
+            lengthInBytes += static_cast<qint64>(ranges[i].numberOfSamples) * 4;
+            i++;
+        }
+
+        readAudioFile(startByte, lengthInBytes, sampleData.data() + (outputByte / 2));
+        outputByte += lengthInBytes;
+    }
 
-    // Range check the request
+    return sampleData;
+}
+
+// Range check a request
+void SourceAudio::checkRange(qint64 startByte, qint64 lengthInBytes)
+{
     if (startByte < 0) {
         qFatal("getAudioData requested, but startSample was less than 0!");
-        return sampleData;
     }
 
     if (lengthInBytes < 1) {
         qFatal("getAudioData requested, but numberOfSamples was less than 1!");
-        return sampleData;
     }
 
     if ((startByte + lengthInBytes) > audioFileByteLength) {
         qFatal("getAudioData requested, but startSample + numberOfSamples was out of bounds!");
-        return sampleData;
-    }
-
-    // Seek to the correct file position (if not already there)
-    if (!inputAudioFile.seek(startByte)) {
-        // Seek failed
-        qFatal("Could not seek to field position in input audio file!");
-        return sampleData;
     }
+}
 
-    // Define a data stream to read 16 bit values from the audio file
-    QDataStream audioData(&inputAudioFile);
-    audioData.setByteOrder(QDataStream::LittleEndian);
-    qint16 x;
-    for (qint32 sample = 0; sample < numberOfSamples; sample++) {
-        // Left 16 bit sample
-        audioData >> x;
-        if (audioData.atEnd()) {
-            qFatal("getAudioData hit premature end of file!");
-            return sampleData;
+// Read samples from the audio source file into buffer, converting them from
+// little-endian if necessary. If there are several files, the read may span
+// more than one of them.
+void SourceAudio::readAudioFile(qint64 startByte, qint64 lengthInBytes, qint16 *buffer)
+{
+    // Find the file containing the start of the data
+    qint32 file = static_cast<qint32>(std::upper_bound(fileStartBytes.begin(), fileStartBytes.end(), startByte)
+                                      - fileStartBytes.begin()) - 1;
+
+    char *output = reinterpret_cast<char *>(buffer);
+    qint64 position = startByte;
+    qint64 remainingBytes = lengthInBytes;
+    while (remainingBytes > 0) {
+        const qint64 fileOffset = position - fileStartBytes[file];
+        const qint64 fileLength = qMin(remainingBytes, fileStartBytes[file + 1] - position);
+
+        if (mappedFiles[file] != nullptr) {
+            // Copy the data from the mapping
+            memcpy(output, mappedFiles[file] + fileOffset, static_cast<size_t>(fileLength));
+        } else {
+            QFile &inputAudioFile = *inputAudioFiles[file];
+
+            // Seek to the correct file position
+            if (!inputAudioFile.seek(fileOffset)) {
+                // Seek failed
+                qFatal("Could not seek to field position in input audio file!");
+            }
+
+            // Read all the data at once
+            if (inputAudioFile.read(output, fileLength) != fileLength) {
+                qFatal("getAudioData hit premature end of file!");
+            }
         }
-        sampleData.append(x);
 
-        // Right 16 bit sample
-        audioData >> x;
-        if (audioData.atEnd()) {
-            qFatal("getAudioData hit premature end of file!");
-            return sampleData;
-        }
-        sampleData.append(x);
+        position += fileLength;
+        remainingBytes -= fileLength;
+        output += fileLength;
+        file++;
     }
 
-    return sampleData;
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+    for (qint64 i = 0; i < lengthInBytes / 2; i++) {
+        buffer[i] = qFromLittleEndian(buffer[i]);
+    }
+#endif
 }
-
@@ -29,6 +29,8 @@
 #include <QDebug>
 #include <QFileInfo>
 #include <QFile>
+#include <memory>
+#include <vector>
 
 // TBC library includes
 #include "lddecodemetadata.h"
@@ -46,16 +48,34 @@ public:
     SourceAudio(const SourceAudio &) = delete;
     SourceAudio& operator=(const SourceAudio &) = delete;
 
+    // A range of stereo samples in the audio source file
+    struct Range {
+        qint32 startSample;
+        qint32 numberOfSamples;
+    };
+
     // File handling methods
-    bool open(QFileInfo inputFileInfo);
+    bool open(QFileInfo inputFileInfo, bool mapFile = false);
     void close();
+    bool isSourceMapped();
 
     // Data handling methods
     Data getAudioData(qint32 startSample, qint32 numberOfSamples);
+    Data getAudioData(const QVector<Range> &ranges);
 
 private:
-    QFile inputAudioFile;
+    // The audio source files (one per part, if the capture is split -- see
+    // tbcparts.h), their mappings (nullptr if not mapped), and the position of
+    // each within the combined audio, followed by the combined length
+    std::vector<std::unique_ptr<QFile>> inputAudioFiles;
+    QVector<const uchar *> mappedFiles;
+    QVector<qint64> fileStartBytes;
     qint64 audioFileByteLength;
+
+    bool openFile(const QString &fileName, bool mapFile);
+
+    void checkRange(qint64 startByte, qint64 lengthInBytes);
+    void readAudioFile(qint64 startByte, qint64 lengthInBytes, qint16 *buffer);
 };
 
 #endif // SOURCEAUDIO_H
@@ -23,11 +23,198 @@
 ************************************************************************/
 
 #include "sourcevideo.h"
+#include "compressedtbc.h"
+#include "parallelfor.h"
+#include "tbcparts.h"
+
+#include <QFileInfo>
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+#include <QtEndian>
 
 #include <cstdio>
+#include <cstring>
+#include <vector>
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+// Background thread that reads whole fields ahead of the position the
+// application is reading from.
+//
+// If the input file is memory-mapped, the thread touches each page of the
+// field so it's resident by the time it's needed. If it's compressed or split
+// into parts, the thread reads the field through the SourceVideo (which is
+// safe, as those reads don't use the file position). Otherwise, it reads the
+// field into memory using its own file handle, so it doesn't disturb the
+// position of the application's reads.
+class SourceVideo::Prefetcher : public QThread
+{
+public:
+    Prefetcher(const QString &filename, const uchar *_mappedFile, SourceVideo *_source,
+               qint32 _fieldByteLength, qint32 _availableFields, qint32 _window);
+    ~Prefetcher() override;
+
+    void fieldRequested(qint32 fieldNumber);
+    bool takeField(qint32 fieldNumber, Data &fieldData);
+
+protected:
+    void run() override;
+
+private:
+    QFile inputFile;
+    const uchar *mappedFile;
+    SourceVideo *source;
+    const qint32 fieldByteLength;
+    const qint32 availableFields;
+    const qint32 window;
+
+    // Everything below is protected by mutex
+    QMutex mutex;
+    QWaitCondition wakeCondition;
+    bool abort;
+    qint32 highestField;
+    qint32 nextField;
+    qint32 generation;
+
+    // Fields that have been prefetched (with empty data if mapped)
+    QMap<qint32, Data> fields;
+};
+
+SourceVideo::Prefetcher::Prefetcher(const QString &filename, const uchar *_mappedFile, SourceVideo *_source,
+                                    qint32 _fieldByteLength, qint32 _availableFields, qint32 _window)
+    : inputFile(filename), mappedFile(_mappedFile), source(_source),
+      fieldByteLength(_fieldByteLength),
+      availableFields(_availableFields), window(_window)
+{
+    abort = false;
+    highestField = -1;
+    nextField = 0;
+    generation = 0;
+}
+
+SourceVideo::Prefetcher::~Prefetcher()
+{
+    {
+        QMutexLocker locker(&mutex);
+        abort = true;
+        wakeCondition.wakeAll();
+    }
+    wait();
+}
+
+// Tell the prefetcher that the application has requested a field (zero-based),
+// so it can move its window forwards
+void SourceVideo::Prefetcher::fieldRequested(qint32 fieldNumber)
+{
+    QMutexLocker locker(&mutex);
+
+    if (highestField == -1 || fieldNumber < highestField - window || fieldNumber > highestField + window) {
+        // This isn't near the previous requests, so the application isn't
+        // reading sequentially -- restart prefetching after this field
+        generation++;
+        fields.clear();
+        highestField = fieldNumber;
+        nextField = fieldNumber + 1;
+    } else {
+        // Don't prefetch fields the application has already read
+        highestField = qMax(highestField, fieldNumber);
+        nextField = qMax(nextField, highestField + 1);
+
+        // Discard fields that have fallen behind the window
+        while (!fields.isEmpty() && fields.firstKey() < highestField - window) {
+            fields.erase(fields.begin());
+        }
+    }
+
+    wakeCondition.wakeAll();
+}
+
+// If a field (zero-based) has been prefetched, remove it from the prefetcher
+// and return true. For a memory-mapped file, fieldData will be empty.
+bool SourceVideo::Prefetcher::takeField(qint32 fieldNumber, Data &fieldData)
+{
+    QMutexLocker locker(&mutex);
+
+    if (!fields.contains(fieldNumber)) return false;
+
+    fieldData = fields.take(fieldNumber);
+    return true;
+}
+
+void SourceVideo::Prefetcher::run()
+{
+    if (mappedFile == nullptr && source == nullptr && !inputFile.open(QIODevice::ReadOnly)) {
+        qWarning() << "Could not open" << inputFile.fileName() << "for prefetching:" << inputFile.errorString();
+        return;
+    }
+
+    QMutexLocker locker(&mutex);
+    while (!abort) {
+        // Wait until there's a field within the window to prefetch
+        if (nextField >= qMin(highestField + 1 + window, availableFields)) {
+            wakeCondition.wait(&mutex);
+            continue;
+        }
+
+        const qint32 fieldNumber = nextField++;
+        const qint32 fieldGeneration = generation;
+        locker.unlock();
+
+        const qint64 position = static_cast<qint64>(fieldByteLength) * static_cast<qint64>(fieldNumber);
+        Data fieldData;
+        bool success = true;
+        QString errorString;
+        if (mappedFile != nullptr) {
+            // Touch each page of the field (pages are at least 4 KiB)
+            volatile uchar touch;
+            for (qint64 offset = 0; offset < fieldByteLength; offset += 4096) {
+                touch = mappedFile[position + offset];
+            }
+            Q_UNUSED(touch);
+        } else if (source != nullptr) {
+            fieldData.resize(fieldByteLength / 2);
+            errno = 0;
+            success = source->readFieldsAt(fieldNumber, 1, fieldData.data());
+            if (!success) {
+                // The source reads with pread or decodes compressed data,
+                // neither of which uses our inputFile
+                errorString = (errno != 0) ? qt_error_string(errno) : QString("unexpected end of file or invalid data");
+            }
+        } else {
+            fieldData.resize(fieldByteLength / 2);
+            success = inputFile.seek(position)
+                      && inputFile.read(reinterpret_cast<char *>(fieldData.data()), fieldByteLength) == fieldByteLength;
+            if (!success) errorString = inputFile.errorString();
+        }
+
+        locker.relock();
+
+        if (!success) {
+            // Stop prefetching; the application's own read will report the error
+            qWarning() << "Prefetching field" << fieldNumber << "from" << inputFile.fileName() << "failed:" << errorString;
+            break;
+        }
+
+        // Keep the field, unless the window moved while we were reading it
+        if (fieldGeneration == generation && fieldNumber >= highestField - window) {
+            fields.insert(fieldNumber, fieldData);
+        }
+    }
+}
 
 // Class constructor
 SourceVideo::SourceVideo()
+    : fieldCache(FieldCache::global())
 {
     // Default object settings
     isSourceVideoOpen = false;
@@ -36,22 +223,39 @@ SourceVideo::SourceVideo()
     fieldLength = -1;
     fieldByteLength = -1;
     fieldLineLength = -1;
-
-    // Set up the cache
-    fieldCache.setMaxCost(100);
+    mappedFile = nullptr;
+    mappedFileSize = 0;
+    isCompressed = false;
+    compressedFieldWidth = -1;
+    compressedFieldHeight = -1;
+    prefetchWindow = 0;
+    streamWindow = 0;
+    streamNextField = 0;
+    followMode = false;
+    followIdleTimeout = DEFAULT_FOLLOW_TIMEOUT;
+    prefetchHits = 0;
+    prefetchMisses = 0;
+    cacheSourceId = -1;
 }
 
 SourceVideo::~SourceVideo()
 {
-    if (isSourceVideoOpen) inputFile.close();
+    if (isSourceVideoOpen) close();
 }
 
 // Source Video file manipulation methods -----------------------------------------------------------------------------
 
-// Open an input video data file. If filename is "-", read from stdin.
+// Open an input video data file. If filename is "-", read from stdin; if it's
+// a manifest for a split capture (see tbcparts.h), read the parts it lists.
 // Returns true on success.
 bool SourceVideo::open(QString filename, qint32 _fieldLength, qint32 _fieldLineLength)
 {
+    if (filename != "-" && TbcParts::isManifest(filename)) {
+        QStringList partFilenames;
+        if (!TbcParts::readManifest(filename, partFilenames)) return false;
+        return openParts(partFilenames, _fieldLength, _fieldLineLength);
+    }
+
     fieldLength = _fieldLength;
     fieldByteLength = _fieldLength * 2;
     if (_fieldLineLength != -1) {
@@ -83,19 +287,116 @@ bool SourceVideo::open(QString filename, qint32 _fieldLength, qint32 _fieldLineL
             return false;
         }
 
-        // File open successful - configure source video parameters
-        qint64 tAvailableFields = (inputFile.size() / fieldByteLength);
-        availableFields = static_cast<qint32>(tAvailableFields);
-        qDebug() << "SourceVideo::open(): Successful -" << availableFields << "fields available";
+        if (CompressedTbc::isCompressed(inputFile.peek(CompressedTbc::HEADER_SIZE))) {
+            // The file is compressed -- read its header and index
+            if (!openCompressedInputFile()) {
+                inputFile.close();
+                return false;
+            }
+            qDebug() << "SourceVideo::open(): Successful (compressed) -" << availableFields << "fields available";
+        } else {
+            // File open successful - configure source video parameters
+            qint64 tAvailableFields = (inputFile.size() / fieldByteLength);
+            availableFields = static_cast<qint32>(tAvailableFields);
+            qDebug() << "SourceVideo::open(): Successful -" << availableFields << "fields available";
+
+            // Try to map the file into memory; if this isn't possible, we'll fall
+            // back to reading it. If the file is still being written, its size
+            // will change, so don't map it.
+            if (followMode) {
+                qDebug() << "SourceVideo::open(): Following input file as it is written";
+            } else if (mapInputFile()) {
+                qDebug() << "SourceVideo::open(): Input file is memory-mapped";
+            }
+        }
+    }
+
+    // Register with the field cache. Other SourceVideos reading the same file
+    // will share its cached fields; stdin always gets a fresh entry.
+    if (filename == "-") {
+        openCompleted(QString());
+    } else {
+        openCompleted(QFileInfo(filename).canonicalFilePath() + ":" + QString::number(fieldLength));
+    }
+
+    return true;
+}
+
+// Open several input video data files, which are parts of the same capture, as
+// if they were a single file. Returns true on success.
+bool SourceVideo::openParts(QStringList filenames, qint32 _fieldLength, qint32 _fieldLineLength)
+{
+    if (filenames.size() == 1) return open(filenames.first(), _fieldLength, _fieldLineLength);
+
+    fieldLength = _fieldLength;
+    fieldByteLength = _fieldLength * 2;
+    if (_fieldLineLength != -1) {
+        fieldLineLength = _fieldLineLength * 2;
+    } else fieldLineLength = -1;
+    qDebug() << "SourceVideo::openParts(): Called with" << filenames.size() << "parts and field byte length ="
+             << fieldByteLength;
+
+    if (isSourceVideoOpen) {
+        qInfo() << "A source video input file is already open, cannot open a new one";
+        return false;
+    }
+    if (filenames.isEmpty()) {
+        qWarning() << "No parts given for the source video input";
+        return false;
+    }
+
+    // Open each part. Each part holds a whole number of fields, so a field
+    // never spans two parts.
+    partStartPositions.clear();
+    partStartPositions.append(0);
+    QString cacheName;
+    for (const QString &filename : filenames) {
+        std::unique_ptr<QFile> partFile(new QFile(filename));
+        if (!partFile->open(QIODevice::ReadOnly)) {
+            qWarning() << "Could not open" << filename << "as part of the source video input";
+            partFiles.clear();
+            return false;
+        }
+        if (CompressedTbc::isCompressed(partFile->peek(CompressedTbc::HEADER_SIZE))) {
+            qWarning() << "Compressed TBC file" << filename << "cannot be used as part of the source video input";
+            partFiles.clear();
+            return false;
+        }
+
+        const qint64 partFields = partFile->size() / fieldByteLength;
+        partStartPositions.append(partStartPositions.last() + (partFields * fieldByteLength));
+        partFiles.push_back(std::move(partFile));
+        cacheName += QFileInfo(filename).canonicalFilePath() + ":";
     }
 
-    // Initialise cache
-    fieldCache.clear();
+    availableFields = static_cast<qint32>(partStartPositions.last() / fieldByteLength);
+    qDebug() << "SourceVideo::openParts(): Successful -" << availableFields << "fields available";
+
+    // The parts aren't memory-mapped, so the field cache is used instead
+    openCompleted(cacheName + QString::number(fieldLength));
+
+    return true;
+}
+
+// Finish opening the input, registering it with the field cache as cacheName
+void SourceVideo::openCompleted(const QString &cacheName)
+{
+    cacheSourceId = fieldCache.registerSource(cacheName);
 
     isSourceVideoOpen = true;
     inputFilePos = 0;
 
-    return true;
+    // Set up the stream window, if reading from stdin
+    if (availableFields == -1 && streamWindow > 0) {
+        qDebug() << "SourceVideo::open(): Keeping the last" << streamWindow << "fields read from stdin";
+        streamFields.resize(streamWindow);
+        streamNextField = 0;
+    }
+
+    // Start prefetching, if requested
+    prefetchHits = 0;
+    prefetchMisses = 0;
+    if (prefetchWindow > 0) startPrefetcher();
 }
 
 // Close an input video data file
@@ -106,8 +407,21 @@ void SourceVideo::close()
         return;
     }
 
-    qDebug() << "SourceVideo::close(): Called, closing the source video file and emptying the frame cache";
+    qDebug() << "SourceVideo::close(): Called, closing the source video file";
+    stopPrefetcher();
+    if (mappedFile != nullptr) {
+        inputFile.unmap(const_cast<uchar *>(mappedFile));
+        mappedFile = nullptr;
+        mappedFileSize = 0;
+    }
     inputFile.close();
+    partFiles.clear();
+    partStartPositions.clear();
+    isCompressed = false;
+    compressedFieldPositions.clear();
+    streamFields.clear();
+    fieldCache.releaseSource(cacheSourceId);
+    cacheSourceId = -1;
     isSourceVideoOpen = false;
     inputFilePos = -1;
 
@@ -120,10 +434,20 @@ bool SourceVideo::isSourceValid()
     return isSourceVideoOpen;
 }
 
+// Return true if the source video file is memory-mapped (so views returned by
+// getVideoFieldView point directly into the file)
+bool SourceVideo::isSourceMapped()
+{
+    return mappedFile != nullptr;
+}
+
 // Get the number of fields available from the source video file.
 // Returns -1 if the length is unknown (e.g. we're reading from stdin).
+// If the file is being followed, this is the number of fields written so far.
 qint32 SourceVideo::getNumberOfAvailableFields()
 {
+    if (isFollowing()) updateAvailableFields();
+
     return availableFields;
 }
 
@@ -133,6 +457,86 @@ qint32 SourceVideo::getFieldLength()
     return fieldLength;
 }
 
+// Set the number of fields to read ahead of the application in a background
+// thread (0 to disable prefetching). This may be called before or after the
+// source video file is opened.
+void SourceVideo::setPrefetchWindow(qint32 fields)
+{
+    prefetchWindow = qMax(fields, 0);
+
+    if (isSourceVideoOpen) {
+        stopPrefetcher();
+        if (prefetchWindow > 0) startPrefetcher();
+    }
+}
+
+// Get the number of field requests that were satisfied by the prefetcher
+qint64 SourceVideo::getPrefetchHits()
+{
+    return prefetchHits;
+}
+
+// Get the number of field requests that the prefetcher had not read in time
+qint64 SourceVideo::getPrefetchMisses()
+{
+    return prefetchMisses;
+}
+
+// Set the number of fields to keep when reading from stdin (0 to disable).
+// Reading from stdin can only go forwards, so this lets the application go back
+// to any of the last few fields it has read -- it should be at least as many
+// fields as the application will look behind. This must be called before the
+// source video file is opened, and has no effect for other files.
+void SourceVideo::setStreamWindow(qint32 fields)
+{
+    if (isSourceVideoOpen) qFatal("Application set the stream window after opening TBC file - Fatal error");
+
+    streamWindow = qMax(fields, 0);
+}
+
+// Treat the source video file as one that's still being written (e.g. by
+// ld-decode): its length will be checked again when fields beyond the end are
+// requested, and reads will wait for fields to appear. The file is considered
+// complete once it has not grown for idleTimeout milliseconds. This must be
+// called before the source video file is opened, and has no effect for stdin or
+// compressed files.
+void SourceVideo::setFollowMode(bool follow, qint32 idleTimeout)
+{
+    if (isSourceVideoOpen) qFatal("Application set follow mode after opening TBC file - Fatal error");
+
+    followMode = follow;
+    followIdleTimeout = idleTimeout;
+}
+
+// Wait until at least numberOfFields fields are available. Returns true if
+// they are; false if the file stopped growing before then (or isn't being
+// followed, and is too short).
+bool SourceVideo::waitForFields(qint32 numberOfFields)
+{
+    if (!isFollowing()) return availableFields == -1 || availableFields >= numberOfFields;
+
+    // Poll the size of the file, until either it's long enough or it's been
+    // the same size for followIdleTimeout
+    static constexpr qint32 POLL_INTERVAL = 100;
+    QElapsedTimer idleTimer;
+    idleTimer.start();
+    qint32 lastAvailableFields = availableFields;
+    while (true) {
+        updateAvailableFields();
+        if (availableFields >= numberOfFields) return true;
+
+        if (availableFields != lastAvailableFields) {
+            lastAvailableFields = availableFields;
+            idleTimer.restart();
+        } else if (idleTimer.elapsed() >= followIdleTimeout) {
+            qDebug() << "SourceVideo::waitForFields(): Input file has stopped growing at" << availableFields << "fields";
+            return false;
+        }
+
+        QThread::msleep(POLL_INTERVAL);
+    }
+}
+
 // Frame data retrieval methods ---------------------------------------------------------------------------------------
 
 // Method to retrieve a range of field lines from a single video field.
@@ -145,18 +549,354 @@ SourceVideo::Data SourceVideo::getVideoField(qint32 fieldNumber, qint32 startFie
     // Ensure source video is open
     if (!isSourceVideoOpen) qFatal("Application requested TBC field before opening TBC file - Fatal error");
 
-    // Calculate the position of the require field line data
-    qint64 requiredStartPosition = static_cast<qint64>(fieldByteLength) * static_cast<qint64>(fieldNumber);
+    const bool wholeField = (startFieldLine == -1 && endFieldLine == -1);
+
+    // Calculate the position of the required field line data
     qint64 requiredReadLength;
+    qint64 requiredStartPosition = getRequiredStartPosition(fieldNumber, startFieldLine, endFieldLine, requiredReadLength);
 
-    if (startFieldLine == -1 && endFieldLine == -1) {
-        // Read the whole field
+    if (isStreaming()) {
+        Data streamField = getStreamField(fieldNumber);
+        if (wholeField) return streamField;
+
+        // Return the requested lines from the field
+        const qint64 fieldStartPosition = static_cast<qint64>(fieldByteLength) * static_cast<qint64>(fieldNumber);
+        return streamField.mid(static_cast<qint32>((requiredStartPosition - fieldStartPosition) / 2),
+                               static_cast<qint32>(requiredReadLength / 2));
+    }
+
+    // Check the cache (we only cache whole fields, and only if the file isn't
+    // mapped -- if it is, the OS's page cache does the job instead)
+    Data cachedField;
+    bool isCached = false;
+    if (mappedFile == nullptr) {
+        isCached = fieldCache.find(cacheSourceId, fieldNumber, cachedField);
+    }
+    if (isCached) {
+        // Keep the prefetcher's window moving with the application's reads
+        notifyPrefetcher(fieldNumber);
+    } else {
+        // Check if the prefetcher has already read the field
+        if (getPrefetchedField(fieldNumber, cachedField) && !cachedField.isEmpty()) {
+            fieldCache.insert(cacheSourceId, fieldNumber, cachedField);
+            isCached = true;
+        }
+    }
+    if (isCached) {
+        if (wholeField) return cachedField;
+
+        // Return the requested lines from the cached field
+        const qint64 fieldStartPosition = static_cast<qint64>(fieldByteLength) * static_cast<qint64>(fieldNumber);
+        return cachedField.mid(static_cast<qint32>((requiredStartPosition - fieldStartPosition) / 2),
+                               static_cast<qint32>(requiredReadLength / 2));
+    }
+
+    // Read the field lines into a new buffer (which the cache can then share
+    // with the caller without copying)
+    Data fieldData(static_cast<qint32>(requiredReadLength / 2));
+    readInputFile(requiredStartPosition, requiredReadLength, reinterpret_cast<char *>(fieldData.data()));
+
+    if (wholeField && mappedFile == nullptr) {
+        // Insert the field data into the cache
+        fieldCache.insert(cacheSourceId, fieldNumber, fieldData);
+    }
+
+    // Return the data
+    return fieldData;
+}
+
+// Method to retrieve a read-only view of a single video field.
+// If the source is memory-mapped, this doesn't copy the data at all.
+SourceVideo::View SourceVideo::getVideoFieldView(qint32 fieldNumber)
+{
+    // Ensure source video is open
+    if (!isSourceVideoOpen) qFatal("Application requested TBC field before opening TBC file - Fatal error");
+
+    if (mappedFile == nullptr) {
+        // Not mapped -- read the field (the view will share the buffer)
+        return View(getVideoField(fieldNumber));
+    }
+
+    // Calculate the position of the field within the mapping
+    qint64 requiredReadLength;
+    qint64 requiredStartPosition = getRequiredStartPosition(fieldNumber - 1, -1, -1, requiredReadLength);
+
+    // Let the prefetcher know which field we're reading (it has nothing to
+    // return, but we want to know if the field was already resident)
+    Data prefetchedField;
+    getPrefetchedField(fieldNumber - 1, prefetchedField);
+
+    // Hint that we'll want the next field soon
+    adviseInputFile(requiredStartPosition + requiredReadLength, requiredReadLength, true);
+
+    return View(reinterpret_cast<const quint16 *>(mappedFile + requiredStartPosition),
+                static_cast<qint32>(requiredReadLength / 2));
+}
+
+// Start the background prefetcher
+void SourceVideo::startPrefetcher()
+{
+    if (availableFields == -1) {
+        qInfo() << "Prefetching is not supported when reading the source video from stdin";
+        return;
+    }
+    if (isFollowing()) {
+        qInfo() << "Prefetching is not supported when following the source video";
+        return;
+    }
+
+    qDebug() << "SourceVideo::startPrefetcher(): Prefetching" << prefetchWindow << "fields ahead";
+    const bool readThroughSource = isCompressed || !partFiles.empty();
+    prefetcher.reset(new Prefetcher(inputFile.fileName(), mappedFile, readThroughSource ? this : nullptr,
+                                    fieldByteLength, availableFields, prefetchWindow));
+    prefetcher->start();
+}
+
+// Stop the background prefetcher (if it's running), discarding any fields it
+// has read
+void SourceVideo::stopPrefetcher()
+{
+    prefetcher.reset();
+}
+
+// Check if the prefetcher has read a field (zero-based) and update the hit
+// statistics. Returns true if it has; fieldData will hold the field, or will be
+// empty if the input is memory-mapped.
+bool SourceVideo::getPrefetchedField(qint32 fieldNumber, Data &fieldData)
+{
+    if (!prefetcher) return false;
+
+    prefetcher->fieldRequested(fieldNumber);
+    if (prefetcher->takeField(fieldNumber, fieldData)) {
+        prefetchHits++;
+        return true;
+    }
+
+    prefetchMisses++;
+    return false;
+}
+
+// Tell the prefetcher that the application has read a field (zero-based) that
+// it didn't need the prefetcher for (because it was already cached), so it
+// keeps reading ahead. This doesn't count as a hit or a miss.
+void SourceVideo::notifyPrefetcher(qint32 fieldNumber)
+{
+    if (!prefetcher) return;
+
+    prefetcher->fieldRequested(fieldNumber);
+
+    // Drop the prefetcher's copy of the field, if it has one
+    Data unusedField;
+    prefetcher->takeField(fieldNumber, unusedField);
+}
+
+// Method to retrieve a run of consecutive whole fields, starting at
+// firstFieldNumber, into a caller-owned buffer. The buffer is resized to hold
+// count fields, one after another.
+//
+// Fields that are already cached are copied from the cache; the rest are read
+// in as few reads as possible (usually one).
+void SourceVideo::getVideoFields(qint32 firstFieldNumber, qint32 count, Data &buffer)
+{
+    // Adjust the field number to index from zero
+    firstFieldNumber--;
+
+    // Ensure source video is open
+    if (!isSourceVideoOpen) qFatal("Application requested TBC field before opening TBC file - Fatal error");
+
+    if (count <= 0) {
+        buffer.clear();
+        return;
+    }
+
+    // Check the first and last fields are within the input file
+    qint64 requiredReadLength;
+    const qint64 requiredStartPosition = getRequiredStartPosition(firstFieldNumber, -1, -1, requiredReadLength);
+    getRequiredStartPosition(firstFieldNumber + count - 1, -1, -1, requiredReadLength);
+
+    buffer.resize(count * fieldLength);
+    char *bufferBytes = reinterpret_cast<char *>(buffer.data());
+
+    if (isStreaming()) {
+        for (qint32 i = 0; i < count; i++) {
+            const Data streamField = getStreamField(firstFieldNumber + i);
+            std::copy(streamField.begin(), streamField.end(), buffer.begin() + (i * fieldLength));
+        }
+        return;
+    }
+
+    // Read fields [runStart, runEnd) from the input file, and add them to the cache
+    auto readRun = [&](qint32 runStart, qint32 runEnd) {
+        const qint64 runOffset = static_cast<qint64>(fieldByteLength) * runStart;
+        readInputFile(requiredStartPosition + runOffset, static_cast<qint64>(fieldByteLength) * (runEnd - runStart),
+                      bufferBytes + runOffset);
+
+        if (mappedFile == nullptr) {
+            for (qint32 i = runStart; i < runEnd; i++) {
+                fieldCache.insert(cacheSourceId, firstFieldNumber + i, buffer.mid(i * fieldLength, fieldLength));
+            }
+        }
+    };
+
+    // Find runs of fields that aren't cached or prefetched
+    qint32 runStart = -1;
+    for (qint32 i = 0; i < count; i++) {
+        const qint32 fieldNumber = firstFieldNumber + i;
+
+        Data cachedField;
+        bool isCached = false;
+        if (mappedFile == nullptr) {
+            isCached = fieldCache.find(cacheSourceId, fieldNumber, cachedField);
+        }
+        if (isCached) {
+            notifyPrefetcher(fieldNumber);
+        } else if (getPrefetchedField(fieldNumber, cachedField) && !cachedField.isEmpty()) {
+            fieldCache.insert(cacheSourceId, fieldNumber, cachedField);
+            isCached = true;
+        }
+
+        if (isCached) {
+            // Finish the current run, and copy the cached field
+            if (runStart != -1) readRun(runStart, i);
+            runStart = -1;
+
+            std::copy(cachedField.begin(), cachedField.end(), buffer.begin() + (i * fieldLength));
+        } else if (runStart == -1) {
+            // Start a new run
+            runStart = i;
+        }
+    }
+    if (runStart != -1) readRun(runStart, count);
+}
+
+// Method to retrieve the same range of field lines from count consecutive
+// fields, starting at firstFieldNumber. The buffer is resized to hold the
+// lines from each field, packed one after another.
+//
+// Fields that are already cached are copied from the cache; the rest are read
+// with as few system calls as possible. This is much faster than calling
+// getVideoField for each field when only a few lines from each are needed.
+void SourceVideo::getVideoFieldLines(qint32 firstFieldNumber, qint32 count, qint32 startFieldLine, qint32 endFieldLine,
+                                     Data &buffer)
+{
+    // Adjust the field number to index from zero
+    firstFieldNumber--;
+
+    // Ensure source video is open
+    if (!isSourceVideoOpen) qFatal("Application requested TBC field before opening TBC file - Fatal error");
+
+    if (count <= 0) {
+        buffer.clear();
+        return;
+    }
+
+    // Work out where the lines are, and check the first and last fields are
+    // within the input file
+    qint64 requiredReadLength;
+    const qint64 requiredStartPosition = getRequiredStartPosition(firstFieldNumber, startFieldLine, endFieldLine,
+                                                                  requiredReadLength);
+    getRequiredStartPosition(firstFieldNumber + count - 1, startFieldLine, endFieldLine, requiredReadLength);
+    const qint32 linesOffset = static_cast<qint32>((requiredStartPosition
+                                                    - static_cast<qint64>(fieldByteLength) * firstFieldNumber) / 2);
+    const qint32 linesLength = static_cast<qint32>(requiredReadLength / 2);
+
+    buffer.resize(count * linesLength);
+    char *bufferBytes = reinterpret_cast<char *>(buffer.data());
+
+    if (isStreaming()) {
+        for (qint32 i = 0; i < count; i++) {
+            const Data streamField = getStreamField(firstFieldNumber + i);
+            std::copy(streamField.begin() + linesOffset, streamField.begin() + linesOffset + linesLength,
+                      buffer.begin() + (i * linesLength));
+        }
+        return;
+    }
+
+    // Read the lines from fields [runStart, runEnd) from the input file
+    auto readRun = [&](qint32 runStart, qint32 runEnd) {
+        readInputFileStrided(requiredStartPosition + static_cast<qint64>(fieldByteLength) * runStart, requiredReadLength,
+                             fieldByteLength, runEnd - runStart, bufferBytes + requiredReadLength * runStart);
+    };
+
+    // Find runs of fields that aren't cached or prefetched
+    qint32 runStart = -1;
+    for (qint32 i = 0; i < count; i++) {
+        const qint32 fieldNumber = firstFieldNumber + i;
 
-        // Check the cache (we only cache whole fields)
-        if (fieldCache.contains(fieldNumber)) {
-            return *fieldCache.object(fieldNumber);
+        Data cachedField;
+        bool isCached = false;
+        if (mappedFile == nullptr) {
+            isCached = fieldCache.find(cacheSourceId, fieldNumber, cachedField);
         }
+        if (isCached) {
+            notifyPrefetcher(fieldNumber);
+        } else if (getPrefetchedField(fieldNumber, cachedField) && !cachedField.isEmpty()) {
+            fieldCache.insert(cacheSourceId, fieldNumber, cachedField);
+            isCached = true;
+        }
+
+        if (isCached) {
+            // Finish the current run, and copy the lines from the cached field
+            if (runStart != -1) readRun(runStart, i);
+            runStart = -1;
+
+            std::copy(cachedField.begin() + linesOffset, cachedField.begin() + linesOffset + linesLength,
+                      buffer.begin() + (i * linesLength));
+        } else if (runStart == -1) {
+            // Start a new run
+            runStart = i;
+        }
+    }
+    if (runStart != -1) readRun(runStart, count);
+}
+
+// Return true if the input file is being followed as it's written
+bool SourceVideo::isFollowing()
+{
+    return followMode && availableFields != -1 && !isCompressed && partFiles.empty();
+}
+
+// Update availableFields from the current size of the input file
+void SourceVideo::updateAvailableFields()
+{
+    availableFields = static_cast<qint32>(inputFile.size() / fieldByteLength);
+}
+
+// Return true if fields are being read through the stream window
+bool SourceVideo::isStreaming()
+{
+    return !streamFields.isEmpty();
+}
+
+// Get a whole field (zero-based) through the stream window, reading forwards
+// from stdin as far as necessary
+SourceVideo::Data SourceVideo::getStreamField(qint32 fieldNumber)
+{
+    if (fieldNumber < streamNextField - streamWindow) {
+        qFatal("Application requested a field that is no longer in the stream window when reading from stdin");
+    }
+
+    while (streamNextField <= fieldNumber) {
+        Data fieldData(fieldLength);
+        readInputFile(static_cast<qint64>(fieldByteLength) * streamNextField, fieldByteLength,
+                      reinterpret_cast<char *>(fieldData.data()));
+        streamFields[streamNextField % streamWindow] = fieldData;
+        streamNextField++;
+    }
+
+    return streamFields[fieldNumber % streamWindow];
+}
 
+// Work out the file position and length of a range of field lines, checking
+// that they're within the bounds of the input file. fieldNumber is zero-based.
+// If startFieldLine and endFieldLine are both -1, use the whole field.
+qint64 SourceVideo::getRequiredStartPosition(qint32 fieldNumber, qint32 startFieldLine, qint32 endFieldLine,
+                                             qint64 &requiredReadLength)
+{
+    qint64 requiredStartPosition = static_cast<qint64>(fieldByteLength) * static_cast<qint64>(fieldNumber);
+
+    if (startFieldLine == -1 && endFieldLine == -1) {
+        // Read the whole field
         requiredReadLength = static_cast<qint64>(fieldByteLength);
     } else {
         // Read a range of lines
@@ -173,6 +913,12 @@ SourceVideo::Data SourceVideo::getVideoField(qint32 fieldNumber, qint32 startFie
         requiredReadLength = static_cast<qint64>(endFieldLine - startFieldLine + 1) * static_cast<qint64>(fieldLineLength);
     }
 
+    // If the file is still being written, wait for the requested data to appear
+    const qint64 requiredEndPosition = requiredStartPosition + requiredReadLength;
+    if (isFollowing() && requiredEndPosition > static_cast<qint64>(fieldByteLength) * availableFields) {
+        waitForFields(static_cast<qint32>((requiredEndPosition + fieldByteLength - 1) / fieldByteLength));
+    }
+
     // Check the requested field and lines are valid
     if (availableFields != -1
         && (requiredStartPosition < 0
@@ -180,8 +926,62 @@ SourceVideo::Data SourceVideo::getVideoField(qint32 fieldNumber, qint32 startFie
         qFatal("Application requested field line range that exceeds the boundaries of the input TBC file");
     }
 
-    // Resize the output buffer
-    outputFieldData.resize(static_cast<qint32>(requiredReadLength) / 2);
+    return requiredStartPosition;
+}
+
+// Read data from the input file into buffer, from either the mapping or the
+// file itself
+void SourceVideo::readInputFile(qint64 requiredStartPosition, qint64 requiredReadLength, char *buffer)
+{
+    if (isCompressed) {
+        // Work out which fields the data is in
+        const qint32 firstFieldNumber = static_cast<qint32>(requiredStartPosition / fieldByteLength);
+        const qint32 lastFieldNumber = static_cast<qint32>((requiredStartPosition + requiredReadLength - 1) / fieldByteLength);
+        const qint32 count = lastFieldNumber - firstFieldNumber + 1;
+        const qint64 offset = requiredStartPosition - (static_cast<qint64>(fieldByteLength) * firstFieldNumber);
+
+        if (offset == 0 && requiredReadLength == static_cast<qint64>(fieldByteLength) * count) {
+            // Whole fields -- decode straight into the buffer
+            if (!readCompressedFields(firstFieldNumber, count, reinterpret_cast<quint16 *>(buffer))) {
+                qFatal("Could not read field data from compressed input TBC file");
+            }
+        } else {
+            // Decode the fields, then copy the part that's needed
+            Data fields(count * fieldLength);
+            if (!readCompressedFields(firstFieldNumber, count, fields.data())) {
+                qFatal("Could not read field data from compressed input TBC file");
+            }
+            memcpy(buffer, reinterpret_cast<const char *>(fields.constData()) + offset,
+                   static_cast<size_t>(requiredReadLength));
+        }
+        return;
+    }
+
+    if (mappedFile != nullptr) {
+        // Copy straight from the mapping
+        memcpy(buffer, mappedFile + requiredStartPosition, static_cast<size_t>(requiredReadLength));
+        adviseInputFile(requiredStartPosition + requiredReadLength, requiredReadLength, true);
+        return;
+    }
+
+    if (!partFiles.empty()) {
+        // Read from whichever parts the data is in
+        if (!readInputFileAt(requiredStartPosition, requiredReadLength, buffer)) {
+            qFatal("Could not read field data from input TBC file");
+        }
+        return;
+    }
+
+#ifdef Q_OS_UNIX
+    if (availableFields != -1) {
+        // This is a regular file -- read it with pread, which doesn't need a
+        // separate seek
+        if (!readInputFileAt(requiredStartPosition, requiredReadLength, buffer)) {
+            qFatal("Could not read field data from input TBC file");
+        }
+        return;
+    }
+#endif
 
     // Seek to the correct file position (if not already there)
     if (inputFilePos != requiredStartPosition) {
@@ -194,8 +994,7 @@ SourceVideo::Data SourceVideo::getVideoField(qint32 fieldNumber, qint32 startFie
                 // Seeking forwards -- try reading and discarding data instead
                 qint64 discardBytes = requiredStartPosition - inputFilePos;
                 while (discardBytes > 0) {
-                    qint64 readBytes = inputFile.read(reinterpret_cast<char *>(outputFieldData.data()),
-                                                      qMin(discardBytes, static_cast<qint64>(outputFieldData.size() * 2)));
+                    qint64 readBytes = inputFile.read(buffer, qMin(discardBytes, requiredReadLength));
                     if (readBytes <= 0) {
                         qFatal("Could not seek or read forwards to required field position in input TBC file");
                     }
@@ -210,8 +1009,7 @@ SourceVideo::Data SourceVideo::getVideoField(qint32 fieldNumber, qint32 startFie
     qint64 totalReceivedBytes = 0;
     qint64 receivedBytes = 0;
     do {
-        receivedBytes = inputFile.read(reinterpret_cast<char *>(outputFieldData.data()) + totalReceivedBytes,
-                                       requiredReadLength - totalReceivedBytes);
+        receivedBytes = inputFile.read(buffer + totalReceivedBytes, requiredReadLength - totalReceivedBytes);
         if (receivedBytes > 0) {
             totalReceivedBytes += receivedBytes;
             inputFilePos += receivedBytes;
@@ -220,25 +1018,263 @@ SourceVideo::Data SourceVideo::getVideoField(qint32 fieldNumber, qint32 startFie
 
     // Verify read was ok
     if (totalReceivedBytes != requiredReadLength) qFatal("Could not read field data from input TBC file");
+}
 
-    if (startFieldLine == -1 && endFieldLine == -1) {
-        // Insert the field data into the cache
-        fieldCache.insert(fieldNumber, new Data(outputFieldData), 1);
+// Read count ranges of requiredReadLength bytes, each stride bytes apart in
+// the input file, into buffer (packed together)
+void SourceVideo::readInputFileStrided(qint64 requiredStartPosition, qint64 requiredReadLength, qint64 stride,
+                                       qint32 count, char *buffer)
+{
+    if (isCompressed) {
+        // Decode a few fields at a time, and copy the lines from each
+        static constexpr qint32 MAX_FIELDS = 32;
+        const qint32 firstFieldNumber = static_cast<qint32>(requiredStartPosition / fieldByteLength);
+        const qint64 offset = requiredStartPosition - (static_cast<qint64>(fieldByteLength) * firstFieldNumber);
+
+        Data fields;
+        for (qint32 first = 0; first < count; first += MAX_FIELDS) {
+            const qint32 fieldCount = qMin(MAX_FIELDS, count - first);
+            fields.resize(fieldCount * fieldLength);
+            if (!readCompressedFields(firstFieldNumber + first, fieldCount, fields.data())) {
+                qFatal("Could not read field data from compressed input TBC file");
+            }
+
+            for (qint32 i = 0; i < fieldCount; i++) {
+                memcpy(buffer + requiredReadLength * (first + i),
+                       reinterpret_cast<const char *>(fields.constData()) + (static_cast<qint64>(fieldByteLength) * i) + offset,
+                       static_cast<size_t>(requiredReadLength));
+            }
+        }
+        return;
     }
 
-    // Return the data
-    return outputFieldData;
+#ifdef Q_OS_UNIX
+    if (mappedFile == nullptr && partFiles.empty() && availableFields != -1 && count > 1) {
+        // This is a regular file -- use preadv to read a block of ranges in a
+        // single call, with the data between them going into a scratch buffer.
+        // The number of ranges per call is limited by the number of iovecs
+        // allowed, and by the total size of the block.
+        static const qint32 maxIovecs = qMax(2, static_cast<qint32>(qMin(sysconf(_SC_IOV_MAX), static_cast<long>(1024))));
+        static constexpr qint64 maxBlockLength = 64 * 1024 * 1024;
+        const qint32 maxRanges = qMin((maxIovecs + 1) / 2, static_cast<qint32>(qMax(static_cast<qint64>(1), maxBlockLength / stride)));
+
+        const qint64 gapLength = stride - requiredReadLength;
+        std::vector<char> gap(static_cast<size_t>(gapLength));
+        std::vector<iovec> iovecs;
+        iovecs.reserve(static_cast<size_t>(maxRanges * 2));
+
+        const int fd = inputFile.handle();
+        for (qint32 first = 0; first < count; first += maxRanges) {
+            const qint32 ranges = qMin(maxRanges, count - first);
+
+            iovecs.clear();
+            for (qint32 i = 0; i < ranges; i++) {
+                if (i != 0 && gapLength > 0) iovecs.push_back({gap.data(), static_cast<size_t>(gapLength)});
+                iovecs.push_back({buffer + requiredReadLength * (first + i), static_cast<size_t>(requiredReadLength)});
+            }
+
+            const qint64 blockStart = requiredStartPosition + stride * first;
+            const qint64 blockLength = (stride * (ranges - 1)) + requiredReadLength;
+            ssize_t receivedBytes;
+            do {
+                receivedBytes = preadv(fd, iovecs.data(), static_cast<int>(iovecs.size()), static_cast<off_t>(blockStart));
+            } while (receivedBytes < 0 && errno == EINTR);
+
+            if (receivedBytes != blockLength) {
+                // Short read -- fall back to reading each range separately
+                for (qint32 i = 0; i < ranges; i++) {
+                    readInputFile(blockStart + stride * i, requiredReadLength, buffer + requiredReadLength * (first + i));
+                }
+            }
+        }
+        return;
+    }
+#endif
+
+    for (qint32 i = 0; i < count; i++) {
+        readInputFile(requiredStartPosition + stride * i, requiredReadLength, buffer + requiredReadLength * i);
+    }
 }
 
+// Read count consecutive whole fields (zero-based) into samples, without
+// changing the file position. This is safe to call from multiple threads.
+// Returns true on success.
+bool SourceVideo::readFieldsAt(qint32 firstFieldNumber, qint32 count, quint16 *samples)
+{
+    if (isCompressed) return readCompressedFields(firstFieldNumber, count, samples);
 
+    return readInputFileAt(static_cast<qint64>(fieldByteLength) * firstFieldNumber,
+                           static_cast<qint64>(fieldByteLength) * count, reinterpret_cast<char *>(samples));
+}
 
+// Read part of the input, without changing the file position. If the input is
+// split into parts, the read may span several of them. This is safe to call
+// from multiple threads. Returns true on success.
+bool SourceVideo::readInputFileAt(qint64 position, qint64 length, char *buffer)
+{
+    if (partFiles.empty()) return readFileAt(inputFile, position, length, buffer);
 
+    // Find the part containing the start of the data
+    qint32 part = static_cast<qint32>(std::upper_bound(partStartPositions.begin(), partStartPositions.end(), position)
+                                      - partStartPositions.begin()) - 1;
+    while (length > 0) {
+        if (part < 0 || part >= static_cast<qint32>(partFiles.size())) return false;
 
+        const qint64 partLength = qMin(length, partStartPositions[part + 1] - position);
+        if (!readFileAt(*partFiles[part], position - partStartPositions[part], partLength, buffer)) return false;
 
+        position += partLength;
+        length -= partLength;
+        buffer += partLength;
+        part++;
+    }
+    return true;
+}
 
+// Read part of a file, without changing its file position (on platforms with
+// pread). Returns true on success.
+bool SourceVideo::readFileAt(QFile &file, qint64 position, qint64 length, char *buffer)
+{
+#ifdef Q_OS_UNIX
+    const int fd = file.handle();
+    qint64 totalReceivedBytes = 0;
+    while (totalReceivedBytes < length) {
+        const ssize_t receivedBytes = pread(fd, buffer + totalReceivedBytes,
+                                            static_cast<size_t>(length - totalReceivedBytes),
+                                            static_cast<off_t>(position + totalReceivedBytes));
+        if (receivedBytes < 0 && errno == EINTR) continue;
+        if (receivedBytes <= 0) return false;
+        totalReceivedBytes += receivedBytes;
+    }
+    return true;
+#else
+    // No pread, so serialise access to the file position
+    QMutexLocker locker(&readMutex);
+    if (&file == &inputFile) inputFilePos = -1;
+    return file.seek(position) && file.read(buffer, length) == length;
+#endif
+}
 
+// Read the header and field index of a compressed input file.
+// Returns true on success.
+bool SourceVideo::openCompressedInputFile()
+{
+    CompressedTbc::Header header;
+    if (!CompressedTbc::readHeader(inputFile.read(CompressedTbc::HEADER_SIZE), header)) {
+        qWarning() << "Compressed source video input file has an invalid header";
+        return false;
+    }
 
+    // Check the field dimensions match what the application expects
+    if (static_cast<qint64>(header.fieldWidth) * header.fieldHeight != fieldLength
+        || (fieldLineLength != -1 && header.fieldWidth * 2 != fieldLineLength)) {
+        qWarning() << "Compressed source video input file has fields of" << header.fieldWidth << "x" << header.fieldHeight
+                   << "samples, which does not match the metadata";
+        return false;
+    }
 
+    // Read the field index
+    const qint64 indexLength = static_cast<qint64>(header.numberOfFields + 1) * static_cast<qint64>(sizeof(quint64));
+    QByteArray index;
+    if (header.indexPosition + indexLength <= inputFile.size() && inputFile.seek(header.indexPosition)) {
+        index = inputFile.read(indexLength);
+    }
+    if (index.size() != indexLength) {
+        qWarning() << "Could not read the field index from the compressed source video input file";
+        return false;
+    }
 
+    compressedFieldPositions.resize(header.numberOfFields + 1);
+    const uchar *indexData = reinterpret_cast<const uchar *>(index.constData());
+    for (qint32 i = 0; i <= header.numberOfFields; i++) {
+        compressedFieldPositions[i] = static_cast<qint64>(qFromLittleEndian<quint64>(indexData + (i * sizeof(quint64))));
 
+        // Fields must be in order, and within the file
+        if (compressedFieldPositions[i] < CompressedTbc::HEADER_SIZE
+            || compressedFieldPositions[i] > header.indexPosition
+            || (i > 0 && compressedFieldPositions[i] < compressedFieldPositions[i - 1])) {
+            qWarning() << "The field index in the compressed source video input file is corrupt";
+            compressedFieldPositions.clear();
+            return false;
+        }
+    }
 
+    isCompressed = true;
+    compressedFieldWidth = header.fieldWidth;
+    compressedFieldHeight = header.fieldHeight;
+    availableFields = header.numberOfFields;
+    return true;
+}
+
+// Read and decode count consecutive fields (zero-based) from a compressed input
+// file into samples, decoding the fields in parallel. This is safe to call
+// from multiple threads. Returns true on success.
+bool SourceVideo::readCompressedFields(qint32 firstFieldNumber, qint32 count, quint16 *samples)
+{
+    // The fields are stored one after another, so read them all at once
+    const qint64 blockStart = compressedFieldPositions[firstFieldNumber];
+    const qint64 blockLength = compressedFieldPositions[firstFieldNumber + count] - blockStart;
+    QByteArray block(static_cast<qint32>(blockLength), '\0');
+    if (!readInputFileAt(blockStart, blockLength, block.data())) return false;
+
+    QAtomicInt failed(0);
+    parallelFor(count, QThread::idealThreadCount(), [&](qint32 i) {
+        const qint64 fieldStart = compressedFieldPositions[firstFieldNumber + i];
+        const qint64 fieldEnd = compressedFieldPositions[firstFieldNumber + i + 1];
+        if (!CompressedTbc::decodeField(block.constData() + (fieldStart - blockStart), fieldEnd - fieldStart,
+                                        compressedFieldWidth, compressedFieldHeight,
+                                        samples + (static_cast<qint64>(fieldLength) * i))) {
+            failed.storeRelaxed(1);
+        }
+    });
+
+    return failed.loadRelaxed() == 0;
+}
+
+// Map the whole of the input file into memory.
+// Returns true on success; on failure, the file is read normally instead.
+bool SourceVideo::mapInputFile()
+{
+    mappedFileSize = static_cast<qint64>(fieldByteLength) * availableFields;
+    if (mappedFileSize == 0) return false;
+
+    mappedFile = inputFile.map(0, mappedFileSize);
+    if (mappedFile == nullptr) {
+        qDebug() << "SourceVideo::mapInputFile(): Could not map input file:" << inputFile.errorString();
+        mappedFileSize = 0;
+        return false;
+    }
+
+    // Most of the tools read the file from start to end, so ask the OS to
+    // read ahead aggressively and drop pages behind us
+    adviseInputFile(0, mappedFileSize, false);
+
+    return true;
+}
+
+// Give the OS a hint about how we're going to access part of the mapping.
+// If willNeed is true, the range will be needed soon; otherwise, the range
+// will be accessed sequentially.
+void SourceVideo::adviseInputFile(qint64 start, qint64 length, bool willNeed)
+{
+#ifdef Q_OS_UNIX
+    if (mappedFile == nullptr) return;
+
+    // Clip the range to the mapping
+    if (start >= mappedFileSize) return;
+    length = qMin(length, mappedFileSize - start);
+
+    // madvise needs a page-aligned start address (the mapping itself is
+    // page-aligned, as it starts at offset 0)
+    static const qint64 pageSize = sysconf(_SC_PAGESIZE);
+    const qint64 alignedStart = start - (start % pageSize);
+    length += start - alignedStart;
+
+    madvise(const_cast<uchar *>(mappedFile) + alignedStart, static_cast<size_t>(length),
+            willNeed ? MADV_WILLNEED : MADV_SEQUENTIAL);
+#else
+    Q_UNUSED(start);
+    Q_UNUSED(length);
+    Q_UNUSED(willNeed);
+#endif
+}
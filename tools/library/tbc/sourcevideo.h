@@ -26,9 +26,15 @@
 #define SOURCEVIDEO_H
 
 #include <QFile>
-#include <QCache>
+#include <QMutex>
 #include <QDebug>
+#include <QStringList>
 #include <QVector>
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "fieldcache.h"
 
 class SourceVideo
 {
@@ -39,6 +45,58 @@ public:
     // yourself).
     using Data = QVector<quint16>;
 
+    // A read-only view of timebase-corrected video samples.
+    // If the source is memory-mapped, this points directly into the mapping
+    // and remains valid until the SourceVideo is closed. Otherwise, the view
+    // holds a (shared) reference to a Data that owns the samples.
+    class View
+    {
+    public:
+        View() = default;
+        View(const Data &data)
+            : owner(data), viewData(owner.constData()), viewSize(owner.size()) {}
+
+        // A view of part of a Data, which it shares ownership of
+        View(const Data &data, qint32 offset, qint32 size)
+            : owner(data), viewData(owner.constData() + offset), viewSize(size) {}
+
+        const quint16 *data() const {
+            return viewData;
+        }
+        qint32 size() const {
+            return viewSize;
+        }
+        bool empty() const {
+            return viewSize == 0;
+        }
+        const quint16 &operator[](qint32 index) const {
+            return viewData[index];
+        }
+        const quint16 *begin() const {
+            return viewData;
+        }
+        const quint16 *end() const {
+            return viewData + viewSize;
+        }
+
+        // Return a modifiable copy of the samples
+        Data toData() const {
+            Data copy(viewSize);
+            std::copy(begin(), end(), copy.begin());
+            return copy;
+        }
+
+    private:
+        friend class SourceVideo;
+
+        View(const quint16 *_data, qint32 _size)
+            : viewData(_data), viewSize(_size) {}
+
+        Data owner;
+        const quint16 *viewData = nullptr;
+        qint32 viewSize = 0;
+    };
+
     SourceVideo();
     ~SourceVideo();
 
@@ -48,16 +106,35 @@ public:
 
     // File handling methods
     bool open(QString filename, qint32 _fieldLength, qint32 _fieldLineLength = -1);
+    bool openParts(QStringList filenames, qint32 _fieldLength, qint32 _fieldLineLength = -1);
     void close(void);
 
     // Field handling methods
     Data getVideoField(qint32 fieldNumber, qint32 startFieldLine = -1, qint32 endFieldLine = -1);
+    View getVideoFieldView(qint32 fieldNumber);
+    void getVideoFields(qint32 firstFieldNumber, qint32 count, Data &buffer);
+    void getVideoFieldLines(qint32 firstFieldNumber, qint32 count, qint32 startFieldLine, qint32 endFieldLine,
+                            Data &buffer);
 
     // Get and set methods
     bool isSourceValid();
+    bool isSourceMapped();
     qint32 getNumberOfAvailableFields();
     qint32 getFieldLength();
 
+    // Background prefetching
+    void setPrefetchWindow(qint32 fields);
+    qint64 getPrefetchHits();
+    qint64 getPrefetchMisses();
+
+    // Streaming from stdin
+    void setStreamWindow(qint32 fields);
+
+    // Following a file that's still being written
+    static constexpr qint32 DEFAULT_FOLLOW_TIMEOUT = 30000;
+    void setFollowMode(bool follow, qint32 idleTimeout = DEFAULT_FOLLOW_TIMEOUT);
+    bool waitForFields(qint32 numberOfFields);
+
 private:
     // File handling globals
     QFile inputFile;
@@ -68,10 +145,65 @@ private:
     qint32 fieldByteLength;
     qint32 fieldLineLength;
 
-    Data outputFieldData;
-
-    // Field caching
-    QCache<qint32, Data> fieldCache;
+    // Memory-mapped input (nullptr if the input could not be mapped)
+    const uchar *mappedFile;
+    qint64 mappedFileSize;
+
+    // Compressed input (see compressedtbc.h)
+    bool isCompressed;
+    qint32 compressedFieldWidth;
+    qint32 compressedFieldHeight;
+    QVector<qint64> compressedFieldPositions;
+
+    // Split input (see tbcparts.h): the parts' files, and the position of each
+    // part within the combined input, followed by the combined length
+    std::vector<std::unique_ptr<QFile>> partFiles;
+    QVector<qint64> partStartPositions;
+
+    // Serialises positioned reads on platforms without pread
+    QMutex readMutex;
+
+    // Field caching (shared with other SourceVideos in the process)
+    FieldCache &fieldCache;
+    qint32 cacheSourceId;
+
+    // Background prefetching (nullptr if disabled)
+    class Prefetcher;
+    std::unique_ptr<Prefetcher> prefetcher;
+    qint32 prefetchWindow;
+    qint64 prefetchHits;
+    qint64 prefetchMisses;
+
+    // Streaming from stdin: the most recent streamWindow fields, indexed by
+    // field number modulo streamWindow (empty if not streaming)
+    qint32 streamWindow;
+    QVector<Data> streamFields;
+    qint32 streamNextField;
+
+    // Following a file that's still being written (the timeout is in ms)
+    bool followMode;
+    qint32 followIdleTimeout;
+
+    void openCompleted(const QString &cacheName);
+    void startPrefetcher();
+    void stopPrefetcher();
+    bool getPrefetchedField(qint32 fieldNumber, Data &fieldData);
+    void notifyPrefetcher(qint32 fieldNumber);
+    bool isStreaming();
+    Data getStreamField(qint32 fieldNumber);
+    bool isFollowing();
+    void updateAvailableFields();
+    bool mapInputFile();
+    bool openCompressedInputFile();
+    bool readCompressedFields(qint32 firstFieldNumber, qint32 count, quint16 *samples);
+    bool readFieldsAt(qint32 firstFieldNumber, qint32 count, quint16 *samples);
+    bool readInputFileAt(qint64 position, qint64 length, char *buffer);
+    bool readFileAt(QFile &file, qint64 position, qint64 length, char *buffer);
+    void adviseInputFile(qint64 start, qint64 length, bool willNeed);
+    qint64 getRequiredStartPosition(qint32 fieldNumber, qint32 startFieldLine, qint32 endFieldLine, qint64 &requiredReadLength);
+    void readInputFile(qint64 requiredStartPosition, qint64 requiredReadLength, char *buffer);
+    void readInputFileStrided(qint64 requiredStartPosition, qint64 requiredReadLength, qint64 stride, qint32 count,
+                              char *buffer);
 };
 
 #endif // SOURCEVIDEO_H
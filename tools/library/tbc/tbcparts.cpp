@@ -0,0 +1,88 @@
+/************************************************************************
+
+    tbcparts.cpp
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include "tbcparts.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+const char TbcParts::MAGIC[] = "# ld-decode-tools TBC parts";
+
+// Return true if fileName is a manifest file. This only reads the start of the
+// file, so it's cheap to call on a TBC file.
+bool TbcParts::isManifest(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) return false;
+
+    const QByteArray magic(MAGIC);
+    return file.read(magic.size()) == magic;
+}
+
+// Read the list of parts from a manifest file. Returns true on success.
+bool TbcParts::readManifest(const QString &fileName, QStringList &partFileNames)
+{
+    QFile file(fileName);
+    if (!isManifest(fileName) || !file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qCritical() << "Could not read" << fileName << "as a TBC parts manifest";
+        return false;
+    }
+
+    const QDir manifestDir = QFileInfo(fileName).absoluteDir();
+    partFileNames.clear();
+    while (!file.atEnd()) {
+        const QString line = QString::fromUtf8(file.readLine()).trimmed();
+        if (line.isEmpty() || line.startsWith('#')) continue;
+
+        partFileNames.append(QDir::cleanPath(manifestDir.absoluteFilePath(line)));
+    }
+
+    if (partFileNames.isEmpty()) {
+        qCritical() << "TBC parts manifest" << fileName << "does not list any parts";
+        return false;
+    }
+
+    return true;
+}
+
+// If jsonFileName is the metadata filename for a manifest (i.e. the manifest's
+// filename plus .json), and that file doesn't exist, get the metadata
+// filenames for the parts instead. Returns true if it is.
+bool TbcParts::getJsonPartFileNames(const QString &jsonFileName, QStringList &jsonFileNames)
+{
+    if (!jsonFileName.endsWith(".json") || QFileInfo::exists(jsonFileName)) return false;
+
+    const QString manifestFileName = jsonFileName.left(jsonFileName.size() - 5);
+    QStringList partFileNames;
+    if (!isManifest(manifestFileName) || !readManifest(manifestFileName, partFileNames)) return false;
+
+    jsonFileNames.clear();
+    for (const QString &partFileName : partFileNames) {
+        jsonFileNames.append(partFileName + ".json");
+    }
+
+    return true;
+}
@@ -0,0 +1,54 @@
+/************************************************************************
+
+    tbcparts.h
+
+    ld-decode-tools TBC library
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#ifndef TBCPARTS_H
+#define TBCPARTS_H
+
+#include <QString>
+#include <QStringList>
+
+// Captures that have been split into several parts.
+//
+// Each part is an ordinary TBC file, with its own .json (and .pcm, if there is
+// audio). The parts can be used as a single source, without joining them
+// together, by listing them in a manifest file: a text file whose first line
+// is MAGIC, followed by the parts' TBC filenames in order, one per line.
+// Relative filenames are relative to the directory containing the manifest;
+// blank lines and lines starting with # are ignored.
+//
+// The manifest can then be given to the tools in place of a TBC file.
+// SourceVideo and SourceAudio read the parts as if they had been joined, and
+// LdDecodeMetaData joins the parts' metadata if the manifest's own .json file
+// doesn't exist.
+class TbcParts
+{
+public:
+    static const char MAGIC[];
+
+    static bool isManifest(const QString &fileName);
+    static bool readManifest(const QString &fileName, QStringList &partFileNames);
+    static bool getJsonPartFileNames(const QString &jsonFileName, QStringList &jsonFileNames);
+};
+
+#endif // TBCPARTS_H
@@ -0,0 +1,148 @@
+/************************************************************************
+
+    testcompressedtbc.cpp
+
+    Unit tests for compressed TBC files
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include <QTemporaryDir>
+#include <QVector>
+#include <cassert>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+#include "compressedtbc.h"
+#include "sourcevideo.h"
+
+// Small fields, so the tests run quickly
+static constexpr qint32 FIELD_WIDTH = 256;
+static constexpr qint32 FIELD_HEIGHT = 40;
+static constexpr qint32 FIELD_LENGTH = FIELD_WIDTH * FIELD_HEIGHT;
+
+// Make a field that looks roughly like video: a subcarrier-like sine wave
+// with noise, some lines of extreme values, and some lines of random data
+QVector<quint16> makeField(qint32 fieldNumber)
+{
+    std::mt19937 random(fieldNumber);
+    std::uniform_int_distribution<qint32> noise(-20, 20);
+    std::uniform_int_distribution<qint32> anything(0, 65535);
+
+    QVector<quint16> field(FIELD_LENGTH);
+    for (qint32 y = 0; y < FIELD_HEIGHT; y++) {
+        for (qint32 x = 0; x < FIELD_WIDTH; x++) {
+            qint32 value;
+            if (y == 3) {
+                value = (x % 2) == 0 ? 0 : 65535;
+            } else if (y == 7) {
+                value = anything(random);
+            } else {
+                value = 20000 + (y * 100) + static_cast<qint32>(8000.0 * sin((x + y + fieldNumber) * 0.6)) + noise(random);
+            }
+            field[(y * FIELD_WIDTH) + x] = static_cast<quint16>(value);
+        }
+    }
+    return field;
+}
+
+// Check that fields survive encoding and decoding
+void testRoundTrip()
+{
+    printf("Testing field round trip\n");
+
+    bool b;
+    for (qint32 fieldNumber = 0; fieldNumber < 8; fieldNumber++) {
+        const QVector<quint16> field = makeField(fieldNumber);
+
+        QByteArray encoded;
+        CompressedTbc::encodeField(field.constData(), FIELD_WIDTH, FIELD_HEIGHT, encoded);
+
+        QVector<quint16> decoded(FIELD_LENGTH);
+        b = CompressedTbc::decodeField(encoded.constData(), encoded.size(), FIELD_WIDTH, FIELD_HEIGHT,
+                                       decoded.data());
+        assert(b);
+        assert(decoded == field);
+
+        // Truncated input must be rejected
+        b = CompressedTbc::decodeField(encoded.constData(), encoded.size() / 2, FIELD_WIDTH, FIELD_HEIGHT,
+                                       decoded.data());
+        assert(!b);
+    }
+}
+
+// Check that SourceVideo reads a compressed file the same as a raw one
+void testSourceVideo()
+{
+    printf("Testing SourceVideo\n");
+
+    static constexpr qint32 NUM_FIELDS = 20;
+    bool b;
+
+    QTemporaryDir tempDir;
+    assert(tempDir.isValid());
+    const QString filename = tempDir.filePath("test.tbc");
+
+    // Write the file
+    CompressedTbcWriter writer;
+    b = writer.open(filename, FIELD_WIDTH, FIELD_HEIGHT, 4);
+    assert(b);
+    for (qint32 fieldNumber = 0; fieldNumber < NUM_FIELDS; fieldNumber++) {
+        b = writer.writeFields(makeField(fieldNumber).constData(), 1);
+        assert(b);
+    }
+    b = writer.close();
+    assert(b);
+
+    // The dimensions must match
+    SourceVideo badSourceVideo;
+    b = badSourceVideo.open(filename, FIELD_LENGTH, FIELD_WIDTH + 1);
+    assert(!b);
+
+    // Read it back, one field at a time and in groups
+    SourceVideo sourceVideo;
+    b = sourceVideo.open(filename, FIELD_LENGTH, FIELD_WIDTH);
+    assert(b);
+    assert(sourceVideo.getNumberOfAvailableFields() == NUM_FIELDS);
+
+    for (qint32 fieldNumber = 0; fieldNumber < NUM_FIELDS; fieldNumber++) {
+        const QVector<quint16> expected = makeField(fieldNumber);
+        SourceVideo::Data field = sourceVideo.getVideoField(fieldNumber + 1);
+        assert(field == expected);
+
+        SourceVideo::Data lines = sourceVideo.getVideoField(fieldNumber + 1, 5, 10);
+        assert(lines == expected.mid(4 * FIELD_WIDTH, 6 * FIELD_WIDTH));
+    }
+
+    SourceVideo::Data fields;
+    sourceVideo.getVideoFields(3, 10, fields);
+    for (qint32 i = 0; i < 10; i++) {
+        assert(fields.mid(i * FIELD_LENGTH, FIELD_LENGTH) == makeField(i + 2));
+    }
+
+    sourceVideo.close();
+}
+
+int main()
+{
+    testRoundTrip();
+    testSourceVideo();
+
+    return 0;
+}
@@ -0,0 +1,161 @@
+/************************************************************************
+
+    testfieldcache.cpp
+
+    Unit tests for FieldCache
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include <cassert>
+#include <cstdio>
+
+#include "fieldcache.h"
+
+// The size of a PAL field (1135 x 313 samples), in samples and bytes
+static constexpr qint32 FIELD_SAMPLES = 1135 * 313;
+static constexpr qint64 FIELD_BYTES = FIELD_SAMPLES * static_cast<qint64>(sizeof(quint16));
+
+// Make a field whose samples are all the field number, so it can be checked
+FieldCache::Data makeField(qint32 fieldNumber)
+{
+    return FieldCache::Data(FIELD_SAMPLES, static_cast<quint16>(fieldNumber));
+}
+
+// Check that a field is in the cache and has the right contents
+bool isCached(FieldCache &cache, qint32 sourceId, qint32 fieldNumber)
+{
+    FieldCache::Data data;
+    if (!cache.find(sourceId, fieldNumber, data)) return false;
+
+    assert(data.size() == FIELD_SAMPLES);
+    assert(data[0] == static_cast<quint16>(fieldNumber));
+    assert(data[FIELD_SAMPLES - 1] == static_cast<quint16>(fieldNumber));
+    return true;
+}
+
+// With a limit that's much smaller than one field per shard, fields should
+// still be cached, and the total size should stay within the limit
+void testSmallLimit()
+{
+    printf("Small limit\n");
+
+    const qint64 byteLimit = 3 * FIELD_BYTES;
+    FieldCache cache(byteLimit);
+    const qint32 sourceId = cache.registerSource("");
+
+    for (qint32 fieldNumber = 0; fieldNumber < 50; fieldNumber++) {
+        cache.insert(sourceId, fieldNumber, makeField(fieldNumber));
+
+        // The field just inserted must be retrievable
+        const bool found = isCached(cache, sourceId, fieldNumber);
+        assert(found);
+
+        const FieldCache::Statistics statistics = cache.getStatistics();
+        assert(statistics.bytes <= byteLimit);
+    }
+
+    // The most recently used fields should be the ones that were kept
+    qint32 numCached = 0;
+    for (qint32 fieldNumber = 0; fieldNumber < 50; fieldNumber++) {
+        if (isCached(cache, sourceId, fieldNumber)) numCached++;
+    }
+    printf("  %d fields cached\n", numCached);
+    assert(numCached == 3);
+    for (qint32 fieldNumber = 47; fieldNumber < 50; fieldNumber++) {
+        const bool found = isCached(cache, sourceId, fieldNumber);
+        assert(found);
+    }
+
+    const FieldCache::Statistics statistics = cache.getStatistics();
+    assert(statistics.bytes == 3 * FIELD_BYTES);
+    assert(statistics.evictions == 47);
+
+    cache.releaseSource(sourceId);
+    assert(cache.getStatistics().bytes == 0);
+}
+
+// A field that's bigger than the whole limit is never cached
+void testTooSmallLimit()
+{
+    printf("Limit smaller than a field\n");
+
+    FieldCache cache(FIELD_BYTES - 1);
+    const qint32 sourceId = cache.registerSource("");
+
+    cache.insert(sourceId, 0, makeField(0));
+    const bool found = isCached(cache, sourceId, 0);
+    assert(!found);
+    assert(cache.getStatistics().bytes == 0);
+}
+
+// Reducing the limit discards fields until the cache fits
+void testShrinkLimit()
+{
+    printf("Shrinking the limit\n");
+
+    FieldCache cache(100 * FIELD_BYTES);
+    const qint32 sourceId = cache.registerSource("");
+
+    for (qint32 fieldNumber = 0; fieldNumber < 40; fieldNumber++) {
+        cache.insert(sourceId, fieldNumber, makeField(fieldNumber));
+    }
+    assert(cache.getStatistics().bytes == 40 * FIELD_BYTES);
+
+    cache.setByteLimit(5 * FIELD_BYTES);
+    assert(cache.getByteLimit() == 5 * FIELD_BYTES);
+    assert(cache.getStatistics().bytes <= 5 * FIELD_BYTES);
+
+    // New fields still fit after shrinking
+    cache.insert(sourceId, 100, makeField(100));
+    const bool found = isCached(cache, sourceId, 100);
+    assert(found);
+    assert(cache.getStatistics().bytes <= 5 * FIELD_BYTES);
+}
+
+// The sequential policy should keep the highest-numbered fields
+void testSequentialPolicy()
+{
+    printf("Sequential policy\n");
+
+    FieldCache cache(4 * FIELD_BYTES);
+    cache.setEvictionPolicy(FieldCache::SEQUENTIAL);
+    const qint32 sourceId = cache.registerSource("");
+
+    for (qint32 fieldNumber = 0; fieldNumber < 20; fieldNumber++) {
+        cache.insert(sourceId, fieldNumber, makeField(fieldNumber));
+    }
+
+    // Each shard evicts its own lowest-numbered field, so with fields spread
+    // over the shards only the latest ones survive
+    for (qint32 fieldNumber = 16; fieldNumber < 20; fieldNumber++) {
+        const bool found = isCached(cache, sourceId, fieldNumber);
+        assert(found);
+    }
+    assert(cache.getStatistics().bytes == 4 * FIELD_BYTES);
+}
+
+int main()
+{
+    testSmallLimit();
+    testTooSmallLimit();
+    testShrinkLimit();
+    testSequentialPolicy();
+
+    return 0;
+}
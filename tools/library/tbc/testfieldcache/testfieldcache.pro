@@ -0,0 +1,14 @@
+CONFIG += c++17 testcase
+CONFIG -= app_bundle
+
+SOURCES += \
+    testfieldcache.cpp \
+    ../fieldcache.cpp
+
+HEADERS += \
+    ../fieldcache.h
+
+INCLUDEPATH += \
+    ..
+
+target.CONFIG += no_default_install
@@ -3,16 +3,24 @@ CONFIG -= app_bundle
 
 SOURCES += \
     testlinenumber.cpp \
+    ../binarymetadata.cpp \
     ../dropouts.cpp \
+    ../fieldstore.cpp \
     ../jsonio.cpp \
     ../lddecodemetadata.cpp \
+    ../parallelfor.cpp \
+    ../tbcparts.cpp \
     ../vbidecoder.cpp
 
 HEADERS += \
+    ../binarymetadata.h \
     ../dropouts.h \
+    ../fieldstore.h \
     ../jsonio.h \
     ../lddecodemetadata.h \
     ../linenumber.h \
+    ../parallelfor.h \
+    ../tbcparts.h \
     ../vbidecoder.h
 
 INCLUDEPATH += \
@@ -24,11 +24,20 @@
 
 #include <QCoreApplication>
 #include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QThread>
 #include <cmath>
 #include <cstdlib>
 #include <iostream>
+#include <limits>
+#include <random>
 #include <sstream>
 
+#include "fieldstore.h"
 #include "jsonio.h"
 #include "lddecodemetadata.h"
 
@@ -227,6 +236,753 @@ void testVideoSystem() {
     assert(!b);
 }
 
+// Check that metadata survives conversion to binary and back
+// Make some metadata that uses all the optional members in the first few
+// fields, with more typical fields after that
+void makeTestMetaData(LdDecodeMetaData &metaData, qint32 numberOfFields = 5) {
+    LdDecodeMetaData::VideoParameters videoParameters;
+    videoParameters.system = PAL;
+    videoParameters.fieldWidth = 1135;
+    videoParameters.fieldHeight = 313;
+    videoParameters.sampleRate = 17734475.0;
+    videoParameters.gitBranch = "branch";
+    videoParameters.isValid = true;
+    metaData.setVideoParameters(videoParameters);
+
+    for (qint32 i = 0; i < numberOfFields; i++) {
+        LdDecodeMetaData::Field field;
+        field.seqNo = i + 1;
+        field.isFirstField = (i % 2) == 0;
+        field.syncConf = 100 - i;
+        field.medianBurstIRE = 0.1 * i + 1.0 / 3.0;
+        field.fieldPhaseID = i % 8;
+        if (i == 1) field.audioSamples = 882;
+        if (i == 2) {
+            field.vitsMetrics.inUse = true;
+            field.vitsMetrics.wSNR = 42.123456789;
+            field.vitsMetrics.bPSNR = -1.5e-9;
+            field.vbi.inUse = true;
+            field.vbi.vbiData = {0x8ba000, 0xf80000, 0xf81234};
+            field.ntsc.inUse = true;
+            field.ntsc.isFmCodeDataValid = true;
+            field.ntsc.fmCodeData = 12345;
+            field.ntsc.whiteFlag = true;
+            field.ntsc.ccData0 = 20;
+        }
+        if (i == 3) {
+            field.dropOuts.append(10, 20, 30);
+            field.dropOuts.append(40, 50, 60);
+            field.pad = true;
+            field.decodeFaults = 4;
+        }
+        if (i >= 5) {
+            field.audioSamples = 882 + (i % 3);
+            field.vitsMetrics.inUse = true;
+            field.vitsMetrics.wSNR = 40.0 + (i % 100) / 7.0;
+            field.vitsMetrics.bPSNR = 35.0 + (i % 50) / 3.0;
+            field.vbi.inUse = true;
+            field.vbi.vbiData = {0x8ba000 + (i % 1000), 0xf80000 + i, 0xf80000 + i};
+            for (qint32 j = 0; j < i % 4; j++) {
+                field.dropOuts.append(100 * j + (i % 50), 100 * j + 60, 20 + (i % 280));
+            }
+        }
+        metaData.appendField(field);
+    }
+}
+
+// Check that two files have the same contents
+bool filesMatch(const QString &fileName1, const QString &fileName2) {
+    QFile file1(fileName1);
+    QFile file2(fileName2);
+    return file1.open(QIODevice::ReadOnly) && file2.open(QIODevice::ReadOnly) && file1.readAll() == file2.readAll();
+}
+
+void testBinaryMetadata() {
+    std::cerr << "Testing binary metadata\n";
+
+    bool b;
+    QTemporaryDir tempDir;
+    assert(tempDir.isValid());
+    const QString jsonFileName = tempDir.filePath("test.tbc.json");
+    const QString binaryFileName = tempDir.filePath("test.tbc.ldmeta");
+    const QString roundTripFileName = tempDir.filePath("roundtrip.tbc.json");
+
+    LdDecodeMetaData metaData;
+    makeTestMetaData(metaData);
+
+    // JSON -> binary -> JSON should give the same file
+    b = metaData.write(jsonFileName);
+    assert(b);
+    b = metaData.write(binaryFileName);
+    assert(b);
+
+    LdDecodeMetaData binaryMetaData;
+    b = binaryMetaData.read(binaryFileName);
+    assert(b);
+    assert(binaryMetaData.getNumberOfFields() == 5);
+    assert(binaryMetaData.getFieldDropOuts(4).size() == 2);
+    b = binaryMetaData.writeJson(roundTripFileName);
+    assert(b);
+    assert(filesMatch(jsonFileName, roundTripFileName));
+
+    // The binary file should be found in place of a missing JSON file
+    QFile::remove(jsonFileName);
+    LdDecodeMetaData sidecarMetaData;
+    b = sidecarMetaData.read(jsonFileName);
+    assert(b);
+    assert(sidecarMetaData.getNumberOfFields() == 5);
+}
+
+void testLazyMetadata() {
+    std::cerr << "Testing lazy metadata loading\n";
+
+    bool b;
+    QTemporaryDir tempDir;
+    assert(tempDir.isValid());
+    const QString jsonFileName = tempDir.filePath("test.tbc.json");
+    const QString indexFileName = jsonFileName + LdDecodeMetaData::FIELD_INDEX_SUFFIX;
+    const QString roundTripFileName = tempDir.filePath("roundtrip.tbc.json");
+
+    LdDecodeMetaData metaData;
+    makeTestMetaData(metaData);
+    b = metaData.write(jsonFileName);
+    assert(b);
+
+    // Read it twice: the first read makes the index, and the second uses it
+    for (qint32 pass = 0; pass < 2; pass++) {
+        LdDecodeMetaData lazyMetaData;
+        lazyMetaData.setLazyLoading(true);
+        b = lazyMetaData.read(jsonFileName);
+        assert(b);
+        assert(QFile::exists(indexFileName));
+
+        assert(lazyMetaData.getNumberOfFields() == 5);
+        assert(lazyMetaData.getVideoParameters().fieldWidth == 1135);
+        assert(lazyMetaData.getFieldPcmAudioLength(1) == 882);
+        assert(lazyMetaData.getFieldDropOuts(4).size() == 2);
+        assert(lazyMetaData.getFieldVbi(3).vbiData[2] == 0xf81234);
+
+        // Loading the rest of the fields should give the same file
+        b = lazyMetaData.writeJson(roundTripFileName);
+        assert(b);
+        assert(filesMatch(jsonFileName, roundTripFileName));
+    }
+
+    // A corrupt index should be ignored, and replaced
+    QFile indexFile(indexFileName);
+    b = indexFile.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    assert(b);
+    b = indexFile.write(QByteArray(20, 'x')) == 20;
+    assert(b);
+    indexFile.close();
+
+    LdDecodeMetaData lazyMetaData;
+    lazyMetaData.setLazyLoading(true);
+    b = lazyMetaData.read(jsonFileName);
+    assert(b);
+    assert(lazyMetaData.getNumberOfFields() == 5);
+    assert(lazyMetaData.getField(3).vitsMetrics.wSNR == 42.123456789);
+    assert(QFileInfo(indexFileName).size() > 20);
+}
+
+void testParallelMetadata() {
+    std::cerr << "Testing parallel metadata parsing and writing\n";
+
+    bool b;
+    QTemporaryDir tempDir;
+    assert(tempDir.isValid());
+    const QString jsonFileName = tempDir.filePath("test.tbc.json");
+    const QString roundTripFileName = tempDir.filePath("roundtrip.tbc.json");
+
+    LdDecodeMetaData metaData;
+    makeTestMetaData(metaData, 3000);
+
+    // Serial and parallel writing should give the same output
+    const QString parallelFileName = tempDir.filePath("parallel.tbc.json");
+    metaData.setMaxThreads(1);
+    b = metaData.write(jsonFileName);
+    assert(b);
+    metaData.setMaxThreads(4);
+    b = metaData.write(parallelFileName);
+    assert(b);
+    assert(filesMatch(jsonFileName, parallelFileName));
+
+    // Serial and parallel parsing should give the same result
+    for (qint32 maxThreads : {1, 4}) {
+        LdDecodeMetaData readMetaData;
+        readMetaData.setMaxThreads(maxThreads);
+        b = readMetaData.read(jsonFileName);
+        assert(b);
+        assert(readMetaData.getNumberOfFields() == 3000);
+        b = readMetaData.writeJson(roundTripFileName);
+        assert(b);
+        assert(filesMatch(jsonFileName, roundTripFileName));
+    }
+
+    // A bad field in the middle should make both fail
+    QFile jsonFile(jsonFileName);
+    b = jsonFile.open(QIODevice::ReadOnly);
+    assert(b);
+    QByteArray contents = jsonFile.readAll();
+    jsonFile.close();
+    assert(contents.contains("\"seqNo\":2000,"));
+    contents.replace("\"seqNo\":2000,", "\"seqNo\":2000,,");
+    b = jsonFile.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    assert(b);
+    b = jsonFile.write(contents) == contents.size();
+    assert(b);
+    jsonFile.close();
+
+    for (qint32 maxThreads : {1, 4}) {
+        LdDecodeMetaData readMetaData;
+        readMetaData.setMaxThreads(maxThreads);
+        b = readMetaData.read(jsonFileName);
+        assert(!b);
+    }
+}
+
+// Check that two sets of dropouts are the same
+bool dropOutsMatch(const DropOuts &dropOuts1, const DropOuts &dropOuts2) {
+    if (dropOuts1.size() != dropOuts2.size()) return false;
+    for (qint32 i = 0; i < dropOuts1.size(); i++) {
+        if (dropOuts1.startx(i) != dropOuts2.startx(i) || dropOuts1.endx(i) != dropOuts2.endx(i)
+            || dropOuts1.fieldLine(i) != dropOuts2.fieldLine(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void testFieldStore() {
+    std::cerr << "Testing field store\n";
+
+    static constexpr qint32 NUM_FIELDS = 1000;
+
+    // Fields with only default values shouldn't need any memory
+    FieldStore store;
+    store.resize(NUM_FIELDS);
+    assert(store.size() == NUM_FIELDS);
+    assert(store.getMemoryUsage() == 0);
+    assert(store.get(NUM_FIELDS - 1).fieldPhaseID == -1);
+    assert(store.get(NUM_FIELDS - 1).audioSamples == -1);
+
+    // Every value should survive, including the sign of a zero
+    LdDecodeMetaData::Field field;
+    field.seqNo = 11;
+    field.isFirstField = true;
+    field.medianBurstIRE = -0.0;
+    field.pad = true;
+    field.vitsMetrics.bPSNR = 12.5;
+    field.vbi.inUse = true;
+    field.vbi.vbiData = {1, 2, 3};
+    field.ntsc.inUse = true;
+    field.ntsc.whiteFlag = true;
+    field.ntsc.ccData1 = 42;
+    field.dropOuts.append(4, 5, 6);
+    field.efmTValues = 7;
+    store.set(10, field);
+
+    const LdDecodeMetaData::Field readField = store.get(10);
+    assert(readField.seqNo == 11 && readField.isFirstField && readField.pad);
+    assert(readField.medianBurstIRE == 0.0 && std::signbit(readField.medianBurstIRE));
+    assert(!readField.vitsMetrics.inUse && readField.vitsMetrics.bPSNR == 12.5);
+    assert(readField.vbi.inUse && readField.vbi.vbiData == field.vbi.vbiData);
+    assert(readField.ntsc.inUse && !readField.ntsc.fieldFlag && readField.ntsc.whiteFlag && readField.ntsc.ccData1 == 42);
+    assert(dropOutsMatch(readField.dropOuts, field.dropOuts));
+    assert(readField.efmTValues == 7 && readField.diskLoc == -1);
+    assert(!store.getIsFirstField(9) && store.getIsFirstField(10));
+
+    // Replacing part of a field should leave the rest alone
+    LdDecodeMetaData::Ntsc ntsc;
+    store.setNtsc(10, ntsc);
+    assert(!store.get(10).ntsc.whiteFlag && store.get(10).pad && store.get(10).vbi.inUse);
+
+    // Replace the dropouts with sets of different sizes, so some are updated
+    // in place and some are moved, and check they all survive
+    std::mt19937 random(1);
+    std::uniform_int_distribution<qint32> fieldDist(0, NUM_FIELDS - 1);
+    std::uniform_int_distribution<qint32> countDist(0, 12);
+    QVector<DropOuts> expected(NUM_FIELDS);
+    expected[10] = field.dropOuts;
+    for (qint32 i = 0; i < 50000; i++) {
+        const qint32 fieldNumber = fieldDist(random);
+        DropOuts dropOuts;
+        for (qint32 j = countDist(random); j > 0; j--) dropOuts.append(i, i + j, fieldNumber);
+        store.setDropOuts(fieldNumber, dropOuts);
+        expected[fieldNumber] = dropOuts;
+    }
+    for (qint32 i = 0; i < NUM_FIELDS; i++) assert(dropOutsMatch(store.getDropOuts(i), expected[i]));
+    assert(store.getMemoryUsage() < 2 * 1024 * 1024);
+
+    // Appending should give the next field
+    store.append(field);
+    assert(store.size() == NUM_FIELDS + 1);
+    assert(dropOutsMatch(store.getDropOuts(NUM_FIELDS), field.dropOuts));
+    assert(store.getAudioSamples(NUM_FIELDS) == -1);
+
+    // Loading whole columns should give the same result as setting fields,
+    // and replace the dropouts that were there before
+    QVector<qint32> seqNos(NUM_FIELDS + 1), dropOutsStart(NUM_FIELDS + 2), dropOutValues;
+    QVector<double> wSNRs(NUM_FIELDS + 1);
+    QVector<quint8> flags(NUM_FIELDS + 1);
+    for (qint32 i = 0; i <= NUM_FIELDS; i++) {
+        seqNos[i] = i + 100;
+        wSNRs[i] = i * 0.25;
+        flags[i] = (i % 3 == 0) ? FieldStore::FLAG_IS_FIRST_FIELD : FieldStore::FLAG_PAD;
+        dropOutsStart[i] = dropOutValues.size();
+        for (qint32 j = 0; j < i % 4; j++) dropOutValues.append(i + j);
+    }
+    dropOutsStart[NUM_FIELDS + 1] = dropOutValues.size();
+    store.loadColumn(FieldStore::SEQ_NO, seqNos);
+    store.loadColumn(FieldStore::VITS_WSNR, wSNRs);
+    store.loadFlags(flags);
+    store.loadDropOuts(dropOutsStart, dropOutValues, dropOutValues, dropOutValues);
+    for (qint32 i = 0; i <= NUM_FIELDS; i++) {
+        const LdDecodeMetaData::Field loadedField = store.get(i);
+        assert(loadedField.seqNo == i + 100);
+        assert(loadedField.vitsMetrics.wSNR == i * 0.25);
+        assert(loadedField.isFirstField == (i % 3 == 0) && loadedField.pad == (i % 3 != 0));
+        assert(!loadedField.vbi.inUse);
+        assert(loadedField.dropOuts.size() == i % 4);
+        for (qint32 j = 0; j < i % 4; j++) assert(loadedField.dropOuts.fieldLine(j) == i + j);
+    }
+    assert(store.getMemoryUsage() < 2 * 1024 * 1024);
+}
+
+// Find the fields in a frame by searching forward for a first field, as
+// LdDecodeMetaData did before it had a frame map
+qint32 findFieldNumber(const QVector<bool> &isFirstFields, bool isFirstFieldFirst, qint32 frameNumber, qint32 field) {
+    const qint32 numberOfFields = isFirstFields.size();
+    qint32 firstFieldNumber = isFirstFieldFirst ? (frameNumber * 2) - 1 : frameNumber * 2;
+    while (firstFieldNumber <= numberOfFields && !isFirstFields[firstFieldNumber - 1]) firstFieldNumber++;
+    if (firstFieldNumber > numberOfFields) return -1;
+
+    const qint32 secondFieldNumber = isFirstFieldFirst ? firstFieldNumber + 1 : firstFieldNumber - 1;
+    if (secondFieldNumber > numberOfFields) return -1;
+
+    return field == 1 ? firstFieldNumber : secondFieldNumber;
+}
+
+// Check DropOutIndex's queries match a search of the dropouts
+void testDropOutIndex() {
+    std::cerr << "Testing dropout index\n";
+
+    static constexpr qint32 NUM_LINES = 20;
+    static constexpr qint32 FIELD_HEIGHT = NUM_LINES - 2;
+    static constexpr qint32 WIDTH = 100;
+
+    // Random dropouts, overlapping in places, with some invalid ones (including
+    // some on lines past the end of the field)
+    std::mt19937 random(42);
+    std::uniform_int_distribution<qint32> lineDist(-1, NUM_LINES);
+    std::uniform_int_distribution<qint32> xDist(-5, WIDTH + 5);
+    std::uniform_int_distribution<qint32> lengthDist(-2, 15);
+    DropOuts dropOuts;
+    for (qint32 i = 0; i < 60; i++) {
+        const qint32 startx = xDist(random);
+        dropOuts.append(startx, startx + lengthDist(random), lineDist(random));
+    }
+    dropOuts.append(10, 20, std::numeric_limits<qint32>::max());
+    dropOuts.append(10, 20, std::numeric_limits<qint32>::min());
+
+    // Lines outside the field never match
+    auto searchContains = [&](qint32 x, qint32 fieldLine) {
+        if (fieldLine < 1 || fieldLine > FIELD_HEIGHT) return false;
+        for (qint32 i = 0; i < dropOuts.size(); i++) {
+            if (dropOuts.fieldLine(i) == fieldLine && x >= dropOuts.startx(i) && x <= dropOuts.endx(i)) return true;
+        }
+        return false;
+    };
+    auto searchOverlaps = [&](qint32 fieldLine, qint32 startx, qint32 endx) {
+        if (fieldLine < 1 || fieldLine > FIELD_HEIGHT) return false;
+        for (qint32 i = 0; i < dropOuts.size(); i++) {
+            if (dropOuts.fieldLine(i) == fieldLine && dropOuts.startx(i) <= dropOuts.endx(i)
+                && endx >= dropOuts.startx(i) && dropOuts.endx(i) >= startx) return true;
+        }
+        return false;
+    };
+
+    assert(!DropOutIndex().contains(0, 1));
+    assert(DropOutIndex().empty());
+
+    const DropOutIndex index(dropOuts, FIELD_HEIGHT);
+    assert(!index.empty());
+    QVector<bool> mask(WIDTH);
+    for (qint32 fieldLine = -1; fieldLine <= NUM_LINES + 1; fieldLine++) {
+        index.getLineMask(fieldLine, mask);
+        for (qint32 x = -10; x < WIDTH + 10; x++) {
+            assert(index.contains(x, fieldLine) == searchContains(x, fieldLine));
+            if (x >= 0 && x < WIDTH) assert(mask[x] == searchContains(x, fieldLine));
+            for (qint32 length : {0, 3, 20}) {
+                assert(index.overlaps(fieldLine, x, x + length) == searchOverlaps(fieldLine, x, x + length));
+            }
+        }
+    }
+}
+
+// Check the fields in each frame match the result of searching
+void checkFrameNumbers(LdDecodeMetaData &metaData, const QVector<bool> &isFirstFields) {
+    for (bool isFirstFieldFirst : {true, false}) {
+        metaData.setIsFirstFieldFirst(isFirstFieldFirst);
+
+        const qint32 numberOfFrames = metaData.getNumberOfFrames();
+        const bool startsWithFirstField = isFirstFields[0];
+        assert(numberOfFrames == (isFirstFields.size() / 2) - (startsWithFirstField == isFirstFieldFirst ? 0 : 1));
+
+        for (qint32 frameNumber = 1; frameNumber <= numberOfFrames; frameNumber++) {
+            const qint32 expectedFirst = findFieldNumber(isFirstFields, isFirstFieldFirst, frameNumber, 1);
+            const qint32 expectedSecond = findFieldNumber(isFirstFields, isFirstFieldFirst, frameNumber, 2);
+            if (expectedFirst == -1 || expectedSecond == -1) continue;
+
+            assert(metaData.getFirstFieldNumber(frameNumber) == expectedFirst);
+            assert(metaData.getSecondFieldNumber(frameNumber) == expectedSecond);
+        }
+    }
+}
+
+// Check that fields are found correctly for each frame, including when the
+// field order has glitches
+void testFrameNumbers() {
+    std::cerr << "Testing frame numbers\n";
+
+    bool b;
+    QTemporaryDir tempDir;
+    assert(tempDir.isValid());
+    const QString jsonFileName = tempDir.filePath("test.tbc.json");
+
+    // Alternating fields, starting with a second field, with repeated first
+    // and second fields in places
+    QVector<bool> isFirstFields;
+    for (qint32 i = 0; i < 200; i++) {
+        bool isFirstField = (i % 2) == 1;
+        if (i == 50 || i == 120) isFirstField = true;
+        if (i >= 150 && i < 160) isFirstField = false;
+        isFirstFields.append(isFirstField);
+    }
+
+    LdDecodeMetaData metaData;
+    makeTestMetaData(metaData, 0);
+    for (qint32 i = 0; i < isFirstFields.size(); i++) {
+        LdDecodeMetaData::Field field;
+        field.seqNo = i + 1;
+        field.isFirstField = isFirstFields[i];
+        metaData.appendField(field);
+    }
+    checkFrameNumbers(metaData, isFirstFields);
+
+    // Changing a field should update the map
+    for (qint32 fieldNumber : {3, 77, 152, 200}) {
+        LdDecodeMetaData::Field field = metaData.getField(fieldNumber);
+        field.isFirstField = !field.isFirstField;
+        metaData.updateField(field, fieldNumber);
+        isFirstFields[fieldNumber - 1] = field.isFirstField;
+        checkFrameNumbers(metaData, isFirstFields);
+    }
+
+    // The map should be the same when read from a file, including lazily
+    metaData.setIsFirstFieldFirst(true);
+    b = metaData.write(jsonFileName);
+    assert(b);
+    for (bool lazy : {false, true, true}) {
+        LdDecodeMetaData readMetaData;
+        readMetaData.setLazyLoading(lazy);
+        b = readMetaData.read(jsonFileName);
+        assert(b);
+        checkFrameNumbers(readMetaData, isFirstFields);
+    }
+}
+
+// Check that changes recorded in a journal are applied when reading
+void testJournal() {
+    std::cerr << "Testing metadata journals\n";
+
+    bool b;
+    QTemporaryDir tempDir;
+    assert(tempDir.isValid());
+    const QString jsonFileName = tempDir.filePath("test.tbc.json");
+    const QString originalFileName = tempDir.filePath("original.tbc.json");
+    const QString expectedFileName = tempDir.filePath("expected.tbc.json");
+    const QString roundTripFileName = tempDir.filePath("roundtrip.tbc.json");
+    const QString journalFileName = jsonFileName + LdDecodeMetaData::JOURNAL_SUFFIX;
+
+    {
+        LdDecodeMetaData metaData;
+        makeTestMetaData(metaData, 10);
+        b = metaData.write(jsonFileName);
+        assert(b);
+        b = metaData.write(originalFileName);
+        assert(b);
+    }
+
+    // Make some changes, and write them to the journal
+    LdDecodeMetaData metaData;
+    metaData.setJournalling(true);
+    b = metaData.read(jsonFileName);
+    assert(b);
+
+    LdDecodeMetaData::VitsMetrics vitsMetrics;
+    vitsMetrics.inUse = true;
+    vitsMetrics.wSNR = 12.25;
+    vitsMetrics.bPSNR = 1.0 / 3.0;
+    metaData.updateFieldVitsMetrics(vitsMetrics, 1);
+    metaData.updateFieldVbi(LdDecodeMetaData::Vbi(), 3);
+    metaData.updateFieldNtsc(LdDecodeMetaData::Ntsc(), 3);
+    metaData.clearFieldDropOuts(4);
+    DropOuts dropOuts;
+    dropOuts.append(1, 2, 3);
+    metaData.updateFieldDropOuts(dropOuts, 5);
+
+    b = metaData.write(jsonFileName);
+    assert(b);
+    assert(QFileInfo::exists(journalFileName));
+    assert(filesMatch(jsonFileName, originalFileName));
+
+    // Add some more changes to the journal
+    LdDecodeMetaData::Field field = metaData.getField(7);
+    field.medianBurstIRE = 2.5;
+    field.vbi.vbiData[1] = 0x123456;
+    metaData.updateField(field, 7);
+    metaData.updateFieldVitsMetrics(vitsMetrics, 8);
+    b = metaData.write(jsonFileName);
+    assert(b);
+    b = metaData.writeJson(expectedFileName);
+    assert(b);
+
+    // Reading the JSON file should apply all the changes
+    {
+        LdDecodeMetaData readMetaData;
+        b = readMetaData.read(jsonFileName);
+        assert(b);
+        b = readMetaData.writeJson(roundTripFileName);
+        assert(b);
+        assert(filesMatch(expectedFileName, roundTripFileName));
+    }
+
+    // An incomplete record at the end should be ignored
+    {
+        QFile journalFile(journalFileName);
+        b = journalFile.open(QIODevice::WriteOnly | QIODevice::Append);
+        assert(b);
+        journalFile.write("{\"field\":2,\"vitsMe");
+        journalFile.close();
+
+        LdDecodeMetaData readMetaData;
+        b = readMetaData.read(jsonFileName);
+        assert(b);
+        b = readMetaData.writeJson(roundTripFileName);
+        assert(b);
+        assert(filesMatch(expectedFileName, roundTripFileName));
+    }
+
+    // Compacting should fold the journal into the JSON file
+    {
+        LdDecodeMetaData readMetaData;
+        b = readMetaData.read(jsonFileName);
+        assert(b);
+        b = readMetaData.compactJournal(jsonFileName);
+        assert(b);
+        assert(!QFileInfo::exists(journalFileName));
+        assert(filesMatch(expectedFileName, jsonFileName));
+    }
+
+    // Writing JSON should fail if the file can't be replaced, leaving any
+    // existing file alone
+    {
+        const QString dirName = tempDir.filePath("dir.tbc.json");
+        b = QDir().mkdir(dirName);
+        assert(b);
+        b = metaData.writeJson(dirName);
+        assert(!b);
+        assert(QFileInfo(dirName).isDir());
+    }
+
+    // A journal for a different version of the JSON file should be ignored
+    {
+        LdDecodeMetaData changedMetaData;
+        changedMetaData.setJournalling(true);
+        b = changedMetaData.read(jsonFileName);
+        assert(b);
+        changedMetaData.clearFieldDropOuts(6);
+        b = changedMetaData.write(jsonFileName);
+        assert(b);
+        assert(QFileInfo::exists(journalFileName));
+
+        QFile jsonFile(jsonFileName);
+        b = jsonFile.open(QIODevice::WriteOnly | QIODevice::Append);
+        assert(b);
+        jsonFile.write("\n");
+        jsonFile.close();
+
+        LdDecodeMetaData readMetaData;
+        b = readMetaData.read(jsonFileName);
+        assert(b);
+        b = readMetaData.writeJson(roundTripFileName);
+        assert(b);
+        assert(filesMatch(expectedFileName, roundTripFileName));
+    }
+}
+
+// Make the VBI for a field with a CAV picture number or a chapter number
+LdDecodeMetaData::Vbi makeTestVbi(qint32 picNo, qint32 chNo) {
+    auto toBcd = [](qint32 value) {
+        qint32 bcd = 0;
+        for (qint32 shift = 0; value != 0; shift += 4, value /= 10) bcd |= (value % 10) << shift;
+        return bcd;
+    };
+
+    LdDecodeMetaData::Vbi vbi;
+    vbi.inUse = true;
+    if (picNo != -1) vbi.vbiData[1] = 0xF80000 | toBcd(picNo);
+    if (chNo != -1) vbi.vbiData[1] = 0x800DDD | (toBcd(chNo) << 12);
+    return vbi;
+}
+
+// Check the decoded VBI for each frame, and the lookup from VBI frame numbers
+void checkFrameVbi(LdDecodeMetaData &metaData, qint32 numberOfFrames) {
+    assert(metaData.getNumberOfFrames() == numberOfFrames);
+    for (qint32 frameNumber = 1; frameNumber <= numberOfFrames; frameNumber++) {
+        const LdDecodeMetaData::FrameVbi frameVbi = metaData.getFrameVbi(frameNumber);
+        const qint32 expectedPicNo = frameNumber == 4 ? 102 : 99 + frameNumber;
+        assert(frameVbi.picNo == expectedPicNo);
+        assert(frameVbi.chNo == (frameNumber - 1) / 5);
+    }
+
+    // The first frame with a repeated picture number should be found
+    assert(metaData.getFrameNumberForVbiFrame(100) == 1);
+    assert(metaData.getFrameNumberForVbiFrame(102) == 3);
+    assert(metaData.getFrameNumberForVbiFrame(103) == -1);
+    assert(metaData.getFrameNumberForVbiFrame(104) == 5);
+    assert(metaData.getFrameNumberForVbiFrame(99 + numberOfFrames) == numberOfFrames);
+    assert(metaData.getFrameNumberForVbiFrame(100 + numberOfFrames) == -1);
+}
+
+// Check the VBI index is generated, invalidated and cached correctly
+void testVbiIndex() {
+    std::cerr << "Testing VBI index\n";
+
+    static constexpr qint32 NUMBER_OF_FRAMES = 30;
+
+    bool b;
+    QTemporaryDir tempDir;
+    assert(tempDir.isValid());
+    const QString jsonFileName = tempDir.filePath("test.tbc.json");
+    const QString indexFileName = jsonFileName + LdDecodeMetaData::VBI_INDEX_SUFFIX;
+
+    // Each frame has a picture number in its first field and a chapter number
+    // in its second, with frame 4 repeating the picture number of frame 3
+    LdDecodeMetaData metaData;
+    makeTestMetaData(metaData, 0);
+    for (qint32 i = 0; i < NUMBER_OF_FRAMES * 2; i++) {
+        const qint32 frameNumber = (i / 2) + 1;
+        LdDecodeMetaData::Field field;
+        field.seqNo = i + 1;
+        field.isFirstField = (i % 2) == 0;
+        if (field.isFirstField) {
+            field.vbi = makeTestVbi(frameNumber == 4 ? 102 : 99 + frameNumber, -1);
+        } else {
+            field.vbi = makeTestVbi(-1, (frameNumber - 1) / 5);
+        }
+        metaData.appendField(field);
+    }
+    metaData.setIsFirstFieldFirst(true);
+    checkFrameVbi(metaData, NUMBER_OF_FRAMES);
+
+    // Changing a field's VBI should update the index
+    metaData.updateFieldVbi(makeTestVbi(500, -1), 9);
+    assert(metaData.getFrameVbi(5).picNo == 500);
+    assert(metaData.getFrameNumberForVbiFrame(104) == -1);
+    assert(metaData.getFrameNumberForVbiFrame(500) == 5);
+    metaData.updateFieldVbi(makeTestVbi(104, -1), 9);
+    checkFrameVbi(metaData, NUMBER_OF_FRAMES);
+
+    // Reading the metadata should write an index file alongside it
+    b = metaData.write(jsonFileName);
+    assert(b);
+    assert(!QFileInfo::exists(indexFileName));
+    {
+        LdDecodeMetaData readMetaData;
+        b = readMetaData.read(jsonFileName);
+        assert(b);
+        checkFrameVbi(readMetaData, NUMBER_OF_FRAMES);
+        assert(QFileInfo::exists(indexFileName));
+    }
+
+    // ... which should be used next time. Change the picture number for frame
+    // 2 in the index to check this.
+    {
+        QFile indexFile(indexFileName);
+        b = indexFile.open(QIODevice::ReadWrite);
+        assert(b);
+        b = indexFile.seek(48 + 32 + 4);
+        assert(b);
+        b = indexFile.write(QByteArray("\x39\x30\0\0", 4)) == 4;
+        assert(b);
+        indexFile.close();
+
+        LdDecodeMetaData readMetaData;
+        b = readMetaData.read(jsonFileName);
+        assert(b);
+        assert(readMetaData.getFrameVbi(2).picNo == 12345);
+        assert(readMetaData.getFrameNumberForVbiFrame(12345) == 2);
+    }
+
+    // An index for a different version of the metadata should be ignored
+    {
+        QFile jsonFile(jsonFileName);
+        b = jsonFile.open(QIODevice::WriteOnly | QIODevice::Append);
+        assert(b);
+        jsonFile.write("\n");
+        jsonFile.close();
+
+        LdDecodeMetaData readMetaData;
+        readMetaData.setLazyLoading(true);
+        b = readMetaData.read(jsonFileName);
+        assert(b);
+        checkFrameVbi(readMetaData, NUMBER_OF_FRAMES);
+    }
+}
+
+// Compare serial and parallel parsing and writing of a large synthetic JSON file
+void runBenchmark() {
+    static constexpr qint32 BENCHMARK_FIELDS = 500000;
+
+    bool b;
+    QTemporaryDir tempDir;
+    assert(tempDir.isValid());
+    const QString jsonFileName = tempDir.filePath("benchmark.tbc.json");
+    const QString writeFileName = tempDir.filePath("written.tbc.json");
+
+    std::cerr << "Writing " << BENCHMARK_FIELDS << " fields of metadata\n";
+    {
+        LdDecodeMetaData metaData;
+        makeTestMetaData(metaData, BENCHMARK_FIELDS);
+        b = metaData.write(jsonFileName);
+        assert(b);
+    }
+    std::cerr << "JSON file is " << QFileInfo(jsonFileName).size() << " bytes\n";
+
+    QVector<qint32> threadCounts {1};
+    if (QThread::idealThreadCount() > 1) threadCounts.append(QThread::idealThreadCount());
+    for (qint32 maxThreads : threadCounts) {
+        QElapsedTimer timer;
+        timer.start();
+
+        LdDecodeMetaData metaData;
+        metaData.setMaxThreads(maxThreads);
+        b = metaData.read(jsonFileName);
+        assert(b);
+        assert(metaData.getNumberOfFields() == BENCHMARK_FIELDS);
+
+        std::cerr << "Read with " << maxThreads << " thread(s) in " << timer.elapsed() << " ms\n";
+
+        timer.restart();
+        b = metaData.write(writeFileName);
+        assert(b);
+
+        std::cerr << "Wrote with " << maxThreads << " thread(s) in " << timer.elapsed() << " ms\n";
+    }
+}
+
 int main(int argc, char *argv[])
 {
     // Initialise Qt
@@ -247,6 +1003,12 @@ int main(int argc, char *argv[])
     QCommandLineOption exitOption(QStringList() << "x" << "exit",
                                   "call exit(0) after parsing, to analyse memory usage");
     parser.addOption(exitOption);
+    QCommandLineOption benchmarkOption(QStringList() << "b" << "benchmark",
+                                       "time serial and parallel parsing of a synthetic 500k-field file");
+    parser.addOption(benchmarkOption);
+    QCommandLineOption lazyOption(QStringList() << "l" << "lazy",
+                                  "only parse fields when they are used");
+    parser.addOption(lazyOption);
 
     // Positional argument to specify input video file
     parser.addPositionalArgument("input", "Input JSON file (omit to run unit tests)");
@@ -257,12 +1019,25 @@ int main(int argc, char *argv[])
     // Parse the command line
     parser.process(app);
 
+    if (parser.isSet(benchmarkOption)) {
+        runBenchmark();
+        return 0;
+    }
+
     // Process the positional args
     QStringList positionalArguments = parser.positionalArguments();
     if (positionalArguments.count() == 0) {
         // Run unit tests
         testJsonReader();
         testVideoSystem();
+        testBinaryMetadata();
+        testLazyMetadata();
+        testParallelMetadata();
+        testFieldStore();
+        testDropOutIndex();
+        testJournal();
+        testFrameNumbers();
+        testVbiIndex();
         return 0;
     }
     if (positionalArguments.count() > 2) {
@@ -272,6 +1047,7 @@ int main(int argc, char *argv[])
 
     // Read the input file
     LdDecodeMetaData metaData;
+    metaData.setLazyLoading(parser.isSet(lazyOption));
     if (!metaData.read(positionalArguments.at(0))) {
         qCritical("Unable to read input file");
         return 1;
@@ -3,15 +3,23 @@ CONFIG -= app_bundle
 
 SOURCES += \
     testmetadata.cpp \
+    ../binarymetadata.cpp \
     ../dropouts.cpp \
+    ../fieldstore.cpp \
     ../jsonio.cpp \
     ../lddecodemetadata.cpp \
+    ../parallelfor.cpp \
+    ../tbcparts.cpp \
     ../vbidecoder.cpp
 
 HEADERS += \
+    ../binarymetadata.h \
     ../dropouts.h \
+    ../fieldstore.h \
     ../jsonio.h \
     ../lddecodemetadata.h \
+    ../parallelfor.h \
+    ../tbcparts.h \
     ../vbidecoder.h
 
 INCLUDEPATH += \
@@ -0,0 +1,537 @@
+/************************************************************************
+
+    testsourcevideo.cpp
+
+    Unit tests for SourceVideo
+    Copyright (C) 2026 ld-decode-tools contributors
+
+    This file is part of ld-decode-tools.
+
+    ld-decode-tools is free software: you can redistribute it and/or
+    modify it under the terms of the GNU General Public License as
+    published by the Free Software Foundation, either version 3 of the
+    License, or (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+************************************************************************/
+
+#include <QFile>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QThread>
+#include <QVector>
+#include <cassert>
+#include <cstdio>
+#include <functional>
+
+#include "sourcevideo.h"
+#include "tbcparts.h"
+
+#ifdef Q_OS_UNIX
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// Small fields, so the tests run quickly. A field is half a page, so fields
+// in a memory-mapped file don't start on page boundaries.
+static constexpr qint32 FIELD_WIDTH = 64;
+static constexpr qint32 FIELD_HEIGHT = 16;
+static constexpr qint32 FIELD_LENGTH = FIELD_WIDTH * FIELD_HEIGHT;
+static constexpr qint32 FIELD_BYTES = FIELD_LENGTH * sizeof(quint16);
+
+// The number of fields in the test input
+static constexpr qint32 NUM_FIELDS = 13;
+
+// Make a field (numbered from 1) where every sample is different from every
+// other sample in the input, so data from the wrong place can't match
+SourceVideo::Data makeField(qint32 fieldNumber)
+{
+    SourceVideo::Data field(FIELD_LENGTH);
+    for (qint32 i = 0; i < FIELD_LENGTH; i++) {
+        field[i] = static_cast<quint16>((fieldNumber << 10) ^ i);
+    }
+    return field;
+}
+
+// Get the expected contents of a range of lines (numbered from 1) from a field
+SourceVideo::Data makeLines(qint32 fieldNumber, qint32 startFieldLine, qint32 endFieldLine)
+{
+    return makeField(fieldNumber).mid((startFieldLine - 1) * FIELD_WIDTH,
+                                      (endFieldLine - startFieldLine + 1) * FIELD_WIDTH);
+}
+
+// Get the raw contents of fields [firstFieldNumber, lastFieldNumber], as
+// they'd appear in a TBC file
+QByteArray makeFieldBytes(qint32 firstFieldNumber, qint32 lastFieldNumber)
+{
+    QByteArray bytes;
+    for (qint32 fieldNumber = firstFieldNumber; fieldNumber <= lastFieldNumber; fieldNumber++) {
+        const SourceVideo::Data field = makeField(fieldNumber);
+        bytes.append(reinterpret_cast<const char *>(field.constData()), FIELD_BYTES);
+    }
+    return bytes;
+}
+
+// Write fields [firstFieldNumber, lastFieldNumber] to a TBC file. If
+// truncated is true, follow them with half a field of junk (as if the capture
+// had been cut short), which SourceVideo should ignore.
+void writeTbc(const QString &filename, qint32 firstFieldNumber, qint32 lastFieldNumber, bool truncated)
+{
+    QFile file(filename);
+    bool b;
+    b = file.open(QIODevice::WriteOnly);
+    assert(b);
+
+    QByteArray bytes = makeFieldBytes(firstFieldNumber, lastFieldNumber);
+    if (truncated) bytes.append(QByteArray(FIELD_BYTES / 2, '\xFF'));
+    b = file.write(bytes) == bytes.size();
+    assert(b);
+
+    file.close();
+}
+
+// Read every field of the input through each of SourceVideo's methods, and
+// check that they all give the same data as the original fields.
+//
+// The batched methods are called before anything has been cached, then again
+// with some fields in the cache, so they have to read several separate runs.
+void checkSource(SourceVideo &sourceVideo)
+{
+    assert(sourceVideo.getNumberOfAvailableFields() == NUM_FIELDS);
+
+    // Lines at the end of every field, read with strided reads
+    SourceVideo::Data buffer;
+    sourceVideo.getVideoFieldLines(1, NUM_FIELDS, FIELD_HEIGHT - 2, FIELD_HEIGHT, buffer);
+    assert(buffer.size() == NUM_FIELDS * 3 * FIELD_WIDTH);
+    for (qint32 i = 0; i < NUM_FIELDS; i++) {
+        assert(buffer.mid(i * 3 * FIELD_WIDTH, 3 * FIELD_WIDTH) == makeLines(i + 1, FIELD_HEIGHT - 2, FIELD_HEIGHT));
+    }
+
+    // All the lines of the last few fields, so there's no gap between ranges
+    sourceVideo.getVideoFieldLines(NUM_FIELDS - 3, 4, 1, FIELD_HEIGHT, buffer);
+    assert(buffer.size() == 4 * FIELD_LENGTH);
+    for (qint32 i = 0; i < 4; i++) {
+        assert(buffer.mid(i * FIELD_LENGTH, FIELD_LENGTH) == makeField(NUM_FIELDS - 3 + i));
+    }
+
+    // A run of whole fields ending at the last field, then some fields in the
+    // middle (which will leave them in the cache, if the source isn't mapped)
+    sourceVideo.getVideoFields(NUM_FIELDS - 3, 4, buffer);
+    assert(buffer.size() == 4 * FIELD_LENGTH);
+    for (qint32 i = 0; i < 4; i++) {
+        assert(buffer.mid(i * FIELD_LENGTH, FIELD_LENGTH) == makeField(NUM_FIELDS - 3 + i));
+    }
+    sourceVideo.getVideoFields(4, 3, buffer);
+    for (qint32 i = 0; i < 3; i++) {
+        assert(buffer.mid(i * FIELD_LENGTH, FIELD_LENGTH) == makeField(4 + i));
+    }
+
+    // Everything again, with some of the fields cached
+    sourceVideo.getVideoFieldLines(1, NUM_FIELDS, 2, 3, buffer);
+    for (qint32 i = 0; i < NUM_FIELDS; i++) {
+        assert(buffer.mid(i * 2 * FIELD_WIDTH, 2 * FIELD_WIDTH) == makeLines(i + 1, 2, 3));
+    }
+    sourceVideo.getVideoFields(1, NUM_FIELDS, buffer);
+    assert(buffer.size() == NUM_FIELDS * FIELD_LENGTH);
+    for (qint32 i = 0; i < NUM_FIELDS; i++) {
+        assert(buffer.mid(i * FIELD_LENGTH, FIELD_LENGTH) == makeField(i + 1));
+    }
+
+    // One field at a time, including lines at the start and end of the field
+    for (qint32 fieldNumber = 1; fieldNumber <= NUM_FIELDS; fieldNumber++) {
+        const SourceVideo::Data field = sourceVideo.getVideoField(fieldNumber);
+        assert(field == makeField(fieldNumber));
+
+        const SourceVideo::Data startLines = sourceVideo.getVideoField(fieldNumber, 1, 2);
+        assert(startLines == makeLines(fieldNumber, 1, 2));
+
+        const SourceVideo::Data endLines = sourceVideo.getVideoField(fieldNumber, FIELD_HEIGHT - 1, FIELD_HEIGHT);
+        assert(endLines == makeLines(fieldNumber, FIELD_HEIGHT - 1, FIELD_HEIGHT));
+
+        const SourceVideo::View view = sourceVideo.getVideoFieldView(fieldNumber);
+        assert(view.size() == FIELD_LENGTH);
+        assert(view.toData() == field);
+    }
+
+    // Backwards, which isn't what the prefetcher expects
+    for (qint32 fieldNumber = NUM_FIELDS; fieldNumber >= 1; fieldNumber--) {
+        const SourceVideo::View view = sourceVideo.getVideoFieldView(fieldNumber);
+        assert(view.toData() == makeField(fieldNumber));
+    }
+}
+
+// Check a memory-mapped file, with views pointing into the mapping
+void testMapped(const QString &filename)
+{
+    printf("Testing a memory-mapped file\n");
+
+    SourceVideo sourceVideo;
+    bool b;
+    b = sourceVideo.open(filename, FIELD_LENGTH, FIELD_WIDTH);
+    assert(b);
+    assert(sourceVideo.isSourceMapped());
+
+    checkSource(sourceVideo);
+
+    // Views of the same field should point at the same place in the mapping
+    const SourceVideo::View firstView = sourceVideo.getVideoFieldView(NUM_FIELDS);
+    const SourceVideo::View secondView = sourceVideo.getVideoFieldView(NUM_FIELDS);
+    assert(firstView.data() == secondView.data());
+
+    sourceVideo.close();
+}
+
+// Check a file that isn't mapped (following a file stops it being mapped),
+// which is read with pread and preadv
+void testUnmapped(const QString &filename)
+{
+    printf("Testing an unmapped file\n");
+
+    SourceVideo sourceVideo;
+    sourceVideo.setFollowMode(true, 0);
+    bool b;
+    b = sourceVideo.open(filename, FIELD_LENGTH, FIELD_WIDTH);
+    assert(b);
+    assert(!sourceVideo.isSourceMapped());
+
+    checkSource(sourceVideo);
+
+    sourceVideo.close();
+}
+
+// Read each field in order, pausing between them so the prefetcher can get
+// ahead, and check that some of them came from the prefetcher
+void readSequentially(SourceVideo &sourceVideo)
+{
+    for (qint32 fieldNumber = 1; fieldNumber <= NUM_FIELDS; fieldNumber++) {
+        const SourceVideo::Data field = sourceVideo.getVideoField(fieldNumber);
+        assert(field == makeField(fieldNumber));
+
+        QThread::msleep(20);
+    }
+
+    assert(sourceVideo.getPrefetchHits() > 0);
+}
+
+// Check reading with the prefetcher running
+void testPrefetch(const QString &filename, const QStringList &partFilenames)
+{
+    printf("Testing prefetching\n");
+
+    bool b;
+    for (qint32 window : {1, 4, NUM_FIELDS * 2}) {
+        // From the mapping
+        SourceVideo mappedSource;
+        mappedSource.setPrefetchWindow(window);
+        b = mappedSource.open(filename, FIELD_LENGTH, FIELD_WIDTH);
+        assert(b);
+        readSequentially(mappedSource);
+        checkSource(mappedSource);
+        mappedSource.close();
+
+        // Through the SourceVideo, with the window changed after opening
+        SourceVideo partsSource;
+        b = partsSource.openParts(partFilenames, FIELD_LENGTH, FIELD_WIDTH);
+        assert(b);
+        partsSource.setPrefetchWindow(window);
+        readSequentially(partsSource);
+        partsSource.close();
+
+        // Again, going straight to the batched and out-of-order reads
+        b = partsSource.openParts(partFilenames, FIELD_LENGTH, FIELD_WIDTH);
+        assert(b);
+        partsSource.setPrefetchWindow(window);
+        checkSource(partsSource);
+        partsSource.close();
+    }
+}
+
+// Check a capture split into parts, with a shorter final part, both directly
+// and through a manifest
+void testParts(const QStringList &partFilenames, const QString &manifestFilename)
+{
+    printf("Testing split input\n");
+
+    SourceVideo sourceVideo;
+    bool b;
+    b = sourceVideo.openParts(partFilenames, FIELD_LENGTH, FIELD_WIDTH);
+    assert(b);
+    assert(!sourceVideo.isSourceMapped());
+    checkSource(sourceVideo);
+    sourceVideo.close();
+
+    b = sourceVideo.open(manifestFilename, FIELD_LENGTH, FIELD_WIDTH);
+    assert(b);
+    checkSource(sourceVideo);
+    sourceVideo.close();
+}
+
+// Appends fields to a TBC file, one at a time, as ld-decode would
+class FollowWriter : public QThread
+{
+public:
+    FollowWriter(const QString &_filename, qint32 _firstFieldNumber)
+        : filename(_filename), firstFieldNumber(_firstFieldNumber) {}
+
+protected:
+    void run() override
+    {
+        QFile file(filename);
+        bool b;
+        b = file.open(QIODevice::WriteOnly | QIODevice::Append);
+        assert(b);
+
+        for (qint32 fieldNumber = firstFieldNumber; fieldNumber <= NUM_FIELDS; fieldNumber++) {
+            QThread::msleep(20);
+            const QByteArray bytes = makeFieldBytes(fieldNumber, fieldNumber);
+            b = file.write(bytes) == bytes.size();
+            assert(b);
+            file.flush();
+        }
+
+        file.close();
+    }
+
+private:
+    const QString filename;
+    const qint32 firstFieldNumber;
+};
+
+// Check following a file while it's being written
+void testFollow(const QString &filename)
+{
+    printf("Testing following a file\n");
+
+    // Start with a few fields, and a partly-written one
+    static constexpr qint32 INITIAL_FIELDS = 5;
+    {
+        QFile file(filename);
+        bool b;
+        b = file.open(QIODevice::WriteOnly);
+        assert(b);
+        QByteArray bytes = makeFieldBytes(1, INITIAL_FIELDS + 1);
+        bytes.chop(FIELD_BYTES / 2);
+        b = file.write(bytes) == bytes.size();
+        assert(b);
+        file.close();
+    }
+
+    SourceVideo sourceVideo;
+    sourceVideo.setFollowMode(true, 2000);
+    bool b;
+    b = sourceVideo.open(filename, FIELD_LENGTH, FIELD_WIDTH);
+    assert(b);
+    assert(sourceVideo.getNumberOfAvailableFields() == INITIAL_FIELDS);
+    const SourceVideo::Data initialField = sourceVideo.getVideoField(INITIAL_FIELDS);
+    assert(initialField == makeField(INITIAL_FIELDS));
+
+    // Finish the partly-written field, then append the rest of them
+    {
+        QFile file(filename);
+        b = file.open(QIODevice::WriteOnly | QIODevice::Append);
+        assert(b);
+        const QByteArray bytes = makeFieldBytes(INITIAL_FIELDS + 1, INITIAL_FIELDS + 1).mid(FIELD_BYTES / 2);
+        b = file.write(bytes) == bytes.size();
+        assert(b);
+        file.close();
+    }
+    FollowWriter writer(filename, INITIAL_FIELDS + 2);
+    writer.start();
+
+    // Reading the last field and lines from the end of it should wait until
+    // they've been written
+    const SourceVideo::Data lastLines = sourceVideo.getVideoField(NUM_FIELDS, FIELD_HEIGHT - 1, FIELD_HEIGHT);
+    assert(lastLines == makeLines(NUM_FIELDS, FIELD_HEIGHT - 1, FIELD_HEIGHT));
+    b = sourceVideo.waitForFields(NUM_FIELDS);
+    assert(b);
+    writer.wait();
+
+    checkSource(sourceVideo);
+
+    // The file has stopped growing, so waiting for more fields should time out
+    sourceVideo.close();
+    sourceVideo.setFollowMode(true, 200);
+    b = sourceVideo.open(filename, FIELD_LENGTH, FIELD_WIDTH);
+    assert(b);
+    b = sourceVideo.waitForFields(NUM_FIELDS + 1);
+    assert(!b);
+    assert(sourceVideo.getNumberOfAvailableFields() == NUM_FIELDS);
+    sourceVideo.close();
+}
+
+#ifdef Q_OS_UNIX
+// Run function in a child process with bytes on its stdin (through a pipe, so
+// it can't seek), and return the child's status from waitpid
+int runWithStdin(const QByteArray &bytes, const std::function<void()> &function)
+{
+    int pipeFds[2];
+    bool b;
+    b = pipe(pipeFds) == 0;
+    assert(b);
+
+    const pid_t pid = fork();
+    assert(pid != -1);
+    if (pid == 0) {
+        // Child
+        close(pipeFds[1]);
+        dup2(pipeFds[0], STDIN_FILENO);
+        close(pipeFds[0]);
+
+        function();
+        _exit(0);
+    }
+
+    // Parent -- write the data, stopping early if the child exits without
+    // reading all of it
+    close(pipeFds[0]);
+    signal(SIGPIPE, SIG_IGN);
+    qint64 position = 0;
+    while (position < bytes.size()) {
+        const ssize_t written = write(pipeFds[1], bytes.constData() + position, bytes.size() - position);
+        if (written <= 0) break;
+        position += written;
+    }
+    close(pipeFds[1]);
+
+    int status;
+    b = waitpid(pid, &status, 0) == pid;
+    assert(b);
+    return status;
+}
+#endif
+
+// Check reading from stdin through the stream window
+void testStream()
+{
+#ifdef Q_OS_UNIX
+    printf("Testing stdin\n");
+
+    static constexpr qint32 STREAM_WINDOW = 4;
+    const QByteArray bytes = makeFieldBytes(1, NUM_FIELDS);
+    int status;
+
+    // Read forwards, going back as far as the window allows each time
+    status = runWithStdin(bytes, [] {
+        SourceVideo sourceVideo;
+        sourceVideo.setStreamWindow(STREAM_WINDOW);
+        bool b;
+        b = sourceVideo.open("-", FIELD_LENGTH, FIELD_WIDTH);
+        assert(b);
+        assert(sourceVideo.getNumberOfAvailableFields() == -1);
+
+        SourceVideo::Data buffer;
+        for (qint32 fieldNumber = 1; fieldNumber <= NUM_FIELDS; fieldNumber++) {
+            const SourceVideo::Data field = sourceVideo.getVideoField(fieldNumber);
+            assert(field == makeField(fieldNumber));
+
+            const SourceVideo::Data endLines = sourceVideo.getVideoField(fieldNumber, FIELD_HEIGHT - 1, FIELD_HEIGHT);
+            assert(endLines == makeLines(fieldNumber, FIELD_HEIGHT - 1, FIELD_HEIGHT));
+
+            // The oldest field still in the window
+            const qint32 firstFieldNumber = qMax(1, fieldNumber - STREAM_WINDOW + 1);
+            const qint32 count = fieldNumber - firstFieldNumber + 1;
+            const SourceVideo::View view = sourceVideo.getVideoFieldView(firstFieldNumber);
+            assert(view.toData() == makeField(firstFieldNumber));
+
+            sourceVideo.getVideoFields(firstFieldNumber, count, buffer);
+            for (qint32 i = 0; i < count; i++) {
+                assert(buffer.mid(i * FIELD_LENGTH, FIELD_LENGTH) == makeField(firstFieldNumber + i));
+            }
+
+            sourceVideo.getVideoFieldLines(firstFieldNumber, count, FIELD_HEIGHT - 2, FIELD_HEIGHT, buffer);
+            for (qint32 i = 0; i < count; i++) {
+                assert(buffer.mid(i * 3 * FIELD_WIDTH, 3 * FIELD_WIDTH)
+                       == makeLines(firstFieldNumber + i, FIELD_HEIGHT - 2, FIELD_HEIGHT));
+            }
+        }
+
+        sourceVideo.close();
+    });
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    // Skipping forwards reads the fields in between, and the last field in
+    // the stream can be read
+    status = runWithStdin(bytes, [] {
+        SourceVideo sourceVideo;
+        sourceVideo.setStreamWindow(STREAM_WINDOW);
+        bool b;
+        b = sourceVideo.open("-", FIELD_LENGTH, FIELD_WIDTH);
+        assert(b);
+
+        const SourceVideo::Data lastField = sourceVideo.getVideoField(NUM_FIELDS);
+        assert(lastField == makeField(NUM_FIELDS));
+
+        const SourceVideo::Data oldestField = sourceVideo.getVideoField(NUM_FIELDS - STREAM_WINDOW + 1);
+        assert(oldestField == makeField(NUM_FIELDS - STREAM_WINDOW + 1));
+
+        sourceVideo.close();
+    });
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    // Going back to a field that has left the window is a fatal error
+    printf("Testing a stream window miss (a fatal error is expected)\n");
+    fflush(stdout);
+    status = runWithStdin(bytes, [] {
+        SourceVideo sourceVideo;
+        sourceVideo.setStreamWindow(STREAM_WINDOW);
+        bool b;
+        b = sourceVideo.open("-", FIELD_LENGTH, FIELD_WIDTH);
+        assert(b);
+
+        sourceVideo.getVideoField(NUM_FIELDS);
+        sourceVideo.getVideoField(NUM_FIELDS - STREAM_WINDOW);
+    });
+    assert(!WIFEXITED(status) || WEXITSTATUS(status) != 0);
+#else
+    printf("Skipping stdin tests on this platform\n");
+#endif
+}
+
+int main()
+{
+    QTemporaryDir tempDir;
+    assert(tempDir.isValid());
+
+    // A single file
+    const QString filename = tempDir.filePath("test.tbc");
+    writeTbc(filename, 1, NUM_FIELDS, true);
+
+    // The same fields split into three parts, with a short final part, and a
+    // manifest listing them
+    QStringList partFilenames;
+    partFilenames.append(tempDir.filePath("part1.tbc"));
+    partFilenames.append(tempDir.filePath("part2.tbc"));
+    partFilenames.append(tempDir.filePath("part3.tbc"));
+    writeTbc(partFilenames[0], 1, 5, false);
+    writeTbc(partFilenames[1], 6, 10, false);
+    writeTbc(partFilenames[2], 11, NUM_FIELDS, true);
+
+    const QString manifestFilename = tempDir.filePath("test.tbcparts");
+    {
+        QFile manifestFile(manifestFilename);
+        bool b;
+        b = manifestFile.open(QIODevice::WriteOnly);
+        assert(b);
+        const QByteArray manifest = QByteArray(TbcParts::MAGIC) + "\n# Parts, relative to the manifest\n\npart1.tbc\npart2.tbc\npart3.tbc\n";
+        b = manifestFile.write(manifest) == manifest.size();
+        assert(b);
+        manifestFile.close();
+    }
+
+    testMapped(filename);
+    testUnmapped(filename);
+    testParts(partFilenames, manifestFilename);
+    testPrefetch(filename, partFilenames);
+    testFollow(tempDir.filePath("follow.tbc"));
+    testStream();
+
+    return 0;
+}
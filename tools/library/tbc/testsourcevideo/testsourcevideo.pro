@@ -0,0 +1,22 @@
+CONFIG += c++17 testcase
+CONFIG -= app_bundle
+
+SOURCES += \
+    testsourcevideo.cpp \
+    ../compressedtbc.cpp \
+    ../fieldcache.cpp \
+    ../parallelfor.cpp \
+    ../sourcevideo.cpp \
+    ../tbcparts.cpp
+
+HEADERS += \
+    ../compressedtbc.h \
+    ../fieldcache.h \
+    ../parallelfor.h \
+    ../sourcevideo.h \
+    ../tbcparts.h
+
+INCLUDEPATH += \
+    ..
+
+target.CONFIG += no_default_install